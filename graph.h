@@ -2,6 +2,8 @@
 #include <iostream>
 #include "graph/adjacency_list.h"
 #include "graph/adjacency_matrix.h"
+#include "graph/csr.h"
+#include "graph/bit_matrix.h"
 
 
 namespace sal {
@@ -10,9 +12,17 @@ template <typename V, typename E = int>
 using graph = Adjacency_list<V,E>;
 template <typename E = int> 
 using graph_mat = Adjacency_matrix<size_t,E>;
+// immutable, built once from an edge list
+template <typename V, typename E = int>
+using graph_csr = Csr_graph<V,E>;
+// unweighted, one bit per edge
+using graph_bits = Bit_adjacency_matrix;
 // directed
 template <typename V, typename E = int>
 using digraph = Adjacency_list_directed<V,E>;
 template <typename E = int>
 using digraph_mat = Adjacency_matrix_directed<E>;
+template <typename V, typename E = int>
+using digraph_csr = Csr_graph_directed<V,E>;
+using digraph_bits = Bit_adjacency_matrix_directed;
 }
\ No newline at end of file
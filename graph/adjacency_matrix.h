@@ -19,10 +19,12 @@ struct Matrix_adjacent_iterator {
 
 	Matrix_adjacent_iterator() = default;
 	Matrix_adjacent_iterator(Mat* m, size_t row) : mat{m}, u{row}, v{0} {
-		while (!mat->is_edge(u, v)) ++v;
+		while (v < mat->num_vertex() && !mat->is_edge(u, v)) ++v;
 	}
+	// end iterator, column index past the last
+	Matrix_adjacent_iterator(Mat* m, size_t row, size_t col) : mat{m}, u{row}, v{col} {}
 
-	void operator++() {do {++v;} while (!mat->is_edge(u, v));}
+	void operator++() {do {++v;} while (v < mat->num_vertex() && !mat->is_edge(u, v));}
 	void operator--() {do {--v;} while (!mat->is_edge(u, v));}
 	size_t operator*() const {return v;}
 	bool operator==(CR other) {return other.v == v && other.u == u && other.mat == mat;}
@@ -40,10 +42,12 @@ struct Matrix_adjacent_const_iterator {
 
 	Matrix_adjacent_const_iterator() = default;
 	Matrix_adjacent_const_iterator(const Mat* m, size_t row) : mat{m}, u{row}, v{0} {
-		while (!mat->is_edge(u, v)) ++v;
+		while (v < mat->num_vertex() && !mat->is_edge(u, v)) ++v;
 	}
+	// end iterator, column index past the last
+	Matrix_adjacent_const_iterator(const Mat* m, size_t row, size_t col) : mat{m}, u{row}, v{col} {}
 
-	void operator++() {do {++v;} while (!mat->is_edge(u, v));}
+	void operator++() {do {++v;} while (v < mat->num_vertex() && !mat->is_edge(u, v));}
 	void operator--() {do {--v;} while (!mat->is_edge(u, v));}
 	size_t operator*() const {return v;}
 	bool operator==(CR other) {return other.v == v && other.u == u && other.mat == mat;}
@@ -155,7 +159,7 @@ public:
 	size_t num_vertex() const {return adj.row();}
 	virtual size_t num_edge() const {
 		size_t edges {};
-		for (size_t edge = 0; edge < adj.row() * adj.col(); ++edge) edges += (edge != POS_INF(E));
+		for (size_t edge = 0; edge < adj.row() * adj.col(); ++edge) edges += (adj.data()[edge] != POS_INF(E));
 		return edges >> 1;	// divide by 2 for undirected
 	}
 
@@ -170,6 +174,10 @@ public:
 	// weight of edge, 1/0 for unweighted edge, assumes edge exists
 	E& weight(size_t u, size_t v) 	   {return adj.get(u, v);}
 	E weight(size_t u, size_t v) const {return adj.get(u, v);}
+	// weights as a matrix, POS_INF where there is no edge
+	const Matrix<E>& matrix() const {return adj;}
+	// weights of the edges into v without building the transpose, a column of the matrix
+	Matrix_view<const E> in_weights(size_t v) const {return adj.col_view(v);}
 	// out degree, assumes vertex exists
 	size_t degree(size_t v) const {
 		size_t res {0};
@@ -180,12 +188,12 @@ public:
 
 	std::pair<adjacent_iterator, adjacent_iterator> adjacent(size_t v) {
 		if (v < adj.row()) 
-			return {{this, v}, {this, v, adj.cols()}};
+			return {{this, v}, {this, v, adj.col()}};
 		else return {{},{}};
 	}	
 	std::pair<adjacent_const_iterator, adjacent_const_iterator> adjacent(size_t v) const {
 		if (v < adj.row()) 
-			return {{this, v}, {this, v, adj.cols()}};
+			return {{this, v}, {this, v, adj.col()}};
 		else return {{},{}};
 	}
 
@@ -271,11 +279,13 @@ public:
 			++begin;
 		}		
 	}
+	// n x n weights where (u,v) is the edge u -> v, POS_INF where there is none
+	explicit Adjacency_matrix_directed(Matrix<E> weights) {adj = std::move(weights);}
 
 	// cardinality of vertex set
 	size_t num_edge() const override {
 		size_t edges {};
-		for (size_t edge = 0; edge < adj.row() * adj.col(); ++edge) edges += (edge != POS_INF(E));
+		for (size_t edge = 0; edge < adj.row() * adj.col(); ++edge) edges += (adj.data()[edge] != POS_INF(E));
 		return edges;
 	}
 
@@ -300,4 +310,11 @@ public:
 	}
 };
 
-}
\ No newline at end of file
+// reversing every edge is transposing the matrix, done by cache oblivious blocks
+// instead of an add_edge per edge
+template <typename E>
+Adjacency_matrix_directed<E> transpose(const Adjacency_matrix_directed<E>& g) {
+	return Adjacency_matrix_directed<E>{g.matrix().transpose()};
+}
+
+}
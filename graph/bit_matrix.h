@@ -0,0 +1,404 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "common.h"	// edges
+#include "../matrix/gemm.h"	// bit packed boolean products
+
+// unweighted adjacency matrix packed one bit per edge, 64 columns to a word
+// n^2 / 8 bytes instead of n^2 * sizeof(E), and rows are bitsets so
+// neighbour iteration skips empty words and jumps between set bits with count trailing zeros,
+// degree and number of edges are popcounts, and set algorithms on neighbourhoods
+// (triangle counting, transitive closure, k hop reachability) work on 64 vertices per instruction
+// popcount kernels are compiled once per instruction set (AVX-512 VPOPCNTDQ, POPCNT) and picked at runtime
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SAL_BITS_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace sal {
+
+using Bit_word = std::uint64_t;
+constexpr size_t bit_word_size = 64;
+
+inline size_t bit_word_count(size_t bits) {return (bits + bit_word_size - 1) / bit_word_size;}
+inline size_t lowest_bit(Bit_word w) {return __builtin_ctzll(w);}
+
+// popcount of n words, and of the intersection of two word arrays
+inline size_t bit_count_generic(const Bit_word* a, size_t n) {
+	size_t res {0};
+	for (size_t i = 0; i < n; ++i) res += __builtin_popcountll(a[i]);
+	return res;
+}
+inline size_t bit_count_and_generic(const Bit_word* a, const Bit_word* b, size_t n) {
+	size_t res {0};
+	for (size_t i = 0; i < n; ++i) res += __builtin_popcountll(a[i] & b[i]);
+	return res;
+}
+#ifdef SAL_BITS_DISPATCH
+__attribute__((target("popcnt")))
+inline size_t bit_count_popcnt(const Bit_word* a, size_t n) {
+	size_t res {0};
+	for (size_t i = 0; i < n; ++i) res += __builtin_popcountll(a[i]);
+	return res;
+}
+__attribute__((target("popcnt")))
+inline size_t bit_count_and_popcnt(const Bit_word* a, const Bit_word* b, size_t n) {
+	size_t res {0};
+	for (size_t i = 0; i < n; ++i) res += __builtin_popcountll(a[i] & b[i]);
+	return res;
+}
+// 8 word popcounts per instruction, written with intrinsics since -O2 leaves the scalar loops alone
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+inline size_t bit_count_avx512(const Bit_word* a, size_t n) {
+	__m512i sum {_mm512_setzero_si512()};
+	size_t i {0};
+	for (; i + 8 <= n; i += 8) sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_loadu_si512(a + i)));
+	Bit_word lanes[8];
+	_mm512_storeu_si512(lanes, sum);
+	size_t res {0};
+	for (Bit_word lane : lanes) res += lane;
+	for (; i < n; ++i) res += __builtin_popcountll(a[i]);
+	return res;
+}
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+inline size_t bit_count_and_avx512(const Bit_word* a, const Bit_word* b, size_t n) {
+	__m512i sum {_mm512_setzero_si512()};
+	size_t i {0};
+	for (; i + 8 <= n; i += 8)
+		sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+	Bit_word lanes[8];
+	_mm512_storeu_si512(lanes, sum);
+	size_t res {0};
+	for (Bit_word lane : lanes) res += lane;
+	for (; i < n; ++i) res += __builtin_popcountll(a[i] & b[i]);
+	return res;
+}
+#endif
+
+using Bit_count_fn = size_t (*)(const Bit_word*, size_t);
+using Bit_count_and_fn = size_t (*)(const Bit_word*, const Bit_word*, size_t);
+
+// best kernels the cpu supports, checked once
+inline Bit_count_fn bit_count_dispatch() {
+#ifdef SAL_BITS_DISPATCH
+	static const Bit_count_fn fn {
+		(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq"))? &bit_count_avx512 :
+		__builtin_cpu_supports("popcnt")? &bit_count_popcnt : &bit_count_generic};
+	return fn;
+#else
+	return &bit_count_generic;
+#endif
+}
+inline Bit_count_and_fn bit_count_and_dispatch() {
+#ifdef SAL_BITS_DISPATCH
+	static const Bit_count_and_fn fn {
+		(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq"))? &bit_count_and_avx512 :
+		__builtin_cpu_supports("popcnt")? &bit_count_and_popcnt : &bit_count_and_generic};
+	return fn;
+#else
+	return &bit_count_and_generic;
+#endif
+}
+inline size_t bit_count(const Bit_word* a, size_t n) {return bit_count_dispatch()(a, n);}
+inline size_t bit_count_and(const Bit_word* a, const Bit_word* b, size_t n) {return bit_count_and_dispatch()(a, b, n);}
+
+
+template <typename Graph>
+struct Bit_matrix_adjacent_iterator {
+	using CR = const Bit_matrix_adjacent_iterator&;
+	const Graph* g;
+	size_t u, v;	// v is num_vertex() at the end
+
+	void operator++() {v = g->next_edge(u, v + 1);}
+	Bit_matrix_adjacent_iterator operator++(int) {Bit_matrix_adjacent_iterator prev {*this}; ++*this; return prev;}
+	size_t operator*() const {return v;}
+	bool operator==(CR other) const {return other.v == v && other.u == u && other.g == g;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	size_t dest() const {return v;}
+	size_t weight() const {return 1;}
+	friend std::ostream& operator<<(std::ostream& os, CR itr) {return os << *itr << ' ';}
+};
+
+template <typename Graph>
+struct Bit_matrix_vertex_iterator {
+	using CR = const Bit_matrix_vertex_iterator&;
+	using adjacent_iterator = Bit_matrix_adjacent_iterator<Graph>;
+	const Graph* g;
+	size_t u;
+
+	void operator++() {++u;}
+	void operator--() {--u;}
+	Bit_matrix_vertex_iterator operator++(int) {return {g, u++};}
+	Bit_matrix_vertex_iterator operator--(int) {return {g, u--};}
+	Bit_matrix_vertex_iterator operator+(int scalar) const {return {g, u + scalar};}
+	Bit_matrix_vertex_iterator operator-(int scalar) const {return {g, u - scalar};}
+	size_t operator*() const {return u;}
+	bool operator==(CR other) const {return other.u == u && other.g == g;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	std::pair<adjacent_iterator, adjacent_iterator> adjacent() const {return g->adjacent(u);}
+	adjacent_iterator begin() const	{return g->adjacent(u).first;}
+	adjacent_iterator end() const	{return {g, u, g->num_vertex()};}
+	friend std::ostream& operator<<(std::ostream& os, CR itr) {return os << *itr << ' ';}
+};
+// reverse vertex iteration, needed for the DFS visitors' initialization order
+template <typename Graph>
+struct Bit_matrix_reverse_vertex_iterator {
+	using CR = const Bit_matrix_reverse_vertex_iterator&;
+	using adjacent_iterator = Bit_matrix_adjacent_iterator<Graph>;
+	const Graph* g;
+	size_t u;	// one past the vertex pointed to
+
+	void operator++() {--u;}
+	void operator--() {++u;}
+	size_t operator*() const {return u - 1;}
+	bool operator==(CR other) const {return other.u == u && other.g == g;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	adjacent_iterator begin() const	{return g->adjacent(u - 1).first;}
+	adjacent_iterator end() const	{return {g, u - 1, g->num_vertex()};}
+};
+
+
+// only vertices 0 .. n-1, undirected by default (bit (u,v) and (v,u) both set)
+// edges have weight 1 so the weighted algorithms see hop counts
+class Bit_adjacency_matrix {
+protected:
+	size_t n {0};
+	// words per row
+	size_t stride {0};
+	std::vector<Bit_word> bits;
+
+	Bit_word* row_words(size_t u) 	{return bits.data() + u*stride;}
+	void set(size_t u, size_t v) 	{bits[u*stride + v/bit_word_size] |= Bit_word{1} << (v % bit_word_size);}
+	void reset(size_t u, size_t v) 	{bits[u*stride + v/bit_word_size] &= ~(Bit_word{1} << (v % bit_word_size));}
+
+	// keeps the existing edges, rows are restrided if the word count changes
+	void resize(size_t vertices) {
+		size_t new_stride {bit_word_count(vertices)};
+		if (new_stride != stride) {
+			std::vector<Bit_word> grown(vertices * new_stride, 0);
+			for (size_t u = 0; u < std::min(n, vertices); ++u)
+				std::copy(bits.begin() + u*stride, bits.begin() + u*stride + std::min(stride, new_stride),
+					grown.begin() + u*new_stride);
+			bits.swap(grown);
+			stride = new_stride;
+		}
+		else bits.resize(vertices * stride, 0);
+		n = vertices;
+	}
+	template <typename Iter_edgelist>
+	static size_t vertices_needed(Iter_edgelist begin, Iter_edgelist end) {
+		size_t max_vertex {0};
+		bool any {false};
+		for (; begin != end; ++begin) {max_vertex = std::max({max_vertex, begin->source, begin->dest}); any = true;}
+		return any? max_vertex + 1 : 0;
+	}
+	size_t self_loops() const {
+		size_t loops {0};
+		for (size_t u = 0; u < n; ++u) loops += is_edge(u, u);
+		return loops;
+	}
+
+public:
+	using vertex_type = size_t;
+	using edge_type = size_t;
+	using iterator = Bit_matrix_vertex_iterator<Bit_adjacency_matrix>;
+	using const_iterator = iterator;
+	using reverse_iterator = Bit_matrix_reverse_vertex_iterator<Bit_adjacency_matrix>;
+	using const_reverse_iterator = reverse_iterator;
+	using adjacent_iterator = Bit_matrix_adjacent_iterator<Bit_adjacency_matrix>;
+	using adjacent_const_iterator = adjacent_iterator;
+
+	Bit_adjacency_matrix() = default;
+	explicit Bit_adjacency_matrix(size_t vertices) {resize(vertices);}
+	Bit_adjacency_matrix(const std::initializer_list<UEdge<size_t>>& l) : Bit_adjacency_matrix(l.begin(), l.end()) {}
+	template <typename Iter_edgelist>
+	Bit_adjacency_matrix(Iter_edgelist begin, const Iter_edgelist end, size_t v_num = 0) {
+		resize(std::max(v_num, vertices_needed(begin, end)));
+		for (; begin != end; ++begin) {set(begin->source, begin->dest); set(begin->dest, begin->source);}
+	}
+	virtual ~Bit_adjacency_matrix() = default;
+
+	// cardinality of vertex set and edge set
+	size_t num_vertex() const {return n;}
+	virtual size_t num_edge() const {
+		// self loops are stored once, every other edge twice
+		return (bit_count(bits.data(), bits.size()) + self_loops()) >> 1;
+	}
+
+	// check existence of vertex and edge
+	bool is_vertex(size_t v) const {return v < n;}
+	bool is_edge(size_t u, size_t v) const {
+		return u < n && v < n && (row(u)[v/bit_word_size] >> (v % bit_word_size) & 1);
+	}
+	// weight of edge, 1/0 for existent/non-existent edge
+	size_t weight(size_t u, size_t v) const {return is_edge(u, v);}
+	// out degree, 0 for non-existent vertex
+	size_t degree(size_t v) const {return v < n? bit_count(row(v), stride) : 0;}
+
+	// row of u as stride() words, bit v of the row is edge (u,v)
+	const Bit_word* row(size_t u) const {return bits.data() + u*stride;}
+	size_t words() const {return stride;}
+
+	// first neighbour of u at or after v, num_vertex() if none
+	size_t next_edge(size_t u, size_t v) const {
+		if (v >= n) return n;
+		const Bit_word* r {row(u)};
+		size_t w {v / bit_word_size};
+		Bit_word word {r[w] & (~Bit_word{0} << (v % bit_word_size))};
+		while (!word) {
+			if (++w == stride) return n;
+			word = r[w];
+		}
+		return w*bit_word_size + lowest_bit(word);
+	}
+
+	std::pair<adjacent_iterator, adjacent_iterator> adjacent(size_t v) const {
+		if (v >= n) return {{this, 0, n}, {this, 0, n}};
+		return {{this, v, next_edge(v, 0)}, {this, v, n}};
+	}
+
+	// retrieving vertex (find by default gives vertex)
+	const_iterator vertex(size_t v) const 	{return {this, std::min(v, n)};}
+	const_iterator find(size_t v) const 	{return {this, std::min(v, n)};}
+
+	// vertex iteration
+	const_iterator begin() const 	{return {this, 0};}
+	const_iterator end() const 		{return {this, n};}
+	const_reverse_iterator rbegin() const 	{return {this, n};}
+	const_reverse_iterator rend() const 	{return {this, 0};}
+
+	// vertex numbered by order inserted
+	void add_vertex(size_t) {resize(n + 1);}
+	virtual void add_edge(size_t u, size_t v) {
+		if (u >= n || v >= n) resize(std::max(u, v) + 1);
+		set(u, v);
+		set(v, u);
+	}
+	virtual void remove_edge(size_t u, size_t v) {
+		if (u >= n || v >= n) return;
+		reset(u, v);
+		reset(v, u);
+	}
+
+	size_t min_vertex() const {return 0;}
+	size_t max_vertex() const {return n - 1;}
+
+	friend std::ostream& operator<<(std::ostream& os, const Bit_adjacency_matrix& g) {
+		for (size_t u = 0; u < g.n; ++u) {
+			for (size_t v = 0; v < g.n; ++v) os << g.is_edge(u, v);
+			os << '\n';
+		}
+		return os;
+	}
+};
+
+class Bit_adjacency_matrix_directed : public Bit_adjacency_matrix {
+	using Bit_adjacency_matrix::bits;
+public:
+	Bit_adjacency_matrix_directed() = default;
+	explicit Bit_adjacency_matrix_directed(size_t vertices) : Bit_adjacency_matrix(vertices) {}
+	Bit_adjacency_matrix_directed(const std::initializer_list<UEdge<size_t>>& l)
+		: Bit_adjacency_matrix_directed(l.begin(), l.end()) {}
+	template <typename Iter_edgelist>
+	Bit_adjacency_matrix_directed(Iter_edgelist begin, const Iter_edgelist end, size_t v_num = 0) {
+		resize(std::max(v_num, vertices_needed(begin, end)));
+		for (; begin != end; ++begin) set(begin->source, begin->dest);
+	}
+
+	// degree is outdegree
+	size_t num_edge() const override {return bit_count(bits.data(), bits.size());}
+
+	void add_edge(size_t u, size_t v) override {
+		if (u >= n || v >= n) resize(std::max(u, v) + 1);
+		set(u, v);
+	}
+	void remove_edge(size_t u, size_t v) override {
+		if (u < n && v < n) reset(u, v);
+	}
+
+	friend Bit_adjacency_matrix_directed transitive_closure(const Bit_adjacency_matrix& g);
+	friend Bit_adjacency_matrix_directed boolean_product(const Bit_adjacency_matrix& a, const Bit_adjacency_matrix& b);
+};
+
+// reachability: edge (u,v) in the result iff a non-empty path u -> v exists
+// Warshall's algorithm, if i reaches k then i reaches everything k does: row i |= row k
+// O(V^3 / 64) with each row update 64 vertices per word
+inline Bit_adjacency_matrix_directed transitive_closure(const Bit_adjacency_matrix& g) {
+	Bit_adjacency_matrix_directed closure {g.num_vertex()};
+	std::copy(g.row(0), g.row(0) + g.num_vertex() * g.words(), closure.bits.begin());
+	size_t stride {g.words()};
+	for (size_t k = 0; k < g.num_vertex(); ++k) {
+		const Bit_word* row_k {closure.row(k)};
+		size_t word {k / bit_word_size};
+		Bit_word bit {Bit_word{1} << (k % bit_word_size)};
+		for (size_t i = 0; i < g.num_vertex(); ++i) {
+			Bit_word* row_i {closure.row_words(i)};
+			if (row_i[word] & bit)
+				for (size_t w = 0; w < stride; ++w) row_i[w] |= row_k[w];
+		}
+	}
+	return closure;
+}
+
+// boolean matrix product: edge (u,v) iff u -> w in a and w -> v in b for some w
+// row u is the OR of the rows of b for every neighbour of u in a, through gemm's bit kernel, O(V^3 / 64) at worst
+inline Bit_adjacency_matrix_directed boolean_product(const Bit_adjacency_matrix& a, const Bit_adjacency_matrix& b) {
+	if (a.num_vertex() != b.num_vertex()) throw std::runtime_error("Invalid dimensions for boolean product");
+	size_t n {a.num_vertex()}, stride {a.words()};
+	Bit_adjacency_matrix_directed product {n};
+	gemm_bits_dispatch()(n, n, stride, a.row(0), stride, b.row(0), stride, product.bits.data(), stride);
+	return product;
+}
+
+// edge (u,v) iff a walk u -> v of exactly hops edges exists, hops = 0 gives only the self loops
+// by repeated squaring, O(V^3 lg hops / 64)
+inline Bit_adjacency_matrix_directed boolean_pow(const Bit_adjacency_matrix& g, size_t hops) {
+	Bit_adjacency_matrix_directed res {g.num_vertex()};
+	for (size_t v = 0; v < g.num_vertex(); ++v) res.add_edge(v, v);
+	// g as a directed matrix, the identity times g
+	Bit_adjacency_matrix_directed base {boolean_product(res, g)};
+	while (hops > 0) {
+		if (hops & 1) res = boolean_product(res, base);
+		hops >>= 1;
+		if (hops) base = boolean_product(base, base);
+	}
+	return res;
+}
+
+// edge (u,v) iff v is at most hops edges from u, so every vertex reaches itself
+// the power of g with a self loop on every vertex, letting walks stay put
+inline Bit_adjacency_matrix_directed reachable_within(const Bit_adjacency_matrix& g, size_t hops) {
+	Bit_adjacency_matrix_directed loops {g.num_vertex()};
+	for (size_t u = 0; u < g.num_vertex(); ++u) {
+		loops.add_edge(u, u);
+		for (size_t v = g.next_edge(u, 0); v < g.num_vertex(); v = g.next_edge(u, v + 1)) loops.add_edge(u, v);
+	}
+	return boolean_pow(loops, hops);
+}
+
+// number of triangles in an undirected graph (self loops ignored)
+// each triangle u < v < w is counted once at its edge (u,v) as the common neighbours above v,
+// the AND of their rows masked below v + 1
+inline size_t triangle_count(const Bit_adjacency_matrix& g) {
+	size_t triangles {0}, stride {g.words()};
+	for (size_t u = 0; u < g.num_vertex(); ++u) {
+		const Bit_word* row_u {g.row(u)};
+		for (size_t v = g.next_edge(u, u + 1); v < g.num_vertex(); v = g.next_edge(u, v + 1)) {
+			const Bit_word* row_v {g.row(v)};
+			// partial word holding the neighbours just above v
+			size_t w {(v + 1) / bit_word_size};
+			if (w >= stride) continue;
+			Bit_word mask {~Bit_word{0} << ((v + 1) % bit_word_size)};
+			triangles += __builtin_popcountll(row_u[w] & row_v[w] & mask);
+			triangles += bit_count_and(row_u + w + 1, row_v + w + 1, stride - w - 1);
+		}
+	}
+	return triangles;
+}
+
+}	// end namespace sal
@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "common.h"	// edges
+
+namespace sal {
+
+// compressed sparse row graph, immutable after construction
+// vertex u's neighbours are dests[offsets[u] .. offsets[u+1]), sorted by destination
+// so traversal walks contiguous memory instead of chasing tree nodes like Adjacency_list
+
+// vertex names are mapped to dense ids 0 .. n-1
+// integer vertices are their own ids, so vertices in [0, max vertex] without edges are isolated vertices
+// other vertices (including characters, usually used as labels) are kept sorted in a table 
+// and looked up by binary search (same order as Adjacency_list)
+template <typename V>
+struct Is_index_vertex {
+	static constexpr bool value = std::is_integral<V>::value && 
+		!std::is_same<V, bool>::value && !std::is_same<V, char>::value && 
+		!std::is_same<V, signed char>::value && !std::is_same<V, unsigned char>::value &&
+		!std::is_same<V, wchar_t>::value && !std::is_same<V, char16_t>::value && !std::is_same<V, char32_t>::value;
+};
+
+// read only contiguous array, either owning its elements or borrowing them (from a mapped file)
+// copies of an owning array own a copy, copies of a borrowing one borrow the same elements
+template <typename T>
+class Csr_array {
+	std::vector<T> own;
+	const T* first {nullptr};
+	size_t n {0};
+	bool borrowed {false};
+public:
+	Csr_array() = default;
+	Csr_array(std::vector<T>&& elems) : own{std::move(elems)}, first{own.data()}, n{own.size()} {}
+	Csr_array(const T* elems, size_t size) : first{elems}, n{size}, borrowed{true} {}
+	Csr_array(const Csr_array& a) : own{a.own}, first{a.borrowed? a.first : own.data()}, n{a.n}, borrowed{a.borrowed} {}
+	// moving a vector keeps its buffer
+	Csr_array(Csr_array&& a) noexcept : own{std::move(a.own)}, first{a.first}, n{a.n}, borrowed{a.borrowed} {
+		a.first = nullptr; 
+		a.n = 0;
+	}
+	Csr_array& operator=(Csr_array a) {
+		std::swap(own, a.own);
+		std::swap(first, a.first);
+		std::swap(n, a.n);
+		std::swap(borrowed, a.borrowed);
+		return *this;
+	}
+
+	const T& operator[](size_t i) const {return first[i];}
+	size_t size() const {return n;}
+	bool empty() const {return n == 0;}
+	const T* data() const {return first;}
+	const T* begin() const {return first;}
+	const T* end() const {return first + n;}
+};
+
+template <typename V, bool = Is_index_vertex<V>::value>
+struct Csr_ids {
+	Csr_array<V> names;
+
+	template <typename Iter>
+	void build(Iter begin, Iter end) {
+		std::vector<V> sorted {begin, end};
+		std::sort(sorted.begin(), sorted.end());
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+		names = std::move(sorted);
+	}
+	// already sorted and unique
+	void assign(Csr_array<V> sorted) {names = std::move(sorted);}
+	size_t size() const {return names.size();}
+	bool has(const V& v) const {return std::binary_search(names.begin(), names.end(), v);}
+	size_t id(const V& v) const {return std::lower_bound(names.begin(), names.end(), v) - names.begin();}
+	const V& name(size_t id) const {return names[id];}
+};
+template <typename V>
+struct Csr_ids<V, true> {
+	size_t n {0};
+
+	template <typename Iter>
+	void build(Iter begin, Iter end) {
+		n = (begin == end)? 0 : static_cast<size_t>(*std::max_element(begin, end)) + 1;
+	}
+	void assign(size_t vertices) {n = vertices;}
+	size_t size() const {return n;}
+	bool has(V v) const {return static_cast<size_t>(v) < n;}	// negative wraps around to large
+	size_t id(V v) const {return static_cast<size_t>(v);}
+	V name(size_t id) const {return static_cast<V>(id);}
+};
+
+template <typename V, typename E>
+class Csr_graph;
+
+// iterate over neighbours of a vertex, a cursor into the contiguous dest and weight arrays
+template <typename V, typename E>
+struct Csr_adjacent_iterator {
+	using CR = const Csr_adjacent_iterator<V,E>&;
+	using Graph = Csr_graph<V,E>;
+	const Graph* g;
+	size_t e;	// index into dests and weights
+
+	void operator++() {++e;}
+	void operator--() {--e;}
+	Csr_adjacent_iterator operator++(int) {return {g, e++};}
+	Csr_adjacent_iterator operator--(int) {return {g, e--};}
+	V operator*() const {return g->ids.name(g->dests[e]);}
+	bool operator==(CR other) const {return other.e == e;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	V dest() const {return g->ids.name(g->dests[e]);}
+	E weight() const {return g->weights[e];}
+	friend std::ostream& operator<<(std::ostream& os, CR itr) {return os << *itr << ' ';}
+};
+
+// iterate over vertices of a graph by their dense id
+template <typename V, typename E>
+struct Csr_vertex_iterator {
+	using CR = const Csr_vertex_iterator<V,E>&;
+	using Graph = Csr_graph<V,E>;
+	using adjacent_iterator = Csr_adjacent_iterator<V,E>;
+	const Graph* g;
+	size_t u;
+
+	void operator++() {++u;}
+	void operator--() {--u;}
+	Csr_vertex_iterator operator++(int) {return {g, u++};}
+	Csr_vertex_iterator operator--(int) {return {g, u--};}
+	Csr_vertex_iterator operator+(int scalar) const {return {g, u + scalar};}
+	Csr_vertex_iterator operator-(int scalar) const {return {g, u - scalar};}
+	V operator*() const {return g->ids.name(u);}
+	bool operator==(CR other) const {return other.u == u && other.g == g;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	std::pair<adjacent_iterator, adjacent_iterator> adjacent() const {
+		return {{g, g->offsets[u]}, {g, g->offsets[u+1]}};
+	}
+	adjacent_iterator begin() const	{return {g, g->offsets[u]};}
+	adjacent_iterator end() const	{return {g, g->offsets[u+1]};}
+	friend std::ostream& operator<<(std::ostream& os, CR itr) {return os << *itr << ' ';}
+};
+// reverse vertex iteration, needed for the DFS visitors' initialization order
+template <typename V, typename E>
+struct Csr_reverse_vertex_iterator {
+	using CR = const Csr_reverse_vertex_iterator<V,E>&;
+	using Graph = Csr_graph<V,E>;
+	using adjacent_iterator = Csr_adjacent_iterator<V,E>;
+	const Graph* g;
+	size_t u;	// one past the vertex pointed to
+
+	void operator++() {--u;}
+	void operator--() {++u;}
+	V operator*() const {return g->ids.name(u - 1);}
+	bool operator==(CR other) const {return other.u == u && other.g == g;}
+	bool operator!=(CR other) const {return !(*this == other);}
+	adjacent_iterator begin() const	{return {g, g->offsets[u-1]};}
+	adjacent_iterator end() const	{return {g, g->offsets[u]};}
+};
+
+
+// arrays of an already built graph, for graphs stored elsewhere like mapped files
+// offsets has num_vertex + 1 entries and each row of dests is sorted
+// backing keeps whatever the borrowed arrays point into alive
+template <typename V, typename E>
+struct Csr_parts {
+	Csr_ids<V> ids;
+	Csr_array<size_t> offsets;
+	Csr_array<size_t> dests;
+	Csr_array<E> weights;
+	std::shared_ptr<const void> backing;
+};
+
+// undirected weighted graph, each edge is stored in both directions
+template <typename V = size_t, typename E = int>
+class Csr_graph {
+protected:
+	friend struct Csr_adjacent_iterator<V,E>;
+	friend struct Csr_vertex_iterator<V,E>;
+	friend struct Csr_reverse_vertex_iterator<V,E>;
+
+	Csr_ids<V> ids;
+	// n + 1 offsets, the last being the number of stored (directed) edges
+	Csr_array<size_t> offsets;
+	Csr_array<size_t> dests;
+	Csr_array<E> weights;
+	std::shared_ptr<const void> backing;
+
+	struct Raw_edge {
+		size_t u, v;
+		E w;
+	};
+
+	// edges have to be gathered once to know the vertex set before ids can be assigned
+	template <typename Iter_edgelist>
+	void build(Iter_edgelist begin, const Iter_edgelist end, bool undirected) {
+		std::vector<V> endpoints;
+		for (auto edge = begin; edge != end; ++edge) {
+			endpoints.push_back(edge->source);
+			endpoints.push_back(edge->dest);
+		}
+		ids.build(endpoints.begin(), endpoints.end());
+		endpoints = std::vector<V>{};
+
+		std::vector<Raw_edge> raw;
+		raw.reserve(undirected? 2*std::distance(begin, end) : std::distance(begin, end));
+		for (; begin != end; ++begin) {
+			size_t u {ids.id(begin->source)}, v {ids.id(begin->dest)};
+			raw.push_back({u, v, static_cast<E>(begin->get_weight())});
+			if (undirected && u != v) raw.push_back({v, u, static_cast<E>(begin->get_weight())});
+		}
+		// sort by (source, dest) keeping insertion order of duplicates, the last one wins like Adjacency_list
+		std::stable_sort(raw.begin(), raw.end(), [](const Raw_edge& a, const Raw_edge& b){
+			return a.u < b.u || (a.u == b.u && a.v < b.v);
+		});
+
+		std::vector<size_t> row_offsets(ids.size() + 1, 0), row_dests;
+		std::vector<E> row_weights;
+		row_dests.reserve(raw.size());
+		row_weights.reserve(raw.size());
+		for (size_t e = 0; e < raw.size(); ++e) {
+			if (e + 1 < raw.size() && raw[e+1].u == raw[e].u && raw[e+1].v == raw[e].v) continue;
+			row_dests.push_back(raw[e].v);
+			row_weights.push_back(raw[e].w);
+			++row_offsets[raw[e].u + 1];
+		}
+		for (size_t u = 0; u < ids.size(); ++u) row_offsets[u+1] += row_offsets[u];
+		offsets = std::move(row_offsets);
+		dests = std::move(row_dests);
+		weights = std::move(row_weights);
+	}
+
+	// position of edge (u,v) in dests, or end of u's row
+	size_t edge_index(size_t u, size_t v) const {
+		const size_t* row_end {dests.begin() + offsets[u+1]};
+		const size_t* found {std::lower_bound(dests.begin() + offsets[u], row_end, v)};
+		return (found != row_end && *found == v)? found - dests.begin() : offsets[u+1];
+	}
+
+	Csr_graph() = default;	// for derived classes building in other orientations
+
+public:
+	using vertex_type = V;
+	using edge_type = E;
+	using adjacent_iterator = Csr_adjacent_iterator<V,E>;
+	using adjacent_const_iterator = Csr_adjacent_iterator<V,E>;
+	using iterator = Csr_vertex_iterator<V,E>;
+	using const_iterator = Csr_vertex_iterator<V,E>;
+	using reverse_iterator = Csr_reverse_vertex_iterator<V,E>;
+	using const_reverse_iterator = Csr_reverse_vertex_iterator<V,E>;
+
+	// constructors, same edge sources as Adjacency_list
+	Csr_graph(const std::initializer_list<UEdge<V>>& l) {build(l.begin(), l.end(), true);}
+	Csr_graph(const std::initializer_list<WEdge<V,E>>& l) {build(l.begin(), l.end(), true);}
+	template <typename Iter_edgelist>
+	Csr_graph(Iter_edgelist begin, const Iter_edgelist end) {build(begin, end, true);}
+	// both directions of every edge already in parts
+	explicit Csr_graph(Csr_parts<V,E> parts) : ids{std::move(parts.ids)}, offsets{std::move(parts.offsets)}, 
+		dests{std::move(parts.dests)}, weights{std::move(parts.weights)}, backing{std::move(parts.backing)} {}
+
+	// cardinality of vertex set and edge set
+	size_t num_vertex() const {return ids.size();}
+	size_t num_edge() const {
+		// self loops are stored once, every other edge twice
+		size_t loops {0};
+		for (size_t u = 0; u < ids.size(); ++u) loops += edge_index(u, u) != offsets[u+1];
+		return (dests.size() + loops) >> 1;
+	}
+
+	// check for existence of vertex and edge
+	bool is_vertex(V v) const {return ids.has(v);}
+	bool is_edge(V u, V v) const {
+		if (!ids.has(u) || !ids.has(v)) return false;
+		return edge_index(ids.id(u), ids.id(v)) != offsets[ids.id(u)+1];
+	}
+
+	// weight of edge, 0 for non-existent edge
+	E weight(V u, V v) const {
+		if (!ids.has(u) || !ids.has(v)) return 0;
+		size_t e {edge_index(ids.id(u), ids.id(v))};
+		return (e == offsets[ids.id(u)+1])? 0 : weights[e];
+	}
+	size_t degree(V v) const {
+		if (!ids.has(v)) return 0;
+		return offsets[ids.id(v)+1] - offsets[ids.id(v)];
+	}
+
+	// dense id of a vertex, for indexing into flat per-vertex arrays
+	size_t id(V v) const {return ids.id(v);}
+	V name(size_t id) const {return ids.name(id);}
+	// neighbours of id u are edge_dests()[edge_offsets()[u] .. edge_offsets()[u+1]), for algorithms on dense ids
+	const Csr_array<size_t>& edge_offsets() const {return offsets;}
+	const Csr_array<size_t>& edge_dests() const 	{return dests;}
+	const Csr_array<E>& edge_weights() const 		{return weights;}
+	// vertex names by id, empty for integer vertices which are their own ids
+	template <typename VV = V, typename = std::enable_if_t<!Is_index_vertex<VV>::value>>
+	const Csr_array<V>& vertex_names() const {return ids.names;}
+
+	// begin and end
+	std::pair<adjacent_iterator, adjacent_iterator> adjacent(V v) const {
+		if (!ids.has(v)) return {{this, 0}, {this, 0}};
+		size_t u {ids.id(v)};
+		return {{this, offsets[u]}, {this, offsets[u+1]}};
+	}
+
+	// retrieving vertex (find by default gives vertex)
+	const_iterator vertex(V v) const {return {this, ids.has(v)? ids.id(v) : ids.size()};}
+	const_iterator find(V v) const 	 {return {this, ids.has(v)? ids.id(v) : ids.size()};}
+
+	// vertex iteration
+	const_iterator begin() const 	{return {this, 0};}
+	const_iterator end() const 		{return {this, ids.size()};}
+	const_reverse_iterator rbegin() const 	{return {this, ids.size()};}
+	const_reverse_iterator rend() const 	{return {this, 0};}
+
+	V min_vertex() const {return ids.size()? ids.name(0) : V{};}
+	V max_vertex() const {return ids.size()? ids.name(ids.size() - 1) : V{};}
+
+	// printing
+	friend std::ostream& operator<<(std::ostream& os, const Csr_graph& g) {
+		for (auto u = g.begin(); u != g.end(); ++u) {
+			os << *u << '(';
+			if (u.begin() != u.end()) {
+				for (auto v = u.begin(); v != u.end(); ++v)
+					os << *v << ':' << v.weight() << ',';
+				os << '\b';
+			}
+			os << ") ";
+		}
+		return os;
+	}
+};
+
+// directed compressed sparse row graph, each edge stored only at its source
+template <typename V = size_t, typename E = int>
+class Csr_graph_directed : public Csr_graph<V,E> {
+	using Csr_graph<V,E>::build;
+	using Csr_graph<V,E>::dests;
+public:
+	using vertex_type = V;
+	using edge_type = E;
+
+	Csr_graph_directed(const std::initializer_list<UEdge<V>>& l) {build(l.begin(), l.end(), false);}
+	Csr_graph_directed(const std::initializer_list<WEdge<V,E>>& l) {build(l.begin(), l.end(), false);}
+	template <typename Iter_edgelist>
+	Csr_graph_directed(Iter_edgelist begin, const Iter_edgelist end) {build(begin, end, false);}
+	explicit Csr_graph_directed(Csr_parts<V,E> parts) : Csr_graph<V,E>{std::move(parts)} {}
+
+	// degree is outdegree
+	size_t num_edge() const {return dests.size();}
+};
+
+}	// end namespace sal
@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include "shortest.h"	// dijkstra, shortest path property map
+#include "../heap.h"	// indexed heap for the repairs
+#include "../../algo/macros.h"
+// shortest paths maintained under edge updates instead of recomputed from scratch
+
+namespace sal {
+
+// single source shortest paths of a directed graph with non-negative weights, repaired after each
+// edge update in the style of Ramalingam and Reps:
+// a decrease (or new edge) that shortens the path to v runs dijkstra out from v, only through
+// vertices that got closer
+// an increase of a shortest path tree edge (u,v) invalidates v's subtree, which is reseeded from
+// in neighbours outside it and settled by dijkstra restricted to it; other increases change nothing
+// so an update costs O(A lg A) in the affected vertices A and their edges instead of O((V+E)lgV)
+// all updates have to go through update_edge, which also keeps the in neighbours the graph lacks
+template <typename Graph, typename Policy = Hashed_property>
+class Dynamic_shortest {
+	using V = typename Graph::vertex_type;
+	using E = typename Graph::edge_type;
+	using Property_map = SPM<Graph, Policy>;
+	using Cmp = Shortest_cmp<Property_map>;
+
+	Graph& g;
+	V source;
+	Property_map property;
+	typename Policy::template map<V, std::vector<V>> in;
+	Indexed_heap<V, Cmp, typename Policy::template index<V>, 4> exploring;
+	size_t affected {0};
+
+	bool reached(const V& v) const {return property.at(v).distance != POS_INF(E);}
+	void add_vertex(const V& v) {
+		if (property.count(v)) return;
+		property.reserve(property.size() + 1);
+		property[v] = {v};
+		in.reserve(in.size() + 1);
+		in[v];
+	}
+	void enqueue(const V& v) {
+		size_t handle {exploring.key(v)};
+		if (handle) exploring.decrease_key(handle);
+		else exploring.insert(v);
+	}
+	// dijkstra from the queued vertices, relaxing only edges that shorten paths
+	void settle() {
+		while (!exploring.empty()) {
+			V u {exploring.extract_top()};
+			++affected;
+			auto edges = g.adjacent(u);
+			for (auto v = edges.first; v != edges.second; ++v) {
+				if (property[u].distance + v.weight() < property[*v].distance) {
+					property[*v].distance = property[u].distance + v.weight();
+					property[*v].parent = u;
+					enqueue(*v);
+				}
+			}
+		}
+	}
+	void decrease(const V& u, const V& v, const E& w) {
+		if (!reached(u) || property[u].distance + w >= property[v].distance) return;
+		property[v].distance = property[u].distance + w;
+		property[v].parent = u;
+		enqueue(v);
+		settle();
+	}
+	void increase(const V& u, const V& v) {
+		if (v == source || property[v].parent != u || !reached(v)) return;
+		// v's subtree, children are the out neighbours that have the vertex as parent
+		std::vector<V> subtree {v};
+		for (size_t i = 0; i < subtree.size(); ++i) {
+			V x {subtree[i]};
+			auto edges = g.adjacent(x);
+			for (auto y = edges.first; y != edges.second; ++y)
+				if (*y != source && *y != x && property[*y].parent == x) subtree.push_back(*y);
+		}
+		for (const V& x : subtree) property[x] = {x};
+		// best entry into the subtree from outside, inside vertices are unreached for now
+		for (const V& x : subtree) {
+			for (const V& p : in[x]) {
+				if (!reached(p)) continue;
+				E candidate {property[p].distance + g.weight(p, x)};
+				if (candidate < property[x].distance) {
+					property[x].distance = candidate;
+					property[x].parent = p;
+				}
+			}
+			if (reached(x)) exploring.insert(x);
+		}
+		settle();
+	}
+
+public:
+	Dynamic_shortest(Graph& graph, V s) : g(graph), source{s}, property{dijkstra<Policy>(graph, s)},
+		exploring{Cmp{property}} {
+		in.reserve(g.num_vertex());
+		for (auto u = g.begin(); u != g.end(); ++u) in[*u];
+		for (auto u = g.begin(); u != g.end(); ++u)
+			for (auto v = u.begin(); v != u.end(); ++v) in[*v].push_back(*u);
+	}
+	// the heap compares through the property map it holds a reference to
+	Dynamic_shortest(const Dynamic_shortest&) = delete;
+	Dynamic_shortest& operator=(const Dynamic_shortest&) = delete;
+
+	// adds edge (u,v) or changes its weight, then repairs the affected paths
+	void update_edge(V u, V v, E w) {
+		add_vertex(u);
+		add_vertex(v);
+		bool existed {g.is_edge(u, v)};
+		E old {g.weight(u, v)};
+		g.add_edge(u, v, w);
+		if (!existed) in[v].push_back(u);
+		affected = 0;
+		if (!existed || w < old) decrease(u, v, w);
+		else if (old < w) increase(u, v);
+	}
+
+	// same results as dijkstra(g, s) on the current graph
+	const Property_map& paths() const {return property;}
+	const Shortest_vertex<V,E>& operator[](const V& v) const {return property.at(v);}
+	V start() const {return source;}
+	// number of vertices settled by the last update's repair
+	size_t last_affected() const {return affected;}
+};
+
+}	// end namespace sal
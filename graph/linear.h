@@ -31,24 +31,25 @@ using Constraint_sys = std::unordered_set<Constraint<T>, Constraint_hash<T>>;
 template <typename T>
 using Constraint_sol = std::vector<T>;
 
-// in Ax <= b problem, b is input limits, x will be returned, A is implicit in constraints
-// returns a feasible solution, or empty if infeasible
-// solution will have minimized mean and variance
+// constraint graph for x[j] - x[i] <= limit has edge (i,j) of weight limit
+// plus a source not in the graph (returned) with 0-edges to all vertices
+// can get rid of adding source vertex if initial shortest distance is 0 instead of POS_INF
 template <typename T>
-Constraint_sol<T> feasible(const Constraint_sys<T>& constraints, size_t sol_size) {
-	digraph<size_t,T> g;	// constraint graph
+size_t constraint_graph(digraph<size_t,T>& g, const Constraint_sys<T>& constraints) {
 	for (const auto& c : constraints)
 		g.add_edge(c.i, c.j, c.limit);
 	// assume indices given in 1 2 .. n
 	// generate source vertex that's not in graph
-	// can get rid of adding source vertex if initial shortest distance is 0 instead of POS_INF
 	size_t s {POS_INF(size_t)};
 	while(g.is_vertex(s)) s >>= 1;
 	// add 0-edges to all vertices
 	for (size_t v : g)
 		g.add_edge(s, v, 0);
-	// run bellman ford to solve system
-	auto solution = bellman_ford(g, s);
+	return s;
+}
+
+template <typename T, typename Property_map>
+Constraint_sol<T> constraint_solution(Property_map& solution, size_t s, size_t sol_size) {
 	// empty implies negative cycle exists
 	if (solution.empty()) return {};
 	solution.erase(s);	// remove temporary source (not actual data)
@@ -58,6 +59,27 @@ Constraint_sol<T> feasible(const Constraint_sys<T>& constraints, size_t sol_size
 	return res;
 }
 
+// in Ax <= b problem, b is input limits, x will be returned, A is implicit in constraints
+// returns a feasible solution, or empty if infeasible
+// solution will have minimized mean and variance
+template <typename T>
+Constraint_sol<T> feasible(const Constraint_sys<T>& constraints, size_t sol_size) {
+	digraph<size_t,T> g;	// constraint graph
+	size_t s {constraint_graph(g, constraints)};
+	// run bellman ford to solve system
+	auto solution = bellman_ford(g, s);
+	return constraint_solution<T>(solution, s, sol_size);
+}
+// same solution from the parallel frontier bellman ford, for large systems
+template <typename T>
+Constraint_sol<T> feasible(const Constraint_sys<T>& constraints, size_t sol_size, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	digraph<size_t,T> g;
+	size_t s {constraint_graph(g, constraints)};
+	auto solution = bellman_ford(g, s, par, pool);
+	return constraint_solution<T>(solution, s, sol_size);
+}
+
 // can use to maximize profit of arbitrage (currency trading)
 // each currency is a vertex, each edge is conversion
 // R[i1,i2] * R[i2,i3] * R[i3,i4] * .. > 1
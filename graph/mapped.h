@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "csr.h"
+#include "../mapped.h"	// mapped files and headers
+
+// compressed sparse row graphs in mapped files, used as Csr_graph without rebuilding anything
+// counts are vertices, stored edges and names, sections are vertex names (none for integer vertices),
+// num_vertex + 1 offsets, dests and weights, undirected graphs store both directions like Csr_graph
+
+namespace sal {
+
+constexpr char mapped_graph_magic[] = "SALGRAPH";
+constexpr uint32_t mapped_directed = 1;
+
+// output file laid out for n vertices and up to m stored edges, sections are written in place
+template <typename V, typename E>
+class Mapped_graph_writer {
+	static_assert(std::is_trivially_copyable<V>::value && std::is_trivially_copyable<E>::value,
+		"only trivially copyable vertices and weights can be mapped");
+	static_assert(sizeof(size_t) == sizeof(uint64_t), "offsets are stored as 64 bit");
+	Mapped_header header;
+	Mapped_file file;
+
+	static Mapped_header layout(size_t n, size_t m, size_t names, bool directed) {
+		Mapped_header header {mapped_header(mapped_graph_magic)};
+		header.flags = directed? mapped_directed : 0;
+		header.index_type = mapped_type_code<size_t>();
+		header.name_type = mapped_type_code<V>();
+		header.value_type = mapped_type_code<E>();
+		header.counts[0] = n;
+		header.counts[1] = m;
+		header.counts[2] = names;
+		header.sections[0] = mapped_align(sizeof(Mapped_header));
+		header.sections[1] = mapped_align(header.sections[0] + names * sizeof(V));
+		header.sections[2] = mapped_align(header.sections[1] + (n + 1) * sizeof(size_t));
+		header.sections[3] = mapped_align(header.sections[2] + m * sizeof(size_t));
+		return header;
+	}
+	template <typename T>
+	T* section(size_t i) {return reinterpret_cast<T*>(file.data() + header.sections[i]);}
+public:
+	Mapped_graph_writer(const std::string& path, size_t n, size_t m, size_t names, bool directed) :
+		header{layout(n, m, names, directed)}, file{path, header.sections[3] + m * sizeof(E)} {}
+
+	V* names() 			{return section<V>(0);}
+	size_t* offsets() 	{return section<size_t>(1);}
+	size_t* dests() 	{return section<size_t>(2);}
+	E* weights() 		{return section<E>(3);}
+
+	// stored edges can end up fewer than laid out when duplicates are dropped
+	void finish(size_t stored) {
+		header.counts[1] = stored;
+		std::memcpy(file.data(), &header, sizeof(header));
+		file.flush();
+	}
+};
+
+// an already built graph's arrays are copied out as they are
+template <typename V, typename E>
+void write_csr(const std::string& path, const Csr_graph<V,E>& g, bool directed) {
+	size_t n {g.num_vertex()}, m {g.edge_dests().size()};
+	size_t names {0};
+	if constexpr (!Is_index_vertex<V>::value) names = n;
+	Mapped_graph_writer<V,E> out {path, n, m, names, directed};
+	if constexpr (!Is_index_vertex<V>::value) std::copy(g.vertex_names().begin(), g.vertex_names().end(), out.names());
+	std::copy(g.edge_offsets().begin(), g.edge_offsets().end(), out.offsets());
+	std::copy(g.edge_dests().begin(), g.edge_dests().end(), out.dests());
+	std::copy(g.edge_weights().begin(), g.edge_weights().end(), out.weights());
+	out.finish(m);
+}
+template <typename V, typename E>
+void write_graph(const std::string& path, const Csr_graph<V,E>& g) {write_csr(path, g, false);}
+template <typename V, typename E>
+void write_graph(const std::string& path, const Csr_graph_directed<V,E>& g) {write_csr(path, g, true);}
+
+// degrees counted on the first pass, integer vertices index a vector and others have to be
+// collected to know their ids
+template <typename V, bool = Is_index_vertex<V>::value>
+struct Mapped_degrees {
+	std::map<V, size_t> degree;
+	void count(const V& u, const V& v, bool both) {
+		++degree[u];
+		if (both) ++degree[v];
+		else degree[v];
+	}
+	std::vector<V> names() const {
+		std::vector<V> sorted;
+		sorted.reserve(degree.size());
+		for (const auto& vertex : degree) sorted.push_back(vertex.first);
+		return sorted;
+	}
+	std::vector<size_t> degrees() const {
+		std::vector<size_t> counts;
+		counts.reserve(degree.size());
+		for (const auto& vertex : degree) counts.push_back(vertex.second);
+		return counts;
+	}
+};
+template <typename V>
+struct Mapped_degrees<V, true> {
+	std::vector<size_t> degree;
+	size_t vertices {0};	// largest vertex seen + 1
+	void count(V u, V v, bool both) {
+		vertices = std::max(vertices, std::max(static_cast<size_t>(u), static_cast<size_t>(v)) + 1);
+		if (vertices > degree.size()) degree.resize(std::max(vertices, 2 * degree.size()), 0);
+		++degree[static_cast<size_t>(u)];
+		if (both) ++degree[static_cast<size_t>(v)];
+	}
+	std::vector<V> names() const {return {};}
+	std::vector<size_t> degrees() const {return {degree.begin(), degree.begin() + vertices};}
+};
+
+// converts an edge source too big for memory in two passes over it:
+// the first counts degrees, the second drops each edge at its source's cursor in the mapped output,
+// then rows are sorted and deduplicated in place (the last duplicate wins, like Csr_graph)
+// only per vertex counts and names are kept in memory
+// for_each_edge(visit) has to call visit(source, dest, weight) for every edge in the same order each time
+template <typename V, typename E, typename Edge_source>
+void write_graph(const std::string& path, Edge_source&& for_each_edge, bool directed) {
+	Mapped_degrees<V> counter;
+	for_each_edge([&](const V& u, const V& v, const E&) {counter.count(u, v, !directed && u != v);});
+	std::vector<V> names {counter.names()};
+	std::vector<size_t> cursor {counter.degrees()};
+	// isolated vertices below the largest integer vertex count too, like Csr_graph
+	size_t n {Is_index_vertex<V>::value? cursor.size() : names.size()};
+	size_t m {0};
+	for (size_t& degree : cursor) {
+		size_t row {degree};
+		degree = m;
+		m += row;
+	}
+
+	Mapped_graph_writer<V,E> out {path, n, m, names.size(), directed};
+	std::copy(names.begin(), names.end(), out.names());
+	Csr_ids<V> ids;
+	if constexpr (Is_index_vertex<V>::value) ids.assign(n);
+	else ids.assign(Csr_array<V>{std::move(names)});
+	size_t* offsets {out.offsets()};
+	size_t* dests {out.dests()};
+	E* weights {out.weights()};
+	std::copy(cursor.begin(), cursor.end(), offsets);
+	offsets[n] = m;
+
+	for_each_edge([&](const V& source, const V& dest, const E& w) {
+		size_t u {ids.id(source)}, v {ids.id(dest)};
+		dests[cursor[u]] = v;
+		weights[cursor[u]++] = w;
+		if (!directed && u != v) {
+			dests[cursor[v]] = u;
+			weights[cursor[v]++] = w;
+		}
+	});
+	cursor = std::vector<size_t>{};
+
+	// rows only shrink, so compacting forward never overwrites a row not yet read
+	std::vector<std::pair<size_t, E>> row;
+	size_t read {0}, write {0};
+	for (size_t u = 0; u < n; ++u) {
+		size_t end {offsets[u+1]};
+		row.clear();
+		for (size_t e = read; e < end; ++e) row.emplace_back(dests[e], weights[e]);
+		std::stable_sort(row.begin(), row.end(), [](const std::pair<size_t,E>& a, const std::pair<size_t,E>& b){
+			return a.first < b.first;
+		});
+		offsets[u] = write;
+		for (size_t e = 0; e < row.size(); ++e) {
+			if (e + 1 < row.size() && row[e+1].first == row[e].first) continue;
+			dests[write] = row[e].first;
+			weights[write++] = row[e].second;
+		}
+		read = end;
+	}
+	offsets[n] = write;
+	out.finish(write);
+}
+// two passes over an edge list that can be iterated more than once
+template <typename V, typename E, typename Iter_edgelist>
+void write_graph(const std::string& path, Iter_edgelist begin, const Iter_edgelist end, bool directed) {
+	write_graph<V,E>(path, [&](auto&& visit) {
+		for (auto edge = begin; edge != end; ++edge) visit(edge->source, edge->dest, static_cast<E>(edge->get_weight()));
+	}, directed);
+}
+
+// Csr_graph or Csr_graph_directed whose arrays are the mapped file's sections
+// the mapping lives as long as the graph and its copies
+template <typename Graph>
+Graph map_graph(const std::string& path) {
+	using V = typename Graph::vertex_type;
+	using E = typename Graph::edge_type;
+	constexpr bool directed {!std::is_same<Graph, Csr_graph<V,E>>::value};
+	auto file = std::make_shared<const Mapped_file>(path);
+	const Mapped_header& header {mapped_check(*file, mapped_graph_magic, path)};
+	if (header.index_type != mapped_type_code<size_t>() || header.name_type != mapped_type_code<V>() ||
+		header.value_type != mapped_type_code<E>())
+		throw std::runtime_error(path + " holds other vertex or weight types");
+	if (((header.flags & mapped_directed) != 0) != directed)
+		throw std::runtime_error(path + (directed? " holds an undirected graph" : " holds a directed graph"));
+
+	size_t n {header.counts[0]}, m {header.counts[1]}, names {header.counts[2]};
+	Csr_parts<V,E> parts;
+	if constexpr (Is_index_vertex<V>::value) {
+		if (names != 0) throw std::runtime_error(path + " is truncated or corrupt");
+		parts.ids.assign(n);
+	}
+	else {
+		if (names != n) throw std::runtime_error(path + " is truncated or corrupt");
+		parts.ids.assign(Csr_array<V>{mapped_section<V>(*file, header.sections[0], n, path), n});
+	}
+	parts.offsets = Csr_array<size_t>{mapped_section<size_t>(*file, header.sections[1], n + 1, path), n + 1};
+	if (parts.offsets[0] != 0 || parts.offsets[n] != m) throw std::runtime_error(path + " is truncated or corrupt");
+	parts.dests = Csr_array<size_t>{mapped_section<size_t>(*file, header.sections[2], m, path), m};
+	parts.weights = Csr_array<E>{mapped_section<E>(*file, header.sections[3], m, path), m};
+	parts.backing = std::move(file);
+	return Graph{std::move(parts)};
+}
+
+}	// end namespace sal
@@ -0,0 +1,101 @@
+#pragma once
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "../heap.h"	// heap position index
+
+namespace sal {
+
+// property maps associate each vertex with its algorithm specific property (BFS_vertex, Shortest_vertex, ...)
+// algorithms take a property policy that picks the map for a vertex type V and property type P
+// Hashed_property works for any vertex name, Dense_property needs vertices to be indices 0 .. n-1
+// (Adjacency_matrix, Csr_graph with integer vertices)
+// each policy also gives the position index for the algorithms' indexed heaps
+
+// flat map with slots indexed by vertex, explored flags kept in a parallel array
+// no hashing and a single allocation per array; slots are sized by reserve(number of vertices)
+template <typename V, typename P>
+class Dense_property_map {
+	std::vector<P> props;
+	std::vector<unsigned char> explored;
+public:
+	using key_type = V;
+	using mapped_type = P;
+	using value_type = std::pair<const V, P&>;
+	using const_value_type = std::pair<const V, const P&>;
+
+	// iterate like a map, giving (vertex, property) pairs
+	template <typename Map, typename Value>
+	struct Iterator {
+		Map* map;
+		size_t v;
+		void operator++() {++v;}
+		Value operator*() const {return {static_cast<V>(v), map->props[v]};}
+		bool operator==(const Iterator& other) const {return v == other.v;}
+		bool operator!=(const Iterator& other) const {return v != other.v;}
+	};
+	using iterator = Iterator<Dense_property_map, value_type>;
+	using const_iterator = Iterator<const Dense_property_map, const_value_type>;
+
+	Dense_property_map() = default;
+	Dense_property_map(size_t n) : props(n), explored(n, 0) {}
+
+	// sizes the map for vertices 0 .. n-1
+	void reserve(size_t n) {
+		if (n > props.size()) {props.resize(n); explored.resize(n, 0);}
+	}
+	size_t size() const {return props.size();}
+	bool empty() const {return props.empty();}
+	void clear() {props.clear(); explored.clear();}
+
+	// assumes v < size()
+	P& operator[](V v) 				{return props[static_cast<size_t>(v)];}
+	P& at(V v) 						{return props[static_cast<size_t>(v)];}
+	const P& at(V v) const 			{return props[static_cast<size_t>(v)];}
+	size_t count(V v) const 		{return static_cast<size_t>(v) < props.size();}
+
+	// explored flag alongside each vertex's property
+	void explore(V v) 				{explored[static_cast<size_t>(v)] = 1;}
+	bool is_explored(V v) const 	{return explored[static_cast<size_t>(v)];}
+
+	iterator begin() 				{return {this, 0};}
+	iterator end() 					{return {this, props.size()};}
+	const_iterator begin() const 	{return {this, 0};}
+	const_iterator end() const 		{return {this, props.size()};}
+};
+
+struct Hashed_property {
+	template <typename V, typename P>
+	using map = std::unordered_map<V, P>;
+	template <typename V>
+	using index = std::unordered_map<V, size_t>;
+};
+struct Dense_property {
+	template <typename V, typename P>
+	using map = Dense_property_map<V, P>;
+	template <typename V>
+	using index = Dense_index<V>;
+};
+
+
+// set of fully explored vertices for the property map's algorithm
+// separate hash set by default, dense maps keep them inside the map
+template <typename Property_map>
+class Explored_set {
+	std::unordered_set<typename Property_map::key_type> set;
+public:
+	Explored_set(const Property_map&) {}
+	void insert(const typename Property_map::key_type& v) {set.insert(v);}
+	size_t count(const typename Property_map::key_type& v) const {return set.count(v);}
+};
+template <typename V, typename P>
+class Explored_set<Dense_property_map<V,P>> {
+	Dense_property_map<V,P>& property;
+public:
+	Explored_set(Dense_property_map<V,P>& p) : property(p) {}
+	void insert(V v) {property.explore(v);}
+	size_t count(V v) const {return property.is_explored(v);}
+};
+
+}
@@ -1,8 +1,16 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <limits>
+#include <vector>
 #include "adjacency_list.h"
+#include "csr.h"
+#include "property_map.h"
+#include "../parallel.h"	// thread pool for the parallel bfs
+#include "../stats.h"	// visitor counters
 #include "../../algo/macros.h"
 
 #define IS_WHITE(x) (property[x].start == POS_INF(decltype(property[x].start)))
@@ -50,15 +58,16 @@ struct DFS_vertex {
 };
 
 // resulting property maps from BFS and DFS
-template <typename V>
-using BFS_property_map = std::unordered_map<V, BFS_vertex<V>>;
-template <typename Graph>
-using BPM = BFS_property_map<typename Graph::vertex_type>;
+// hashed by default, Dense_property for graphs with vertices 0 .. n-1
+template <typename V, typename Policy = Hashed_property>
+using BFS_property_map = typename Policy::template map<V, BFS_vertex<V>>;
+template <typename Graph, typename Policy = Hashed_property>
+using BPM = BFS_property_map<typename Graph::vertex_type, Policy>;
 
-template <typename V>
-using DFS_property_map = std::unordered_map<V, DFS_vertex<V>>;
-template <typename Graph>
-using DPM = DFS_property_map<typename Graph::vertex_type>;
+template <typename V, typename Policy = Hashed_property>
+using DFS_property_map = typename Policy::template map<V, DFS_vertex<V>>;
+template <typename Graph, typename Policy = Hashed_property>
+using DPM = DFS_property_map<typename Graph::vertex_type, Policy>;
 
 // assumes unweighted graph, and assumes V is simple type (name of vertex)
 // works with directed and undirected
@@ -69,19 +78,25 @@ using DPM = DFS_property_map<typename Graph::vertex_type>;
 // common initialization shared by most single-source algorithms (BFS, Bellman-Ford, Djikstra, shortest DAG) 
 template <typename Property_map, typename Graph>
 void initialize_single_source(Property_map& property, const Graph& g, typename Graph::vertex_type s) {
-	for (auto v = g.rbegin(); v != g.rend(); ++v) 
+	property.reserve(g.num_vertex());
+	for (auto v = g.begin(); v != g.end(); ++v) 
 		property[*v] = {*v};	// parent is itself
 	property[s].distance = 0;
 }	
 
+// Stats counts relaxations (see stats.h), readable from the visitor after the search
+template <typename Stats = No_stats>
 struct BFS_visitor {
+	Stats stats;
 	template <typename Property_map, typename Queue>
 	bool relax(Property_map& property, Queue& exploring, 
 		const Edge<typename Property_map::key_type, 
 				   typename Property_map::mapped_type::edge_type>& edge) {
 		using E = typename Property_map::mapped_type::edge_type;
+		stats.count(Stat::relax);
 		// if not visited, relax edge (doesn't care about weight)
 		if (property[edge.dest()].distance == POS_INF(E)) {
+			stats.count(Stat::improve);
 			property[edge.dest()].distance = property[edge.source()].distance + 1;
 			property[edge.dest()].parent = edge.source();
 			exploring.push(edge.dest());
@@ -91,10 +106,10 @@ struct BFS_visitor {
 	}
 };
 
-template <typename Graph, typename Visitor = BFS_visitor>
-BPM<Graph> bfs(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = BFS_visitor{}) {
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = BFS_visitor<>>
+BPM<Graph, Policy> bfs(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Visitor{}) {
 	using V = typename Graph::vertex_type;
-	BPM<Graph> property;
+	BPM<Graph, Policy> property;
 	initialize_single_source(property, g, s);
 
 	property[s].distance = 0;
@@ -104,7 +119,7 @@ BPM<Graph> bfs(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor
 	exploring.push(s);
 
 	while (!exploring.empty()) {
-		V u {exploring.back()};
+		V u {exploring.front()};
 		exploring.pop();
 		// leaving exploring means fully explored
 		// for each adjacent vertex
@@ -117,10 +132,220 @@ BPM<Graph> bfs(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor
 	return property;
 }
 
+// level synchronous parallel bfs -------------
+// frontiers are bitmaps over dense vertex ids, each level expands either
+// top down: frontier vertices claim their unvisited out neighbours with an atomic or into the visited bitmap
+// bottom up: unvisited vertices look for any in neighbour in the frontier, stopping at the first found
+// once the frontier is a large part of the graph most top down edges hit visited vertices,
+// so the direction switches with Beamer's heuristics (frontier edges > unvisited edges / 14 goes bottom up,
+// frontier vertices < V / 24 goes back to top down)
+// needs vertices 0 .. n-1, like Dense_property (Adjacency_matrix, Csr_graph with integer vertices)
+
+template <typename V, typename E>
+class Adjacency_matrix;
+class Bit_adjacency_matrix;
+
+// out and in neighbours as arrays of dense ids, pointing into the graph's own arrays when it has them
+// undirected graphs share the out arrays as the in arrays
+class Bfs_adjacency {
+	std::vector<size_t> own_out_offsets, own_out_dests, own_in_offsets, own_in_dests;
+public:
+	size_t n {0};
+	const size_t* out_offsets {nullptr};
+	const size_t* out_dests {nullptr};
+	const size_t* in_offsets {nullptr};
+	const size_t* in_dests {nullptr};
+
+	Bfs_adjacency() = default;
+	Bfs_adjacency(const Bfs_adjacency&) = delete;
+	Bfs_adjacency& operator=(const Bfs_adjacency&) = delete;
+
+	// out neighbours of any graph whose vertices are indices
+	template <typename Graph>
+	void gather(const Graph& g) {
+		for (auto u = g.begin(); u != g.end(); ++u) {
+			n = std::max(n, static_cast<size_t>(*u) + 1);
+			for (auto v = u.begin(); v != u.end(); ++v) n = std::max(n, static_cast<size_t>(*v) + 1);
+		}
+		own_out_offsets.assign(n + 1, 0);
+		for (auto u = g.begin(); u != g.end(); ++u) 
+			for (auto v = u.begin(); v != u.end(); ++v) ++own_out_offsets[static_cast<size_t>(*u) + 1];
+		for (size_t u = 0; u < n; ++u) own_out_offsets[u+1] += own_out_offsets[u];
+		own_out_dests.resize(own_out_offsets[n]);
+		std::vector<size_t> fill {own_out_offsets.begin(), own_out_offsets.end() - 1};
+		for (auto u = g.begin(); u != g.end(); ++u) 
+			for (auto v = u.begin(); v != u.end(); ++v) own_out_dests[fill[static_cast<size_t>(*u)]++] = static_cast<size_t>(*v);
+		use_out(n, own_out_offsets.data(), own_out_dests.data());
+	}
+	void use_out(size_t vertices, const size_t* offsets, const size_t* dests) {
+		n = vertices;
+		out_offsets = offsets;
+		out_dests = dests;
+	}
+	// in neighbours by counting sort of the out edges on their destination
+	void transpose() {
+		own_in_offsets.assign(n + 1, 0);
+		for (size_t e = 0; e < out_offsets[n]; ++e) ++own_in_offsets[out_dests[e] + 1];
+		for (size_t v = 0; v < n; ++v) own_in_offsets[v+1] += own_in_offsets[v];
+		own_in_dests.resize(out_offsets[n]);
+		std::vector<size_t> fill {own_in_offsets.begin(), own_in_offsets.end() - 1};
+		for (size_t u = 0; u < n; ++u) 
+			for (size_t e = out_offsets[u]; e != out_offsets[u+1]; ++e) own_in_dests[fill[out_dests[e]]++] = u;
+		in_offsets = own_in_offsets.data();
+		in_dests = own_in_dests.data();
+	}
+	void symmetric() {
+		in_offsets = out_offsets;
+		in_dests = out_dests;
+	}
+	size_t num_edge() const {return n? out_offsets[n] : 0;}
+	size_t degree(size_t u) const {return out_offsets[u+1] - out_offsets[u];}
+};
+
+template <typename Graph>
+void bfs_adjacency(Bfs_adjacency& adj, const Graph& g) {adj.gather(g); adj.transpose();}
+template <typename E>
+void bfs_adjacency(Bfs_adjacency& adj, const Adjacency_matrix<size_t,E>& g) {adj.gather(g); adj.symmetric();}
+inline void bfs_adjacency(Bfs_adjacency& adj, const Bit_adjacency_matrix& g) {adj.gather(g); adj.symmetric();}
+template <typename V, typename E>
+void bfs_adjacency(Bfs_adjacency& adj, const Csr_graph<V,E>& g) {
+	adj.use_out(g.num_vertex(), g.edge_offsets().data(), g.edge_dests().data());
+	adj.symmetric();
+}
+template <typename V, typename E>
+void bfs_adjacency(Bfs_adjacency& adj, const Csr_graph_directed<V,E>& g) {
+	adj.use_out(g.num_vertex(), g.edge_offsets().data(), g.edge_dests().data());
+	adj.transpose();
+}
+
+// out neighbours only, borrowed from csr graphs
+template <typename Graph>
+void out_adjacency(Bfs_adjacency& adj, const Graph& g) {adj.gather(g);}
+template <typename V, typename E>
+void out_adjacency(Bfs_adjacency& adj, const Csr_graph<V,E>& g) {
+	adj.use_out(g.num_vertex(), g.edge_offsets().data(), g.edge_dests().data());
+}
+template <typename V, typename E>
+void out_adjacency(Bfs_adjacency& adj, const Csr_graph_directed<V,E>& g) {
+	adj.use_out(g.num_vertex(), g.edge_offsets().data(), g.edge_dests().data());
+}
+
+// words of the bitmaps handed to each task
+constexpr size_t bfs_word_grain = 64;
+
+template <typename Graph>
+BPM<Graph, Dense_property> bfs(const Graph& g, typename Graph::vertex_type s, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	using V = typename Graph::vertex_type;
+	using Word = unsigned long long;
+	static_assert(Is_index_vertex<V>::value, "parallel bfs needs vertices 0 .. n-1");
+	static constexpr size_t alpha = 14, beta = 24;
+
+	Bfs_adjacency adj;
+	bfs_adjacency(adj, g);
+	size_t n {adj.n}, words {(n + 63) / 64};
+	BPM<Graph, Dense_property> property {n};
+	parallel_for(0, n, bfs_word_grain * 64, [&](size_t lo, size_t hi) {
+		for (size_t v = lo; v < hi; ++v) property[static_cast<V>(v)] = {static_cast<V>(v)};
+	}, pool);
+	size_t source {static_cast<size_t>(s)};
+	if (source >= n) return property;
+	property[s].distance = 0;
+
+	std::unique_ptr<std::atomic<Word>[]> visited {new std::atomic<Word>[words]}, 
+		frontier {new std::atomic<Word>[words]}, next {new std::atomic<Word>[words]};
+	for (size_t w = 0; w < words; ++w) {
+		visited[w].store(0, std::memory_order_relaxed);
+		frontier[w].store(0, std::memory_order_relaxed);
+	}
+	visited[source >> 6].store(Word{1} << (source & 63), std::memory_order_relaxed);
+	frontier[source >> 6].store(Word{1} << (source & 63), std::memory_order_relaxed);
+	// bits past the last vertex are never unvisited
+	Word last_word {(n & 63)? (Word{1} << (n & 63)) - 1 : ~Word{0}};
+
+	size_t grain {std::max(bfs_word_grain, words / (8 * pool.size()) + 1)};
+	size_t chunks {(words + grain - 1) / grain};
+	// vertices and out edges added to the next frontier by each chunk
+	std::vector<size_t> found(chunks), found_edges(chunks);
+
+	size_t frontier_size {1}, frontier_edges {adj.degree(source)};
+	size_t unvisited_edges {adj.num_edge() - frontier_edges};
+	bool bottom_up {false};
+	for (size_t level = 1; frontier_size; ++level) {
+		if (!bottom_up && frontier_edges > unvisited_edges / alpha) bottom_up = true;
+		else if (bottom_up && frontier_size < n / beta) bottom_up = false;
+		// parallel_for may run the whole range as one chunk
+		std::fill(found.begin(), found.end(), 0);
+		std::fill(found_edges.begin(), found_edges.end(), 0);
+
+		if (bottom_up) parallel_for(0, words, grain, [&](size_t lo, size_t hi) {
+			// each chunk owns its words, so only the frontier reads are shared
+			size_t added {0}, added_edges {0};
+			for (size_t w = lo; w < hi; ++w) {
+				Word seen {visited[w].load(std::memory_order_relaxed)};
+				Word unseen {~seen & (w + 1 == words? last_word : ~Word{0})}, reached {0};
+				for (; unseen; unseen &= unseen - 1) {
+					size_t v {(w << 6) + __builtin_ctzll(unseen)};
+					for (size_t e = adj.in_offsets[v]; e != adj.in_offsets[v+1]; ++e) {
+						size_t u {adj.in_dests[e]};
+						if (frontier[u >> 6].load(std::memory_order_relaxed) >> (u & 63) & 1) {
+							property[static_cast<V>(v)].parent = static_cast<V>(u);
+							property[static_cast<V>(v)].distance = level;
+							reached |= Word{1} << (v & 63);
+							++added;
+							added_edges += adj.degree(v);
+							break;
+						}
+					}
+				}
+				visited[w].store(seen | reached, std::memory_order_relaxed);
+				next[w].store(reached, std::memory_order_relaxed);
+			}
+			found[lo / grain] = added;
+			found_edges[lo / grain] = added_edges;
+		}, pool);
+		else {
+			for (size_t w = 0; w < words; ++w) next[w].store(0, std::memory_order_relaxed);
+			// chunks claim vertices anywhere in the graph
+			parallel_for(0, words, grain, [&](size_t lo, size_t hi) {
+				size_t added {0}, added_edges {0};
+				for (size_t w = lo; w < hi; ++w) {
+					for (Word bits = frontier[w].load(std::memory_order_relaxed); bits; bits &= bits - 1) {
+						size_t u {(w << 6) + __builtin_ctzll(bits)};
+						for (size_t e = adj.out_offsets[u]; e != adj.out_offsets[u+1]; ++e) {
+							size_t v {adj.out_dests[e]};
+							Word bit {Word{1} << (v & 63)};
+							if (visited[v >> 6].load(std::memory_order_relaxed) & bit) continue;
+							if (visited[v >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) continue;
+							property[static_cast<V>(v)].parent = static_cast<V>(u);
+							property[static_cast<V>(v)].distance = level;
+							next[v >> 6].fetch_or(bit, std::memory_order_relaxed);
+							++added;
+							added_edges += adj.degree(v);
+						}
+					}
+				}
+				found[lo / grain] = added;
+				found_edges[lo / grain] = added_edges;
+			}, pool);
+		}
+
+		std::swap(frontier, next);
+		frontier_size = frontier_edges = 0;
+		for (size_t c = 0; c < chunks; ++c) {frontier_size += found[c]; frontier_edges += found_edges[c];}
+		unvisited_edges -= frontier_edges;
+	}
+	return property;
+}
+
+// Stats counts discovered vertices and back edges, derived visitors inherit them
+template <typename Stats = No_stats>
 struct DFS_visitor {
+	Stats stats;
 	template <typename Property_map, typename Graph>
 	std::vector<typename Graph::vertex_type> initialize_vertex(Property_map& property, const Graph& g) {
 		std::vector<typename Graph::vertex_type> exploring;
+		property.reserve(g.num_vertex());
 		for (auto v = g.rbegin(); v != g.rend(); ++v) {
 			// mark unexplored
 			property[*v] = {*v};
@@ -143,72 +368,94 @@ struct DFS_visitor {
 
 // for DFS on only 1 source vertex
 template <typename Graph>
-struct Graph_single_visitor : public DFS_visitor {
+struct Graph_single_visitor : public DFS_visitor<> {
 	using V = typename Graph::vertex_type;
 	V source;
 	Graph_single_visitor(V s) : source{s} {}
 	template <typename Property_map>
 	std::vector<V> initialize_vertex(Property_map& property, const Graph& g) {
-		for (auto v = g.rbegin(); v != g.rend(); ++v)
+		property.reserve(g.num_vertex());
+		for (auto v = g.begin(); v != g.end(); ++v)
 			property[*v] = {*v};
 		return {source};
 	}
 };
 
+// explicit stack version of dfs_visit with the same callbacks and time stamps, for any depth
+// each frame keeps its vertex's next unexamined edge, so every edge is examined once
+template <typename Graph, typename Visitor, typename Property_map>
+void dfs_explore(const Graph& g, typename Graph::vertex_type u, Property_map& property, size_t& explore_time, Visitor& visitor) {
+	using V = typename Graph::vertex_type;
+	using Adjacent = decltype(g.adjacent(u).first);
+	struct Frame {
+		V vertex;
+		Adjacent next, end;
+	};
+	std::vector<Frame> exploring;
+	auto& stats = visitor_stats(visitor);
+	auto discover = [&](V v) {
+		stats.count(Stat::discover);
+		property[v].start = ++explore_time;
+		visitor.discover_vertex(v, g);
+		auto edges = g.adjacent(v);
+		exploring.push_back({v, edges.first, edges.second});
+	};
+
+	discover(u);
+	while (!exploring.empty()) {
+		Frame& cur = exploring.back();
+		if (cur.next == cur.end) {
+			property[cur.vertex].finish = ++explore_time;
+			visitor.finish_vertex(cur.vertex, g);
+			exploring.pop_back();
+			continue;
+		}
+		V adj {*cur.next};
+		++cur.next;
+		// tree edge, only 1 neighbour is pushed at a time to go depth first
+		if (IS_WHITE(adj)) {
+			property[adj].parent = cur.vertex;
+			discover(adj);
+		}
+		else if (IS_GREY(adj)) {
+			stats.count(Stat::back_edge);
+			visitor.back_edge(adj, g);
+		}
+		else visitor.forward_or_cross_edge(adj, g);
+	}
+}
+
 // depth first search, used usually in other algorithms
 // explores all vertices of a graph, produces a depth-first forest
-template <typename Graph, typename Visitor = DFS_visitor>
-DPM<Graph> dfs(const Graph& g, Visitor&& visitor = DFS_visitor{}) {
+// O(V + E) without recursion, so long chains can't overflow the stack
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = DFS_visitor<>>
+DPM<Graph, Policy> dfs(const Graph& g, Visitor&& visitor = Visitor{}) {
 	using V = typename Graph::vertex_type;
-	DPM<Graph> property;
-	// use visitor to initialize stack (order of DFS)
+	DPM<Graph, Policy> property;
+	// use visitor to initialize stack (order of DFS), roots are taken from the back
 	std::vector<V> exploring {visitor.initialize_vertex(property, g)};
 	
 	size_t explore_time {0};
 
-	while (!exploring.empty()) {
-		V cur {exploring.back()};
-		// tree edge, first exploration on (u,v)
-		if (IS_WHITE(cur)) {
-			property[cur].start = ++explore_time;
-			visitor.start_vertex(cur, g);
-		}
-		
-		bool fully_explored {true};
-		auto edges = g.adjacent(cur);
-		for (auto adj = edges.first; adj != edges.second; ++adj) {
-			// check if any neighbours haven't been explored
-			if (IS_WHITE(*adj)) {
-				property[*adj].start = ++explore_time;
-				property[*adj].parent = cur;
-				exploring.push_back(*adj);
-				fully_explored = false;	// still have unexplored neighbours
-				break;		// only push 1 neighbour to achieve depth first
-			}
-			else if (IS_GREY(*adj)) visitor.back_edge(*adj, g);
-			else visitor.forward_or_cross_edge(*adj, g);
-		}
-		if (fully_explored) {
-			exploring.pop_back();
-			if (property[cur].finish == 0) {// default value
-				property[cur].finish = ++explore_time;
-				visitor.finish_vertex(cur, g);
-			}
+	for (auto v = exploring.rbegin(); v != exploring.rend(); ++v)
+		// start vertex of a new depth first tree
+		if (IS_WHITE(*v)) {
+			visitor.start_vertex(*v, g);
+			dfs_explore(g, *v, property, explore_time, visitor);
 		}
-	}
 
 	return property;
 }
 // overload for specifying a source, can't use other visitors
-template <typename Graph>
-DPM<Graph> dfs(const Graph& g, typename Graph::vertex_type s, int) {	// dummy argument for overloading
-	return dfs(g, Graph_single_visitor<Graph>{s});
+template <typename Policy = Hashed_property, typename Graph>
+DPM<Graph, Policy> dfs(const Graph& g, typename Graph::vertex_type s, int) {	// dummy argument for overloading
+	return dfs<Policy>(g, Graph_single_visitor<Graph>{s});
 }
 
 // recursive version of dfs, much simpler, but can blow up the stack
-template <typename Graph, typename Visitor = DFS_visitor>
-DPM<Graph> dfs_recurse(const Graph& g, Visitor&& visitor = DFS_visitor{}) {
-	DPM<Graph> property;
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = DFS_visitor<>>
+DPM<Graph, Policy> dfs_recurse(const Graph& g, Visitor&& visitor = Visitor{}) {
+	DPM<Graph, Policy> property;
 	using V = typename Graph::vertex_type;
 	// no need to reverse traverse now
 	std::vector<V> exploring {visitor.initialize_vertex(property, g)};
@@ -225,9 +472,10 @@ DPM<Graph> dfs_recurse(const Graph& g, Visitor&& visitor = DFS_visitor{}) {
 	return property;
 }
 // explore only 1 vertex
-template <typename Graph, typename Visitor = DFS_visitor>
-DPM<Graph> dfs_recurse(const Graph& g, typename Graph::vertex_type u, Visitor&& visitor = DFS_visitor{}) {
-	DPM<Graph> property;
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = DFS_visitor<>>
+DPM<Graph, Policy> dfs_recurse(const Graph& g, typename Graph::vertex_type u, Visitor&& visitor = Visitor{}) {
+	DPM<Graph, Policy> property;
+	property.reserve(g.num_vertex());
 	// no need to reverse traverse now
 	for (auto v = g.begin(); v != g.end(); ++v)
 		property[*v] = {*v};
@@ -243,6 +491,7 @@ DPM<Graph> dfs_recurse(const Graph& g, typename Graph::vertex_type u, Visitor&&
 template <typename Graph, typename Visitor, typename Property_map>
 void dfs_visit(const Graph& g, typename Graph::vertex_type u, Property_map& property, size_t& explore_time, Visitor& visitor) {
 	// discover vertex
+	visitor_stats(visitor).count(Stat::discover);
 	property[u].start = ++explore_time;
 	visitor.discover_vertex(u, g);
 
@@ -252,7 +501,10 @@ void dfs_visit(const Graph& g, typename Graph::vertex_type u, Property_map& prop
 			property[*adj].parent = u;
 			dfs_visit(g, *adj, property, explore_time, visitor);
 		}
-		else if (IS_GREY(*adj)) visitor.back_edge(*adj, g);
+		else if (IS_GREY(*adj)) {
+			visitor_stats(visitor).count(Stat::back_edge);
+			visitor.back_edge(*adj, g);
+		}
 		else visitor.forward_or_cross_edge(*adj, g);
 	}
 	// finish vertex
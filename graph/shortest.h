@@ -1,7 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <memory>
+#include <vector>
 #include "search.h"		// initialize single source
+#include "adjacency_matrix.h"	// dense weights for floyd warshall and k hop queries
 #include "utility.h"	// topological sort, shortest path vertex, comparator, and visitor
+#include "../parallel.h"	// thread pool for the parallel engines
 #include "../../algo/macros.h"
 // subset of graph searches, specifically searching for shortest paths
 // solves (1) single-source (2) single-destination (3) single pair (4) all pairs
@@ -21,15 +27,18 @@ namespace sal {
 // single-source general edge weights, DP and is slower than others
 // O(VE) time, does O(V) relaxations on each vertex
 // applicable in many other algorithms, such as for solving difference constraints
-template <typename Graph, typename Visitor = Shortest_visitor>
-SPM<Graph> bellman_ford(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Shortest_visitor{}) {
-	SPM<Graph> property;
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = Shortest_visitor<>>
+SPM<Graph, Policy> bellman_ford(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Visitor{}) {
+	SPM<Graph, Policy> property;
 	initialize_single_source(property, g, s);
+	auto& stats = visitor_stats(visitor);
 
 	// need at most |V| - 1 passes since shortest path is always simple (cycles are banned)
 	size_t pass {1};
 	bool changed {true};
 	while (changed) {
+		auto timing = stats.time(Stat::pass);
+		stats.count(Stat::pass);
 		changed = false;
 		// iterate over all edges (u,v)
 		for (auto u = g.begin(); u != g.end(); ++u)
@@ -40,21 +49,256 @@ SPM<Graph> bellman_ford(const Graph& g, typename Graph::vertex_type s, Visitor&&
 	// check if triangle inequality violated
 	for (auto u = g.begin(); u != g.end(); ++u)
 		for (auto v = u.begin(); v != u.end(); ++v) 
-			if (property[*v].distance > property[*u].distance + v.weight())
-				return SPM<Graph>{};	// -infinity cycle exists
+			if (property[*u].distance != POS_INF(typename Graph::edge_type) && 
+				property[*v].distance > property[*u].distance + v.weight())
+				return SPM<Graph, Policy>{};	// -infinity cycle exists
 	return property;
 }
 
+// parallel single source shortest paths -------------
+// the graph is flattened once into dense ids and contiguous (dest, weight) arrays like Csr_graph,
+// then rounds relax the edges out of a frontier, chunks of the frontier split across the pool
+// assumes arithmetic edge weights (distances are atomics)
+
+// chunks of frontier vertices handed to each task, small frontiers stay on the calling thread
+constexpr size_t sssp_grain = 1024;
+
+template <typename Graph, typename Policy>
+class Parallel_sssp {
+	using V = typename Graph::vertex_type;
+	using E = typename Graph::edge_type;
+	static constexpr size_t none = POS_INF(size_t);
+
+	Thread_pool& pool;
+	std::vector<V> names;
+	std::vector<size_t> offsets, dests;
+	std::vector<E> weights;
+	std::unique_ptr<std::atomic<E>[]> dist;
+	// set when lowered in the current round, claimed by the first edge recording the parent
+	std::unique_ptr<std::atomic<unsigned char>[]> lowered, claimed;
+	std::vector<size_t> parent;
+	// distance each frontier vertex was relaxed with this round
+	std::vector<E> snapshot;
+	size_t source {none};
+
+public:
+	Parallel_sssp(const Graph& g, V s, Thread_pool& p) : pool(p) {
+		// ids are stored + 1 so a lookup of 0 means not a vertex
+		typename Policy::template index<V> ids;
+		names.reserve(g.num_vertex());
+		for (auto u = g.begin(); u != g.end(); ++u) {
+			ids[*u] = names.size() + 1;
+			names.push_back(*u);
+		}
+		offsets.reserve(names.size() + 1);
+		dests.reserve(g.num_edge());
+		weights.reserve(g.num_edge());
+		offsets.push_back(0);
+		for (auto u = g.begin(); u != g.end(); ++u) {
+			for (auto v = u.begin(); v != u.end(); ++v) {
+				dests.push_back(index_lookup(ids, static_cast<V>(*v)) - 1);
+				weights.push_back(v.weight());
+			}
+			offsets.push_back(dests.size());
+		}
+		size_t n {names.size()};
+		dist.reset(new std::atomic<E>[n]);
+		lowered.reset(new std::atomic<unsigned char>[n]);
+		claimed.reset(new std::atomic<unsigned char>[n]);
+		parent.assign(n, none);
+		for (size_t v = 0; v < n; ++v) {
+			dist[v].store(POS_INF(E), std::memory_order_relaxed);
+			lowered[v].store(0, std::memory_order_relaxed);
+			claimed[v].store(0, std::memory_order_relaxed);
+		}
+		size_t id {index_lookup(ids, s)};
+		if (id) {
+			source = id - 1;
+			dist[source].store(0, std::memory_order_relaxed);
+			parent[source] = source;
+		}
+	}
+
+	size_t num_vertex() const {return names.size();}
+	size_t start() const {return source;}
+	bool has_negative_edge() const {
+		return std::any_of(weights.begin(), weights.end(), [](const E& w){return w < 0;});
+	}
+	E max_weight() const {return weights.empty()? E{} : *std::max_element(weights.begin(), weights.end());}
+	size_t num_edge() const {return dests.size();}
+	const std::vector<size_t>& edge_offsets() const {return offsets;}
+	const std::vector<size_t>& edge_dests() const {return dests;}
+	E distance(size_t v) const {return dist[v].load(std::memory_order_relaxed);}
+
+	// relax the edges (u,v) out of the frontier that pass keep(w), returns the vertices lowered
+	// two passes so parents always agree with distances, which racing distance and parent writes can't promise:
+	// the first lowers distances with an atomic min, remembering the distance each source was relaxed with,
+	// the second gives each lowered vertex the first frontier vertex whose edge produced its final distance
+	template <typename Keep>
+	std::vector<size_t> relax(const std::vector<size_t>& frontier, Keep&& keep) {
+		size_t n {frontier.size()};
+		snapshot.resize(n);
+
+		size_t grain {std::max(sssp_grain, n / (4 * pool.size()) + 1)};
+		std::vector<std::vector<size_t>> changed((n + grain - 1) / grain);
+		parallel_for(0, n, grain, [&](size_t lo, size_t hi) {
+			std::vector<size_t>& out = changed[lo / grain];
+			for (size_t i = lo; i < hi; ++i) {
+				size_t u {frontier[i]};
+				// may already be lower than at the start of the round, which only helps
+				snapshot[i] = distance(u);
+				for (size_t e = offsets[u]; e != offsets[u+1]; ++e) {
+					if (!keep(weights[e])) continue;
+					E candidate {snapshot[i] + weights[e]};
+					size_t v {dests[e]};
+					E current {dist[v].load(std::memory_order_relaxed)};
+					while (candidate < current && 
+						!dist[v].compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+					if (candidate < current && !lowered[v].load(std::memory_order_relaxed) && 
+						!lowered[v].exchange(1, std::memory_order_relaxed)) 
+						out.push_back(v);
+				}
+			}
+		}, pool);
+		parallel_for(0, n, grain, [&](size_t lo, size_t hi) {
+			for (size_t i = lo; i < hi; ++i) {
+				size_t u {frontier[i]};
+				for (size_t e = offsets[u]; e != offsets[u+1]; ++e) {
+					size_t v {dests[e]};
+					if (!keep(weights[e]) || !lowered[v].load(std::memory_order_relaxed)) continue;
+					if (snapshot[i] + weights[e] == distance(v) && 
+						!claimed[v].exchange(1, std::memory_order_relaxed)) parent[v] = u;
+				}
+			}
+		}, pool);
+
+		// sorted so the next round walks the edge arrays in order
+		size_t lowered_count {0};
+		for (const auto& out : changed) lowered_count += out.size();
+		std::vector<size_t> next;
+		next.reserve(lowered_count);
+		if (lowered_count > names.size() / 16) {
+			for (size_t v = 0; v < names.size(); ++v) if (lowered[v].load(std::memory_order_relaxed)) next.push_back(v);
+		}
+		else {
+			for (const auto& out : changed) next.insert(next.end(), out.begin(), out.end());
+			std::sort(next.begin(), next.end());
+		}
+		for (size_t v : next) {
+			lowered[v].store(0, std::memory_order_relaxed);
+			claimed[v].store(0, std::memory_order_relaxed);
+		}
+		return next;
+	}
+
+	// parents only form a cycle if it has negative weight, checked by walking parents in O(V)
+	bool has_parent_cycle() const {
+		std::vector<size_t> walk(names.size(), none);
+		for (size_t v = 0; v < names.size(); ++v) {
+			size_t u {v};
+			while (parent[u] != none && parent[u] != u && walk[u] == none) {
+				walk[u] = v;
+				u = parent[u];
+			}
+			if (walk[u] == v) return true;
+		}
+		return false;
+	}
+
+	SPM<Graph, Policy> result(const Graph& g, V s) const {
+		SPM<Graph, Policy> property;
+		initialize_single_source(property, g, s);
+		for (size_t v = 0; v < names.size(); ++v) {
+			if (parent[v] == none) continue;
+			property[names[v]].parent = names[parent[v]];
+			property[names[v]].distance = distance(v);
+		}
+		return property;
+	}
+};
+
+// frontier bellman ford, round r relaxes only the edges out of vertices lowered in round r-1
+// same O(VE) worst case, but most rounds touch a small part of the graph
+// a frontier still alive after V rounds, or a cycle among the parents, means a negative cycle
+template <typename Policy = Hashed_property, typename Graph>
+SPM<Graph, Policy> bellman_ford(const Graph& g, typename Graph::vertex_type s, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	Parallel_sssp<Graph, Policy> engine {g, s, pool};
+	if (engine.start() == POS_INF(size_t)) return engine.result(g, s);
+
+	std::vector<size_t> frontier {engine.start()};
+	for (size_t round = 1; !frontier.empty(); ++round) {
+		if (round > engine.num_vertex()) return SPM<Graph, Policy>{};	// -infinity cycle exists
+		frontier = engine.relax(frontier, [](const typename Graph::edge_type&){return true;});
+		// checking at powers of 2 keeps the checks O(V lgV) in total
+		if ((round & (round - 1)) == 0 && round >= 16 && engine.has_parent_cycle()) 
+			return SPM<Graph, Policy>{};
+	}
+	return engine.result(g, s);
+}
+
+// delta stepping for non-negative weights, a parallel dijkstra over buckets of width delta
+// vertices in the lowest bucket are relaxed together, light edges (w <= delta) first since
+// they can refill the same bucket, then heavy edges once the bucket settles
+// delta trades work for parallelism (dijkstra as delta -> 0, bellman ford as delta -> inf),
+// default is the max weight over the average degree
+// negative weights fall back to the frontier bellman ford along with its negative cycle detection
+template <typename Policy = Hashed_property, typename Graph>
+SPM<Graph, Policy> delta_stepping(const Graph& g, typename Graph::vertex_type s, 
+	typename Graph::edge_type delta = {}, Thread_pool& pool = Thread_pool::global()) {
+	using E = typename Graph::edge_type;
+	Parallel_sssp<Graph, Policy> engine {g, s, pool};
+	if (engine.start() == POS_INF(size_t)) return engine.result(g, s);
+	if (engine.has_negative_edge()) return bellman_ford<Policy>(g, s, par, pool);
+
+	E max_w {engine.max_weight()};
+	if (!(delta > 0)) delta = static_cast<E>(static_cast<double>(max_w) * engine.num_vertex() / std::max<size_t>(engine.num_edge(), 1));
+	if (!(delta > 0)) delta = 1;
+	auto bucket_of = [delta](E d) {return static_cast<size_t>(d / delta);};
+	// tentative distances are within max weight of the current bucket, so buckets are reused cyclically
+	std::vector<std::vector<size_t>> buckets(bucket_of(max_w) + 2);
+	size_t queued {1}, current {0};
+	buckets[0].push_back(engine.start());
+	auto requeue = [&](const std::vector<size_t>& lowered) {
+		for (size_t v : lowered) buckets[bucket_of(engine.distance(v)) % buckets.size()].push_back(v);
+		queued += lowered.size();
+	};
+
+	std::vector<unsigned char> taken(engine.num_vertex(), 0);
+	std::vector<size_t> frontier, settled;
+	while (queued) {
+		std::vector<size_t>& bucket = buckets[current % buckets.size()];
+		settled.clear();
+		while (!bucket.empty()) {
+			// stale entries moved to a lower bucket or are duplicates
+			frontier.clear();
+			for (size_t v : bucket) 
+				if (!taken[v] && bucket_of(engine.distance(v)) == current) {taken[v] = 1; frontier.push_back(v);}
+			queued -= bucket.size();
+			bucket.clear();
+			for (size_t v : frontier) taken[v] = 0;
+			settled.insert(settled.end(), frontier.begin(), frontier.end());
+			requeue(engine.relax(frontier, [delta](const E& w){return w <= delta;}));
+		}
+		frontier.clear();
+		for (size_t v : settled) 
+			if (!taken[v]) {taken[v] = 1; frontier.push_back(v);}
+		for (size_t v : frontier) taken[v] = 0;
+		requeue(engine.relax(frontier, [delta](const E& w){return w > delta;}));
+		++current;
+	}
+	return engine.result(g, s);
+}
 
 
 // single source DAG shortest path in O(V+E) time
 // relax according to a topological sort of vertices
 // always well defined (can't have cycles)
 // can be used to find longest path (critical path) by negating all weights
-template <typename Graph, typename Visitor = Shortest_visitor>
-SPM<Graph> shortest_dag(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Shortest_visitor{}) {
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = Shortest_visitor<>>
+SPM<Graph, Policy> shortest_dag(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Visitor{}) {
 	using V = typename Graph::vertex_type;
-	SPM<Graph> property;
+	SPM<Graph, Policy> property;
 	initialize_single_source(property, g, s);
 
 	// explore vertices in topological order
@@ -68,61 +312,371 @@ SPM<Graph> shortest_dag(const Graph& g, typename Graph::vertex_type s, Visitor&&
 	}
 	return property;
 }
+// a topological level at a time from kahn's algorithm, each level's reached vertices relaxed
+// together like a bellman ford frontier; every in edge of a level comes from an earlier one,
+// so its distances are final before it relaxes and one pass over the levels is enough
+// returns an empty map if g has a cycle
+template <typename Policy = Hashed_property, typename Graph>
+SPM<Graph, Policy> shortest_dag(const Graph& g, typename Graph::vertex_type s, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	using E = typename Graph::edge_type;
+	Parallel_sssp<Graph, Policy> engine {g, s, pool};
+	auto levels = topological_levels(engine.num_vertex(), engine.edge_offsets().data(), engine.edge_dests().data(), pool);
+	size_t ordered {0};
+	for (const auto& level : levels) ordered += level.size();
+	if (ordered != engine.num_vertex()) return SPM<Graph, Policy>{};
+	if (engine.start() == POS_INF(size_t)) return engine.result(g, s);
+
+	std::vector<size_t> frontier;
+	for (const auto& level : levels) {
+		frontier.clear();
+		for (size_t v : level) if (engine.distance(v) != POS_INF(E)) frontier.push_back(v);
+		if (!frontier.empty()) engine.relax(frontier, [](const E&){return true;});
+	}
+	return engine.result(g, s);
+}
 // simpler if the graph can be modified
-template <typename Graph, typename Visitor = Shortest_visitor>
-SPM<Graph> critical_dag(Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Shortest_visitor{}) {
+template <typename Policy = Hashed_property, typename Graph, typename Visitor = Shortest_visitor<>>
+SPM<Graph, Policy> critical_dag(Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Visitor{}) {
 	// negate each edge and run shortest dag
 	for (auto u = g.begin(); u != g.end(); ++u)
 		for (auto v = u.begin(); v != u.end(); ++v)
 			v.weight() = -v.weight();
-	return shortest_dag(g, s, visitor);
+	return shortest_dag<Policy>(g, s, visitor);
 }
 
 
 
 // single source directed graph
-// assumes non-negative weighted edges, O((V+E)lgV) with binary heap (priority queue)
+// assumes non-negative weighted edges, O((V+E)lgV) with indexed heap (priority queue)
+// vertices enter the heap when first reached, so unreachable vertices are never queued
+// the visitor's stats also count the heap's sifts and time settled vertices
+template <typename Stats = No_stats>
 struct DJ_visitor {
+	Stats stats;
 	// relaxes an edge if it meets certain requirements
-	template <typename Property_map, typename Queue>
+	template <typename Property_map, typename Explored, typename Queue>
 	void relax(Property_map& property, 
-				const std::unordered_set<typename Property_map::key_type>& explored,
+				const Explored& explored,
 				Queue& exploring, 
 				const Edge<typename Property_map::key_type, 
 			    typename Property_map::mapped_type::edge_type>& edge) {
 		// haven't explored yet and the cost is less
-		if (explored.find(edge.dest()) == explored.end() && 
-			edge.weight() < property[edge.dest()].distance + edge.weight()) {
+		stats.count(Stat::relax);
+		if (!explored.count(edge.dest()) && 
+			property[edge.source()].distance + edge.weight() < property[edge.dest()].distance) {
+			stats.count(Stat::improve);
 
 			property[edge.dest()].distance = property[edge.source()].distance + edge.weight();
 			property[edge.dest()].parent = edge.source();
-			// fix heap property
-			exploring.sift_up(exploring.key(edge.dest()), edge.dest());
+			// fix heap property, first discovery enters the heap
+			size_t handle {exploring.key(edge.dest())};
+			if (handle) exploring.decrease_key(handle);
+			else exploring.insert(edge.dest());
 		}		
 	}
 };
 
-template <typename Graph>
-SPM<Graph> dijkstra(const Graph& g, typename Graph::vertex_type s, DJ_visitor&& visitor = {}) {
+// integer weights get a radix heap by default (see Auto_queue)
+template <typename Policy = Hashed_property, typename Queue = Auto_queue, typename Graph, typename Visitor = DJ_visitor<>>
+SPM<Graph, Policy> dijkstra(const Graph& g, typename Graph::vertex_type s, Visitor&& visitor = Visitor{}) {
 	using V = typename Graph::vertex_type;
-	using Cmp = Shortest_cmp<SPM<Graph>>;
-	SPM<Graph> property;
+	SPM<Graph, Policy> property;
 	initialize_single_source(property, g, s);
 
-	std::unordered_set<V> explored;
-	// comparator querying on distance
-	Heap<V, Cmp> exploring {Cmp{property}};
-	exploring.insert(g.begin(), g.end());
+	Explored_set<SPM<Graph, Policy>> explored {property};
+	auto& stats = visitor_stats(visitor);
+	with_frontier<Queue, true, Policy>(g, property, stats, [&](auto& exploring) {
+		exploring.insert(s);
+		while (!exploring.empty()) {
+			auto timing = stats.time(Stat::settle);
+			stats.count(Stat::settle);
+			V u {exploring.extract_top()};
+			explored.insert(u);
+			auto edges = g.adjacent(u);
+			for (auto v = edges.first; v != edges.second; ++v) 
+				visitor.relax(property, explored, exploring, {u, v});
+		}
+	});
+	return property;
+}
+
+// all pairs shortest paths -------------
+// dense results for graphs with vertices 0 .. n-1
+// distance(u,v) is POS_INF where v is unreachable from u
+// parent(u,v) is the vertex before v on a shortest u -> v path, v itself for u and unreachable vertices (like SPM),
+// only filled when asked for; both are empty when a negative cycle exists (like an empty SPM)
+template <typename E>
+struct All_pairs {
+	Matrix<E> distance;
+	Matrix<size_t> parent;
 
-	while (!exploring.empty()) {
-		V u {exploring.extract_top()};
-		explored.insert(u);
-		auto edges = g.adjacent(u);
-		for (auto v = edges.first; v != edges.second; ++v) 
-			visitor.relax(property, explored, exploring, {u, v});
+	bool empty() const {return distance.row() == 0;}
+	// u ... v, empty if v is unreachable, needs parents
+	std::vector<size_t> path(size_t u, size_t v) const {
+		std::vector<size_t> res;
+		if (distance.get(u, v) == POS_INF(E)) return res;
+		for (; v != u; v = parent.get(u, v)) res.push_back(v);
+		res.push_back(u);
+		std::reverse(res.begin(), res.end());
+		return res;
 	}
+};
 
-	return property;
+// floyd warshall by tiles, O(V^3) but every pass streams rows, so it beats V dijkstras on dense graphs
+// each round k takes the diagonal tile, then the tiles in its row and column, then every other tile,
+// the tiles within the last two phases are independent of each other
+// three floyd_block x floyd_block tiles (the one updated and the two it's relaxed through) fit in L2
+constexpr size_t floyd_block = 64;
+
+// row i relaxed through row k in chunks of a fixed width, so the loops vectorize at -O2 like gemm's register tile
+// (the rows are distinct, so no alias checks either), the last partial chunk of a tile one column at a time
+// POS_INF stays infinite instead of overflowing, selecting instead of branching keeps the loop straight;
+// floating point needs no select since POS_INF plus any sane weight rounds to POS_INF or overflows to inf
+constexpr size_t floyd_lanes = 16;
+
+template <typename E>
+SAL_GEMM_INLINE E floyd_through(E dik, E dkj) {
+	if constexpr (std::is_floating_point<E>::value) return dik + dkj;
+	else return dkj == POS_INF(E)? POS_INF(E) : dik + dkj;
+}
+template <size_t W, typename E>
+SAL_GEMM_INLINE void floyd_row(E* __restrict di, const E* __restrict dk, E dik) {
+	for (size_t j = 0; j < W; ++j) {
+		E through {floyd_through(dik, dk[j])};
+		di[j] = through < di[j]? through : di[j];
+	}
+}
+template <size_t W, typename E>
+SAL_GEMM_INLINE void floyd_row(E* __restrict di, const E* __restrict dk, E dik, size_t* __restrict pi, const size_t* __restrict pk) {
+	for (size_t j = 0; j < W; ++j) {
+		E through {floyd_through(dik, dk[j])}, current {di[j]};
+		bool shorter {through < current};
+		di[j] = shorter? through : current;
+		// blended through a mask, selecting between the two loads doesn't vectorize
+		size_t mask {size_t{0} - shorter};
+		pi[j] = (pk[j] & mask) | (pi[j] & ~mask);
+	}
+}
+
+// d(i,j) = min(d(i,j), d(i,k) + d(k,j)) for rows [i0,i1), columns [j0,j1) and k in [k0,k1)
+template <bool Parents, typename E>
+SAL_GEMM_INLINE void floyd_tile(E* d, size_t* p, size_t n, size_t i0, size_t i1, size_t j0, size_t j1, size_t k0, size_t k1) {
+	for (size_t k = k0; k < k1; ++k) {
+		for (size_t i = i0; i < i1; ++i) {
+			E dik {d[i*n + k]};
+			// row k only changes through itself on a negative cycle, which is reported either way
+			if (dik == POS_INF(E) || i == k) continue;
+			E* di {d + i*n};
+			const E* dk {d + k*n};
+			size_t j {j0};
+			if constexpr (Parents) {
+				size_t* pi {p + i*n};
+				const size_t* pk {p + k*n};
+				for (; j + floyd_lanes <= j1; j += floyd_lanes) floyd_row<floyd_lanes>(di + j, dk + j, dik, pi + j, pk + j);
+				for (; j < j1; ++j) floyd_row<1>(di + j, dk + j, dik, pi + j, pk + j);
+			}
+			else {
+				for (; j + floyd_lanes <= j1; j += floyd_lanes) floyd_row<floyd_lanes>(di + j, dk + j, dik);
+				for (; j < j1; ++j) floyd_row<1>(di + j, dk + j, dik);
+			}
+		}
+	}
+}
+
+template <bool Parents, typename E>
+void floyd_tile_generic(E* d, size_t* p, size_t n, size_t i0, size_t i1, size_t j0, size_t j1, size_t k0, size_t k1) {
+	floyd_tile<Parents>(d, p, n, i0, i1, j0, j1, k0, k1);
+}
+#ifdef SAL_GEMM_DISPATCH
+template <bool Parents, typename E>
+__attribute__((target("avx2")))
+void floyd_tile_avx2(E* d, size_t* p, size_t n, size_t i0, size_t i1, size_t j0, size_t j1, size_t k0, size_t k1) {
+	floyd_tile<Parents>(d, p, n, i0, i1, j0, j1, k0, k1);
+}
+template <bool Parents, typename E>
+__attribute__((target("avx512f,avx512bw,avx512vl,avx2")))
+void floyd_tile_avx512(E* d, size_t* p, size_t n, size_t i0, size_t i1, size_t j0, size_t j1, size_t k0, size_t k1) {
+	floyd_tile<Parents>(d, p, n, i0, i1, j0, j1, k0, k1);
+}
+#endif
+
+// best tile kernel the cpu supports, checked once
+template <bool Parents, typename E>
+auto floyd_dispatch() {
+	using Fn = void (*)(E*, size_t*, size_t, size_t, size_t, size_t, size_t, size_t, size_t);
+#ifdef SAL_GEMM_DISPATCH
+	if constexpr (std::is_arithmetic<E>::value) {
+		static const Fn fn {
+			(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))? 
+				&floyd_tile_avx512<Parents, E> :
+			__builtin_cpu_supports("avx2")? &floyd_tile_avx2<Parents, E> : &floyd_tile_generic<Parents, E>};
+		return fn;
+	}
+	else return Fn{&floyd_tile_generic<Parents, E>};
+#else
+	return Fn{&floyd_tile_generic<Parents, E>};
+#endif
+}
+
+// closure of an n x n row major distance matrix, pool is null to stay on the calling thread
+template <bool Parents, typename E>
+void floyd_blocked(E* d, size_t* p, size_t n, Thread_pool* pool) {
+	auto tile = floyd_dispatch<Parents, E>();
+	size_t blocks {(n + floyd_block - 1) / floyd_block};
+	auto lo = [](size_t b) {return b * floyd_block;};
+	auto hi = [n](size_t b) {return std::min(n, (b + 1) * floyd_block);};
+	auto each = [&](size_t count, auto&& f) {
+		if (pool && count > 1) parallel_for(0, count, 1, [&](size_t l, size_t h) {for (size_t t = l; t < h; ++t) f(t);}, *pool);
+		else for (size_t t = 0; t < count; ++t) f(t);
+	};
+	for (size_t kb = 0; kb < blocks; ++kb) {
+		size_t k0 {lo(kb)}, k1 {hi(kb)};
+		tile(d, p, n, k0, k1, k0, k1, k0, k1);
+		// row of tiles first then the column, each through the diagonal tile
+		each(2 * blocks, [&](size_t t) {
+			size_t b {t % blocks};
+			if (b == kb) return;
+			if (t < blocks) tile(d, p, n, k0, k1, lo(b), hi(b), k0, k1);
+			else tile(d, p, n, lo(b), hi(b), k0, k1, k0, k1);
+		});
+		each(blocks * blocks, [&](size_t t) {
+			size_t ib {t / blocks}, jb {t % blocks};
+			if (ib == kb || jb == kb) return;
+			tile(d, p, n, lo(ib), hi(ib), lo(jb), hi(jb), k0, k1);
+		});
+	}
+}
+
+// in place on a weight matrix (POS_INF where there's no edge), false if a negative cycle exists
+// parent, if given, is sized and filled as in All_pairs
+template <typename E>
+bool floyd_warshall(Matrix<E>& dist, Matrix<size_t>* parent, Thread_pool* pool) {
+	if (dist.row() != dist.col()) throw runtime_error("Floyd warshall needs a square weight matrix");
+	size_t n {dist.row()};
+	// a path from a vertex to itself costs nothing unless it's a negative loop
+	for (size_t v = 0; v < n; ++v) if (E{} < dist.get(v, v)) dist.get(v, v) = E{};
+	if (parent) {
+		*parent = Matrix<size_t>{n, n};
+		for (size_t u = 0; u < n; ++u)
+			for (size_t v = 0; v < n; ++v) parent->get(u, v) = (u != v && dist.get(u, v) != POS_INF(E))? u : v;
+		floyd_blocked<true>(dist.data(), parent->data(), n, pool);
+	}
+	else floyd_blocked<false>(dist.data(), static_cast<size_t*>(nullptr), n, pool);
+	for (size_t v = 0; v < n; ++v) if (dist.get(v, v) < E{}) return false;
+	return true;
+}
+template <typename E>
+bool floyd_warshall(Matrix<E>& dist, Matrix<size_t>* parent = nullptr) {return floyd_warshall(dist, parent, nullptr);}
+template <typename E>
+bool floyd_warshall(Matrix<E>& dist, Matrix<size_t>* parent, Parallel_policy, Thread_pool& pool = Thread_pool::global()) {
+	return floyd_warshall(dist, parent, &pool);
+}
+
+template <typename E>
+All_pairs<E> floyd_warshall(const Adjacency_matrix<size_t,E>& g, bool parents, Thread_pool* pool) {
+	All_pairs<E> res {g.matrix(), {}};
+	if (!floyd_warshall(res.distance, parents? &res.parent : nullptr, pool)) return {};
+	return res;
+}
+template <typename E>
+All_pairs<E> floyd_warshall(const Adjacency_matrix<size_t,E>& g, bool parents = false) {return floyd_warshall(g, parents, nullptr);}
+template <typename E>
+All_pairs<E> floyd_warshall(const Adjacency_matrix<size_t,E>& g, bool parents, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	return floyd_warshall(g, parents, &pool);
+}
+
+// johnson for sparse graphs, O(VE lgV) against floyd warshall's O(V^3)
+// a virtual source n with 0 weight edges to every vertex gives potentials h (bellman ford from it,
+// only run with negative edges) so w(u,v) + h(u) - h(v) >= 0, then one dijkstra per source on the reweighted graph
+// the dijkstras are independent and share the source rows of the result between tasks
+template <typename Graph>
+All_pairs<typename Graph::edge_type> johnson(const Graph& g, bool parents, Thread_pool* pool) {
+	using E = typename Graph::edge_type;
+	static_assert(Is_index_vertex<typename Graph::vertex_type>::value, "all pairs results need vertices 0 .. n-1");
+	size_t n {g.num_vertex()};
+	std::vector<WEdge<size_t,E>> edges;
+	edges.reserve(n + g.num_edge());
+	bool negative {false};
+	for (auto u = g.begin(); u != g.end(); ++u)
+		for (auto v = u.begin(); v != u.end(); ++v) {
+			edges.emplace_back(*u, *v, v.weight());
+			if (v.weight() < 0) negative = true;
+		}
+	// the virtual source stays in the reweighted graph so it has exactly n + 1 vertices, no edges enter it
+	for (size_t v = 0; v < n; ++v) edges.emplace_back(n, v, E{});
+	Csr_graph_directed<size_t,E> augmented {edges.begin(), edges.end()};
+
+	std::vector<E> h(n + 1, E{});
+	if (negative) {
+		auto potential = pool? bellman_ford<Dense_property>(augmented, n, par, *pool) : bellman_ford<Dense_property>(augmented, n);
+		if (potential.empty()) return {};	// -infinity cycle exists
+		for (size_t v = 0; v < n; ++v) h[v] = potential[v].distance;
+		for (auto& edge : edges) edge.weight += h[edge.source] - h[edge.dest];
+		augmented = Csr_graph_directed<size_t,E>{edges.begin(), edges.end()};
+	}
+
+	All_pairs<E> res {Matrix<E>{n, n, POS_INF(E)}, {}};
+	if (parents) res.parent = Matrix<size_t>{n, n};
+	auto from = [&](size_t s) {
+		auto property = dijkstra<Dense_property>(augmented, s);
+		for (size_t v = 0; v < n; ++v) {
+			if (property[v].distance != POS_INF(E)) res.distance.get(s, v) = property[v].distance - h[s] + h[v];
+			if (parents) res.parent.get(s, v) = property[v].parent;
+		}
+	};
+	if (pool) parallel_for(0, n, 1, [&](size_t lo, size_t hi) {for (size_t s = lo; s < hi; ++s) from(s);}, *pool);
+	else for (size_t s = 0; s < n; ++s) from(s);
+	return res;
+}
+template <typename Graph>
+All_pairs<typename Graph::edge_type> johnson(const Graph& g, bool parents = false) {return johnson(g, parents, nullptr);}
+template <typename Graph>
+All_pairs<typename Graph::edge_type> johnson(const Graph& g, bool parents, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	return johnson(g, parents, &pool);
+}
+
+// k hop queries -------------
+// powers of the weight matrix over a semiring, each squaring one blocked matrix product, O(V^3 lg hops)
+// reachability within k hops is reachable_within on a Bit_adjacency_matrix
+
+// weights with 0 on the diagonal (unless a negative self loop is shorter), so walks may stay put
+template <typename E>
+Matrix<E> hop_weights(const Adjacency_matrix<size_t,E>& g) {
+	Matrix<E> w {g.matrix()};
+	for (size_t v = 0; v < w.row(); ++v) w.get(v, v) = std::min(w.get(v, v), E{});
+	return w;
+}
+// distance(u,v) over paths of at most hops edges, POS_INF where there are none, as min plus powers of hop_weights
+// without negative cycles hops >= V - 1 gives the all pairs shortest distances
+template <typename E>
+Matrix<E> hop_distances(const Adjacency_matrix<size_t,E>& g, size_t hops) {
+	return pow<Min_plus<E>>(hop_weights(g), hops);
+}
+template <typename E>
+Matrix<E> hop_distances(const Adjacency_matrix<size_t,E>& g, size_t hops, Parallel_policy) {
+	return pow<Min_plus<E>>(hop_weights(g), hops, par);
+}
+
+// 1 for every edge and 0 elsewhere
+template <typename T = size_t, typename E>
+Matrix<T> edge_indicator(const Adjacency_matrix<size_t,E>& g) {
+	size_t n {g.num_vertex()};
+	Matrix<T> a {n, n};
+	for (size_t u = 0; u < n; ++u)
+		for (size_t v = 0; v < n; ++v) a.get(u, v) = g.is_edge(u, v);
+	return a;
+}
+// number of walks u -> v of exactly length edges, T has to be wide enough for them
+template <typename T = size_t, typename E>
+Matrix<T> count_walks(const Adjacency_matrix<size_t,E>& g, size_t length) {
+	return pow<Plus_times<T>>(edge_indicator<T>(g), length);
+}
+template <typename T = size_t, typename E>
+Matrix<T> count_walks(const Adjacency_matrix<size_t,E>& g, size_t length, Parallel_policy) {
+	return pow(edge_indicator<T>(g), length, par);
 }
 
-}	// end namespace sal
\ No newline at end of file
+}	// end namespace sal
@@ -1,12 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <unordered_set>
 #include <vector>
 #include "search.h"		// dfs used in many algorithms, single source initialization
+#include "../parallel.h"	// thread pool for the parallel sort and components
 #include "../heap.h"	// used for piority queue
+#include "../stats.h"	// visitor counters
 #include "../../algo/macros.h"	// POS_INF
 
 namespace sal {
@@ -15,7 +20,7 @@ namespace sal {
 // if vertices are events, then sorting gives one possible sequence of events
 // O(V + E) algorithm (as are most algorithms using DFS)
 template <typename Output_iter>
-struct Topological_visitor : public DFS_visitor {
+struct Topological_visitor : public DFS_visitor<> {
 	Output_iter out;
 	Topological_visitor(Output_iter o) : out{o} {}
 
@@ -30,9 +35,74 @@ void topological_sort(const Graph& g, Output_iter res) {
 	dfs(g, Topological_visitor<Output_iter>{res});
 }
 
+// chunks of a level handed to each task
+constexpr size_t topological_grain = 1024;
+
+// kahn's algorithm a level at a time on ids 0 .. n-1 with out edges dests[offsets[u] .. offsets[u+1])
+// level 0 has no in edges and level k+1 the vertices whose last in edge came from level k,
+// so vertices within a level are independent and each level is split across the pool,
+// counting in degrees down atomically; vertices on or behind a cycle are left out of every level
+inline std::vector<std::vector<size_t>> topological_levels(size_t n, const size_t* offsets, const size_t* dests,
+	Thread_pool& pool = Thread_pool::global()) {
+	std::unique_ptr<std::atomic<size_t>[]> in {new std::atomic<size_t>[n]};
+	for (size_t v = 0; v < n; ++v) in[v].store(0, std::memory_order_relaxed);
+	parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+		for (size_t u = lo; u < hi; ++u)
+			for (size_t e = offsets[u]; e != offsets[u+1]; ++e) in[dests[e]].fetch_add(1, std::memory_order_relaxed);
+	}, pool);
+
+	std::vector<std::vector<size_t>> levels;
+	std::vector<size_t> level;
+	for (size_t v = 0; v < n; ++v) if (in[v].load(std::memory_order_relaxed) == 0) level.push_back(v);
+	while (!level.empty()) {
+		size_t grain {std::max(topological_grain, level.size() / (4 * pool.size()) + 1)};
+		std::vector<std::vector<size_t>> found((level.size() + grain - 1) / grain);
+		parallel_for(0, level.size(), grain, [&](size_t lo, size_t hi) {
+			std::vector<size_t>& out = found[lo / grain];
+			for (size_t i = lo; i < hi; ++i) {
+				size_t u {level[i]};
+				// the edge that brings a vertex to 0 is its last, whichever thread has it
+				for (size_t e = offsets[u]; e != offsets[u+1]; ++e)
+					if (in[dests[e]].fetch_sub(1, std::memory_order_relaxed) == 1) out.push_back(dests[e]);
+			}
+		}, pool);
+		levels.push_back(std::move(level));
+		level.clear();
+		for (const auto& out : found) level.insert(level.end(), out.begin(), out.end());
+	}
+	return levels;
+}
+
+// for graphs with vertices 0 .. n-1, fewer than num_vertex vertices in total means g has a cycle
+template <typename Graph>
+std::vector<std::vector<typename Graph::vertex_type>> topological_levels(const Graph& g, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	using V = typename Graph::vertex_type;
+	static_assert(Is_index_vertex<V>::value, "parallel topological sort needs vertices 0 .. n-1");
+	Bfs_adjacency adj;
+	out_adjacency(adj, g);
+	std::vector<std::vector<V>> levels;
+	for (const auto& ids : topological_levels(adj.n, adj.out_offsets, adj.out_dests, pool)) {
+		levels.emplace_back();
+		levels.back().reserve(ids.size());
+		for (size_t v : ids) levels.back().push_back(static_cast<V>(v));
+	}
+	return levels;
+}
+// the levels one after another, returns whether every vertex was ordered (false with a cycle)
+template <typename Graph, typename Output_iter>
+bool topological_sort(const Graph& g, Output_iter res, Parallel_policy, Thread_pool& pool = Thread_pool::global()) {
+	size_t ordered {0};
+	for (const auto& level : topological_levels(g, par, pool)) {
+		ordered += level.size();
+		res = std::copy(level.begin(), level.end(), res);
+	}
+	return ordered == g.num_vertex();
+}
+
 
 
-struct Cycle_visitor : public DFS_visitor {
+struct Cycle_visitor : public DFS_visitor<> {
 	bool has_backedge {false};
 	template <typename Graph>
 	void back_edge(typename Graph::vertex_type, const Graph&) {has_backedge = true;}	
@@ -63,7 +133,7 @@ Graph transpose(const Graph& g) {
 // then traversing full cycle to get entire component
 // no easy way to get sink vertex, so use source vertices of the transpose
 template <typename Output_iter>
-struct Inorder_finish_visitor : public DFS_visitor {
+struct Inorder_finish_visitor : public DFS_visitor<> {
 	Output_iter out;
 	Inorder_finish_visitor(Output_iter o) : out{o} {}
 
@@ -76,7 +146,7 @@ template <typename Graph>
 using Connected_set =  std::vector<std::unordered_set<typename Graph::vertex_type>>;
 
 template <typename Graph>
-struct Connected_visitor : public DFS_visitor {
+struct Connected_visitor : public DFS_visitor<> {
 	using V = typename Graph::vertex_type;
 	Connected_set<Graph> component_set;
 	std::vector<V> finish_order;
@@ -85,6 +155,7 @@ struct Connected_visitor : public DFS_visitor {
 	// visit in order of descending finish time 
 	template <typename Property_map>
 	std::vector<V> initialize_vertex(Property_map& property, const Graph& g) {
+		property.reserve(g.num_vertex());
 		for (auto v : finish_order) 
 			property[v] = {v};
 
@@ -117,6 +188,94 @@ Connected_set<Graph> strongly_connected(const Graph& g) {
 	return std::move(visitor.component_set);
 }
 
+// a first few neighbours of every vertex are linked before the largest component is guessed
+// from this many vertices spread over the graph
+constexpr size_t afforest_rounds = 2;
+constexpr size_t afforest_samples = 1024;
+
+// connected components of an undirected graph (every edge seen from both ends) with vertices 0 .. n-1,
+// labels[v] is the smallest vertex in v's component
+// lock free union find: roots are only linked from the larger to the smaller by compare and swap,
+// so parents only decrease and the root of a tree is its smallest vertex; finds halve their path
+// afforest: linking the first afforest_rounds neighbours of every vertex joins most of a giant component,
+// whose vertices then skip the rest of their edges since the other ends of those edges link to them
+template <typename Graph>
+std::vector<typename Graph::vertex_type> connected_components(const Graph& g, Parallel_policy, 
+	Thread_pool& pool = Thread_pool::global()) {
+	using V = typename Graph::vertex_type;
+	static_assert(Is_index_vertex<V>::value, "parallel connected components needs vertices 0 .. n-1");
+	Bfs_adjacency adj;
+	out_adjacency(adj, g);
+	size_t n {adj.n};
+	const size_t* offsets {adj.out_offsets};
+	const size_t* dests {adj.out_dests};
+
+	std::unique_ptr<std::atomic<size_t>[]> parent {new std::atomic<size_t>[n]};
+	auto find = [&](size_t x) {
+		while (true) {
+			size_t p {parent[x].load(std::memory_order_relaxed)};
+			if (p == x) return x;
+			size_t grand {parent[p].load(std::memory_order_relaxed)};
+			// any ancestor is a valid parent, so losing this race loses nothing
+			if (p != grand) parent[x].compare_exchange_weak(p, grand, std::memory_order_relaxed);
+			x = grand;
+		}
+	};
+	auto link = [&](size_t u, size_t v) {
+		while (true) {
+			u = find(u);
+			v = find(v);
+			if (u == v) return;
+			if (u < v) std::swap(u, v);
+			// u may have been linked since it was found, then try again from its new root
+			size_t root {u};
+			if (parent[u].compare_exchange_strong(root, v, std::memory_order_relaxed)) return;
+		}
+	};
+	auto compress = [&] {
+		parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+			for (size_t v = lo; v < hi; ++v) parent[v].store(find(v), std::memory_order_relaxed);
+		}, pool);
+	};
+
+	parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+		for (size_t v = lo; v < hi; ++v) parent[v].store(v, std::memory_order_relaxed);
+	}, pool);
+	for (size_t round = 0; round < afforest_rounds; ++round) {
+		parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+			for (size_t u = lo; u < hi; ++u)
+				if (offsets[u] + round < offsets[u+1]) link(u, dests[offsets[u] + round]);
+		}, pool);
+		compress();
+	}
+
+	// most frequent root among the samples
+	size_t largest {n};
+	if (n) {
+		std::vector<size_t> sampled;
+		size_t samples {std::min(n, afforest_samples)};
+		for (size_t i = 0; i < samples; ++i) sampled.push_back(find(i * n / samples));
+		std::sort(sampled.begin(), sampled.end());
+		size_t best {0};
+		for (size_t i = 0, j = 0; i < samples; i = j) {
+			while (j < samples && sampled[j] == sampled[i]) ++j;
+			if (j - i > best) {best = j - i; largest = sampled[i];}
+		}
+	}
+	parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+		for (size_t u = lo; u < hi; ++u) {
+			if (find(u) == largest) continue;
+			for (size_t e = std::min(offsets[u] + afforest_rounds, offsets[u+1]); e != offsets[u+1]; ++e) link(u, dests[e]);
+		}
+	}, pool);
+
+	std::vector<V> labels(n);
+	parallel_for(0, n, topological_grain, [&](size_t lo, size_t hi) {
+		for (size_t v = lo; v < hi; ++v) labels[v] = static_cast<V>(find(v));
+	}, pool);
+	return labels;
+}
+
 
 // start of shortest path algorithms ------------- (their utilities)
 
@@ -142,16 +301,24 @@ struct Shortest_cmp {
 	Shortest_cmp(const Property_map& p) : property(p) {}
 
 	bool operator()(const V& u, const V& v) const {
-		return (property.find(u)->second.distance) < (property.find(v)->second.distance); 
+		return property.at(u).distance < property.at(v).distance; 
 	}
 };
+// Stats counts relaxations (see stats.h), readable from the visitor after the algorithm
+template <typename Stats = No_stats>
 struct Shortest_visitor {
+	Stats stats;
 	// returns whether relaxed or not
 	template <typename Property_map>
 	bool relax(Property_map& property,
 		const Edge<typename Property_map::key_type, 
 				   typename Property_map::mapped_type::edge_type>& edge) {
+		using E = typename Property_map::mapped_type::edge_type;
+		stats.count(Stat::relax);
+		// unreached source has no path to extend (and infinity + weight would overflow)
+		if (property[edge.source()].distance == POS_INF(E)) return false;
 		if (property[edge.dest()].distance > property[edge.source()].distance + edge.weight()) {
+			stats.count(Stat::improve);
 			property[edge.dest()].distance = property[edge.source()].distance + edge.weight();
 			property[edge.dest()].parent = edge.source();
 			return true;
@@ -160,61 +327,167 @@ struct Shortest_visitor {
 	}
 };
 
-template <typename V, typename E>
-using Shortest_property_map = std::unordered_map<V, Shortest_vertex<V,E>>;
+template <typename V, typename E, typename Policy = Hashed_property>
+using Shortest_property_map = typename Policy::template map<V, Shortest_vertex<V,E>>;
+template <typename Graph, typename Policy = Hashed_property>
+using SPM = Shortest_property_map<typename Graph::vertex_type, typename Graph::edge_type, Policy>;
+
+
+// priority queues of dijkstra and min_span_tree -----------
+// Indexed_queue is the 4-ary indexed heap with decrease key, for any weights
+// Radix_queue (monotone keys, so dijkstra only) and Dial_queue (buckets up to the largest weight) need
+// integer weights; they compare plain integer keys instead of distances looked up through Shortest_cmp,
+// and reinsert vertices whose distance decreased, skipping the stale entries when extracted
+// Auto_queue is radix for dijkstra and Dial for prim with integer weights, the indexed heap otherwise
+struct Auto_queue {};
+struct Indexed_queue {};
+struct Radix_queue {};
+struct Dial_queue {};
+
+// auto only picks Dial's queue for prim up to this many buckets
+constexpr size_t dial_width_limit = size_t{1} << 16;
+
+template <typename E>
+using Is_integer_weight = std::integral_constant<bool, std::is_integral<E>::value && !std::is_same<E, bool>::value>;
+
+// smallest and largest edge weight, 0 for both without edges
 template <typename Graph>
-using SPM = Shortest_property_map<typename Graph::vertex_type, typename Graph::edge_type>;
+std::pair<typename Graph::edge_type, typename Graph::edge_type> weight_range(const Graph& g) {
+	using E = typename Graph::edge_type;
+	E low {}, high {};
+	bool first {true};
+	for (auto u = g.begin(); u != g.end(); ++u)
+		for (auto v = u.begin(); v != u.end(); ++v) {
+			E w {v.weight()};
+			if (first || w < low) low = w;
+			if (first || w > high) high = w;
+			first = false;
+		}
+	return {low, high};
+}
+
+// an integer queue used like Indexed_heap by the visitors: key() never finds a vertex, so every
+// decrease inserts it again, and entries whose key is no longer the vertex's distance are dropped
+// (a vertex's key only decreases until it is extracted, so only its latest entry matches)
+template <typename Property_map, typename Queue>
+class Lazy_frontier {
+	using V = typename Property_map::key_type;
+	using E = typename Property_map::mapped_type::edge_type;
+	using K = typename Queue::key_type;
+	const Property_map& property;
+	Queue queue;
+	E offset;	// smallest possible key, subtracted to make keys unsigned
+
+	K key_of(const V& v) const {return static_cast<K>(property.at(v).distance - offset);}
+	void drop_stale() {while (!queue.empty() && queue.top_key() != key_of(queue.top())) queue.pop();}
+public:
+	Lazy_frontier(const Property_map& p, Queue&& q, E low = E{}) : property(p), queue{std::move(q)}, offset{low} {}
+
+	size_t key(const V&) const {return 0;}
+	void decrease_key(size_t) {}
+	void insert(const V& v) {queue.push(key_of(v), v);}
+	bool empty() {drop_stale(); return queue.empty();}
+	V extract_top() {
+		drop_stale();
+		V v {queue.top()};
+		queue.pop();
+		return v;
+	}
+};
+
+// search(exploring) with the queue the policy picks, monotone for dijkstra's distances,
+// not for prim's edge weights (which may also be negative)
+template <typename Queue, bool monotone, typename Policy, typename Graph, typename Property_map, typename Stats, typename Search>
+void with_frontier(const Graph& g, const Property_map& property, Stats& stats, Search&& search) {
+	using V = typename Graph::vertex_type;
+	using E = typename Graph::edge_type;
+	constexpr bool integer {Is_integer_weight<E>::value};
+	constexpr bool is_auto {std::is_same<Queue, Auto_queue>::value};
+	static_assert(is_auto || std::is_same<Queue, Indexed_queue>::value || std::is_same<Queue, Radix_queue>::value ||
+		std::is_same<Queue, Dial_queue>::value, "unknown queue policy");
+	auto indexed = [&] {
+		using Cmp = Shortest_cmp<Property_map>;
+		using Shared = Shared_stats<Stats>;
+		Indexed_heap<V, Cmp, typename Policy::template index<V>, 4, Shared> exploring {Cmp{property}, Shared{stats}};
+		exploring.reserve(g.num_vertex());
+		search(exploring);
+	};
+	if constexpr (std::is_same<Queue, Indexed_queue>::value || (is_auto && !integer)) indexed();
+	else {
+		static_assert(integer, "radix and bucket queues need integer weights");
+		using K = std::make_unsigned_t<E>;
+		if constexpr (std::is_same<Queue, Radix_queue>::value || (is_auto && monotone)) {
+			static_assert(monotone, "radix heaps need monotone keys, prim's are not");
+			Lazy_frontier<Property_map, Radix_heap<K,V>> exploring {property, Radix_heap<K,V>{}};
+			search(exploring);
+		}
+		else {
+			auto range = weight_range(g);
+			E low {monotone? E{} : std::min(range.first, E{})};
+			size_t width {static_cast<size_t>(static_cast<K>(std::max(range.second, E{}) - low)) + 1};
+			if (is_auto && width > dial_width_limit) {indexed(); return;}
+			Lazy_frontier<Property_map, Bucket_queue<K,V>> exploring {property, Bucket_queue<K,V>{width}, low};
+			search(exploring);
+		}
+	}
+}
 
 
 // Prim's algorithm for minimum spanning tree
 // connected undirected graph, assuming positive weight
+template <typename Stats = No_stats>
 struct MST_visitor {
+	Stats stats;
 	// relaxes an edge if it meets certain requirements
-	template <typename Property_map, typename Queue>
+	template <typename Property_map, typename Explored, typename Queue>
 	void relax(Property_map& property, 
-		const std::unordered_set<typename Property_map::key_type>& explored,
+		const Explored& explored,
 		Queue& exploring, 
 		const Edge<typename Property_map::key_type, 
 				   typename Property_map::mapped_type::edge_type>& edge) {
 
 		// d_i == 0 means not in exploring
 		// distance for MST means minimum edge weight connecting to it
-		if (explored.find(edge.dest()) == explored.end() && edge.weight() < property[edge.dest()].distance) {
+		stats.count(Stat::relax);
+		if (!explored.count(edge.dest()) && edge.weight() < property[edge.dest()].distance) {
+			stats.count(Stat::improve);
 			property[edge.dest()].distance = edge.weight();
 			property[edge.dest()].parent = edge.source();
-			// fix heap property
-			exploring.sift_up(exploring.key(edge.dest()), edge.dest());
+			// fix heap property, first discovery enters the heap
+			size_t handle {exploring.key(edge.dest())};
+			if (handle) exploring.decrease_key(handle);
+			else exploring.insert(edge.dest());
 		}		
 	}
 };
 
-// can be made faster to O(E) time if edge weights are integers using an array as the exploring
-// with each slot holding doubly linked list of vertices with that distance
-template <typename Graph>
-SPM<Graph> min_span_tree(const Graph& g, MST_visitor&& visitor = {}) {
+// integer weights get Dial's bucket queue, O(E + V W) for weights spanning W instead of O(E lg V)
+// the visitor's stats also count the indexed heap's sifts and time settled vertices
+template <typename Policy = Hashed_property, typename Queue = Auto_queue, typename Graph, typename Visitor = MST_visitor<>>
+SPM<Graph, Policy> min_span_tree(const Graph& g, Visitor&& visitor = Visitor{}) {
 	using V = typename Graph::vertex_type;
-	using Cmp = Shortest_cmp<SPM<Graph>>;
 	// property map of each vertex to their distance
-	SPM<Graph> property;
-	// comparator querying on distance
+	SPM<Graph, Policy> property;
 	initialize_single_source(property, g, *g.begin());
 
-	std::unordered_set<V> explored;
-	Heap<V, Cmp> exploring {Cmp{property}};
-	exploring.insert(g.begin(), g.end());
-
-	// batch insert is O(n) rather than O(nlgn) of inserting each sequentially
-
-	while (!exploring.empty()) {
-		V u {exploring.extract_top()};
-		explored.insert(u);
-		// for each adjacent vertex
-		auto edges = g.adjacent(u);
-		for (auto v = edges.first; v != edges.second; ++v) {
-			// relaxation
-			visitor.relax(property, explored, exploring, {u, v});
+	Explored_set<SPM<Graph, Policy>> explored {property};
+	auto& stats = visitor_stats(visitor);
+	with_frontier<Queue, false, Policy>(g, property, stats, [&](auto& exploring) {
+		// vertices are inserted when first reached
+		exploring.insert(*g.begin());
+		while (!exploring.empty()) {
+			auto timing = stats.time(Stat::settle);
+			stats.count(Stat::settle);
+			V u {exploring.extract_top()};
+			explored.insert(u);
+			// for each adjacent vertex
+			auto edges = g.adjacent(u);
+			for (auto v = edges.first; v != edges.second; ++v) {
+				// relaxation
+				visitor.relax(property, explored, exploring, {u, v});
+			}
 		}
-	}
+	});
 	return property;
 }
 
@@ -243,6 +516,7 @@ bool is_shortest(Property_map& property,
 	// for every edge, triangle inequality has to be satisfied
 	// d(v) <= d(u) + w(u,v)
 	Property_map test;
+	test.reserve(g.num_vertex());
 	for (const V& u : g) 
 		if (property[u].parent == u) test[u].distance = POS_INF(E);
 		// distance of parent + weight of edge getting from parent to child
@@ -251,7 +525,7 @@ bool is_shortest(Property_map& property,
 
 	for (auto u = g.begin(); u != g.end(); ++u) 
 		for (auto v = u.begin(); v != u.end(); ++v) 
-			if (test[*u].distance + v.weight() < test[*v].distance) return false;
+			if (test[*u].distance != POS_INF(E) && test[*u].distance + v.weight() < test[*v].distance) return false;
 		
 	return true;
 }
@@ -1,8 +1,12 @@
 #pragma once
 #include <algorithm>
+#include <array>
 #include <initializer_list>
+#include <type_traits>
+#include <utility>
 #include <unordered_map>
 #include <vector>
+#include "stats.h"		// sift counts
 #include "../algo/macros.h"	// SENTINEL
 
 namespace sal {
@@ -10,12 +14,14 @@ namespace sal {
 // simple, plain old data implementation can work with copies of it
 // swapping should be cheap and there shouldn't be ownership issues
 // by default maxheap where parent greater than children
-template <typename T, typename Cmp = std::greater<T>>
+// Stats counts the levels sifted (see stats.h)
+template <typename T, typename Cmp = std::greater<T>, typename Stats = No_stats>
 class Heap {	
 	// default representation is as a vector, index at 1 so need 1 extra element
 	std::vector<T> elems;
 	// comparator for sorting in a maxheap cmp(a, b) being true means a is an ancestor of b
 	Cmp cmp;
+	Stats counters;
 
 	// semantically clear helpers for getting relative position
 	size_t parent(size_t i) const {return i >> 1;}
@@ -29,6 +35,7 @@ public:
 	// float value up for directly changed value
 	void sift_up(size_t hole, T&& item) {
 		while (hole > 1 && cmp(item, elems[parent(hole)])) {
+			counters.count(Stat::sift_up);
 			elems[hole] = elems[parent(hole)];
 			hole = parent(hole);
 		}		
@@ -48,6 +55,7 @@ public:
 			if (child+1 < elems.size() && cmp(elems[child + 1], elems[child]))
 				++child;
 			if (cmp(elems[child], item)) {
+				counters.count(Stat::sift_down);
 				elems[hole] = std::move(elems[child]);
 				hole = child;
 				child = left(child);
@@ -114,6 +122,8 @@ public:
 	// query ---------------
 	bool empty() const 	{return elems.size() <= 1;}
 	size_t size() const {return elems.size() - 1;}
+	Stats& stats() 				{return counters;}
+	const Stats& stats() const 	{return counters;}
 
 	T& top()			  		{return elems[1];}
 	const T& top() const 		{return elems[1];}
@@ -138,6 +148,7 @@ public:
 		while (child + 1 < elems.size()) {
 			if (cmp(elems[child + 1], elems[child])) 
 				++child;
+			counters.count(Stat::sift_down);
 			elems[hole] = elems[child];
 			hole = child;
 			child = left(child);
@@ -158,12 +169,13 @@ public:
 		while (child+1 < elems.size()) {
 			if (cmp(elems[child + 1], elems[child])) 
 				++child;
+			counters.count(Stat::sift_down);
 			elems[hole] = elems[child];
 			hole = child;
 			child = left(child);
 		}
 		// replace hole with new element
-		sift_up(hole, new_elem);
+		sift_up(hole, std::move(new_elem));
 		return top;
 	}
 
@@ -173,7 +185,7 @@ public:
 	// O(lgn)
 	void insert(T key) {
 		elems.emplace_back();
-		sift_up(elems.size()-1, key);
+		sift_up(elems.size()-1, std::move(key));
 	}
 	// O(n) like constructor for all elements
 	template <typename Iter>
@@ -184,7 +196,7 @@ public:
 
 	// only for direct changes; for indirect changes, have to know whether to sift up or down
 	void increase_key(size_t i, const T& changed) {
-		sift_up(i, changed);	// move closer to root
+		sift_up(i, T{changed});	// move closer to root
 	}
 	void decrease_key(size_t i, const T& changed) {
 		elems[i] = changed;
@@ -203,7 +215,237 @@ public:
 };
 
 
+// position index for heaps whose items are indices 0 .. n-1, grows to fit the largest item
+template <typename T>
+class Dense_index {
+	std::vector<size_t> pos;
+public:
+	void reserve(size_t n) {if (n > pos.size()) pos.resize(n, 0);}
+	size_t get(const T& item) const {
+		return static_cast<size_t>(item) < pos.size()? pos[static_cast<size_t>(item)] : 0;
+	}
+	size_t& operator[](const T& item) {
+		if (static_cast<size_t>(item) >= pos.size()) pos.resize(static_cast<size_t>(item) + 1, 0);
+		return pos[static_cast<size_t>(item)];
+	}
+};
+
+// stored handle of an item in the index, 0 if absent
+template <typename Index, typename T>
+size_t index_lookup(const Index& index, const T& item) {
+	auto pos = index.find(item);
+	return pos == index.end()? 0 : pos->second;
+}
+template <typename T>
+size_t index_lookup(const Dense_index<T>& index, const T& item) {
+	return index.get(item);
 }
 
+// heap that keeps the position of each item, making key(item) O(1) and decrease key O(log_D n)
+// items have to be unique (vertices, ids); D children per node, 4-ary by default since it is shallower and 
+// all children of a node are likely in the same cache line
+// handles from key() are 1-based like Heap's, with 0 meaning not in heap
+// Stats counts the levels floated, Stats_ref shares an algorithm's counters
+template <typename T, typename Cmp = std::greater<T>, typename Index = std::unordered_map<T,size_t>, size_t D = 4,
+	typename Stats = No_stats>
+class Indexed_heap {
+	static_assert(D >= 2, "heap needs at least 2 children per node");
+	// 0-based, index maps item to its position + 1
+	std::vector<T> elems;
+	Index index;
+	Cmp cmp;
+	Stats counters;
 
+	size_t parent(size_t i) const 		{return (i - 1) / D;}
+	size_t first_child(size_t i) const 	{return D*i + 1;}
 
+	// place item at position i and record it
+	void place(size_t i, T&& item) {
+		index[item] = i + 1;
+		elems[i] = std::move(item);
+	}
+	void float_up(size_t hole) {
+		T item {std::move(elems[hole])};
+		while (hole > 0 && cmp(item, elems[parent(hole)])) {
+			counters.count(Stat::sift_up);
+			place(hole, std::move(elems[parent(hole)]));
+			hole = parent(hole);
+		}
+		place(hole, std::move(item));
+	}
+	void float_down(size_t hole) {
+		T item {std::move(elems[hole])};
+		size_t child {first_child(hole)};
+		while (child < elems.size()) {
+			// best of up to D children
+			size_t best {child};
+			size_t last {std::min(child + D, elems.size())};
+			for (++child; child < last; ++child)
+				if (cmp(elems[child], elems[best])) best = child;
+			if (!cmp(elems[best], item)) break;
+			counters.count(Stat::sift_down);
+			place(hole, std::move(elems[best]));
+			hole = best;
+			child = first_child(hole);
+		}
+		place(hole, std::move(item));
+	}
+
+public:
+	using value_type = T;
+	using iterator = typename std::vector<T>::const_iterator;
+	using const_iterator = typename std::vector<T>::const_iterator;
+
+	explicit Indexed_heap(Cmp&& c = Cmp{}, Stats s = Stats{}) : cmp(std::move(c)), counters{s} {}
+
+	void reserve(size_t n) {elems.reserve(n); index.reserve(n);}
+
+	// query ---------------
+	bool empty() const 	{return elems.empty();}
+	size_t size() const {return elems.size();}
+	Stats& stats() 				{return counters;}
+	const Stats& stats() const 	{return counters;}
+	const T& top() const {return elems[0];}
+
+	// get handle to item in O(1), 0 if not in heap
+	size_t key(const T& item) const 		{return index_lookup(index, item);}
+	bool contains(const T& item) const 	{return key(item) != 0;}
+
+	// extraction ----------
+	T extract_top() {
+		if (empty()) return SENTINEL(T);
+		T top {std::move(elems[0])};
+		index[top] = 0;
+		if (elems.size() > 1) {
+			elems[0] = std::move(elems.back());
+			elems.pop_back();
+			float_down(0);
+		}
+		else elems.pop_back();
+		return top;
+	}
+
+	// modification ----------
+	// O(log_D n), item must not already be in the heap
+	void insert(T item) {
+		elems.push_back(std::move(item));
+		float_up(elems.size() - 1);
+	}
+
+	// fix position of item at handle after its value changed indirectly (through comparator)
+	// sift_up when it should move closer to the top (decreased distance for min comparators)
+	void sift_up(size_t handle) 	{float_up(handle - 1);}
+	void sift_down(size_t handle) 	{float_down(handle - 1);}
+	// O(log_D n), after the item at handle improved (moved towards the top under cmp), the same as sift_up
+	void decrease_key(size_t handle) 	{float_up(handle - 1);}
+
+	// iteration in element order (not sorted) -------------
+	const_iterator begin() const 	{return elems.cbegin();}
+	const_iterator end() const 	 	{return elems.cend();}
+
+	bool is_heap() const {
+		for (size_t i = 1; i < elems.size(); ++i)
+			if (cmp(elems[i], elems[parent(i)])) return false;
+		return true;
+	}
+};
+
+// integer keyed min queues for items popped in key order, like vertices by distance --------
+// neither supports decrease key, an item is pushed again with its smaller key instead
+
+// monotone radix heap: keys pushed are never below the last key popped
+// bucket i > 0 holds keys whose highest bit differing from the last popped key is bit i-1,
+// so when bucket 0 (keys equal to the last) runs out, the first nonempty bucket is split by the
+// new minimum into lower buckets only; each item moves O(bits) times, O(1) amortized per push
+template <typename K, typename T>
+class Radix_heap {
+	static_assert(std::is_unsigned<K>::value && sizeof(K) <= 8, "radix heap keys have to be unsigned and at most 64 bit");
+	static constexpr size_t bits = sizeof(K) * 8;
+	std::array<std::vector<std::pair<K,T>>, bits + 1> buckets;
+	K last {0};
+	size_t count {0};
+
+	static size_t bucket(K key, K last) {
+		return key == last? 0 : 64 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(key ^ last)));
+	}
+	// makes bucket 0 hold the minimum
+	void settle() {
+		if (!buckets[0].empty()) return;
+		size_t i {1};
+		while (buckets[i].empty()) ++i;
+		last = buckets[i][0].first;
+		for (const auto& entry : buckets[i]) last = std::min(last, entry.first);
+		for (auto& entry : buckets[i]) buckets[bucket(entry.first, last)].push_back(std::move(entry));
+		buckets[i].clear();
+	}
+public:
+	using key_type = K;
+	using value_type = T;
+
+	bool empty() const 	{return count == 0;}
+	size_t size() const {return count;}
+
+	// key must not be below the last popped key
+	void push(K key, T item) {
+		buckets[bucket(key, last)].emplace_back(key, std::move(item));
+		++count;
+	}
+	// queue must not be empty
+	K top_key() 	{settle(); return buckets[0].back().first;}
+	const T& top() 	{settle(); return buckets[0].back().second;}
+	void pop() {
+		settle();
+		buckets[0].pop_back();
+		--count;
+	}
+	void clear() {
+		for (auto& b : buckets) b.clear();
+		last = 0;
+		count = 0;
+	}
+};
+
+// Dial's bucket queue: keys present at any time span less than width (the largest edge weight + 1
+// for shortest paths and spanning trees), so key % width buckets never mix keys and a cursor at the
+// smallest key walks up to the next; O(1) push, O(width) worst pop, any order of keys within the span
+template <typename K, typename T>
+class Bucket_queue {
+	static_assert(std::is_unsigned<K>::value, "bucket queue keys have to be unsigned");
+	std::vector<std::vector<T>> buckets;
+	K low {0};	// no key below it is present
+	size_t count {0};
+
+	size_t slot(K key) const {return static_cast<size_t>(key % buckets.size());}
+	void advance() {while (buckets[slot(low)].empty()) ++low;}
+public:
+	using key_type = K;
+	using value_type = T;
+
+	explicit Bucket_queue(size_t width) : buckets(std::max<size_t>(width, 1)) {}
+
+	bool empty() const 	{return count == 0;}
+	size_t size() const {return count;}
+	size_t width() const {return buckets.size();}
+
+	// all present keys and key have to lie within width of each other
+	void push(K key, T item) {
+		if (count == 0 || key < low) low = key;
+		buckets[slot(key)].push_back(std::move(item));
+		++count;
+	}
+	// queue must not be empty
+	K top_key() 	{advance(); return low;}
+	const T& top() 	{advance(); return buckets[slot(low)].back();}
+	void pop() {
+		advance();
+		buckets[slot(low)].pop_back();
+		--count;
+	}
+	void clear() {
+		for (auto& b : buckets) b.clear();
+		low = 0;
+		count = 0;
+	}
+};
+
+}
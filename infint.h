@@ -35,6 +35,11 @@
  *   InfintException in case of error instead of writing error messages using
  *   std::cerr.
  *
+ *   You may define Infint_USE_BINARY_BASE to store numbers in base 2^64 limbs
+ *   instead of base 10^9 (needs unsigned __int128). Arithmetic gets cheaper carries
+ *   and full 64x64->128 bit products, decimal conversion (<<, >>, str, digit) costs
+ *   a divide and conquer base conversion instead.
+ *
  *   See ReadMe.txt for more info.
  *
  *
@@ -50,6 +55,8 @@
 #include <sstream>
 #include <iomanip>
 
+#include <algorithm>
+#include <memory>
 #include <limits.h>
 #include <stdlib.h>
 
@@ -57,6 +64,7 @@
 
 //#define Infint_USE_EXCEPTIONS
 //#define Infint_USE_SHORT_BASE
+//#define Infint_USE_BINARY_BASE
 
 #ifdef Infint_USE_EXCEPTIONS
 #include <exception>
@@ -71,13 +79,26 @@
 //    return n <= 0;
 //}
 
-#ifdef Infint_USE_SHORT_BASE // uses 10^4 (short) as the base
+#ifdef Infint_USE_BINARY_BASE // uses 2^64 (unsigned long long) as the base
+#ifndef __SIZEOF_INT128__
+#error "Infint_USE_BINARY_BASE needs unsigned __int128"
+#endif
+typedef long long ELEM_TYPE; // small factors
+typedef unsigned long long LIMB_TYPE;
+typedef unsigned __int128 PRODUCT_TYPE;
+/* decimal conversion goes through chunks of 10^19, the largest power of ten below 2^64 */
+static const LIMB_TYPE DECIMAL_CHUNK = 10000000000000000000ULL;
+static const int DECIMAL_CHUNK_DIGITS = 19;
+/* runs of up to 2^CONVERSION_LEVEL chunks are converted by repeated single limb steps */
+static const size_t CONVERSION_LEVEL = 4;
+#elif defined(Infint_USE_SHORT_BASE) // uses 10^4 (short) as the base
 typedef short ELEM_TYPE;
 typedef int PRODUCT_TYPE;
 static const ELEM_TYPE BASE = 10000;
 static const ELEM_TYPE UPPER_BOUND = 9999;
 static const ELEM_TYPE DIGIT_COUNT = 4;
 static const int powersOfTen[] = { 1, 10, 100, 1000};
+typedef ELEM_TYPE LIMB_TYPE;
 #else // uses 10^9 (int) as the base
 typedef int ELEM_TYPE;
 typedef long long PRODUCT_TYPE;
@@ -85,7 +106,21 @@ static const ELEM_TYPE BASE = 1000000000;
 static const ELEM_TYPE UPPER_BOUND = 999999999;
 static const ELEM_TYPE DIGIT_COUNT = 9;
 static const int powersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+typedef ELEM_TYPE LIMB_TYPE;
+#endif
+
+/* multiplication and division tiers, operand sizes in limbs */
+/* schoolbook below KARATSUBA_THRESHOLD, Karatsuba, then Toom-3, then NTT */
+static const size_t KARATSUBA_THRESHOLD = 48;
+static const size_t TOOM3_THRESHOLD = 300;
+#ifdef Infint_USE_BINARY_BASE
+/* binary limbs go through the transform as two digits, which only wins on far longer operands */
+static const size_t NTT_THRESHOLD = 50000;
+#else
+static const size_t NTT_THRESHOLD = 2500;
 #endif
+/* Newton reciprocal division once both divisor and quotient are this long */
+static const size_t NEWTON_THRESHOLD = 48;
 
 #ifdef Infint_USE_EXCEPTIONS
 class InfintException: public std::exception
@@ -113,11 +148,265 @@ const char* InfintException::what() const throw ()
 }
 #endif
 
+/* limbs of a number, the first INLINE_LIMBS live inside the object so small numbers never allocate */
+/* a vector subset of what Infint needs, LIMB_TYPE is a plain integer so contents are moved with memcpy */
+static const size_t INLINE_LIMBS = 32 / sizeof(LIMB_TYPE);
+
+class InfintLimbs
+{
+public:
+    InfintLimbs() : ptr(local), len(0), cap(INLINE_LIMBS)
+    {
+    }
+    InfintLimbs(size_t n, LIMB_TYPE v) : ptr(local), len(0), cap(INLINE_LIMBS)
+    {
+        assign(n, v);
+    }
+    InfintLimbs(const InfintLimbs& other) : ptr(local), len(0), cap(INLINE_LIMBS)
+    {
+        assign(other.begin(), other.end());
+    }
+    InfintLimbs(InfintLimbs&& other) noexcept : ptr(local), len(0), cap(INLINE_LIMBS)
+    {
+        steal(other);
+    }
+    ~InfintLimbs()
+    {
+        release();
+    }
+    InfintLimbs& operator=(const InfintLimbs& other)
+    {
+        if (this != &other)
+        {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    InfintLimbs& operator=(InfintLimbs&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    size_t size() const { return len; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return len == 0; }
+    LIMB_TYPE* data() { return ptr; }
+    const LIMB_TYPE* data() const { return ptr; }
+    LIMB_TYPE* begin() { return ptr; }
+    const LIMB_TYPE* begin() const { return ptr; }
+    LIMB_TYPE* end() { return ptr + len; }
+    const LIMB_TYPE* end() const { return ptr + len; }
+    LIMB_TYPE& operator[](size_t i) { return ptr[i]; }
+    const LIMB_TYPE& operator[](size_t i) const { return ptr[i]; }
+    LIMB_TYPE& back() { return ptr[len - 1]; }
+    const LIMB_TYPE& back() const { return ptr[len - 1]; }
+
+    void reserve(size_t n)
+    {
+        if (n <= cap)
+        {
+            return;
+        }
+        LIMB_TYPE* grown = new LIMB_TYPE[n];
+        std::copy(ptr, ptr + len, grown);
+        release();
+        ptr = grown;
+        cap = n;
+    }
+    void clear() { len = 0; }
+    void push_back(LIMB_TYPE v)
+    {
+        if (len == cap)
+        {
+            reserve(2 * cap);
+        }
+        ptr[len++] = v;
+    }
+    void pop_back() { --len; }
+    void resize(size_t n, LIMB_TYPE v = 0)
+    {
+        if (n > cap)
+        {
+            reserve(std::max(n, 2 * cap));
+        }
+        if (n > len)
+        {
+            std::fill(ptr + len, ptr + n, v);
+        }
+        len = n;
+    }
+    void assign(size_t n, LIMB_TYPE v)
+    {
+        len = 0;
+        resize(n, v);
+    }
+    // source must not be inside this
+    void assign(const LIMB_TYPE* first, const LIMB_TYPE* last)
+    {
+        len = 0;
+        reserve((size_t) (last - first));
+        std::copy(first, last, ptr);
+        len = (size_t) (last - first);
+    }
+    LIMB_TYPE* insert(LIMB_TYPE* pos, size_t k, LIMB_TYPE v)
+    {
+        size_t at = (size_t) (pos - ptr);
+        if (len + k > cap)
+        {
+            reserve(std::max(len + k, 2 * cap));
+        }
+        std::copy_backward(ptr + at, ptr + len, ptr + len + k);
+        std::fill(ptr + at, ptr + at + k, v);
+        len += k;
+        return ptr + at;
+    }
+    LIMB_TYPE* insert(LIMB_TYPE* pos, LIMB_TYPE v)
+    {
+        return insert(pos, 1, v);
+    }
+    LIMB_TYPE* erase(LIMB_TYPE* first, LIMB_TYPE* last)
+    {
+        std::copy(last, ptr + len, first);
+        len -= (size_t) (last - first);
+        return first;
+    }
+    LIMB_TYPE* erase(LIMB_TYPE* pos)
+    {
+        return erase(pos, pos + 1);
+    }
+    void swap(InfintLimbs& other)
+    {
+        InfintLimbs tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    void release()
+    {
+        if (ptr != local)
+        {
+            delete[] ptr;
+        }
+        ptr = local;
+        cap = INLINE_LIMBS;
+    }
+    // takes other's heap buffer or copies its inline limbs, this must hold none
+    void steal(InfintLimbs& other)
+    {
+        if (other.ptr == other.local)
+        {
+            std::copy(other.local, other.local + other.len, local);
+        }
+        else
+        {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.local;
+            other.cap = INLINE_LIMBS;
+        }
+        len = other.len;
+        other.len = 0;
+    }
+
+    LIMB_TYPE* ptr;
+    size_t len;
+    size_t cap;
+    LIMB_TYPE local[INLINE_LIMBS];
+};
+
+/* per thread bump allocator for the temporary limb buffers of multiplication and division */
+/* buffers are taken inside a Frame and all handed back when it goes out of scope, blocks are kept for reuse */
+class InfintScratch
+{
+public:
+    class Frame
+    {
+    public:
+        Frame() : scratch(InfintScratch::local()), block(scratch.block), used(scratch.used)
+        {
+        }
+        ~Frame()
+        {
+            scratch.block = block;
+            scratch.used = used;
+        }
+        // n uninitialized limbs
+        LIMB_TYPE* take(size_t n)
+        {
+            return scratch.take(n);
+        }
+        LIMB_TYPE* takeZeroed(size_t n)
+        {
+            LIMB_TYPE* p = scratch.take(n);
+            std::fill(p, p + n, (LIMB_TYPE) 0);
+            return p;
+        }
+    private:
+        Frame(const Frame&);
+        Frame& operator=(const Frame&);
+        InfintScratch& scratch;
+        size_t block;
+        size_t used;
+    };
+
+    static InfintScratch& local()
+    {
+        static thread_local InfintScratch scratch;
+        return scratch;
+    }
+
+private:
+    static const size_t FIRST_BLOCK = 4096;
+
+    InfintScratch() : block(0), used(0)
+    {
+    }
+    LIMB_TYPE* take(size_t n)
+    {
+        // skip to the first later block with room, allocating one if there is none
+        while (block < blocks.size() && used + n > sizes[block])
+        {
+            ++block;
+            used = 0;
+        }
+        if (block == blocks.size())
+        {
+            size_t size = std::max(n, sizes.empty() ? FIRST_BLOCK : 2 * sizes.back());
+            blocks.emplace_back(new LIMB_TYPE[size]);
+            sizes.push_back(size);
+            used = 0;
+        }
+        LIMB_TYPE* p = blocks[block].get() + used;
+        used += n;
+        return p;
+    }
+
+    std::vector<std::unique_ptr<LIMB_TYPE[]> > blocks;
+    std::vector<size_t> sizes;
+    size_t block; // block being handed out
+    size_t used; // limbs handed out from it
+};
+
 class Infint
 {
     friend std::ostream& operator<<(std::ostream &s, const Infint &n);
     friend std::istream& operator>>(std::istream &s, Infint &val);
 
+    /* rvalue operands lend their storage to the result */
+    friend Infint operator-(Infint&& n);
+    friend Infint operator+(Infint&& lhs, const Infint& rhs);
+    friend Infint operator+(const Infint& lhs, Infint&& rhs);
+    friend Infint operator+(Infint&& lhs, Infint&& rhs);
+    friend Infint operator-(Infint&& lhs, const Infint& rhs);
+    friend Infint operator-(const Infint& lhs, Infint&& rhs);
+    friend Infint operator-(Infint&& lhs, Infint&& rhs);
+
 public:
     /* some constants */
     static const Infint zero;
@@ -168,6 +457,13 @@ public:
     Infint operator%(const Infint& rhs) const; // throw
     Infint operator*(ELEM_TYPE rhs) const;
 
+    /* operations into an existing number, which reuses its storage; out may be a or b */
+    static void add(Infint& out, const Infint& a, const Infint& b);
+    static void subtract(Infint& out, const Infint& a, const Infint& b);
+    static void multiply(Infint& out, const Infint& a, const Infint& b);
+    static void multiply(Infint& out, const Infint& a, ELEM_TYPE b);
+    static void divide(Infint& quotient, Infint& remainder, const Infint& a, const Infint& b); // throw
+
     /* relational operations */
     bool operator==(const Infint& rhs) const;
     bool operator!=(const Infint& rhs) const;
@@ -198,17 +494,57 @@ public:
     unsigned long long toUnsignedLongLong() const; // throw
 
 private:
-    static ELEM_TYPE dInR(const Infint& R, const Infint& D);
-    static void multiplyByDigit(ELEM_TYPE factor, std::vector<ELEM_TYPE>& val);
+#ifdef Infint_USE_BINARY_BASE
+    /* sign and magnitude arithmetic on 2^64 limbs */
+    static int compareMagnitudes(const Infint& a, const Infint& b);
+    void addSigned(const Infint& rhs, bool rhsPos);
+    static void multiplyBySmall(LIMB_TYPE factor, LIMB_TYPE addend, InfintLimbs& val);
+    static LIMB_TYPE divideBySmall(LIMB_TYPE* val, size_t n, LIMB_TYPE d);
+    static void divideMagnitudes(const Infint& N, const Infint& D, Infint& Q, Infint& R);
+    static void divideKnuth(const Infint& N, const Infint& D, Infint& Q, Infint& R);
+
+    /* divide and conquer conversion between limbs and base 10^19 chunks */
+    static void decimalPowers(size_t levels, std::vector<Infint>& powers);
+    static Infint fromDecimalChunks(const LIMB_TYPE* chunks, size_t n, size_t level, const std::vector<Infint>& powers);
+    static void toDecimalChunks(const Infint& x, size_t level, const std::vector<Infint>& powers, const std::vector<Infint>& inverses, LIMB_TYPE* chunks);
+#else
+    static ELEM_TYPE dInR(const Infint& R, const Infint& D, Infint& prod);
+    static void multiplyByDigit(ELEM_TYPE factor, InfintLimbs& val);
+#endif
 
+    /* magnitude multiplication, out holds n + m zeroed limbs */
+    static void multiplyMagnitudes(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out);
+    static void multiplySchoolbook(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out);
+    static void multiplyKaratsuba(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out);
+    static void multiplyToom3(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out);
+#ifdef __SIZEOF_INT128__
+    static bool multiplyNTT(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out);
+    static void ntt(std::vector<unsigned>& a, bool invert, unsigned mod);
+    static unsigned powMod(unsigned long long b, unsigned long long e, unsigned mod);
+#endif
+    static void addLimbs(LIMB_TYPE* dst, size_t dstLen, const LIMB_TYPE* src, size_t srcLen);
+    static void subtractLimbs(LIMB_TYPE* dst, size_t dstLen, const LIMB_TYPE* src, size_t srcLen);
+    static Infint fromLimbs(const LIMB_TYPE* p, size_t n);
+    static void divideExact(Infint& x, ELEM_TYPE d);
+
+    /* Newton reciprocal division on magnitudes */
+    static bool useNewtonDivision(const Infint& N, const Infint& D);
+    static void newtonDivide(const Infint& N, const Infint& D, Infint& Q, Infint& R);
+    static Infint reciprocal(const Infint& D, size_t p);
+    static void shiftLimbsUp(Infint& x, size_t k);
+    static void shiftLimbsDown(Infint& x, size_t k);
+
+#ifndef Infint_USE_BINARY_BASE
     void correct(bool justCheckLeadingZeros = false, bool hasValidSign = false);
-    void from_str(const std::string& s);
-    void optimizeSqrtSearchBounds(Infint& lo, Infint& hi) const;
     void truncate();
     bool equalizeSigns();
+#endif
+    void from_str(const std::string& s);
+    void optimizeSqrtSearchBounds(Infint& lo, Infint& hi) const;
     void remove_lzeros();
+    unsigned long long lowMagnitude() const; // magnitude modulo 2^64
 
-    std::vector<ELEM_TYPE> val; // number with base FACTOR
+    InfintLimbs val; // number with base FACTOR
     bool pos; // true if number is positive
 };
 
@@ -231,6 +567,7 @@ inline Infint::Infint(const std::string& s)
     from_str(s);
 }
 
+#ifndef Infint_USE_BINARY_BASE
 inline Infint::Infint(int l) : pos(l >= 0)
 {
     if (!pos)
@@ -427,244 +764,116 @@ inline Infint Infint::operator--(int)
     return result;
 }
 
+#endif
+
 inline const Infint& Infint::operator+=(const Infint& rhs)
 {
-    if (rhs.val.size() > val.size())
-    {
-        val.resize(rhs.val.size(), 0);
-    }
-    for (size_t i = 0; i < val.size(); ++i)
-    {
-        val[i] = (pos ? val[i] : -val[i]) + (i < rhs.val.size() ? (rhs.pos ? rhs.val[i] : -rhs.val[i]) : 0);
-    }
-    correct();
+    add(*this, *this, rhs);
     return *this;
 }
 
 inline const Infint& Infint::operator-=(const Infint& rhs)
 {
-    if (rhs.val.size() > val.size())
-    {
-        val.resize(rhs.val.size(), 0);
-    }
-    for (size_t i = 0; i < val.size(); ++i)
-    {
-        val[i] = (pos ? val[i] : -val[i]) - (i < rhs.val.size() ? (rhs.pos ? rhs.val[i] : -rhs.val[i]) : 0);
-    }
-    correct();
+    subtract(*this, *this, rhs);
     return *this;
 }
 
 inline const Infint& Infint::operator*=(const Infint& rhs)
 {
-    // TODO: optimize (do not use operator*)
-    *this = *this * rhs;
+    multiply(*this, *this, rhs);
     return *this;
 }
 
 inline const Infint& Infint::operator/=(const Infint& rhs)
 {
-    if (rhs == zero)
-    {
-#ifdef Infint_USE_EXCEPTIONS
-        throw InfintException("division by zero");
-#else
-        std::cerr << "Division by zero!" << std::endl;
-        return *this;
-#endif
-    }
-    Infint R, D = (rhs.pos ? rhs : -rhs), N = (pos ? *this : -*this);
-    bool oldpos = pos;
-    val.clear();
-    val.resize(N.val.size(), 0);
-    for (int i = (int) N.val.size() - 1; i >= 0; --i)
-    {
-        R.val.insert(R.val.begin(), (ELEM_TYPE) 0);
-        R.val[0] = N.val[i];
-        R.correct(true);
-        ELEM_TYPE cnt = dInR(R, D);
-        R -= D * cnt;
-        val[i] += cnt;
-    }
-    correct();
-    pos = (val.size() == 1 && val[0] == 0) ? true : (oldpos == rhs.pos);
+    Infint R;
+    divide(*this, R, *this, rhs);
     return *this;
 }
 
 inline const Infint& Infint::operator%=(const Infint& rhs)
 {
-    if (rhs == zero)
-    {
-#ifdef Infint_USE_EXCEPTIONS
-        throw InfintException("division by zero");
-#else
-        std::cerr << "Division by zero!" << std::endl;
-        return zero;
-#endif
-    }
-    Infint D = (rhs.pos ? rhs : -rhs), N = (pos ? *this : -*this);
-    bool oldpos = pos;
-    val.clear();
-    for (int i = (int) N.val.size() - 1; i >= 0; --i)
-    {
-        val.insert(val.begin(), (ELEM_TYPE) 0);
-        val[0] = N.val[i];
-        correct(true);
-        *this -= D * dInR(*this, D);
-    }
-    correct();
-    pos = (val.size() == 1 && val[0] == 0) ? true : oldpos;
+    Infint Q;
+    divide(Q, *this, *this, rhs);
     return *this;
 }
 
 inline const Infint& Infint::operator*=(ELEM_TYPE rhs)
 {
-    ELEM_TYPE factor = rhs < 0 ? -rhs : rhs;
-    bool oldpos = pos;
-    multiplyByDigit(factor, val);
-    correct();
-    pos = (val.size() == 1 && val[0] == 0) ? true : (oldpos == (rhs >= 0));
+    multiply(*this, *this, rhs);
     return *this;
 }
 
 inline Infint Infint::operator-() const
 {//PROFILED_SCOPE
     Infint result = *this;
-    result.pos = !pos;
+    result.pos = (val.size() == 1 && val[0] == 0) ? true : !pos;
     return result;
 }
 
 inline Infint Infint::operator+(const Infint& rhs) const
 {//PROFILED_SCOPE
     Infint result;
-    result.val.resize(val.size() > rhs.val.size() ? val.size() : rhs.val.size(), 0);
-    for (size_t i = 0; i < val.size() || i < rhs.val.size(); ++i)
-    {
-        result.val[i] = (i < val.size() ? (pos ? val[i] : -val[i]) : 0) + (i < rhs.val.size() ? (rhs.pos ? rhs.val[i] : -rhs.val[i]) : 0);
-    }
-    result.correct();
+    add(result, *this, rhs);
     return result;
 }
 
 inline Infint Infint::operator-(const Infint& rhs) const
 {//PROFILED_SCOPE
     Infint result;
-    result.val.resize(val.size() > rhs.val.size() ? val.size() : rhs.val.size(), 0);
-    for (size_t i = 0; i < val.size() || i < rhs.val.size(); ++i)
-    {
-        result.val[i] = (i < val.size() ? (pos ? val[i] : -val[i]) : 0) - (i < rhs.val.size() ? (rhs.pos ? rhs.val[i] : -rhs.val[i]) : 0);
-    }
-    result.correct();
+    subtract(result, *this, rhs);
     return result;
 }
 
 inline Infint Infint::operator*(const Infint& rhs) const
 {//PROFILED_SCOPE
     Infint result;
-    result.val.resize(val.size() + rhs.val.size(), 0);
-    PRODUCT_TYPE carry = 0;
-    size_t digit = 0;
-    for (;; ++digit)
-    {//PROFILED_SCOPE
-        //result.val[digit] = (ELEM_TYPE) (carry % BASE);
-        //carry /= BASE;
-
-        PRODUCT_TYPE oldcarry = carry;
-        carry /= BASE;
-        result.val[digit] = (ELEM_TYPE) (oldcarry - carry * BASE);
-
-        bool found = false;
-        for (size_t i = digit < rhs.val.size() ? 0 : digit - rhs.val.size() + 1; i < val.size() && i <= digit; ++i)
-        {//PROFILED_SCOPE
-            PRODUCT_TYPE pval = result.val[digit] + val[i] * (PRODUCT_TYPE) rhs.val[digit - i];
-            if (pval >= BASE || pval <= -BASE)
-            {//PROFILED_SCOPE
-                //carry += pval / BASE;
-                //pval %= BASE;
-
-                PRODUCT_TYPE quot = pval / BASE;
-                carry += quot;
-                pval -= quot * BASE;
-            }
-            result.val[digit] = (ELEM_TYPE) pval;
-            found = true;
-        }
-        if (!found)
-        {//PROFILED_SCOPE
-            break;
-        }
-    }
-    for (; carry > 0; ++digit)
-    {//PROFILED_SCOPE
-        result.val[digit] = (ELEM_TYPE) (carry % BASE);
-        carry /= BASE;
-    }
-    result.correct();
-    result.pos = (result.val.size() == 1 && result.val[0] == 0) ? true : (pos == rhs.pos);
+    multiply(result, *this, rhs);
     return result;
 }
 
 inline Infint Infint::operator/(const Infint& rhs) const
 {//PROFILED_SCOPE
-    if (rhs == zero)
-    {
-#ifdef Infint_USE_EXCEPTIONS
-        throw InfintException("division by zero");
-#else
-        std::cerr << "Division by zero!" << std::endl;
-        return zero;
-#endif
-    }
-    Infint Q, R, D = (rhs.pos ? rhs : -rhs), N = (pos ? *this : -*this);
-    Q.val.resize(N.val.size(), 0);
-    for (int i = (int) N.val.size() - 1; i >= 0; --i)
-    {//PROFILED_SCOPE
-        R.val.insert(R.val.begin(), (ELEM_TYPE) 0);
-        R.val[0] = N.val[i];
-        R.correct(true);
-        ELEM_TYPE cnt = dInR(R, D);
-        R -= D * cnt;
-        Q.val[i] += cnt;
-    }
-    Q.correct();
-    Q.pos = (Q.val.size() == 1 && Q.val[0] == 0) ? true : (pos == rhs.pos);
+    Infint Q, R;
+    divide(Q, R, *this, rhs);
     return Q;
 }
 
 inline Infint Infint::operator%(const Infint& rhs) const
 {//PROFILED_SCOPE
-    if (rhs == zero)
-    {
-#ifdef Infint_USE_EXCEPTIONS
-        throw InfintException("division by zero");
-#else
-        std::cerr << "Division by zero!" << std::endl;
-        return zero;
-#endif
-    }
-    Infint R, D = (rhs.pos ? rhs : -rhs), N = (pos ? *this : -*this);
-    for (int i = (int) N.val.size() - 1; i >= 0; --i)
-    {
-        R.val.insert(R.val.begin(), (ELEM_TYPE) 0);
-        R.val[0] = N.val[i];
-        R.correct(true);
-        R -= D * dInR(R, D);
-    }
-    R.correct();
-    R.pos = (R.val.size() == 1 && R.val[0] == 0) ? true : pos;
+    Infint Q, R;
+    divide(Q, R, *this, rhs);
     return R;
 }
 
 inline Infint Infint::operator*(ELEM_TYPE rhs) const
 {//PROFILED_SCOPE
-    Infint result = *this;
-    ELEM_TYPE factor = rhs < 0 ? -rhs : rhs;
-    multiplyByDigit(factor, result.val);
-    result.correct();
-    result.pos = (result.val.size() == 1 && result.val[0] == 0) ? true : (pos == (rhs >= 0));
+    Infint result;
+    multiply(result, *this, rhs);
     return result;
 }
 
+// products land in out directly unless it is also an operand
+inline void Infint::multiply(Infint& out, const Infint& a, const Infint& b)
+{//PROFILED_SCOPE
+    size_t n = a.val.size(), m = b.val.size();
+    bool sign = a.pos == b.pos;
+    if (&out == &a || &out == &b)
+    {
+        InfintScratch::Frame frame;
+        LIMB_TYPE* product = frame.takeZeroed(n + m);
+        multiplyMagnitudes(a.val.data(), n, b.val.data(), m, product);
+        out.val.assign(product, product + n + m);
+    }
+    else
+    {
+        out.val.assign(n + m, 0);
+        multiplyMagnitudes(a.val.data(), n, b.val.data(), m, out.val.data());
+    }
+    out.remove_lzeros();
+    out.pos = (out.val.size() == 1 && out.val[0] == 0) ? true : sign;
+}
+
 inline bool Infint::operator==(const Infint& rhs) const
 {//PROFILED_SCOPE
     if (pos != rhs.pos || val.size() != rhs.val.size())
@@ -877,6 +1086,7 @@ inline Infint Infint::isqrt() const
     return lo;
 }
 
+#ifndef Infint_USE_BINARY_BASE
 inline char Infint::digit(size_t i) const
 {//PROFILED_SCOPE
     if (digit_num() <= i)
@@ -902,6 +1112,17 @@ inline size_t Infint::digit_num() const
 #endif
 }
 
+inline unsigned long long Infint::lowMagnitude() const
+{
+    unsigned long long result = 0;
+    for (int i = (int) val.size() - 1; i >= 0; --i)
+    {
+        result = result * BASE + val[i];
+    }
+    return result;
+}
+#endif
+
 inline std::string Infint::str() const
 {//PROFILED_SCOPE
     std::ostringstream oss;
@@ -911,7 +1132,7 @@ inline std::string Infint::str() const
 
 inline size_t Infint::size() const
 {//PROFILED_SCOPE
-    return val.size() * sizeof(ELEM_TYPE) + sizeof(bool);
+    return val.size() * sizeof(LIMB_TYPE) + sizeof(bool);
 }
 
 inline int Infint::toInt() const
@@ -922,12 +1143,8 @@ inline int Infint::toInt() const
 #else
     std::cerr << "Out of INT bounds: " << *this << std::endl;
 #endif
-    int result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return pos ? result : -result;
+    unsigned long long result = lowMagnitude();
+    return (int) (pos ? result : 0 - result);
 }
 
 inline long Infint::toLong() const
@@ -938,12 +1155,8 @@ inline long Infint::toLong() const
 #else
     std::cerr << "Out of LONG bounds: " << *this << std::endl;
 #endif
-    long result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return pos ? result : -result;
+    unsigned long long result = lowMagnitude();
+    return (long) (pos ? result : 0 - result);
 }
 
 inline long long Infint::toLongLong() const
@@ -954,12 +1167,8 @@ inline long long Infint::toLongLong() const
 #else
     std::cerr << "Out of LLONG bounds: " << *this << std::endl;
 #endif
-    long long result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return pos ? result : -result;
+    unsigned long long result = lowMagnitude();
+    return (long long) (pos ? result : 0 - result);
 }
 
 inline unsigned int Infint::toUnsignedInt() const
@@ -970,12 +1179,7 @@ inline unsigned int Infint::toUnsignedInt() const
 #else
     std::cerr << "Out of UINT bounds: " << *this << std::endl;
 #endif
-    unsigned int result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return result;
+    return (unsigned int) lowMagnitude();
 }
 
 inline unsigned long Infint::toUnsignedLong() const
@@ -986,12 +1190,7 @@ inline unsigned long Infint::toUnsignedLong() const
 #else
     std::cerr << "Out of ULONG bounds: " << *this << std::endl;
 #endif
-    unsigned long result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return result;
+    return (unsigned long) lowMagnitude();
 }
 
 inline unsigned long long Infint::toUnsignedLongLong() const
@@ -1002,14 +1201,10 @@ inline unsigned long long Infint::toUnsignedLongLong() const
 #else
     std::cerr << "Out of ULLONG bounds: " << *this << std::endl;
 #endif
-    unsigned long long result = 0;
-    for (int i = (int) val.size() - 1; i >= 0; --i)
-    {
-        result = result * BASE + val[i];
-    }
-    return result;
+    return (unsigned long long) lowMagnitude();
 }
 
+#ifndef Infint_USE_BINARY_BASE
 inline void Infint::truncate()
 {//PROFILED_SCOPE
     for (size_t i = 0; i < val.size(); ++i) // truncate each
@@ -1086,22 +1281,17 @@ inline bool Infint::equalizeSigns()
     
     return isPositive;
 }
+#endif
 
 inline void Infint::remove_lzeros()
 {//PROFILED_SCOPE
-    for (int i = (int) (val.size()) - 1; i > 0; --i) // remove leading 0's
+    while (val.size() > 1 && val.back() == 0) // remove leading 0's
     {
-        if (val[i] != 0)
-        {
-            return;
-        }
-        else
-        {
-            val.erase(val.begin() + i);
-        }
+        val.pop_back();
     }
 }
 
+#ifndef Infint_USE_BINARY_BASE
 inline void Infint::correct(bool justCheckLeadingZeros, bool hasValidSign)
 {//PROFILED_SCOPE
     if (!justCheckLeadingZeros)
@@ -1156,52 +1346,907 @@ inline void Infint::from_str(const std::string& s)
     correct(true);
 }
 
-inline ELEM_TYPE Infint::dInR(const Infint& R, const Infint& D)
+// out = a + b, limb sums may leave the base until correct() carries them
+inline void Infint::add(Infint& out, const Infint& a, const Infint& b)
 {//PROFILED_SCOPE
-    ELEM_TYPE min = 0, max = UPPER_BOUND;
-    while (max - min > 0)
+    size_t n = a.val.size(), m = b.val.size();
+    bool apos = a.pos, bpos = b.pos;
+    out.val.resize(n > m ? n : m, 0);
+    for (size_t i = 0; i < out.val.size(); ++i)
     {
-        ELEM_TYPE avg = max + min;
-        //div_t dt = div(avg, 2);
-        //avg = dt.rem ? (dt.quot + 1) : dt.quot;
-        ELEM_TYPE havg = avg / 2;
-        avg = (avg - havg * 2) ? (havg + 1) : havg;
-        Infint prod = D * avg;
-        if (R == prod)
-        {//PROFILED_SCOPE
-            return avg;
-        }
-        else if (R > prod)
-        {//PROFILED_SCOPE
-            min = avg;
-        }
-        else
-        {//PROFILED_SCOPE
-            max = avg - 1;
-        }
+        out.val[i] = (i < n ? (apos ? a.val[i] : -a.val[i]) : 0) + (i < m ? (bpos ? b.val[i] : -b.val[i]) : 0);
     }
-    return min;
+    out.correct();
 }
 
-inline void Infint::multiplyByDigit(ELEM_TYPE factor, std::vector<ELEM_TYPE>& val)
+inline void Infint::subtract(Infint& out, const Infint& a, const Infint& b)
 {//PROFILED_SCOPE
-    ELEM_TYPE carry = 0;
+    size_t n = a.val.size(), m = b.val.size();
+    bool apos = a.pos, bpos = b.pos;
+    out.val.resize(n > m ? n : m, 0);
+    for (size_t i = 0; i < out.val.size(); ++i)
+    {
+        out.val[i] = (i < n ? (apos ? a.val[i] : -a.val[i]) : 0) - (i < m ? (bpos ? b.val[i] : -b.val[i]) : 0);
+    }
+    out.correct();
+}
+
+inline void Infint::multiply(Infint& out, const Infint& a, ELEM_TYPE b)
+{//PROFILED_SCOPE
+    bool sign = a.pos == (b >= 0);
+    if (&out != &a)
+    {
+        out.val = a.val;
+    }
+    multiplyByDigit(b < 0 ? -b : b, out.val);
+    out.correct();
+    out.pos = (out.val.size() == 1 && out.val[0] == 0) ? true : sign;
+}
+
+// leaves quotient and remainder untouched on division by zero, they must be different numbers
+inline void Infint::divide(Infint& quotient, Infint& remainder, const Infint& a, const Infint& b)
+{//PROFILED_SCOPE
+    if (b == zero)
+    {
+#ifdef Infint_USE_EXCEPTIONS
+        throw InfintException("division by zero");
+#else
+        std::cerr << "Division by zero!" << std::endl;
+        return;
+#endif
+    }
+    bool qpos = a.pos == b.pos, rpos = a.pos;
+    Infint N = a, D = b;
+    N.pos = D.pos = true;
+    if (useNewtonDivision(N, D))
+    {
+        newtonDivide(N, D, quotient, remainder);
+    }
+    else
+    {
+        Infint& Q = quotient;
+        Infint& R = remainder;
+        Infint prod;
+        Q.val.assign(N.val.size(), 0);
+        R = zero;
+        for (int i = (int) N.val.size() - 1; i >= 0; --i)
+        {//PROFILED_SCOPE
+            R.val.insert(R.val.begin(), (ELEM_TYPE) 0);
+            R.val[0] = N.val[i];
+            R.correct(true);
+            ELEM_TYPE cnt = dInR(R, D, prod);
+            multiply(prod, D, cnt);
+            R -= prod;
+            Q.val[i] += cnt;
+        }
+        Q.correct();
+        R.correct();
+    }
+    quotient.pos = (quotient.val.size() == 1 && quotient.val[0] == 0) ? true : qpos;
+    remainder.pos = (remainder.val.size() == 1 && remainder.val[0] == 0) ? true : rpos;
+}
+
+inline ELEM_TYPE Infint::dInR(const Infint& R, const Infint& D, Infint& prod)
+{//PROFILED_SCOPE
+    ELEM_TYPE min = 0, max = UPPER_BOUND;
+    while (max - min > 0)
+    {
+        ELEM_TYPE avg = max + min;
+        //div_t dt = div(avg, 2);
+        //avg = dt.rem ? (dt.quot + 1) : dt.quot;
+        ELEM_TYPE havg = avg / 2;
+        avg = (avg - havg * 2) ? (havg + 1) : havg;
+        multiply(prod, D, avg);
+        if (R == prod)
+        {//PROFILED_SCOPE
+            return avg;
+        }
+        else if (R > prod)
+        {//PROFILED_SCOPE
+            min = avg;
+        }
+        else
+        {//PROFILED_SCOPE
+            max = avg - 1;
+        }
+    }
+    return min;
+}
+
+inline void Infint::multiplyByDigit(ELEM_TYPE factor, InfintLimbs& val)
+{//PROFILED_SCOPE
+    ELEM_TYPE carry = 0;
     for (size_t i = 0; i < val.size(); ++i)
     {
-        PRODUCT_TYPE pval = val[i] * (PRODUCT_TYPE) factor + carry;
-        if (pval >= BASE || pval <= -BASE)
+        PRODUCT_TYPE pval = val[i] * (PRODUCT_TYPE) factor + carry;
+        if (pval >= BASE || pval <= -BASE)
+        {
+            //carry = (ELEM_TYPE) (pval / BASE);
+            //pval %= BASE;
+
+            carry = (ELEM_TYPE) (pval / BASE);
+            pval -= carry * (PRODUCT_TYPE) BASE;
+        }
+        else
+        {
+            carry = 0;
+        }
+        val[i] = (ELEM_TYPE) pval;
+    }
+    if (carry > 0)
+    {
+        val.push_back(carry);
+    }
+}
+#endif
+
+/**************************************************************/
+/*************** MULTIPLICATION AND DIVISION TIERS ************/
+/**************************************************************/
+
+inline void Infint::multiplyMagnitudes(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out)
+{//PROFILED_SCOPE
+    if (n < m)
+    {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m == 0)
+    {
+        return;
+    }
+    if (m < KARATSUBA_THRESHOLD)
+    {
+        multiplySchoolbook(a, n, b, m, out);
+        return;
+    }
+    // unbalanced operands, multiply b by m limb slices of a
+    if (n >= 2 * m)
+    {
+        InfintScratch::Frame frame;
+        LIMB_TYPE* part = frame.take(2 * m);
+        for (size_t i = 0; i < n; i += m)
+        {
+            size_t len = std::min(m, n - i);
+            std::fill(part, part + 2 * m, (LIMB_TYPE) 0);
+            multiplyMagnitudes(a + i, len, b, m, part);
+            addLimbs(out + i, n + m - i, part, len + m);
+        }
+        return;
+    }
+#ifdef __SIZEOF_INT128__
+    if (m >= NTT_THRESHOLD && multiplyNTT(a, n, b, m, out))
+    {
+        return;
+    }
+#endif
+    if (m >= TOOM3_THRESHOLD)
+    {
+        multiplyToom3(a, n, b, m, out);
+        return;
+    }
+    multiplyKaratsuba(a, n, b, m, out);
+}
+
+#ifndef Infint_USE_BINARY_BASE
+inline void Infint::multiplySchoolbook(const ELEM_TYPE* a, size_t n, const ELEM_TYPE* b, size_t m, ELEM_TYPE* out)
+{//PROFILED_SCOPE
+    for (size_t i = 0; i < n; ++i)
+    {
+        PRODUCT_TYPE ai = a[i], carry = 0;
+        if (ai == 0)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < m; ++j)
+        {
+            PRODUCT_TYPE t = out[i + j] + ai * b[j] + carry;
+            carry = t / BASE;
+            out[i + j] = (ELEM_TYPE) (t - carry * BASE);
+        }
+        // rows only reach this limb once the previous row is done
+        out[i + m] = (ELEM_TYPE) carry;
+    }
+}
+#endif
+
+// n >= m > n / 2, split both at k: (a1 x + a0)(b1 x + b0) with 3 half size products
+inline void Infint::multiplyKaratsuba(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out)
+{//PROFILED_SCOPE
+    size_t k = (n + 1) / 2;
+    size_t bLow = std::min(k, m);
+    // z0 = a0 b0 and z2 = a1 b1 go straight into their places in out
+    multiplyMagnitudes(a, k, b, bLow, out);
+    multiplyMagnitudes(a + k, n - k, b + bLow, m - bLow, out + 2 * k);
+
+    InfintScratch::Frame frame;
+    LIMB_TYPE* sa = frame.takeZeroed(k + 1);
+    LIMB_TYPE* sb = frame.takeZeroed(k + 1);
+    std::copy(a, a + k, sa);
+    std::copy(b, b + bLow, sb);
+    addLimbs(sa, k + 1, a + k, n - k);
+    addLimbs(sb, k + 1, b + bLow, m - bLow);
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    size_t len = 2 * k + 2;
+    LIMB_TYPE* z1 = frame.takeZeroed(len);
+    multiplyMagnitudes(sa, k + 1, sb, k + 1, z1);
+    subtractLimbs(z1, len, out, k + bLow);
+    subtractLimbs(z1, len, out + 2 * k, n + m - 2 * k);
+    while (len > 0 && z1[len - 1] == 0)
+    {
+        --len;
+    }
+    addLimbs(out + k, n + m - k, z1, len);
+}
+
+// n >= m > n / 2, split into thirds and evaluate at 0, 1, -1, -2, infinity (Bodrato's sequence)
+inline void Infint::multiplyToom3(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out)
+{//PROFILED_SCOPE
+    size_t k = (n + 2) / 3;
+    size_t b1 = std::min(k, m), b2 = std::min(2 * k, m);
+    Infint a0 = fromLimbs(a, k), a1 = fromLimbs(a + k, k), a2 = fromLimbs(a + 2 * k, n - 2 * k);
+    Infint c0 = fromLimbs(b, b1), c1 = fromLimbs(b + b1, b2 - b1), c2 = fromLimbs(b + b2, m - b2);
+
+    Infint pm = a0 + a2, p1 = pm + a1, pm1 = pm - a1, pm2 = (pm1 + a2) * 2 - a0;
+    Infint qm = c0 + c2, q1 = qm + c1, qm1 = qm - c1, qm2 = (qm1 + c2) * 2 - c0;
+
+    Infint r0 = a0 * c0, r1 = p1 * q1, rm1 = pm1 * qm1, rm2 = pm2 * qm2, rinf = a2 * c2;
+    // interpolate the 5 coefficients of the product
+    Infint r3 = rm2 - r1;
+    divideExact(r3, 3);
+    r1 -= rm1;
+    divideExact(r1, 2);
+    Infint r2 = rm1 - r0;
+    r3 = r2 - r3;
+    divideExact(r3, 2);
+    r3 += rinf * 2;
+    r2 += r1;
+    r2 -= rinf;
+    r1 -= r3;
+
+    const Infint* coefficients[] = {&r0, &r1, &r2, &r3, &rinf};
+    for (size_t i = 0; i < 5; ++i)
+    {
+        const Infint& c = *coefficients[i];
+        if (i * k < n + m && !(c.val.size() == 1 && c.val[0] == 0))
+        {
+            addLimbs(out + i * k, n + m - i * k, c.val.data(), c.val.size());
+        }
+    }
+}
+
+#ifdef __SIZEOF_INT128__
+inline unsigned Infint::powMod(unsigned long long b, unsigned long long e, unsigned mod)
+{
+    unsigned long long result = 1;
+    b %= mod;
+    for (; e > 0; e >>= 1)
+    {
+        if (e & 1)
+        {
+            result = result * b % mod;
+        }
+        b = b * b % mod;
+    }
+    return (unsigned) result;
+}
+
+// in place iterative transform, primitive root 3 for every modulus used
+inline void Infint::ntt(std::vector<unsigned>& a, bool invert, unsigned mod)
+{//PROFILED_SCOPE
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(a[i], a[j]);
+        }
+    }
+    std::vector<unsigned> roots(n / 2 + 1);
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        unsigned long long w = powMod(3, (mod - 1) / len, mod);
+        if (invert)
+        {
+            w = powMod(w, mod - 2, mod);
+        }
+        size_t half = len / 2;
+        roots[0] = 1;
+        for (size_t i = 1; i < half; ++i)
+        {
+            roots[i] = (unsigned) (roots[i - 1] * w % mod);
+        }
+        for (size_t i = 0; i < n; i += len)
+        {
+            for (size_t j = 0; j < half; ++j)
+            {
+                unsigned u = a[i + j];
+                unsigned v = (unsigned) ((unsigned long long) a[i + j + half] * roots[j] % mod);
+                a[i + j] = u + v >= mod ? u + v - mod : u + v;
+                a[i + j + half] = u >= v ? u - v : u + mod - v;
+            }
+        }
+    }
+    if (invert)
+    {
+        unsigned long long inverse = powMod(n, mod - 2, mod);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = (unsigned) (a[i] * inverse % mod);
+        }
+    }
+}
+
+// convolution of the limbs modulo 3 NTT primes, recombined with the chinese remainder theorem
+// the primes' product (~2^86) bounds the convolution terms n * BASE^2, false if too long to transform
+// binary limbs are transformed as two 32 bit digits each
+inline bool Infint::multiplyNTT(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out)
+{//PROFILED_SCOPE
+    static const unsigned mods[3] = {998244353u, 167772161u, 469762049u};
+#ifdef Infint_USE_BINARY_BASE
+    std::vector<unsigned> da(2 * n), db(2 * m);
+    for (size_t i = 0; i < n; ++i)
+    {
+        da[2 * i] = (unsigned) a[i];
+        da[2 * i + 1] = (unsigned) (a[i] >> 32);
+    }
+    for (size_t i = 0; i < m; ++i)
+    {
+        db[2 * i] = (unsigned) b[i];
+        db[2 * i + 1] = (unsigned) (b[i] >> 32);
+    }
+    const unsigned* pa = da.data();
+    const unsigned* pb = db.data();
+    n *= 2;
+    m *= 2;
+#else
+    const ELEM_TYPE* pa = a;
+    const ELEM_TYPE* pb = b;
+#endif
+    size_t size = 1;
+    while (size < n + m)
+    {
+        size <<= 1;
+    }
+    // 998244353 - 1 has only 2^23 as its power of two factor
+    if (size > (size_t(1) << 23))
+    {
+        return false;
+    }
+    std::vector<unsigned> residues[3];
+    for (int p = 0; p < 3; ++p)
+    {
+        std::vector<unsigned> fa(size, 0), fb(size, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            fa[i] = (unsigned) pa[i] % mods[p];
+        }
+        for (size_t i = 0; i < m; ++i)
+        {
+            fb[i] = (unsigned) pb[i] % mods[p];
+        }
+        ntt(fa, false, mods[p]);
+        ntt(fb, false, mods[p]);
+        for (size_t i = 0; i < size; ++i)
+        {
+            fa[i] = (unsigned) ((unsigned long long) fa[i] * fb[i] % mods[p]);
+        }
+        ntt(fa, true, mods[p]);
+        residues[p].swap(fa);
+    }
+    // Garner's recombination
+    const unsigned long long m0 = mods[0], m1 = mods[1], m2 = mods[2];
+    const unsigned long long inv01 = powMod(m0, m1 - 2, (unsigned) m1);
+    const unsigned long long inv012 = powMod(m0 * m1 % m2, m2 - 2, (unsigned) m2);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < n + m; ++i)
+    {
+        unsigned long long x0 = residues[0][i];
+        unsigned long long x1 = (residues[1][i] + m1 - x0 % m1) % m1 * inv01 % m1;
+        unsigned long long partial = (x0 + x1 * m0) % m2;
+        unsigned long long x2 = (residues[2][i] + m2 - partial) % m2 * inv012 % m2;
+        carry += (unsigned __int128) x0 + (unsigned __int128) x1 * m0 + (unsigned __int128) x2 * m0 * m1;
+#ifdef Infint_USE_BINARY_BASE
+        out[i / 2] |= (LIMB_TYPE) (unsigned) carry << (i % 2 * 32);
+        carry >>= 32;
+#else
+        unsigned __int128 quot = carry / BASE;
+        out[i] = (ELEM_TYPE) (carry - quot * BASE);
+        carry = quot;
+#endif
+    }
+    return true;
+}
+#endif
+
+#ifndef Infint_USE_BINARY_BASE
+// dst += src, the sum must fit in dstLen limbs
+inline void Infint::addLimbs(ELEM_TYPE* dst, size_t dstLen, const ELEM_TYPE* src, size_t srcLen)
+{
+    ELEM_TYPE carry = 0;
+    size_t i = 0;
+    for (; i < srcLen; ++i)
+    {
+        ELEM_TYPE sum = dst[i] + src[i] + carry;
+        carry = sum >= BASE;
+        dst[i] = carry ? sum - BASE : sum;
+    }
+    for (; carry && i < dstLen; ++i)
+    {
+        ELEM_TYPE sum = dst[i] + carry;
+        carry = sum >= BASE;
+        dst[i] = carry ? sum - BASE : sum;
+    }
+}
+
+// dst -= src, the difference must not be negative
+inline void Infint::subtractLimbs(ELEM_TYPE* dst, size_t dstLen, const ELEM_TYPE* src, size_t srcLen)
+{
+    ELEM_TYPE borrow = 0;
+    size_t i = 0;
+    for (; i < srcLen; ++i)
+    {
+        ELEM_TYPE diff = dst[i] - src[i] - borrow;
+        borrow = diff < 0;
+        dst[i] = borrow ? diff + BASE : diff;
+    }
+    for (; borrow && i < dstLen; ++i)
+    {
+        ELEM_TYPE diff = dst[i] - borrow;
+        borrow = diff < 0;
+        dst[i] = borrow ? diff + BASE : diff;
+    }
+}
+
+#endif
+
+inline Infint Infint::fromLimbs(const LIMB_TYPE* p, size_t n)
+{
+    Infint result;
+    if (n > 0)
+    {
+        result.val.assign(p, p + n);
+        result.remove_lzeros();
+    }
+    return result;
+}
+
+#ifndef Infint_USE_BINARY_BASE
+// x /= d for d dividing x exactly, keeps the sign
+inline void Infint::divideExact(Infint& x, ELEM_TYPE d)
+{
+    PRODUCT_TYPE rem = 0;
+    for (int i = (int) x.val.size() - 1; i >= 0; --i)
+    {
+        PRODUCT_TYPE cur = rem * BASE + x.val[i];
+        x.val[i] = (ELEM_TYPE) (cur / d);
+        rem = cur - x.val[i] * (PRODUCT_TYPE) d;
+    }
+    x.correct(true);
+    if (x.val.size() == 1 && x.val[0] == 0)
+    {
+        x.pos = true;
+    }
+}
+#endif
+
+// x * BASE^k
+inline void Infint::shiftLimbsUp(Infint& x, size_t k)
+{
+    if (!(x.val.size() == 1 && x.val[0] == 0))
+    {
+        x.val.insert(x.val.begin(), k, (LIMB_TYPE) 0);
+    }
+}
+
+// x / BASE^k truncated toward zero
+inline void Infint::shiftLimbsDown(Infint& x, size_t k)
+{
+    if (k >= x.val.size())
+    {
+        x = zero;
+        return;
+    }
+    x.val.erase(x.val.begin(), x.val.begin() + k);
+    x.remove_lzeros();
+    if (x.val.size() == 1 && x.val[0] == 0)
+    {
+        x.pos = true;
+    }
+}
+
+inline bool Infint::useNewtonDivision(const Infint& N, const Infint& D)
+{
+    return D.val.size() >= NEWTON_THRESHOLD && N.val.size() >= D.val.size() + NEWTON_THRESHOLD;
+}
+
+// floor(BASE^(2p) / D) for D of exactly p limbs
+// Newton's iteration X = X + X (BASE^(2p) - D X) / BASE^(2p) from a half precision reciprocal
+// of D's top limbs, then a few exact corrections
+inline Infint Infint::reciprocal(const Infint& D, size_t p)
+{//PROFILED_SCOPE
+    Infint power;
+    power.val.assign(2 * p + 1, 0);
+    power.val.back() = 1;
+    if (p < NEWTON_THRESHOLD)
+    {
+        return power / D;
+    }
+    // two guard limbs keep the error after one step within a few units
+    size_t h = p / 2 + 2;
+    Infint top = D;
+    shiftLimbsDown(top, p - h);
+    Infint X = reciprocal(top, h);
+    shiftLimbsUp(X, p - h);
+
+    Infint E = power - D * X;
+    Infint step = X * E;
+    shiftLimbsDown(step, 2 * p);
+    X += step;
+
+    E = power - D * X;
+    while (E < zero)
+    {
+        --X;
+        E += D;
+    }
+    while (E >= D)
+    {
+        ++X;
+        E -= D;
+    }
+    return X;
+}
+
+// Q = N / D, R = N % D for positive N, D via a reciprocal of D good to the quotient's length
+inline void Infint::newtonDivide(const Infint& N, const Infint& D, Infint& Q, Infint& R)
+{//PROFILED_SCOPE
+    if (N < D)
+    {
+        Q = zero;
+        R = N;
+        return;
+    }
+    size_t n = N.val.size(), m = D.val.size();
+    size_t p = n - m + 3;
+    // D scaled to exactly p limbs, D ~ top * BASE^(m - p)
+    Infint top = D;
+    if (m >= p)
+    {
+        shiftLimbsDown(top, m - p);
+    }
+    else
+    {
+        shiftLimbsUp(top, p - m);
+    }
+    // X ~ BASE^(2p) / top ~ BASE^(p + m) / D
+    Infint X = reciprocal(top, p);
+    Q = N * X;
+    shiftLimbsDown(Q, p + m);
+    R = N - Q * D;
+    while (R < zero)
+    {
+        --Q;
+        R += D;
+    }
+    while (R >= D)
+    {
+        ++Q;
+        R -= D;
+    }
+}
+
+#ifdef Infint_USE_BINARY_BASE
+/**************************************************************/
+/************************ BINARY LIMBS ************************/
+/**************************************************************/
+
+inline Infint::Infint(int l) : pos(l >= 0)
+{
+    val.push_back(pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+}
+
+inline Infint::Infint(long l) : pos(l >= 0)
+{
+    val.push_back(pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+}
+
+inline Infint::Infint(long long l) : pos(l >= 0)
+{
+    val.push_back(pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+}
+
+inline Infint::Infint(unsigned int l) : pos(true)
+{
+    val.push_back(l);
+}
+
+inline Infint::Infint(unsigned long l) : pos(true)
+{
+    val.push_back(l);
+}
+
+inline Infint::Infint(unsigned long long l) : pos(true)
+{
+    val.push_back(l);
+}
+
+inline const Infint& Infint::operator=(int l)
+{
+    pos = l >= 0;
+    val.assign(1, pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+    return *this;
+}
+
+inline const Infint& Infint::operator=(long l)
+{
+    pos = l >= 0;
+    val.assign(1, pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+    return *this;
+}
+
+inline const Infint& Infint::operator=(long long l)
+{
+    pos = l >= 0;
+    val.assign(1, pos ? (LIMB_TYPE) l : 0 - (LIMB_TYPE) l);
+    return *this;
+}
+
+inline const Infint& Infint::operator=(unsigned int l)
+{
+    pos = true;
+    val.assign(1, l);
+    return *this;
+}
+
+inline const Infint& Infint::operator=(unsigned long l)
+{
+    pos = true;
+    val.assign(1, l);
+    return *this;
+}
+
+inline const Infint& Infint::operator=(unsigned long long l)
+{
+    pos = true;
+    val.assign(1, l);
+    return *this;
+}
+
+inline const Infint& Infint::operator++()
+{
+    addSigned(one, true);
+    return *this;
+}
+
+inline const Infint& Infint::operator--()
+{
+    addSigned(one, false);
+    return *this;
+}
+
+inline Infint Infint::operator++(int)
+{
+    Infint result = *this;
+    addSigned(one, true);
+    return result;
+}
+
+inline Infint Infint::operator--(int)
+{
+    Infint result = *this;
+    addSigned(one, false);
+    return result;
+}
+
+inline void Infint::add(Infint& out, const Infint& a, const Infint& b)
+{//PROFILED_SCOPE
+    if (&out == &b)
+    {
+        out.addSigned(a, a.pos);
+        return;
+    }
+    if (&out != &a)
+    {
+        out.val = a.val;
+        out.pos = a.pos;
+    }
+    out.addSigned(b, b.pos);
+}
+
+inline void Infint::subtract(Infint& out, const Infint& a, const Infint& b)
+{//PROFILED_SCOPE
+    if (&out == &b && &out != &a)
+    {
+        // a - b = -(b - a)
+        out.addSigned(a, !a.pos);
+        out.pos = (out.val.size() == 1 && out.val[0] == 0) ? true : !out.pos;
+        return;
+    }
+    if (&out != &a)
+    {
+        out.val = a.val;
+        out.pos = a.pos;
+    }
+    out.addSigned(b, !b.pos);
+}
+
+inline void Infint::multiply(Infint& out, const Infint& a, ELEM_TYPE b)
+{//PROFILED_SCOPE
+    bool sign = a.pos == (b >= 0);
+    if (&out != &a)
+    {
+        out.val = a.val;
+    }
+    multiplyBySmall(b < 0 ? 0 - (LIMB_TYPE) b : (LIMB_TYPE) b, 0, out.val);
+    out.remove_lzeros();
+    out.pos = (out.val.size() == 1 && out.val[0] == 0) ? true : sign;
+}
+
+// leaves quotient and remainder untouched on division by zero, they must be different numbers
+inline void Infint::divide(Infint& quotient, Infint& remainder, const Infint& a, const Infint& b)
+{//PROFILED_SCOPE
+    if (b == zero)
+    {
+#ifdef Infint_USE_EXCEPTIONS
+        throw InfintException("division by zero");
+#else
+        std::cerr << "Division by zero!" << std::endl;
+        return;
+#endif
+    }
+    bool qpos = a.pos == b.pos, rpos = a.pos;
+    Infint N = a, D = b;
+    N.pos = D.pos = true;
+    divideMagnitudes(N, D, quotient, remainder);
+    quotient.pos = (quotient.val.size() == 1 && quotient.val[0] == 0) ? true : qpos;
+    remainder.pos = (remainder.val.size() == 1 && remainder.val[0] == 0) ? true : rpos;
+}
+
+// digits come from a full decimal conversion
+inline char Infint::digit(size_t i) const
+{//PROFILED_SCOPE
+    std::string s = str();
+    size_t digits = s.size() - (pos ? 0 : 1);
+    if (digits <= i)
+    {
+#ifdef Infint_USE_EXCEPTIONS
+        throw InfintException("invalid digit index");
+#else
+        std::cerr << "Invalid digit index: " << i << std::endl;
+        return -1;
+#endif
+    }
+    return s[s.size() - 1 - i] - '0';
+}
+
+inline size_t Infint::digit_num() const
+{//PROFILED_SCOPE
+    return str().size() - (pos ? 0 : 1);
+}
+
+inline unsigned long long Infint::lowMagnitude() const
+{
+    return val[0];
+}
+
+inline int Infint::compareMagnitudes(const Infint& a, const Infint& b)
+{
+    if (a.val.size() != b.val.size())
+    {
+        return a.val.size() < b.val.size() ? -1 : 1;
+    }
+    for (int i = (int) a.val.size() - 1; i >= 0; --i)
+    {
+        if (a.val[i] != b.val[i])
         {
-            //carry = (ELEM_TYPE) (pval / BASE);
-            //pval %= BASE;
+            return a.val[i] < b.val[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
 
-            carry = (ELEM_TYPE) (pval / BASE);
-            pval -= carry * BASE;
+// *this += (rhsPos ? |rhs| : -|rhs|), rhs may be *this
+inline void Infint::addSigned(const Infint& rhs, bool rhsPos)
+{//PROFILED_SCOPE
+    size_t n = rhs.val.size();
+    if (pos == rhsPos)
+    {
+        val.resize(std::max(val.size(), n) + 1, 0);
+        addLimbs(val.data(), val.size(), rhs.val.data(), n);
+    }
+    else if (compareMagnitudes(*this, rhs) >= 0)
+    {
+        subtractLimbs(val.data(), val.size(), rhs.val.data(), n);
+    }
+    else
+    {
+        // |rhs| > |*this|, val = |rhs| - val in place
+        val.resize(n, 0);
+        LIMB_TYPE borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            PRODUCT_TYPE diff = (PRODUCT_TYPE) rhs.val[i] - val[i] - borrow;
+            val[i] = (LIMB_TYPE) diff;
+            borrow = (LIMB_TYPE) (diff >> 64) & 1;
         }
-        else
+        pos = rhsPos;
+    }
+    remove_lzeros();
+    if (val.size() == 1 && val[0] == 0)
+    {
+        pos = true;
+    }
+}
+
+// dst += src, the sum must fit in dstLen limbs
+inline void Infint::addLimbs(LIMB_TYPE* dst, size_t dstLen, const LIMB_TYPE* src, size_t srcLen)
+{
+    LIMB_TYPE carry = 0;
+    size_t i = 0;
+    for (; i < srcLen; ++i)
+    {
+        PRODUCT_TYPE sum = (PRODUCT_TYPE) dst[i] + src[i] + carry;
+        dst[i] = (LIMB_TYPE) sum;
+        carry = (LIMB_TYPE) (sum >> 64);
+    }
+    for (; carry && i < dstLen; ++i)
+    {
+        carry = ++dst[i] == 0;
+    }
+}
+
+// dst -= src, the difference must not be negative
+inline void Infint::subtractLimbs(LIMB_TYPE* dst, size_t dstLen, const LIMB_TYPE* src, size_t srcLen)
+{
+    LIMB_TYPE borrow = 0;
+    size_t i = 0;
+    for (; i < srcLen; ++i)
+    {
+        PRODUCT_TYPE diff = (PRODUCT_TYPE) dst[i] - src[i] - borrow;
+        dst[i] = (LIMB_TYPE) diff;
+        borrow = (LIMB_TYPE) (diff >> 64) & 1;
+    }
+    for (; borrow && i < dstLen; ++i)
+    {
+        borrow = dst[i]-- == 0;
+    }
+}
+
+inline void Infint::multiplySchoolbook(const LIMB_TYPE* a, size_t n, const LIMB_TYPE* b, size_t m, LIMB_TYPE* out)
+{//PROFILED_SCOPE
+    for (size_t i = 0; i < n; ++i)
+    {
+        LIMB_TYPE ai = a[i], carry = 0;
+        if (ai == 0)
         {
-            carry = 0;
+            continue;
         }
-        val[i] = (ELEM_TYPE) pval;
+        for (size_t j = 0; j < m; ++j)
+        {
+            PRODUCT_TYPE t = (PRODUCT_TYPE) ai * b[j] + out[i + j] + carry;
+            out[i + j] = (LIMB_TYPE) t;
+            carry = (LIMB_TYPE) (t >> 64);
+        }
+        out[i + m] = carry;
+    }
+}
+
+// val = val * factor + addend
+inline void Infint::multiplyBySmall(LIMB_TYPE factor, LIMB_TYPE addend, InfintLimbs& val)
+{
+    LIMB_TYPE carry = addend;
+    for (size_t i = 0; i < val.size(); ++i)
+    {
+        PRODUCT_TYPE t = (PRODUCT_TYPE) val[i] * factor + carry;
+        val[i] = (LIMB_TYPE) t;
+        carry = (LIMB_TYPE) (t >> 64);
     }
     if (carry > 0)
     {
@@ -1209,10 +2254,295 @@ inline void Infint::multiplyByDigit(ELEM_TYPE factor, std::vector<ELEM_TYPE>& va
     }
 }
 
+// val[0 .. n) /= d, returns the remainder, leading zeros are left in place
+inline LIMB_TYPE Infint::divideBySmall(LIMB_TYPE* val, size_t n, LIMB_TYPE d)
+{
+    LIMB_TYPE rem = 0;
+    for (int i = (int) n - 1; i >= 0; --i)
+    {
+        PRODUCT_TYPE cur = ((PRODUCT_TYPE) rem << 64) | val[i];
+        val[i] = (LIMB_TYPE) (cur / d);
+        rem = (LIMB_TYPE) (cur - (PRODUCT_TYPE) val[i] * d);
+    }
+    return rem;
+}
+
+// x /= d for d dividing x exactly, keeps the sign
+inline void Infint::divideExact(Infint& x, ELEM_TYPE d)
+{
+    divideBySmall(x.val.data(), x.val.size(), (LIMB_TYPE) d);
+    x.remove_lzeros();
+    if (x.val.size() == 1 && x.val[0] == 0)
+    {
+        x.pos = true;
+    }
+}
+
+// Q = N / D, R = N % D for positive N, D
+inline void Infint::divideMagnitudes(const Infint& N, const Infint& D, Infint& Q, Infint& R)
+{//PROFILED_SCOPE
+    if (compareMagnitudes(N, D) < 0)
+    {
+        Q = zero;
+        R = N;
+        return;
+    }
+    if (D.val.size() == 1)
+    {
+        Q = N;
+        R = divideBySmall(Q.val.data(), Q.val.size(), D.val[0]);
+        Q.remove_lzeros();
+        return;
+    }
+    if (useNewtonDivision(N, D))
+    {
+        newtonDivide(N, D, Q, R);
+        return;
+    }
+    divideKnuth(N, D, Q, R);
+}
+
+// Knuth's algorithm D for N >= D and D of at least 2 limbs
+// both are shifted so D's top bit is set, then each estimated quotient limb is at most 2 too large
+inline void Infint::divideKnuth(const Infint& N, const Infint& D, Infint& Q, Infint& R)
+{//PROFILED_SCOPE
+    size_t n = D.val.size(), m = N.val.size() - n;
+    int s = __builtin_clzll(D.val.back());
+    InfintScratch::Frame frame;
+    LIMB_TYPE* v = frame.take(n);
+    LIMB_TYPE* u = frame.take(m + n + 1);
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        v[i] = (D.val[i] << s) | (s ? D.val[i - 1] >> (64 - s) : 0);
+    }
+    v[0] = D.val[0] << s;
+    u[m + n] = s ? N.val[m + n - 1] >> (64 - s) : 0;
+    for (size_t i = m + n - 1; i > 0; --i)
+    {
+        u[i] = (N.val[i] << s) | (s ? N.val[i - 1] >> (64 - s) : 0);
+    }
+    u[0] = N.val[0] << s;
+
+    const PRODUCT_TYPE b = (PRODUCT_TYPE) 1 << 64;
+    Q.pos = true;
+    Q.val.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        PRODUCT_TYPE num = ((PRODUCT_TYPE) u[j + n] << 64) | u[j + n - 1];
+        PRODUCT_TYPE qhat = num / v[n - 1], rhat = num % v[n - 1];
+        while (qhat >= b || qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2]))
+        {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= b)
+            {
+                break;
+            }
+        }
+        // u[j .. j + n] -= qhat * v
+        __int128 borrow = 0, t;
+        for (size_t i = 0; i < n; ++i)
+        {
+            PRODUCT_TYPE p = qhat * v[i];
+            t = (__int128) u[i + j] - borrow - (__int128) (LIMB_TYPE) p;
+            u[i + j] = (LIMB_TYPE) t;
+            borrow = (__int128) (p >> 64) - (t >> 64);
+        }
+        t = (__int128) u[j + n] - borrow;
+        u[j + n] = (LIMB_TYPE) t;
+        if (t < 0)
+        {
+            // qhat was one too large, add v back
+            --qhat;
+            PRODUCT_TYPE carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                carry += (PRODUCT_TYPE) u[i + j] + v[i];
+                u[i + j] = (LIMB_TYPE) carry;
+                carry >>= 64;
+            }
+            u[j + n] += (LIMB_TYPE) carry;
+        }
+        Q.val[j] = (LIMB_TYPE) qhat;
+    }
+    Q.remove_lzeros();
+
+    R.pos = true;
+    R.val.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        R.val[i] = (u[i] >> s) | (s ? u[i + 1] << (64 - s) : 0);
+    }
+    R.remove_lzeros();
+}
+
+// powers[k] = 10^(19 * 2^k) for k < levels
+inline void Infint::decimalPowers(size_t levels, std::vector<Infint>& powers)
+{
+    powers.clear();
+    if (levels > 0)
+    {
+        powers.push_back(Infint(DECIMAL_CHUNK));
+    }
+    while (powers.size() < levels)
+    {
+        powers.push_back(powers.back() * powers.back());
+    }
+}
+
+// value of the n <= 2^level base 10^19 chunks, least significant first
+// split in halves at a power of 10^19, so conversion costs O(log n) multiplications of each size
+inline Infint Infint::fromDecimalChunks(const LIMB_TYPE* chunks, size_t n, size_t level, const std::vector<Infint>& powers)
+{//PROFILED_SCOPE
+    if (level <= CONVERSION_LEVEL)
+    {
+        Infint result;
+        for (size_t i = n; i-- > 0;)
+        {
+            multiplyBySmall(DECIMAL_CHUNK, chunks[i], result.val);
+        }
+        result.remove_lzeros();
+        return result;
+    }
+    size_t half = (size_t) 1 << (level - 1);
+    if (n <= half)
+    {
+        return fromDecimalChunks(chunks, n, level - 1, powers);
+    }
+    Infint result = fromDecimalChunks(chunks + half, n - half, level - 1, powers) * powers[level - 1];
+    result += fromDecimalChunks(chunks, half, level - 1, powers);
+    return result;
+}
+
+// writes the 2^level base 10^19 chunks of 0 <= x < 10^(19 * 2^level) into zeroed chunks
+// inverses[k] = floor(2^(128 p) / powers[k]) for powers[k] of p limbs, or zero to divide directly,
+// every division on a level is by the same power so its reciprocal is only computed once
+inline void Infint::toDecimalChunks(const Infint& x, size_t level, const std::vector<Infint>& powers, const std::vector<Infint>& inverses, LIMB_TYPE* chunks)
+{//PROFILED_SCOPE
+    if (x.val.size() == 1 && x.val[0] == 0)
+    {
+        return;
+    }
+    if (level <= CONVERSION_LEVEL)
+    {
+        InfintScratch::Frame frame;
+        size_t len = x.val.size();
+        LIMB_TYPE* rest = frame.take(len);
+        std::copy(x.val.begin(), x.val.end(), rest);
+        for (size_t i = 0; len > 0; ++i)
+        {
+            chunks[i] = divideBySmall(rest, len, DECIMAL_CHUNK);
+            while (len > 0 && rest[len - 1] == 0)
+            {
+                --len;
+            }
+        }
+        return;
+    }
+    const Infint& P = powers[level - 1];
+    const Infint& X = inverses[level - 1];
+    Infint Q, R;
+    if (X.val.size() == 1 && X.val[0] == 0)
+    {
+        divideMagnitudes(x, P, Q, R);
+    }
+    else
+    {
+        // x < P^2 puts the estimate at most 2 below the quotient
+        Q = x * X;
+        shiftLimbsDown(Q, 2 * P.val.size());
+        R = x - Q * P;
+        while (R >= P)
+        {
+            ++Q;
+            R -= P;
+        }
+    }
+    toDecimalChunks(R, level - 1, powers, inverses, chunks);
+    toDecimalChunks(Q, level - 1, powers, inverses, chunks + ((size_t) 1 << (level - 1)));
+}
+
+inline void Infint::from_str(const std::string& s)
+{//PROFILED_SCOPE
+    size_t start = 0;
+    bool negative = false;
+    if (!s.empty() && (s[0] == '-' || s[0] == '+'))
+    {
+        negative = s[0] == '-';
+        start = 1;
+    }
+    size_t n = (s.size() - start + DECIMAL_CHUNK_DIGITS - 1) / DECIMAL_CHUNK_DIGITS;
+    std::vector<LIMB_TYPE> chunks(n, 0);
+    for (size_t c = 0; c < n; ++c)
+    {
+        size_t end = s.size() - c * DECIMAL_CHUNK_DIGITS;
+        size_t begin = end - start > (size_t) DECIMAL_CHUNK_DIGITS ? end - DECIMAL_CHUNK_DIGITS : start;
+        for (size_t i = begin; i < end; ++i)
+        {
+            chunks[c] = chunks[c] * 10 + (LIMB_TYPE) (s[i] - '0');
+        }
+    }
+    size_t level = 0;
+    while (((size_t) 1 << level) < n)
+    {
+        ++level;
+    }
+    std::vector<Infint> powers;
+    if (level > CONVERSION_LEVEL)
+    {
+        decimalPowers(level, powers);
+    }
+    *this = fromDecimalChunks(chunks.data(), n, level, powers);
+    pos = !negative || (val.size() == 1 && val[0] == 0);
+}
+#endif
+
 /**************************************************************/
 /******************** NON-MEMBER OPERATORS ********************/
 /**************************************************************/
 
+inline Infint operator-(Infint&& n)
+{
+    n.pos = (n.val.size() == 1 && n.val[0] == 0) ? true : !n.pos;
+    return std::move(n);
+}
+
+inline Infint operator+(Infint&& lhs, const Infint& rhs)
+{
+    Infint::add(lhs, lhs, rhs);
+    return std::move(lhs);
+}
+
+inline Infint operator+(const Infint& lhs, Infint&& rhs)
+{
+    Infint::add(rhs, lhs, rhs);
+    return std::move(rhs);
+}
+
+inline Infint operator+(Infint&& lhs, Infint&& rhs)
+{
+    Infint::add(lhs, lhs, rhs);
+    return std::move(lhs);
+}
+
+inline Infint operator-(Infint&& lhs, const Infint& rhs)
+{
+    Infint::subtract(lhs, lhs, rhs);
+    return std::move(lhs);
+}
+
+inline Infint operator-(const Infint& lhs, Infint&& rhs)
+{
+    Infint::subtract(rhs, lhs, rhs);
+    return std::move(rhs);
+}
+
+inline Infint operator-(Infint&& lhs, Infint&& rhs)
+{
+    Infint::subtract(lhs, lhs, rhs);
+    return std::move(lhs);
+}
+
 inline std::istream& operator>>(std::istream &s, Infint &n)
 {//PROFILED_SCOPE
     std::string str;
@@ -1221,6 +2551,59 @@ inline std::istream& operator>>(std::istream &s, Infint &n)
     return s;
 }
 
+#ifdef Infint_USE_BINARY_BASE
+inline std::ostream& operator<<(std::ostream &s, const Infint &n)
+{//PROFILED_SCOPE
+    if (!n.pos)
+    {
+        s << '-';
+    }
+    if (n.val.size() == 1)
+    {
+        return s << n.val[0];
+    }
+    // n < powers.back()^2 once the square would have more limbs than n
+    std::vector<Infint> powers;
+    Infint::decimalPowers(1, powers);
+    while (2 * powers.back().val.size() - 1 <= n.val.size())
+    {
+        powers.push_back(powers.back() * powers.back());
+    }
+    size_t level = powers.size();
+    std::vector<Infint> inverses(level);
+    for (size_t k = 0; k < level; ++k)
+    {
+        size_t p = powers[k].val.size();
+        if (p >= NEWTON_THRESHOLD)
+        {
+            inverses[k] = Infint::reciprocal(powers[k], p);
+        }
+    }
+    std::vector<LIMB_TYPE> chunks((size_t) 1 << level, 0);
+    Infint magnitude = n;
+    magnitude.pos = true;
+    Infint::toDecimalChunks(magnitude, level, powers, inverses, chunks.data());
+
+    size_t top = chunks.size() - 1;
+    while (top > 0 && chunks[top] == 0)
+    {
+        --top;
+    }
+    std::string out = std::to_string(chunks[top]);
+    out.resize(out.size() + top * DECIMAL_CHUNK_DIGITS);
+    char* p = &out[out.size()];
+    for (size_t i = 0; i < top; ++i)
+    {
+        LIMB_TYPE c = chunks[i];
+        for (int d = 0; d < DECIMAL_CHUNK_DIGITS; ++d)
+        {
+            *--p = (char) ('0' + c % 10);
+            c /= 10;
+        }
+    }
+    return s << out;
+}
+#else
 inline std::ostream& operator<<(std::ostream &s, const Infint &n)
 {//PROFILED_SCOPE
     if (!n.pos)
@@ -1242,5 +2625,6 @@ inline std::ostream& operator<<(std::ostream &s, const Infint &n)
     }
     return s;
 }
+#endif
 
 #endif
@@ -1,3 +1,4 @@
 #pragma once
 #include "tree/interval_set.h"
+#include "tree/interval_index.h"
 #include "tree/plane_set.h"
\ No newline at end of file
@@ -1,7 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <initializer_list>
+#include <iterator>
+#include <type_traits>
 #include <unordered_set>
+#include <utility>
+#include "pool.h"	// chunk allocator of the unrolled list
 
 namespace sal {
 
@@ -95,15 +101,16 @@ public:
 		delete temp;
 	}
 	void remove_dup() {
-		std::unordered_set<T> elems(head->data);
+		if (!head) return;
 		// cannot have duplicate in first element
-		for (Node* node = head; node->next; node = node->next) {
-			while (node->next && elems.find(node->next->data) != elems.end()) {
+		std::unordered_set<T> elems {head->data};
+		for (Node* node = head; node->next; ) {
+			if (!elems.insert(node->next->data).second) {
 				NP to_del {node->next};
 				node->next = node->next->next;
 				delete to_del;
 			}
-			elems.insert(node->next->data);
+			else node = node->next;
 		}
 	}
 
@@ -149,4 +156,243 @@ struct Basic_list_node {
 template <typename T>
 using Basic_list = List<Basic_list_node<T>>;
 
+
+// unrolled list, each node a chunk of up to B elements, with a tail pointer and pooled chunks
+// appends and head inserts are O(1), scans touch n / B nodes instead of n
+// same value interface as List where it carries over (nodes aren't handed out, so kth_last gives the element),
+// switching is changing Basic_list<T> to Unrolled_list<T>
+// chunks split in half when an insert in the middle finds them full; once erasing leaves one under half full
+// it merges with a neighbour it fits into, or else takes elements from the next until both are half full,
+// so chunks besides the ends stay at least half full and there are at most 2n / B + 2 of them
+template <typename T, size_t B>
+struct Unrolled_chunk {
+	Unrolled_chunk* next {nullptr};
+	size_t count {0};
+	T elems[B];
+};
+
+// chunks of about 256 bytes of elements
+template <typename T>
+constexpr size_t unrolled_chunk_size = std::max<size_t>(4, 256 / sizeof(T));
+
+template <typename T, size_t B = unrolled_chunk_size<T>, typename Alloc = Node_pool<Unrolled_chunk<T,B>>>
+class Unrolled_list {
+	static_assert(B >= 2, "chunks have to hold at least 2 elements");
+	using Chunk = Unrolled_chunk<T,B>;
+	Chunk* head {nullptr};
+	Chunk* tail {nullptr};
+	size_t n {0};
+	Alloc alloc;
+
+	Chunk* make_chunk(Chunk* next) {
+		Chunk* chunk {alloc.create()};
+		chunk->next = next;
+		return chunk;
+	}
+	// moves the upper half of a full chunk into a new chunk after it
+	void split(Chunk* chunk) {
+		Chunk* upper {make_chunk(chunk->next)};
+		size_t half {B / 2};
+		std::move(chunk->elems + half, chunk->elems + B, upper->elems);
+		upper->count = B - half;
+		chunk->count = half;
+		chunk->next = upper;
+		if (tail == chunk) tail = upper;
+	}
+	// unlinks chunk, prev being its predecessor or nullptr for the head
+	void drop(Chunk* chunk, Chunk* prev) {
+		(prev? prev->next : head) = chunk->next;
+		if (tail == chunk) tail = prev;
+		alloc.destroy(chunk);
+	}
+	void insert_at(Chunk* chunk, size_t i, T d) {
+		if (chunk->count == B) {
+			split(chunk);
+			if (i > chunk->count) {
+				i -= chunk->count;
+				chunk = chunk->next;
+			}
+		}
+		std::move_backward(chunk->elems + i, chunk->elems + chunk->count, chunk->elems + chunk->count + 1);
+		chunk->elems[i] = std::move(d);
+		++chunk->count;
+		++n;
+	}
+	void erase_at(Chunk* chunk, Chunk* prev, size_t i) {
+		std::move(chunk->elems + i + 1, chunk->elems + chunk->count, chunk->elems + i);
+		--chunk->count;
+		--n;
+		if (chunk->count == 0) {drop(chunk, prev); return;}
+		if (chunk->count >= B / 2) return;
+		Chunk* next {chunk->next};
+		if (prev && prev->count + chunk->count <= B) {
+			std::move(chunk->elems, chunk->elems + chunk->count, prev->elems + prev->count);
+			prev->count += chunk->count;
+			drop(chunk, prev);
+		}
+		else if (next && chunk->count + next->count <= B) {
+			std::move(next->elems, next->elems + next->count, chunk->elems + chunk->count);
+			chunk->count += next->count;
+			drop(next, chunk);
+		}
+		// more than B between them, so half each leaves both at least half full
+		else if (next) {
+			size_t moved {(chunk->count + next->count) / 2 - chunk->count};
+			std::move(next->elems, next->elems + moved, chunk->elems + chunk->count);
+			std::move(next->elems + moved, next->elems + next->count, next->elems);
+			chunk->count += moved;
+			next->count -= moved;
+		}
+	}
+
+public:
+	using value_type = T;
+	template <typename Chunk_ptr, typename Ref>
+	class Iterator {
+		Chunk_ptr chunk;
+		size_t i;
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::remove_reference_t<Ref>*;
+		using reference = Ref;
+		Iterator(Chunk_ptr c = nullptr, size_t index = 0) : chunk{c}, i{index} {}
+		Ref operator*() const {return chunk->elems[i];}
+		pointer operator->() const {return &chunk->elems[i];}
+		Iterator& operator++() {
+			if (++i == chunk->count) {chunk = chunk->next; i = 0;}
+			return *this;
+		}
+		Iterator operator++(int) {Iterator prev {*this}; ++*this; return prev;}
+		bool operator==(const Iterator& other) const {return chunk == other.chunk && i == other.i;}
+		bool operator!=(const Iterator& other) const {return !(*this == other);}
+	};
+	using iterator = Iterator<Chunk*, T&>;
+	using const_iterator = Iterator<const Chunk*, const T&>;
+
+	Unrolled_list() = default;
+	Unrolled_list(T d) {append(std::move(d));}
+	Unrolled_list(std::initializer_list<T> l) {for (const T& d : l) append(d);}
+	Unrolled_list(const Unrolled_list& other) {for (const T& d : other) append(d);}
+	Unrolled_list(Unrolled_list&& other) noexcept : head{other.head}, tail{other.tail}, n{other.n}, alloc{std::move(other.alloc)} {
+		other.head = other.tail = nullptr;
+		other.n = 0;
+	}
+	Unrolled_list& operator=(Unrolled_list other) noexcept {
+		std::swap(head, other.head);
+		std::swap(tail, other.tail);
+		std::swap(n, other.n);
+		std::swap(alloc, other.alloc);
+		return *this;
+	}
+	~Unrolled_list() {clear();}
+
+	size_t size() const {return n;}
+	bool empty() const {return n == 0;}
+	// chunks in use, for checking the fill bound
+	size_t chunk_count() const {
+		size_t chunks {0};
+		for (const Chunk* chunk = head; chunk; chunk = chunk->next) ++chunks;
+		return chunks;
+	}
+	iterator begin() 				{return {head, 0};}
+	iterator end() 					{return {};}
+	const_iterator begin() const 	{return {head, 0};}
+	const_iterator end() const 		{return {};}
+
+	// index from 1, so last is k = 1, nullptr past either end
+	T* kth_last(size_t k) {
+		if (k == 0 || k > n) return nullptr;
+		size_t i {n - k};
+		Chunk* chunk {head};
+		for (; i >= chunk->count; chunk = chunk->next) i -= chunk->count;
+		return &chunk->elems[i];
+	}
+
+	// insert at head
+	void insert(T d) {
+		if (!head) head = tail = make_chunk(nullptr);
+		else if (head->count == B) head = make_chunk(head);
+		insert_at(head, 0, std::move(d));
+	}
+	// prev points to an element of this list, found by a scan over the chunks
+	void insert_after(T d, const T* prev) {
+		std::less<const T*> before;
+		for (Chunk* chunk = head; chunk; chunk = chunk->next)
+			if (!before(prev, chunk->elems) && before(prev, chunk->elems + chunk->count)) {
+				insert_at(chunk, prev - chunk->elems + 1, std::move(d));
+				return;
+			}
+	}
+	// append to tail
+	void append(T d) {
+		if (!tail) head = tail = make_chunk(nullptr);
+		else if (tail->count == B) tail = tail->next = make_chunk(nullptr);
+		tail->elems[tail->count++] = std::move(d);
+		++n;
+	}
+	// erase the first element equal to d
+	void erase(const T& d) {
+		for (Chunk* chunk = head, *prev = nullptr; chunk; prev = chunk, chunk = chunk->next)
+			for (size_t i = 0; i < chunk->count; ++i)
+				if (chunk->elems[i] == d) {erase_at(chunk, prev, i); return;}
+	}
+	// one pass keeping first occurrences, packing the kept elements into the leading chunks
+	void remove_dup() {
+		std::unordered_set<T> elems;
+		elems.reserve(n);
+		Chunk* out {head};
+		size_t o {0};
+		n = 0;
+		for (Chunk* chunk = head; chunk; chunk = chunk->next)
+			for (size_t i = 0; i < chunk->count; ++i) {
+				if (!elems.insert(chunk->elems[i]).second) continue;
+				if (o == B) {out->count = B; out = out->next; o = 0;}
+				// the write position never passes the read position
+				if (out != chunk || o != i) out->elems[o] = std::move(chunk->elems[i]);
+				++o;
+				++n;
+			}
+		if (!out) return;
+		Chunk* rest {out->next};
+		out->count = o;
+		out->next = nullptr;
+		tail = out;
+		while (rest) {
+			Chunk* next {rest->next};
+			alloc.destroy(rest);
+			rest = next;
+		}
+	}
+	void clear() {
+		if (!Alloc::bulk_release || !std::is_trivially_destructible<T>::value || !alloc.exclusive())
+			while (head) {
+				Chunk* next {head->next};
+				alloc.destroy(head);
+				head = next;
+			}
+		alloc.release();
+		head = tail = nullptr;
+		n = 0;
+	}
+
+	void print() const {std::cout << *this;}
+};
+
+// appends every element in one pass onto the tail
+template <typename T, size_t B, typename Alloc>
+std::istream& operator>>(std::istream& is, Unrolled_list<T,B,Alloc>& l) {
+	T tmp;
+	while (is >> tmp) l.append(std::move(tmp));
+	return is;
+}
+
+template <typename T, size_t B, typename Alloc>
+std::ostream& operator<<(std::ostream& os, const Unrolled_list<T,B,Alloc>& l) {
+	for (const T& d : l) os << d << ' ';
+	os << std::endl;
+	return os;
+}
+
 }	// end namespace sal
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>		// open
+#include <sys/mman.h>	// mmap
+#include <sys/stat.h>	// fstat
+#include <unistd.h>		// close, ftruncate
+#include "matrix.h"		// matrix views over mapped data
+
+// binary files that are mapped read only and used in place instead of parsed
+// layout is a fixed header followed by 64 byte aligned sections the header gives the positions of,
+// all in the writing machine's byte order and type sizes (checked when mapping)
+// loading costs only the page faults of what gets touched
+
+namespace sal {
+
+// whole file mapped into memory, read only or created at a given size for writing
+class Mapped_file {
+	void* addr {nullptr};
+	size_t length {0};
+	bool writable {false};
+
+	static int open_or_throw(const std::string& path, int flags) {
+		int fd {::open(path.c_str(), flags, 0644)};
+		if (fd < 0) throw std::runtime_error("Cannot open " + path);
+		return fd;
+	}
+	void map(int fd, const std::string& path) {
+		if (length == 0) {::close(fd); return;}
+		addr = ::mmap(nullptr, length, writable? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);	// the mapping stays valid
+		if (addr == MAP_FAILED) {addr = nullptr; throw std::runtime_error("Cannot map " + path);}
+	}
+public:
+	explicit Mapped_file(const std::string& path) {
+		int fd {open_or_throw(path, O_RDONLY)};
+		struct stat info;
+		if (::fstat(fd, &info) != 0) {::close(fd); throw std::runtime_error("Cannot stat " + path);}
+		length = static_cast<size_t>(info.st_size);
+		map(fd, path);
+	}
+	Mapped_file(const std::string& path, size_t size) : length{size}, writable{true} {
+		int fd {open_or_throw(path, O_RDWR | O_CREAT | O_TRUNC)};
+		if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {::close(fd); throw std::runtime_error("Cannot resize " + path);}
+		map(fd, path);
+	}
+	Mapped_file(const Mapped_file&) = delete;
+	Mapped_file& operator=(const Mapped_file&) = delete;
+	~Mapped_file() {if (addr) ::munmap(addr, length);}
+
+	size_t size() const {return length;}
+	const char* data() const {return static_cast<const char*>(addr);}
+	// only files created for writing can be written through
+	char* data() {return static_cast<char*>(addr);}
+	// access will be in order, lets the kernel read ahead aggressively
+	void sequential() const {if (addr) ::madvise(addr, length, MADV_SEQUENTIAL);}
+	// writes dirty pages back before the file is read again
+	void flush() {if (addr && writable) ::msync(addr, length, MS_SYNC);}
+};
+
+constexpr uint32_t mapped_version = 1;
+constexpr uint32_t mapped_byte_order = 0x01020304;
+constexpr size_t mapped_alignment = 64;
+
+// size, signedness and floating point of a stored type, so mapping as the wrong type fails
+template <typename T>
+constexpr uint32_t mapped_type_code() {
+	return static_cast<uint32_t>(sizeof(T)) | (std::is_signed<T>::value? 1u << 16 : 0) |
+		(std::is_floating_point<T>::value? 1u << 17 : 0);
+}
+
+struct Mapped_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t flags;
+	uint32_t index_type;	// type codes of indices, names and values
+	uint32_t name_type;
+	uint32_t value_type;
+	uint64_t counts[4];		// kind specific, rows and columns or vertices and edges
+	uint64_t sections[4];	// byte positions of the arrays
+};
+static_assert(std::is_trivially_copyable<Mapped_header>::value, "header is written byte for byte");
+
+inline size_t mapped_align(size_t pos) {return (pos + mapped_alignment - 1) / mapped_alignment * mapped_alignment;}
+
+inline Mapped_header mapped_header(const char* magic) {
+	Mapped_header header {};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = mapped_version;
+	header.byte_order = mapped_byte_order;
+	return header;
+}
+
+// header of a mapped file after checking it is of the expected kind and readable here
+inline const Mapped_header& mapped_check(const Mapped_file& file, const char* magic, const std::string& path) {
+	const Mapped_header* header {reinterpret_cast<const Mapped_header*>(file.data())};
+	if (file.size() < sizeof(Mapped_header) || std::memcmp(header->magic, magic, sizeof(header->magic)) != 0)
+		throw std::runtime_error(path + " is not a " + std::string(magic, 8) + " file");
+	if (header->version != mapped_version) throw std::runtime_error(path + " has unsupported version");
+	if (header->byte_order != mapped_byte_order) throw std::runtime_error(path + " was written with another byte order");
+	return *header;
+}
+
+// elements at a section, after checking they lie inside the file
+template <typename T>
+const T* mapped_section(const Mapped_file& file, uint64_t pos, uint64_t count, const std::string& path) {
+	if (pos % alignof(T) || pos > file.size() || count > (file.size() - pos) / sizeof(T))
+		throw std::runtime_error(path + " is truncated or corrupt");
+	return reinterpret_cast<const T*>(file.data() + pos);
+}
+
+
+// matrices are dimensions plus row major elements -----------
+constexpr char mapped_matrix_magic[] = "SALMATRX";
+
+template <typename TT>
+void write_matrix(const std::string& path, Matrix_view<TT> m) {
+	using T = std::remove_const_t<TT>;
+	static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements can be mapped");
+	Mapped_header header {mapped_header(mapped_matrix_magic)};
+	header.value_type = mapped_type_code<T>();
+	header.counts[0] = m.row();
+	header.counts[1] = m.col();
+	header.sections[0] = mapped_align(sizeof(Mapped_header));
+	Mapped_file file {path, header.sections[0] + m.row() * m.col() * sizeof(T)};
+	std::memcpy(file.data(), &header, sizeof(header));
+	// any layout is written row major
+	if (m.row() && m.col())
+		copy_strided(m.row(), m.col(), static_cast<const T*>(m.data()), m.row_stride(), m.col_stride(),
+			reinterpret_cast<T*>(file.data() + header.sections[0]), m.col(), 1);
+	file.flush();
+}
+template <typename T>
+void write_matrix(const std::string& path, const Matrix<T>& m) {write_matrix(path, m.view());}
+
+// matrix stored in a mapped file, used through its view
+template <typename T>
+class Mapped_matrix {
+	std::shared_ptr<const Mapped_file> file;
+	const T* elems {nullptr};
+	size_t rows {0}, cols {0};
+public:
+	explicit Mapped_matrix(const std::string& path) : file{std::make_shared<const Mapped_file>(path)} {
+		const Mapped_header& header {mapped_check(*file, mapped_matrix_magic, path)};
+		if (header.value_type != mapped_type_code<T>()) throw std::runtime_error(path + " holds another element type");
+		rows = header.counts[0];
+		cols = header.counts[1];
+		if (cols && rows > UINT64_MAX / cols) throw std::runtime_error(path + " is truncated or corrupt");
+		elems = mapped_section<T>(*file, header.sections[0], rows * cols, path);
+	}
+
+	size_t row() const {return rows;}
+	size_t col() const {return cols;}
+	const T& get(size_t r, size_t c) const {return elems[r*cols + c];}
+	const T* data() const {return elems;}
+	// valid while this or a copy of it is alive
+	Matrix_view<const T> view() const {return {elems, rows, cols, cols, 1};}
+	Matrix<T> copy() const {return Matrix<T>{view()};}
+};
+
+}	// end namespace sal
@@ -6,14 +6,63 @@
 #include <stdexcept>
 #include <initializer_list>
 #include <limits>	// numeric limits
+#include <type_traits>
 #include "../algo/utility.h"	// Rand int
 #include "../algo/macros.h"		// POS_INF
+#include "matrix/gemm.h"		// blocked multiplication kernel
+#include "matrix/semiring.h"	// min plus, boolean products
+#include "matrix/fixed.h"		// compile time sized small matrices
+#include "matrix/transpose.h"	// cache oblivious strided copies
+#include "parallel.h"			// execution policies and thread pool for parallel overloads
 
 
 namespace sal {
 
 using namespace std;
 
+// non owning window onto matrix storage, element (i,j) is at data[i*row_stride + j*col_stride]
+// rows, columns, blocks and the transpose of a matrix are all views of the same elements, 
+// so they can be used as operands without copying; a view dangles once its matrix resizes
+template <typename T>
+class Matrix_view {
+	T* first;
+	size_t rows, cols;
+	size_t rs, cs;
+public:
+	using value_type = std::remove_const_t<T>;
+
+	Matrix_view(T* data, size_t r, size_t c, size_t row_stride, size_t col_stride) : 
+		first{data}, rows{r}, cols{c}, rs{row_stride}, cs{col_stride} {}
+	// read only view of a mutable one
+	template <typename U, typename = std::enable_if_t<std::is_same<const U, T>::value>>
+	Matrix_view(const Matrix_view<U>& v) : 
+		first{v.data()}, rows{v.row()}, cols{v.col()}, rs{v.row_stride()}, cs{v.col_stride()} {}
+
+	size_t row() const {return rows;}
+	size_t col() const {return cols;}
+	size_t row_stride() const {return rs;}
+	size_t col_stride() const {return cs;}
+	T* data() const {return first;}
+	T& get(size_t r, size_t c) const {return first[r*rs + c*cs];}
+
+	Matrix_view row_view(size_t r) const {return {first + r*rs, 1, cols, rs, cs};}
+	Matrix_view col_view(size_t c) const {return {first + c*cs, rows, 1, rs, cs};}
+	// nr x nc block with (r,c) as its top left
+	Matrix_view block(size_t r, size_t c, size_t nr, size_t nc) const {return {first + r*rs + c*cs, nr, nc, rs, cs};}
+	Matrix_view transposed() const {return {first, cols, rows, cs, rs};}
+
+	template <typename Op>
+	value_type row_op(size_t row, Op&& op, value_type res = 0) const {
+		for (size_t col = 0; col < cols; ++col) op(res, get(row, col));
+		return res;
+	}
+	template <typename Op>
+	value_type col_op(size_t col, Op&& op, value_type res = 0) const {
+		for (size_t row = 0; row < rows; ++row) op(res, get(row, col));
+		return res;
+	}
+};
+
 template <typename T>
 class Matrix {
 
@@ -31,7 +80,14 @@ public:
 	Matrix(size_t r, size_t c, vector<T>&& e) : elems{std::move(e)}, rows{r}, cols{c}  {}
 	Matrix(initializer_list<initializer_list<T>> a);
 	Matrix(const Matrix& a) : elems{a.elems}, rows{a.row()}, cols{a.col()}  {}
+	// copy out of any layout, a transposed view copies by cache oblivious blocks
+	explicit Matrix(Matrix_view<const T> v) : elems(v.row()*v.col()), rows{v.row()}, cols{v.col()} {
+		copy_strided(rows, cols, v.data(), v.row_stride(), v.col_stride(), elems.data(), cols, 1);
+	}
 	Matrix(Matrix&& a) : elems{std::move(a.elems)}, rows{a.row()}, cols{a.col()}  {}
+	// copy of a compile time sized one, the other way is Fixed_matrix's explicit constructor
+	template <size_t R, size_t C>
+	Matrix(const Fixed_matrix<T,R,C>& a) : elems(a.begin(), a.end()), rows{R}, cols{C} {}
 	Matrix<T>& operator=(const Matrix& a) {
 		rows = a.rows; cols = a.cols;
 		elems = a.elems;
@@ -46,8 +102,13 @@ public:
 	// essential operators
 	Matrix<T>& operator*=(T);
 	Matrix<T>& operator*=(const Matrix&);
+	Matrix<T>& operator*=(Matrix_view<const T>);
 	Matrix<T>& operator+=(const Matrix&);
 	Matrix<T>& operator-=(const Matrix&);
+	// products and powers over another semiring, *this = *this (x) a, e.g. multiply<Min_plus<int>>(a)
+	template <typename S = Plus_times<T>>
+	Matrix<T>& multiply(Matrix_view<const T>);
+	template <typename S = Plus_times<T>>
 	Matrix<T>& pow(size_t exponent);
 
 	bool operator==(const Matrix&) const;
@@ -61,20 +122,31 @@ public:
 	size_t col() const { return cols; }
 	T& get(size_t row, size_t col) { return elems[row*cols + col]; }
 	const T& get(size_t row, size_t col) const {return elems[row*cols + col]; }
+	// row major contiguous storage
+	T* data() {return elems.data();}
+	const T* data() const {return elems.data();}
+
+	// views ----------
+	Matrix_view<T> view() {return {elems.data(), rows, cols, cols, 1};}
+	Matrix_view<const T> view() const {return {elems.data(), rows, cols, cols, 1};}
+	Matrix_view<T> row_view(size_t r) {return view().row_view(r);}
+	Matrix_view<const T> row_view(size_t r) const {return view().row_view(r);}
+	Matrix_view<T> col_view(size_t c) {return view().col_view(c);}
+	Matrix_view<const T> col_view(size_t c) const {return view().col_view(c);}
+	Matrix_view<T> block(size_t r, size_t c, size_t nr, size_t nc) {return view().block(r, c, nr, nc);}
+	Matrix_view<const T> block(size_t r, size_t c, size_t nr, size_t nc) const {return view().block(r, c, nr, nc);}
+	Matrix_view<T> transposed_view() {return view().transposed();}
+	Matrix_view<const T> transposed_view() const {return view().transposed();}
 
 	// manipulators -------
 	Matrix<T> transpose() const {	// create a copy of itself that is the transpose
-		vector<T> elems_t;
-		elems_t.reserve(rows*cols);
-		for (size_t i = 0; i < cols; ++i)
-			for (size_t j = 0; j < rows; ++j) 
-				elems_t.push_back(get(j, i));
-		return Matrix<T>{cols, rows, std::move(elems_t)};
+		return Matrix<T>{transposed_view()};
 	}
 
 	// modifiers ----------
 	// can just extend depth
 	void rotate(); // clockwise
+	void transpose_in_place();	// no extra storage for squares
 	void clear_zero();
 	void resize_rows(size_t new_rows, T def = 0) {elems.resize(new_rows, def);}
 
@@ -100,13 +172,13 @@ public:
 
 	// convenient row and col operations
 	template <typename Op>
-	T row_op(size_t row, Op&& op, T res = 0) {
+	T row_op(size_t row, Op&& op, T res = 0) const {
 		for (size_t col = 0; col < cols; ++col)
 			op(res, elems[row*cols + col]);
 		return res;
 	}
 	template <typename Op>
-	T col_op(size_t col, Op&& op, T res = 0) {
+	T col_op(size_t col, Op&& op, T res = 0) const {
 		for (size_t row = 0; row < rows; ++row)
 			op(res, elems[row*cols + col]);
 		return res;
@@ -118,13 +190,18 @@ public:
 	friend ostream& operator<<(ostream&, const Matrix<TT>&);
 	void print() const {std::cout << *this;}
 };
+// fixed matrices as operands of dynamic products without copying
+template <typename T, size_t R, size_t C>
+Matrix_view<const T> view(const Fixed_matrix<T,R,C>& a) {return {a.data(), R, C, C, 1};}
+
 // creation of matrices
-template <typename T>
+// the semiring's one on the diagonal and zero elsewhere, e.g. 0 and POS_INF for min plus
+template <typename T, typename S = Plus_times<T>>
 Matrix<T> identity(size_t size) {
-	vector<T> elems(size*size, 0);
+	vector<T> elems(size*size, S::zero());
 	Matrix<T> id {size, size, std::move(elems)};
 	for (size_t i = 0; i < size; ++i) {
-		id.get(i,i) = 1;
+		id.get(i,i) = S::one();
 	}
 	return id;
 }
@@ -152,40 +229,28 @@ Matrix<T>::Matrix(initializer_list<initializer_list<T>> a) : rows{a.size()}, col
 template <typename T>
 void Matrix<T>::rotate() {	// clockwise
 	if (rows != cols) {return rotate_copy();}	// else rotate in place for squares
-	int n = rows;	// rows == cols
-	for (int layer = 0; layer < n / 2; ++layer) {
-		int first = layer;
-		int last = n - 1 - layer;
-		for (int i = first; i < last; ++i) {
-			int offset = i - first;
-
-			// save top
-			T top = elems[first*cols + i];
-			// left -> top
-			elems[first*cols + i] = elems[(last - offset)*cols + first];
-			// bot -> left
-			elems[(last - offset)*cols + first] = elems[last*cols + (last - offset)];
-			// right -> bot
-			elems[last*cols + (last - offset)] = elems[i*cols + last];
-			// top -> right
-			elems[i*cols + last] = top;
-		}
-	}
+	// clockwise is the transpose with each row reversed, both walk memory in order
+	transpose_square(rows, elems.data(), cols);
+	for (size_t r = 0; r < rows; ++r) std::reverse(elems.begin() + r*cols, elems.begin() + (r+1)*cols);
 }
 
 template <typename T>
 void Matrix<T>::rotate_copy() {	// clockwise
-	std::vector<T> new_elems;
-	new_elems.reserve(elems.size());
-	// go up from the bottom of each column to become new row
-	for (size_t c = 0; c < cols; ++c) 
-		for (size_t r = rows; r != 0; --r)
-			new_elems.push_back(elems[(r - 1)*cols + c]);
-		
+	// new (i,j) is old (rows-1-j, i), so read from the bottom left going up each column
+	std::vector<T> new_elems(elems.size());
+	if (!elems.empty())
+		copy_strided(cols, rows, elems.data() + (rows - 1)*cols, 1, -static_cast<std::ptrdiff_t>(cols), 
+			new_elems.data(), rows, 1);
 	std::swap(cols, rows);
 	elems = std::move(new_elems);
 }
 
+template <typename T>
+void Matrix<T>::transpose_in_place() {
+	if (rows == cols) return transpose_square(rows, elems.data(), cols);
+	*this = transpose();
+}
+
 template <typename T>
 void Matrix<T>::clear_zero() {
 	std::set<size_t> rows_to_clear;
@@ -208,32 +273,31 @@ void Matrix<T>::clear_zero() {
 
 template <typename T>
 Matrix<T>& Matrix<T>::operator*=(T scalar) {
-	for (T elem : elems) elems *= scalar;
+	for (T& elem : elems) elem *= scalar;
 	return *this;
 }
 template <typename T>
 Matrix<T>& Matrix<T>::operator*=(const Matrix& a) {
+	return *this *= a.view();
+}
+template <typename T>
+Matrix<T>& Matrix<T>::operator*=(Matrix_view<const T> a) {
+	return multiply(a);
+}
+template <typename T>
+template <typename S>
+Matrix<T>& Matrix<T>::multiply(Matrix_view<const T> a) {
 	// m x n times n x p --> m x p
-	if (cols != a.rows) throw runtime_error("Invalid dimensions for matrix multiplication");
-	// an optimization that can lead to 4x speed up is to multiply by the transpose
-	// this way the inner loop can be sequential rather than jumping down rows
-	auto a_transpose = a.transpose();
-
-
-	vector<T> newelems;
-	newelems.reserve(rows*a.cols);
-	// naive O(n^3) algorithm, which works well for small matrices
-	for (size_t i = 0; i < rows; ++i) {
-		for (size_t j = 0; j < a.cols; ++j) {
-			T elem {0};
-			for (size_t k = 0; k < cols; ++k) {
-				elem += get(i, k) * a_transpose.get(j, k);
-			}
-			newelems.push_back(elem);
-		}
-	}
-	elems = newelems;
-	cols = a.cols;
+	if (cols != a.row()) throw runtime_error("Invalid dimensions for matrix multiplication");
+	// accumulate into a fresh buffer since a might view *this (pow)
+	// arithmetic types use the blocked kernel which packs panels of both operands, 
+	// packing reads through a's strides so transposed views cost no copy
+	// boolean semirings multiply packed bits, others fall back to the naive O(n^3) loop
+	vector<T> newelems(rows*a.col(), S::zero());
+	gemm<S>(rows, a.col(), cols, elems.data(), cols, 1, a.data(), a.row_stride(), a.col_stride(), 
+		newelems.data(), a.col(), 1);
+	elems = std::move(newelems);
+	cols = a.col();
 	return *this;
 }
 
@@ -250,15 +314,17 @@ Matrix<T>& Matrix<T>::operator-=(const Matrix& a) {
 	return *this;
 }
 template <typename T>
+template <typename S>
 Matrix<T>& Matrix<T>::pow(size_t exponent) {
-	Matrix<T> res {identity<T>(rows)};
-	while (exponent > 0) {
-		if (exponent & 1)	// odd exponent
-			res *= *this;
-		exponent >>= 1;
-		*this *= *this;
+	if (exponent == 0) return *this = identity<T,S>(rows);
+	// the lowest set bit starts the result, which saves a product with the identity
+	for (; !(exponent & 1); exponent >>= 1) multiply<S>(view());
+	Matrix<T> res {*this};
+	while (exponent >>= 1) {
+		multiply<S>(view());
+		if (exponent & 1) res.template multiply<S>(view());
 	}
-	*this = res;
+	*this = std::move(res);
 	return *this;
 }
 
@@ -282,6 +348,21 @@ Matrix<T> operator*(const Matrix<T>& a, const Matrix<T>& b) {
 	ret *= b;
 	return ret;
 }
+// product of any two layouts, e.g. a.transposed_view() * b.view() for a^T b
+template <typename T, typename U>
+Matrix<std::remove_const_t<T>> operator*(Matrix_view<T> a, Matrix_view<U> b) {
+	using R = std::remove_const_t<T>;
+	static_assert(std::is_same<R, std::remove_const_t<U>>::value, "views must have the same element type");
+	if (a.col() != b.row()) throw runtime_error("Invalid dimensions for matrix multiplication");
+	Matrix<R> res {a.row(), b.col()};
+	gemm(a.row(), b.col(), a.col(), static_cast<const R*>(a.data()), a.row_stride(), a.col_stride(), 
+		static_cast<const R*>(b.data()), b.row_stride(), b.col_stride(), res.data(), b.col(), 1);
+	return res;
+}
+template <typename T, typename U>
+Matrix<T> operator*(const Matrix<T>& a, Matrix_view<U> b) {return a.view() * b;}
+template <typename T, typename U>
+Matrix<T> operator*(Matrix_view<U> a, const Matrix<T>& b) {return a * b.view();}
 template <typename T>
 Matrix<T> operator+(const Matrix<T>& a, const Matrix<T>& b) {
 	Matrix<T> ret {a};
@@ -309,6 +390,111 @@ ostream& operator<<(ostream& os, const Matrix<T>& m) {
 	return os;
 }
 
+
+// execution policy overloads ------------
+// parallel versions split the output into blocks of rows run on the library's thread pool
+// below matrix_parallel_threshold elements of work they stay serial to avoid dispatch overhead
+constexpr size_t matrix_parallel_threshold = 1 << 16;
+
+// rows per task, a few tasks per worker so stealing can balance uneven blocks
+inline size_t matrix_row_grain(size_t rows, size_t min_rows = 8) {
+	size_t tasks {4 * Thread_pool::global().size()};
+	return std::max(min_rows, (rows + tasks - 1) / tasks);
+}
+
+// products over a semiring S, e.g. mul<Min_plus<int>>(a, b)
+template <typename S, typename T>
+Matrix<T> mul(const Matrix<T>& a, const Matrix<T>& b) {
+	Matrix<T> res {a};
+	res.template multiply<S>(b.view());
+	return res;
+}
+template <typename S, typename T>
+Matrix<T> mul(const Matrix<T>& a, const Matrix<T>& b, Sequential_policy) {return mul<S>(a, b);}
+template <typename S, typename T>
+Matrix<T> mul(const Matrix<T>& a, const Matrix<T>& b, Parallel_policy) {
+	if (a.col() != b.row()) throw runtime_error("Invalid dimensions for matrix multiplication");
+	size_t m {a.row()}, n {b.col()}, k {a.col()};
+	if (m * n * k < matrix_parallel_threshold) return mul<S>(a, b);
+	Matrix<T> res {m, n, S::zero()};
+	// each block of rows of the result only needs the same rows of a
+	parallel_for(0, m, matrix_row_grain(m, Gemm_tile<T>::mr * 4), [&](size_t lo, size_t hi) {
+		gemm<S>(hi - lo, n, k, a.data() + lo*k, k, 1, b.data(), n, 1, res.data() + lo*n, n, 1);
+	});
+	return res;
+}
+template <typename T>
+Matrix<T> mul(const Matrix<T>& a, const Matrix<T>& b, Sequential_policy) {return a * b;}
+template <typename T>
+Matrix<T> mul(const Matrix<T>& a, const Matrix<T>& b, Parallel_policy) {return mul<Plus_times<T>>(a, b, par);}
+
+// elementwise res = op(a, b) by blocks of rows
+template <typename T, typename Op>
+Matrix<T> elementwise(const Matrix<T>& a, const Matrix<T>& b, Op&& op, Parallel_policy) {
+	Matrix<T> res {a.row(), a.col()};
+	size_t cols {a.col()};
+	parallel_for(0, a.row(), matrix_row_grain(a.row()), [&](size_t lo, size_t hi) {
+		for (size_t i = lo*cols; i < hi*cols; ++i) res.data()[i] = op(a.data()[i], b.data()[i]);
+	});
+	return res;
+}
+
+template <typename T>
+Matrix<T> add(const Matrix<T>& a, const Matrix<T>& b, Sequential_policy) {return a + b;}
+template <typename T>
+Matrix<T> add(const Matrix<T>& a, const Matrix<T>& b, Parallel_policy) {
+	if (a.row() != b.row() || a.col() != b.col()) throw runtime_error("Invalid dimensions for matrix addition");
+	if (a.row() * a.col() < matrix_parallel_threshold) return a + b;
+	return elementwise(a, b, [](const T& x, const T& y) {return x + y;}, par);
+}
+template <typename T>
+Matrix<T> sub(const Matrix<T>& a, const Matrix<T>& b, Sequential_policy) {return a - b;}
+template <typename T>
+Matrix<T> sub(const Matrix<T>& a, const Matrix<T>& b, Parallel_policy) {
+	if (a.row() != b.row() || a.col() != b.col()) throw runtime_error("Invalid dimensions for matrix subtraction");
+	if (a.row() * a.col() < matrix_parallel_threshold) return a - b;
+	return elementwise(a, b, [](const T& x, const T& y) {return x - y;}, par);
+}
+
+template <typename T>
+Matrix<T> transpose(const Matrix<T>& a, Sequential_policy) {return a.transpose();}
+template <typename T>
+Matrix<T> transpose(const Matrix<T>& a, Parallel_policy) {
+	if (a.row() * a.col() < matrix_parallel_threshold) return a.transpose();
+	size_t rows {a.row()}, cols {a.col()};
+	Matrix<T> res {cols, rows};
+	// each block of output rows is a block of columns of a, copied by cache oblivious tiles
+	parallel_for(0, cols, matrix_row_grain(cols, 32), [&](size_t lo, size_t hi) {
+		transpose_copy(rows, hi - lo, a.data() + lo, cols, res.data() + lo*rows, rows);
+	});
+	return res;
+}
+
+// powers over a semiring S, pow<Min_plus<int>>(w, k) is the shortest walks of exactly k edges
+template <typename S, typename T>
+Matrix<T> pow(Matrix<T> a, size_t exponent) {
+	a.template pow<S>(exponent);
+	return a;
+}
+template <typename S, typename T>
+Matrix<T> pow(Matrix<T> a, size_t exponent, Sequential_policy) {return pow<S>(std::move(a), exponent);}
+template <typename S, typename T>
+Matrix<T> pow(Matrix<T> a, size_t exponent, Parallel_policy) {
+	if (exponent == 0) return identity<T,S>(a.row());
+	for (; !(exponent & 1); exponent >>= 1) a = mul<S>(a, a, par);
+	Matrix<T> res {a};
+	while (exponent >>= 1) {
+		a = mul<S>(a, a, par);
+		if (exponent & 1) res = mul<S>(res, a, par);
+	}
+	return res;
+}
+template <typename T>
+Matrix<T> pow(Matrix<T> a, size_t exponent, Sequential_policy) {return a.pow(exponent);}
+template <typename T>
+Matrix<T> pow(Matrix<T> a, size_t exponent, Parallel_policy) {return pow<Plus_times<T>>(std::move(a), exponent, par);}
+
+
 template <typename T>
 T row_sum(const Matrix<T>& mat, size_t row) {
 	return mat.row_op(row, [](T& res, const T& elem){res += elem;}, 0);
@@ -319,11 +505,11 @@ T col_sum(const Matrix<T>& mat, size_t col) {
 }
 template <typename T>
 T row_prod(const Matrix<T>& mat, size_t row) {
-	return mat.row_op(row, [](T& res, const T& elem){res *= elem;}, 0);
+	return mat.row_op(row, [](T& res, const T& elem){res *= elem;}, 1);
 }
 template <typename T>
 T col_prod(const Matrix<T>& mat, size_t col) {
-	return mat.col_op(col, [](T& res, const T& elem){res *= elem;}, 0);
+	return mat.col_op(col, [](T& res, const T& elem){res *= elem;}, 1);
 }	
 
 
@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// matrices whose dimensions are fixed at compile time, for small dense kernels (transforms, linear recurrences)
+// elements live inline in a std::array so nothing is allocated and everything is constexpr,
+// products and transposes expand into straight line code up to fixed_unroll_limit multiply adds,
+// and mismatched dimensions fail to compile instead of throwing
+// Matrix converts from these, and these convert from any matrix or view of the right size
+
+namespace sal {
+
+// products with more multiply adds than this stay loops to bound code size
+constexpr size_t fixed_unroll_limit = 64;
+
+template <typename T, size_t R, size_t C>
+class Fixed_matrix {
+	static_assert(R > 0 && C > 0, "fixed matrices need at least one row and column");
+	std::array<T, R*C> elems {};
+
+	template <typename U, size_t RR, size_t CC>
+	friend class Fixed_matrix;
+
+	// row i of a dotted with column j of b
+	template <size_t P, size_t... K>
+	static constexpr T dot(const Fixed_matrix& a, const Fixed_matrix<T,C,P>& b, size_t i, size_t j, std::index_sequence<K...>) {
+		return ((a.elems[i*C + K] * b.elems[K*P + j]) + ...);
+	}
+	template <size_t P, size_t... E>
+	static constexpr Fixed_matrix<T,R,P> product(const Fixed_matrix& a, const Fixed_matrix<T,C,P>& b, std::index_sequence<E...>) {
+		return Fixed_matrix<T,R,P>{dot<P>(a, b, E / P, E % P, std::make_index_sequence<C>{})...};
+	}
+	template <size_t P>
+	static constexpr Fixed_matrix<T,R,P> product(const Fixed_matrix& a, const Fixed_matrix<T,C,P>& b) {
+		if constexpr (R*C*P <= fixed_unroll_limit) return product(a, b, std::make_index_sequence<R*P>{});
+		else {
+			// k in the middle like gemm_naive so the inner loop streams rows of b and the result
+			Fixed_matrix<T,R,P> res;
+			for (size_t i = 0; i < R; ++i)
+				for (size_t k = 0; k < C; ++k) {
+					T a_ik {a.elems[i*C + k]};
+					for (size_t j = 0; j < P; ++j) res.elems[i*P + j] += a_ik * b.elems[k*P + j];
+				}
+			return res;
+		}
+	}
+	// element E of the transpose is (E / R, E % R), which is (E % R, E / R) here
+	template <size_t... E>
+	constexpr Fixed_matrix<T,C,R> transposed(std::index_sequence<E...>) const {
+		return Fixed_matrix<T,C,R>{elems[(E % R)*C + E / R]...};
+	}
+public:
+	using value_type = T;
+	using iterator = typename std::array<T, R*C>::iterator;
+	using const_iterator = typename std::array<T, R*C>::const_iterator;
+
+	// core methods
+	constexpr Fixed_matrix() = default;	// default init to 0
+	// exactly R*C elements in row major order
+	template <typename... U, typename = std::enable_if_t<sizeof...(U) == R*C && (std::is_convertible<U, T>::value && ...)>>
+	constexpr Fixed_matrix(U... values) : elems{{static_cast<T>(values)...}} {}
+	// copy of a dynamic matrix or view, whose size is only known at runtime
+	template <typename Mat, typename = decltype(std::declval<const Mat&>().get(0, 0))>
+	explicit Fixed_matrix(const Mat& m) {
+		if (m.row() != R || m.col() != C) throw std::runtime_error("Invalid dimensions for fixed matrix conversion");
+		for (size_t i = 0; i < R; ++i)
+			for (size_t j = 0; j < C; ++j) elems[i*C + j] = m.get(i, j);
+	}
+	static constexpr Fixed_matrix identity() {
+		static_assert(R == C, "identity matrices are square");
+		Fixed_matrix id;
+		for (size_t i = 0; i < R; ++i) id.elems[i*C + i] = 1;
+		return id;
+	}
+
+	// essential operators
+	constexpr Fixed_matrix& operator*=(T scalar) {
+		for (T& elem : elems) elem *= scalar;
+		return *this;
+	}
+	constexpr Fixed_matrix& operator*=(const Fixed_matrix<T,C,C>& a) {return *this = product(*this, a);}
+	constexpr Fixed_matrix& operator+=(const Fixed_matrix& a) {
+		for (size_t i = 0; i < R*C; ++i) elems[i] += a.elems[i];
+		return *this;
+	}
+	constexpr Fixed_matrix& operator-=(const Fixed_matrix& a) {
+		for (size_t i = 0; i < R*C; ++i) elems[i] -= a.elems[i];
+		return *this;
+	}
+	constexpr Fixed_matrix& pow(size_t exponent) {
+		static_assert(R == C, "only square matrices have powers");
+		Fixed_matrix res {identity()};
+		while (exponent > 0) {
+			if (exponent & 1) res = product(res, *this);
+			exponent >>= 1;
+			if (exponent) *this = product(*this, *this);
+		}
+		return *this = res;
+	}
+
+	template <size_t P>
+	friend constexpr Fixed_matrix<T,R,P> operator*(const Fixed_matrix& a, const Fixed_matrix<T,C,P>& b) {return product(a, b);}
+	friend constexpr Fixed_matrix operator+(Fixed_matrix a, const Fixed_matrix& b) {return a += b;}
+	friend constexpr Fixed_matrix operator-(Fixed_matrix a, const Fixed_matrix& b) {return a -= b;}
+	friend constexpr bool operator==(const Fixed_matrix& a, const Fixed_matrix& b) {
+		for (size_t i = 0; i < R*C; ++i) if (!(a.elems[i] == b.elems[i])) return false;
+		return true;
+	}
+	friend constexpr bool operator!=(const Fixed_matrix& a, const Fixed_matrix& b) {return !(a == b);}
+
+	constexpr T* operator[](size_t r) {return elems.data() + r*C;}
+	constexpr const T* operator[](size_t r) const {return elems.data() + r*C;}
+
+	// accessors ----------
+	static constexpr size_t row() {return R;}
+	static constexpr size_t col() {return C;}
+	constexpr T& get(size_t row, size_t col) {return elems[row*C + col];}
+	constexpr const T& get(size_t row, size_t col) const {return elems[row*C + col];}
+	// row major contiguous storage
+	constexpr T* data() {return elems.data();}
+	constexpr const T* data() const {return elems.data();}
+	constexpr iterator begin() {return elems.begin();}
+	constexpr iterator end() {return elems.end();}
+	constexpr const_iterator begin() const {return elems.begin();}
+	constexpr const_iterator end() const {return elems.end();}
+
+	// manipulators -------
+	constexpr Fixed_matrix<T,C,R> transpose() const {return transposed(std::make_index_sequence<R*C>{});}
+};
+
+template <typename T, size_t N>
+constexpr Fixed_matrix<T,N,N> pow(Fixed_matrix<T,N,N> a, size_t exponent) {return a.pow(exponent);}
+
+template <typename T, size_t R, size_t C>
+std::ostream& operator<<(std::ostream& os, const Fixed_matrix<T,R,C>& m) {
+	for (size_t i = 0; i < R; ++i) {
+		for (size_t j = 0; j < C; ++j) {
+			os << std::setw(5);
+			if (m.get(i,j) == std::numeric_limits<T>::max()) os << "inf";
+			else os << m.get(i,j);
+			os << ' ';
+		}
+		os << '\n';
+	}
+	return os;
+}
+
+}	// end namespace sal
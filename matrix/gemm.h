@@ -0,0 +1,291 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "semiring.h"
+
+// general matrix multiply C += A * B on strided operands, or C = C (+) A (x) B over any semiring
+// element (i,j) of an operand p lives at p[i*rs + j*cs], so row major, column major and transposed
+// views all go through the same code
+// arithmetic types use a cache blocked algorithm:
+// 	B is packed into NR wide column panels (kept in L3/L2), A into MR tall row panels (kept in L2/L1),
+//	and an MR x NR micro-kernel keeps its block of C in registers while streaming the panels
+// the micro-kernel is compiled once per instruction set (AVX2, AVX-512) and picked at runtime
+// boolean semirings pack both operands one bit per element and OR whole rows of B, 64 columns per word
+// other types (Infint) use the naive loop
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SAL_GEMM_DISPATCH
+#define SAL_GEMM_INLINE inline __attribute__((always_inline))
+#else
+#define SAL_GEMM_INLINE inline
+#endif
+
+namespace sal {
+
+// naive O(mnk), k in the middle loop so the inner loop streams rows of B and C
+template <typename T, typename S = Plus_times<T>>
+void gemm_naive(size_t m, size_t n, size_t k,
+	const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs,
+	T* c, size_t c_rs, size_t c_cs) {
+	for (size_t i = 0; i < m; ++i)
+		for (size_t p = 0; p < k; ++p) {
+			const T& a_ip = a[i*a_rs + p*a_cs];
+			for (size_t j = 0; j < n; ++j)
+				c[i*c_rs + j*c_cs] = S::plus(c[i*c_rs + j*c_cs], S::times(a_ip, b[p*b_rs + j*b_cs]));
+		}
+}
+
+// register tile sized for 16 vector registers of 256 bits, NR doubled for 512 bits
+// MC x KC panel of A fits in L2, KC x NR sliver of B in L1
+template <typename T, size_t Width = 32>
+struct Gemm_tile {
+	static constexpr size_t mr = 6;
+	// two vectors wide, clamped for very small or large T
+	static constexpr size_t nr = 2 * Width / sizeof(T) < 4? 4 : 2 * Width / sizeof(T) > 32? 32 : 2 * Width / sizeof(T);
+	static constexpr size_t kc = 256;
+	static constexpr size_t mc = mr * 20;
+	static constexpr size_t nc = nr * 256;
+};
+
+// pack mc x kc block of A into MR tall panels, each stored column by column
+// rows past the end are filled with the semiring's zero so the micro-kernel never branches
+template <size_t MR, typename S, typename T>
+SAL_GEMM_INLINE void gemm_pack_a(size_t mc, size_t kc, const T* a, size_t rs, size_t cs, T* packed) {
+	for (size_t i = 0; i < mc; i += MR) {
+		size_t rows {std::min(MR, mc - i)};
+		for (size_t p = 0; p < kc; ++p) {
+			for (size_t r = 0; r < rows; ++r) *packed++ = a[(i + r)*rs + p*cs];
+			for (size_t r = rows; r < MR; ++r) *packed++ = S::zero();
+		}
+	}
+}
+// pack kc x nc block of B into NR wide panels, each stored row by row
+template <size_t NR, typename S, typename T>
+SAL_GEMM_INLINE void gemm_pack_b(size_t kc, size_t nc, const T* b, size_t rs, size_t cs, T* packed) {
+	for (size_t j = 0; j < nc; j += NR) {
+		size_t cols {std::min(NR, nc - j)};
+		for (size_t p = 0; p < kc; ++p) {
+			for (size_t c = 0; c < cols; ++c) *packed++ = b[p*rs + (j + c)*cs];
+			for (size_t c = cols; c < NR; ++c) *packed++ = S::zero();
+		}
+	}
+}
+
+// C[0..m, 0..n] += packed A panel * packed B panel, m <= MR, n <= NR
+// accumulators are a fixed size array the compiler keeps in vector registers,
+// for min plus the multiply-add becomes an add (and infinity check) and a min, which vectorize the same way
+template <size_t MR, size_t NR, typename S, typename T>
+SAL_GEMM_INLINE void gemm_micro_kernel(size_t kc, const T* a, const T* b,
+	T* c, size_t rs, size_t cs, size_t m, size_t n) {
+	T acc[MR][NR];
+	for (size_t i = 0; i < MR; ++i)
+		for (size_t j = 0; j < NR; ++j)
+			acc[i][j] = S::zero();
+	for (size_t p = 0; p < kc; ++p) {
+		for (size_t i = 0; i < MR; ++i)
+			for (size_t j = 0; j < NR; ++j)
+				acc[i][j] = S::plus(acc[i][j], S::times(a[i], b[j]));
+		a += MR;
+		b += NR;
+	}
+	if (m == MR && n == NR && cs == 1) {
+		for (size_t i = 0; i < MR; ++i)
+			for (size_t j = 0; j < NR; ++j)
+				c[i*rs + j] = S::plus(c[i*rs + j], acc[i][j]);
+	}
+	// partial tile on the edges
+	else {
+		for (size_t i = 0; i < m; ++i)
+			for (size_t j = 0; j < n; ++j)
+				c[i*rs + j*cs] = S::plus(c[i*rs + j*cs], acc[i][j]);
+	}
+}
+
+template <typename Tile, typename S, typename T>
+SAL_GEMM_INLINE void gemm_blocked(size_t m, size_t n, size_t k,
+	const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs,
+	T* c, size_t c_rs, size_t c_cs) {
+	constexpr size_t MR {Tile::mr}, NR {Tile::nr};
+	// panel buffers reused across blocks
+	std::vector<T> packed_a (Tile::mc * Tile::kc);
+	std::vector<T> packed_b (((std::min(n, Tile::nc) + NR - 1) / NR) * NR * Tile::kc);
+
+	for (size_t jc = 0; jc < n; jc += Tile::nc) {
+		size_t nc {std::min(Tile::nc, n - jc)};
+		for (size_t pc = 0; pc < k; pc += Tile::kc) {
+			size_t kc {std::min(Tile::kc, k - pc)};
+			gemm_pack_b<NR,S>(kc, nc, b + pc*b_rs + jc*b_cs, b_rs, b_cs, packed_b.data());
+
+			for (size_t ic = 0; ic < m; ic += Tile::mc) {
+				size_t mc {std::min(Tile::mc, m - ic)};
+				gemm_pack_a<MR,S>(mc, kc, a + ic*a_rs + pc*a_cs, a_rs, a_cs, packed_a.data());
+
+				for (size_t jr = 0; jr < nc; jr += NR)
+					for (size_t ir = 0; ir < mc; ir += MR)
+						gemm_micro_kernel<MR,NR,S>(kc, packed_a.data() + ir*kc, packed_b.data() + jr*kc,
+							c + (ic + ir)*c_rs + (jc + jr)*c_cs, c_rs, c_cs,
+							std::min(MR, mc - ir), std::min(NR, nc - jr));
+			}
+		}
+	}
+}
+
+// per instruction set instantiations, the whole blocked loop is inlined so packing also uses them
+template <typename T, typename S = Plus_times<T>>
+void gemm_generic(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	gemm_blocked<Gemm_tile<T>, S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+#ifdef SAL_GEMM_DISPATCH
+template <typename T, typename S = Plus_times<T>>
+__attribute__((target("avx2,fma")))
+void gemm_avx2(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	gemm_blocked<Gemm_tile<T>, S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+template <typename T, typename S = Plus_times<T>>
+__attribute__((target("avx512f,avx2,fma")))
+void gemm_avx512(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	gemm_blocked<Gemm_tile<T,64>, S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+#endif
+
+template <typename T>
+using Gemm_fn = void (*)(size_t, size_t, size_t, const T*, size_t, size_t,
+	const T*, size_t, size_t, T*, size_t, size_t);
+
+// best kernel the cpu supports, checked once
+template <typename T, typename S = Plus_times<T>>
+Gemm_fn<T> gemm_dispatch() {
+#ifdef SAL_GEMM_DISPATCH
+	static const Gemm_fn<T> fn {
+		__builtin_cpu_supports("avx512f")? &gemm_avx512<T,S> :
+		(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))? &gemm_avx2<T,S> :
+		&gemm_generic<T,S>};
+	return fn;
+#else
+	return &gemm_generic<T,S>;
+#endif
+}
+
+// boolean products on bit packed rows ----------
+// row i of C |= row p of B for every bit p set in row i of A, so the work is one OR per 64 columns
+// rows are words long and stride words apart, bits past the last column must be clear
+// the OR goes in chunks of a fixed width like the micro-kernel so it vectorizes at -O2
+using Gemm_bits = std::uint64_t;
+constexpr size_t gemm_bits_width = 64;
+constexpr size_t gemm_bits_lanes = 8;
+
+inline size_t gemm_bits_words(size_t bits) {return (bits + gemm_bits_width - 1) / gemm_bits_width;}
+
+template <size_t W>
+SAL_GEMM_INLINE void gemm_or_words(Gemm_bits* __restrict c, const Gemm_bits* __restrict b) {
+	for (size_t w = 0; w < W; ++w) c[w] |= b[w];
+}
+// m rows of A with k bits each, B has k rows and C m rows of words each
+SAL_GEMM_INLINE void gemm_bits_kernel(size_t m, size_t k, size_t words,
+	const Gemm_bits* a, size_t a_stride, const Gemm_bits* b, size_t b_stride, Gemm_bits* c, size_t c_stride) {
+	for (size_t i = 0; i < m; ++i) {
+		const Gemm_bits* a_i {a + i*a_stride};
+		Gemm_bits* c_i {c + i*c_stride};
+		for (size_t aw = 0; aw < gemm_bits_words(k); ++aw)
+			for (Gemm_bits set {a_i[aw]}; set; set &= set - 1) {
+				const Gemm_bits* b_p {b + (aw*gemm_bits_width + __builtin_ctzll(set))*b_stride};
+				size_t w {0};
+				for (; w + gemm_bits_lanes <= words; w += gemm_bits_lanes) gemm_or_words<gemm_bits_lanes>(c_i + w, b_p + w);
+				for (; w < words; ++w) gemm_or_words<1>(c_i + w, b_p + w);
+			}
+	}
+}
+
+inline void gemm_bits_generic(size_t m, size_t k, size_t words,
+	const Gemm_bits* a, size_t a_stride, const Gemm_bits* b, size_t b_stride, Gemm_bits* c, size_t c_stride) {
+	gemm_bits_kernel(m, k, words, a, a_stride, b, b_stride, c, c_stride);
+}
+#ifdef SAL_GEMM_DISPATCH
+__attribute__((target("avx2")))
+inline void gemm_bits_avx2(size_t m, size_t k, size_t words,
+	const Gemm_bits* a, size_t a_stride, const Gemm_bits* b, size_t b_stride, Gemm_bits* c, size_t c_stride) {
+	gemm_bits_kernel(m, k, words, a, a_stride, b, b_stride, c, c_stride);
+}
+__attribute__((target("avx512f,avx2")))
+inline void gemm_bits_avx512(size_t m, size_t k, size_t words,
+	const Gemm_bits* a, size_t a_stride, const Gemm_bits* b, size_t b_stride, Gemm_bits* c, size_t c_stride) {
+	gemm_bits_kernel(m, k, words, a, a_stride, b, b_stride, c, c_stride);
+}
+#endif
+
+using Gemm_bits_fn = void (*)(size_t, size_t, size_t, const Gemm_bits*, size_t, const Gemm_bits*, size_t, Gemm_bits*, size_t);
+
+inline Gemm_bits_fn gemm_bits_dispatch() {
+#ifdef SAL_GEMM_DISPATCH
+	static const Gemm_bits_fn fn {
+		__builtin_cpu_supports("avx512f")? &gemm_bits_avx512 :
+		__builtin_cpu_supports("avx2")? &gemm_bits_avx2 : &gemm_bits_generic};
+	return fn;
+#else
+	return &gemm_bits_generic;
+#endif
+}
+
+// dense boolean product through bits, nonzero elements of A and B are true
+// C keeps its true elements and gains a 1 wherever the product is true
+template <typename T>
+void gemm_boolean(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	size_t k_words {gemm_bits_words(k)}, n_words {gemm_bits_words(n)};
+	std::vector<Gemm_bits> a_bits(m * k_words), b_bits(k * n_words), c_bits(m * n_words);
+	auto pack = [](size_t rows, size_t cols, const T* p, size_t rs, size_t cs, Gemm_bits* bits, size_t stride) {
+		for (size_t i = 0; i < rows; ++i)
+			for (size_t j = 0; j < cols; ++j)
+				bits[i*stride + j/gemm_bits_width] |= Gemm_bits{p[i*rs + j*cs] != T(0)} << (j % gemm_bits_width);
+	};
+	pack(m, k, a, a_rs, a_cs, a_bits.data(), k_words);
+	pack(k, n, b, b_rs, b_cs, b_bits.data(), n_words);
+	gemm_bits_dispatch()(m, k, n_words, a_bits.data(), k_words, b_bits.data(), n_words, c_bits.data(), n_words);
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j)
+			if (c_bits[i*n_words + j/gemm_bits_width] >> (j % gemm_bits_width) & 1) c[i*c_rs + j*c_cs] = T(1);
+}
+
+// below this many multiply-adds packing costs more than it saves
+constexpr size_t gemm_small = 16 * 16 * 16;
+
+template <typename T, typename S = Plus_times<T>>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs, std::true_type) {
+	if (m * n * k <= gemm_small) gemm_naive<T,S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+	else gemm_dispatch<T,S>()(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+template <typename T, typename S = Plus_times<T>>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs, std::false_type) {
+	gemm_naive<T,S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+
+// C (m x n) = C (+) A (m x k) (x) B (k x n) over the semiring S, e.g. gemm<Min_plus<int>>(...)
+// C must not alias A or B
+template <typename S, typename T>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	if constexpr (Is_boolean_semiring<S>::value) {
+		if (m * n * k <= gemm_small) gemm_naive<T,S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+		else gemm_boolean(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+	}
+	else gemm<T,S>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs,
+		std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>{});
+}
+// C (m x n) += A (m x k) * B (k x n), C must not alias A or B
+template <typename T>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t a_rs, size_t a_cs,
+	const T* b, size_t b_rs, size_t b_cs, T* c, size_t c_rs, size_t c_cs) {
+	gemm<Plus_times<T>>(m, n, k, a, a_rs, a_cs, b, b_rs, b_cs, c, c_rs, c_cs);
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <limits>
+#include <type_traits>
+
+// semirings for matrix products and powers: C = C (+) A (x) B, with plus, times, zero and one in place of +, *, 0 and 1
+// zero is the identity of plus and absorbs under times, one is the identity of times,
+// so the same repeated squaring answers different questions about an adjacency matrix
+//	Plus_times	ordinary arithmetic, the k-th power of a 0/1 matrix counts walks of k edges
+//	Min_plus	tropical, the k-th power of a weight matrix is the shortest walks of k edges
+//	Or_and		boolean, the k-th power is reachability in exactly k steps
+// everything is static and inline so the blocked kernel vectorizes them like multiply-adds
+
+namespace sal {
+
+template <typename T>
+struct Plus_times {
+	static T zero() {return T(0);}
+	static T one() {return T(1);}
+	static T plus(const T& a, const T& b) {return a + b;}
+	static T times(const T& a, const T& b) {return a * b;}
+};
+
+// zero is POS_INF (numeric limits max) like the missing edges of Adjacency_matrix and unreachable pairs of All_pairs
+// integers check for it so it stays infinite instead of overflowing; floating point needs no check
+// since POS_INF plus any sane weight rounds to POS_INF or overflows to inf, and min keeps POS_INF over inf
+template <typename T>
+struct Min_plus {
+	static T zero() {return std::numeric_limits<T>::max();}
+	static T one() {return T(0);}
+	static T plus(const T& a, const T& b) {return b < a? b : a;}
+	static T times(const T& a, const T& b) {
+		if constexpr (std::is_floating_point<T>::value) return a + b;
+		else return a == zero() || b == zero()? zero() : a + b;
+	}
+};
+
+// any nonzero element is true, products are 0 or 1
+// dense operands are packed to bits and multiplied 64 columns per word operation
+template <typename T>
+struct Or_and {
+	static T zero() {return T(0);}
+	static T one() {return T(1);}
+	static T plus(const T& a, const T& b) {return T(a != T(0) || b != T(0));}
+	static T times(const T& a, const T& b) {return T(a != T(0) && b != T(0));}
+};
+
+template <typename S>
+struct Is_boolean_semiring : std::false_type {};
+template <typename T>
+struct Is_boolean_semiring<Or_and<T>> : std::true_type {};
+
+}	// end namespace sal
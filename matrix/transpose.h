@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// cache oblivious copies between strided layouts
+// element (i,j) of an operand p lives at p[i*rs + j*cs] like in gemm, strides may be negative
+// so transposes (swapped strides), rotations (a negative stride) and views all share one kernel
+// blocks are halved along their longer side until they fit in cache, so both the reads and the writes
+// touch a small set of cache lines at a time whatever the cache sizes are
+
+namespace sal {
+
+// below this many elements a block is copied directly, 32 x 32 doubles read and written fit in L1
+constexpr size_t transpose_block = 32 * 32;
+
+// dst(i,j) = src(i,j) over an r x c block
+template <typename T>
+void copy_strided(size_t r, size_t c, const T* src, std::ptrdiff_t src_rs, std::ptrdiff_t src_cs,
+	T* dst, std::ptrdiff_t dst_rs, std::ptrdiff_t dst_cs) {
+	while (r * c > transpose_block) {
+		if (r >= c) {
+			size_t h {r / 2};
+			copy_strided(h, c, src, src_rs, src_cs, dst, dst_rs, dst_cs);
+			src += static_cast<std::ptrdiff_t>(h) * src_rs;
+			dst += static_cast<std::ptrdiff_t>(h) * dst_rs;
+			r -= h;
+		}
+		else {
+			size_t h {c / 2};
+			copy_strided(r, h, src, src_rs, src_cs, dst, dst_rs, dst_cs);
+			src += static_cast<std::ptrdiff_t>(h) * src_cs;
+			dst += static_cast<std::ptrdiff_t>(h) * dst_cs;
+			c -= h;
+		}
+	}
+	for (size_t i = 0; i < r; ++i) {
+		const T* s {src + static_cast<std::ptrdiff_t>(i) * src_rs};
+		T* d {dst + static_cast<std::ptrdiff_t>(i) * dst_rs};
+		for (size_t j = 0; j < c; ++j) d[static_cast<std::ptrdiff_t>(j) * dst_cs] = s[static_cast<std::ptrdiff_t>(j) * src_cs];
+	}
+}
+
+// dst = transpose of the r x c row major src, dst rows are ld_dst apart
+template <typename T>
+void transpose_copy(size_t r, size_t c, const T* src, size_t ld_src, T* dst, size_t ld_dst) {
+	copy_strided(c, r, src, 1, static_cast<std::ptrdiff_t>(ld_src), dst, static_cast<std::ptrdiff_t>(ld_dst), 1);
+}
+
+// swap the r x c block a with the transpose of the c x r block b, rows of both are ld apart
+template <typename T>
+void transpose_swap(size_t r, size_t c, T* a, T* b, size_t ld) {
+	while (r * c > transpose_block) {
+		if (r >= c) {
+			size_t h {r / 2};
+			transpose_swap(h, c, a, b, ld);
+			a += h * ld;
+			b += h;
+			r -= h;
+		}
+		else {
+			size_t h {c / 2};
+			transpose_swap(r, h, a, b, ld);
+			a += h;
+			b += h * ld;
+			c -= h;
+		}
+	}
+	for (size_t i = 0; i < r; ++i)
+		for (size_t j = 0; j < c; ++j) std::swap(a[i*ld + j], b[j*ld + i]);
+}
+
+// in place transpose of the n x n block a: transpose both diagonal quadrants,
+// then swap the off diagonal ones through each other's transpose
+template <typename T>
+void transpose_square(size_t n, T* a, size_t ld) {
+	if (n * n <= transpose_block) {
+		for (size_t i = 0; i < n; ++i)
+			for (size_t j = i + 1; j < n; ++j) std::swap(a[i*ld + j], a[j*ld + i]);
+		return;
+	}
+	size_t h {n / 2};
+	transpose_square(h, a, ld);
+	transpose_square(n - h, a + h*ld + h, ld);
+	transpose_swap(h, n - h, a + h, a + h*ld, ld);
+}
+
+}
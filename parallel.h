@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sal {
+
+// execution policies for algorithms with parallel overloads
+struct Sequential_policy {};
+struct Parallel_policy {};
+constexpr Sequential_policy seq {};
+constexpr Parallel_policy par {};
+
+
+// work stealing thread pool
+// each worker owns a deque, pushing and popping its own tasks at the back (most recent, cache warm)
+// idle workers steal the oldest tasks from the front of other deques
+// threads outside the pool spread submissions across the deques
+class Thread_pool {
+	using Task = std::function<void()>;
+	struct Worker_queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker_queue>> queues;
+	std::vector<std::thread> workers;
+	// number of tasks waiting in all queues
+	std::atomic<size_t> queued {0};
+	std::atomic<size_t> next_queue {0};
+	std::mutex idle_mutex;
+	std::condition_variable idle;
+	bool stopping {false};
+
+	// identifies the calling thread's queue if it's one of this pool's workers
+	static Thread_pool*& current_pool() {static thread_local Thread_pool* pool {nullptr}; return pool;}
+	static size_t& current_id() 		{static thread_local size_t id {0}; return id;}
+
+	bool pop(size_t id, Task& task) {
+		if (queued.load(std::memory_order_acquire) == 0) return false;
+		// own queue from the back
+		{
+			Worker_queue& own = *queues[id];
+			std::lock_guard<std::mutex> lock {own.mutex};
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				--queued;
+				return true;
+			}
+		}
+		// steal from the front of the others
+		for (size_t i = 1; i < queues.size(); ++i) {
+			Worker_queue& victim = *queues[(id + i) % queues.size()];
+			std::lock_guard<std::mutex> lock {victim.mutex};
+			if (!victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				--queued;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void work(size_t id) {
+		current_pool() = this;
+		current_id() = id;
+		Task task;
+		while (true) {
+			if (pop(id, task)) {task(); task = nullptr; continue;}
+			std::unique_lock<std::mutex> lock {idle_mutex};
+			idle.wait(lock, [this]{return stopping || queued.load() > 0;});
+			if (stopping && queued.load() == 0) return;
+		}
+	}
+
+public:
+	explicit Thread_pool(size_t threads = std::thread::hardware_concurrency()) {
+		threads = std::max<size_t>(threads, 1);
+		for (size_t i = 0; i < threads; ++i) queues.emplace_back(new Worker_queue);
+		for (size_t i = 0; i < threads; ++i) workers.emplace_back(&Thread_pool::work, this, i);
+	}
+	~Thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock {idle_mutex};
+			stopping = true;
+		}
+		idle.notify_all();
+		for (auto& worker : workers) worker.join();
+	}
+	Thread_pool(const Thread_pool&) = delete;
+	Thread_pool& operator=(const Thread_pool&) = delete;
+
+	// pool owned by the library, one worker per hardware thread
+	static Thread_pool& global() {
+		static Thread_pool pool;
+		return pool;
+	}
+
+	size_t size() const {return workers.size();}
+
+	void submit(Task task) {
+		size_t id {current_pool() == this? current_id() : next_queue++ % queues.size()};
+		{
+			Worker_queue& queue = *queues[id];
+			std::lock_guard<std::mutex> lock {queue.mutex};
+			queue.tasks.push_back(std::move(task));
+		}
+		++queued;
+		// taking the lock orders this against a worker about to sleep
+		{std::lock_guard<std::mutex> lock {idle_mutex};}
+		idle.notify_one();
+	}
+
+	// run one waiting task on the calling thread, false if there were none
+	bool try_run_one() {
+		Task task;
+		size_t id {current_pool() == this? current_id() : next_queue.load() % queues.size()};
+		if (!pop(id, task)) return false;
+		task();
+		return true;
+	}
+};
+
+
+// fork join on a pool, wait() runs other tasks while children are unfinished
+// so nested groups (tasks that fork their own) can't deadlock the pool
+// first exception thrown by a task is rethrown by wait()
+class Task_group {
+	Thread_pool& pool;
+	std::atomic<size_t> pending {0};
+	std::exception_ptr error;
+	std::mutex error_mutex;
+public:
+	explicit Task_group(Thread_pool& p = Thread_pool::global()) : pool(p) {}
+	Task_group(const Task_group&) = delete;
+	~Task_group() {
+		while (pending.load() != 0)
+			if (!pool.try_run_one()) std::this_thread::yield();
+	}
+
+	template <typename F>
+	void run(F&& f) {
+		++pending;
+		pool.submit([this, f]() {
+			try {f();}
+			catch (...) {
+				std::lock_guard<std::mutex> lock {error_mutex};
+				if (!error) error = std::current_exception();
+			}
+			--pending;
+		});
+	}
+
+	void wait() {
+		while (pending.load() != 0)
+			if (!pool.try_run_one()) std::this_thread::yield();
+		if (error) {
+			std::exception_ptr e {error};
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+};
+
+
+// calls f(lo, hi) on chunks of at most grain elements covering [begin, end)
+// runs serially if the range fits in one chunk
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& f, Thread_pool& pool = Thread_pool::global()) {
+	if (begin >= end) return;
+	grain = std::max<size_t>(grain, 1);
+	if (end - begin <= grain || pool.size() == 1) {f(begin, end); return;}
+	Task_group group {pool};
+	for (size_t lo = begin + grain; lo < end; lo += grain) {
+		size_t hi {std::min(lo + grain, end)};
+		group.run([&f, lo, hi]() {f(lo, hi);});
+	}
+	// calling thread takes the first chunk
+	f(begin, std::min(begin + grain, end));
+	group.wait();
+}
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sal {
+
+// node allocators for the linked structures (trees, treaps, lists)
+// interface:
+//	create(args...) constructs a node and returns a pointer to it
+//	destroy(node) destroys and frees a single node
+//	release() frees every node at once without running destructors (no-op if bulk_release is false)
+//	exclusive() true if release() is safe for the container's nodes (no other container shares them)
+//	share(other), absorb(other) let containers exchange nodes (see Node_pool)
+
+// hands out nodes from contiguous chunks, freed nodes are reused through an intrusive free list
+// chunks start small and double so small containers stay small, up to max_chunk nodes per chunk
+// nodes allocated together stay close together, and release is O(chunks) instead of O(n)
+// containers that trade nodes (treap split and join) share one arena through share(),
+// the arena lives until its last pool is released; a shared arena is locked from then on
+// so the containers sharing it can be modified on different threads, unshared ones skip the lock
+template <typename Node>
+class Node_pool {
+	// free slots reuse their storage as the link
+	union Slot {
+		Slot* next;
+		alignas(Node) unsigned char storage[sizeof(Node)];
+	};
+	static constexpr size_t first_chunk = 8;
+	static constexpr size_t max_chunk = 1 << 14;
+
+	struct Arena {
+		std::vector<std::unique_ptr<Slot[]>> chunks;
+		Slot* free_list {nullptr};
+		// unused tail of the newest chunk
+		Slot* next_slot {nullptr};
+		Slot* chunk_end {nullptr};
+		size_t chunk_size {first_chunk};
+		size_t allocated {0};
+		// arenas still shared elsewhere whose nodes were absorbed, kept alive with this one
+		std::vector<std::shared_ptr<Arena>> adopted;
+		// set by the first share(), before any other pool holds the arena, and never cleared
+		bool shared {false};
+		std::mutex mutex;
+
+		std::unique_lock<std::mutex> guard() {
+			return shared? std::unique_lock<std::mutex>{mutex} : std::unique_lock<std::mutex>{};
+		}
+
+		void grow() {
+			chunks.emplace_back(new Slot[chunk_size]);
+			next_slot = chunks.back().get();
+			chunk_end = next_slot + chunk_size;
+			allocated += chunk_size;
+			chunk_size = std::min(chunk_size << 1, max_chunk);
+		}
+		Slot* grab() {
+			if (free_list) {
+				Slot* slot {free_list};
+				free_list = slot->next;
+				return slot;
+			}
+			if (next_slot == chunk_end) grow();
+			return next_slot++;
+		}
+		void put_back(Slot* slot) {
+			slot->next = free_list;
+			free_list = slot;
+		}
+	};
+	// created on first allocation
+	std::shared_ptr<Arena> arena;
+
+	Arena& get_arena() {
+		if (!arena) arena = std::make_shared<Arena>();
+		return *arena;
+	}
+
+public:
+	static constexpr bool bulk_release = true;
+
+	Node_pool() = default;
+	Node_pool(const Node_pool&) = delete;
+	Node_pool& operator=(const Node_pool&) = delete;
+	Node_pool(Node_pool&&) noexcept = default;
+	Node_pool& operator=(Node_pool&&) noexcept = default;
+
+	template <typename... Args>
+	Node* create(Args&&... args) {
+		Arena& a {get_arena()};
+		Slot* slot;
+		{auto lock = a.guard(); slot = a.grab();}
+		try {return new (slot->storage) Node(std::forward<Args>(args)...);}
+		catch (...) {auto lock = a.guard(); a.put_back(slot); throw;}
+	}
+	void destroy(Node* node) {
+		node->~Node();
+		auto lock = arena->guard();
+		arena->put_back(reinterpret_cast<Slot*>(node));
+	}
+	// drops this pool's hold on the arena, which frees every node if no other pool shares it
+	void release() {arena.reset();}
+	// true if release() frees the nodes, otherwise they have to be destroyed one by one
+	bool exclusive() const {return arena.use_count() <= 1;}
+
+	// allocate from other's arena from now on, assumes this pool holds no nodes
+	void share(Node_pool& other) {
+		Arena& a {other.get_arena()};
+		if (!a.shared) a.shared = true;
+		arena = other.arena;
+	}
+	// take ownership of the nodes of other, which is left empty
+	void absorb(Node_pool& other) {
+		if (!other.arena || other.arena == arena) {other.release(); return;}
+		if (!arena) {arena = std::move(other.arena); return;}
+		auto lock = arena->guard();
+		if (other.arena.use_count() > 1) {
+			arena->adopted.push_back(std::move(other.arena));
+			return;
+		}
+		// sole owner, splice its chunks and free slots into ours (its chunk tail is abandoned)
+		{
+			Arena& from {*other.arena};
+			auto from_lock = from.guard();
+			for (auto& chunk : from.chunks) arena->chunks.push_back(std::move(chunk));
+			while (from.free_list) {
+				Slot* slot {from.free_list};
+				from.free_list = slot->next;
+				arena->put_back(slot);
+			}
+			for (auto& adopted : from.adopted) arena->adopted.push_back(std::move(adopted));
+			arena->allocated += from.allocated;
+		}
+		other.arena.reset();
+	}
+
+	// number of node slots owned, used or free
+	size_t capacity() const {
+		if (!arena) return 0;
+		auto lock = arena->guard();
+		return arena->allocated;
+	}
+};
+
+// plain new and delete for every node
+template <typename Node>
+struct New_allocator {
+	static constexpr bool bulk_release = false;
+
+	template <typename... Args>
+	Node* create(Args&&... args) {return new Node(std::forward<Args>(args)...);}
+	void destroy(Node* node) {delete node;}
+	void release() {}
+	bool exclusive() const {return true;}
+	void share(New_allocator&) {}
+	void absorb(New_allocator&) {}
+};
+
+}
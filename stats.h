@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+// operation counters for tuning, chosen at compile time
+// visitors, heaps and trees take a Stats policy that defaults to No_stats, whose members are empty
+// so uninstrumented code compiles to what it was; Op_stats counts every operation and can sample the
+// latency of phases (a settled vertex, a bellman ford pass), readable after each call to export
+
+namespace sal {
+
+enum class Stat : size_t {
+	relax,		// edge relaxations tried
+	improve,	// relaxations that shortened a distance
+	settle,		// vertices finalized off a priority queue (dijkstra, prim)
+	pass,		// bellman ford passes over every edge
+	discover,	// vertices discovered by dfs
+	back_edge,	// dfs edges to an ancestor
+	sift_up,	// levels items moved up or down a heap
+	sift_down,
+	rotate,		// tree rotations, from insert and delete fixups and treap heap fixes
+	count_of
+};
+constexpr size_t stat_count = static_cast<size_t>(Stat::count_of);
+
+inline const char* stat_name(Stat stat) {
+	constexpr const char* names[stat_count] {"relax", "improve", "settle", "pass", "discover", "back_edge",
+		"sift_up", "sift_down", "rotate"};
+	return names[static_cast<size_t>(stat)];
+}
+
+// disabled, everything optimizes away
+struct No_stats {
+	// nontrivial destructor so scoped timings don't warn as unused
+	struct Timing {~Timing() {}};
+	void count(Stat, size_t = 1) {}
+	Timing time(Stat) {return {};}
+};
+
+// counts of every Stat, and with Sample_every = k the latency of every k-th timed phase of each kind
+// (0 times nothing, timing each phase costs two clock reads)
+template <size_t Sample_every = 0>
+class Op_stats {
+	std::array<size_t, stat_count> counts {};
+	std::array<size_t, stat_count> timed {};		// phases the samples were taken from
+	std::array<size_t, stat_count> samples {};
+	std::array<double, stat_count> sampled {};		// total nanoseconds of the samples
+public:
+	using clk = std::chrono::steady_clock;
+	// records how long it lives when sampling
+	class Timing {
+		Op_stats* stats {nullptr};
+		Stat stat;
+		clk::time_point start;
+	public:
+		Timing() = default;
+		Timing(Op_stats* s, Stat st) : stats{s}, stat{st}, start{clk::now()} {}
+		Timing(const Timing&) = delete;
+		Timing& operator=(const Timing&) = delete;
+		~Timing() {
+			if (!stats) return;
+			size_t i {static_cast<size_t>(stat)};
+			++stats->samples[i];
+			stats->sampled[i] += std::chrono::duration<double, std::nano>(clk::now() - start).count();
+		}
+	};
+
+	void count(Stat stat, size_t n = 1) {counts[static_cast<size_t>(stat)] += n;}
+	Timing time(Stat stat) {
+		if (Sample_every == 0 || timed[static_cast<size_t>(stat)]++ % (Sample_every? Sample_every : 1)) return {};
+		return {this, stat};
+	}
+
+	size_t operator[](Stat stat) const {return counts[static_cast<size_t>(stat)];}
+	size_t sample_count(Stat stat) const {return samples[static_cast<size_t>(stat)];}
+	// mean nanoseconds of the sampled phases, 0 if none were
+	double latency(Stat stat) const {
+		size_t i {static_cast<size_t>(stat)};
+		return samples[i]? sampled[i] / samples[i] : 0;
+	}
+	void reset() {*this = Op_stats{};}
+	// f(name, count) for every nonzero count, for exporting
+	template <typename F>
+	void for_each(F&& f) const {
+		for (size_t i = 0; i < stat_count; ++i) if (counts[i]) f(stat_name(static_cast<Stat>(i)), counts[i]);
+	}
+	Op_stats& operator+=(const Op_stats& other) {
+		for (size_t i = 0; i < stat_count; ++i) {
+			counts[i] += other.counts[i];
+			timed[i] += other.timed[i];
+			samples[i] += other.samples[i];
+			sampled[i] += other.sampled[i];
+		}
+		return *this;
+	}
+};
+
+// counts into stats kept elsewhere, so an algorithm's visitor and the heap it makes share counters
+template <typename Stats>
+class Stats_ref {
+	Stats* stats;
+public:
+	Stats_ref(Stats& s) : stats{&s} {}
+	void count(Stat stat, size_t n = 1) {stats->count(stat, n);}
+	auto time(Stat stat) {return stats->time(stat);}
+};
+template <typename Stats>
+using Shared_stats = std::conditional_t<std::is_same<std::remove_const_t<Stats>, No_stats>::value, No_stats, Stats_ref<Stats>>;
+
+// a visitor's stats member, or ones that count nothing for visitors without
+template <typename Visitor, typename = void>
+struct Has_stats : std::false_type {};
+template <typename Visitor>
+struct Has_stats<Visitor, std::void_t<decltype(std::declval<Visitor&>().stats)>> : std::true_type {};
+
+template <typename Visitor>
+auto& visitor_stats(Visitor& visitor) {
+	if constexpr (Has_stats<Visitor>::value) return visitor.stats;
+	else {
+		static No_stats none;
+		return none;
+	}
+}
+
+}	// end namespace sal
@@ -0,0 +1,487 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>	// hardware counters
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// benchmark harness for the profiles in dataprofile.cpp
+// a benchmark is run once for every requested size (and key distribution if it draws keys),
+// each of its phases is timed over warmup and repeated trials, reporting the median and percentiles
+// so claims like "4 times faster insert" can be rerun and compared, and the results can be written
+// as one json object per line to diff between commits
+// a phase's body gets the trial, work before trial.start() and after trial.stop() is untimed,
+// so phases that consume what they are given rebuild it every trial without counting it
+
+namespace sal {
+
+enum class Key_dist {sequential, random, zipf};
+
+inline const char* key_dist_name(Key_dist dist) {
+	switch (dist) {
+		case Key_dist::sequential: return "sequential";
+		case Key_dist::random: return "random";
+		default: return "zipf";
+	}
+}
+
+// n keys in [0, n) drawn from a distribution with a fixed seed, so every run sees the same keys
+// sequential is 0..n-1 in order, random is uniform with repeats, zipf has the rank r key drawn
+// with probability proportional to 1/r^theta (the small keys are the popular ones)
+// zipf is Gray et al.'s constant time sampler, needing only the normalizing zeta(n)
+inline std::vector<int> bench_keys(size_t n, Key_dist dist, uint64_t seed, double theta = 0.99) {
+	std::vector<int> keys(n);
+	if (n < 2) return keys;
+	if (dist == Key_dist::sequential) {
+		for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i);
+		return keys;
+	}
+	std::mt19937_64 gen {seed};
+	if (dist == Key_dist::random) {
+		std::uniform_int_distribution<int> uniform {0, static_cast<int>(n) - 1};
+		for (int& key : keys) key = uniform(gen);
+		return keys;
+	}
+	double zetan {0};
+	for (size_t i = 1; i <= n; ++i) zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+	double zeta2 {1.0 + std::pow(0.5, theta)};
+	double alpha {1.0 / (1.0 - theta)};
+	double eta {(1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan)};
+	std::uniform_real_distribution<double> unit {0.0, 1.0};
+	for (int& key : keys) {
+		double u {unit(gen)}, uz {u * zetan};
+		size_t rank {uz < 1.0? 0 : uz < zeta2? 1 : static_cast<size_t>(n * std::pow(eta*u - eta + 1.0, alpha))};
+		key = static_cast<int>(std::min(rank, n - 1));
+	}
+	return keys;
+}
+
+// keeps a result alive so the work producing it is not optimized away
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+
+// hardware counters through perf_event_open, opened as one group so they count over the same instructions
+// counters the machine or its permissions (perf_event_paranoid, containers) refuse are left out
+class Perf_counters {
+	struct Counter {
+		const char* name;
+		int fd;
+	};
+	std::vector<Counter> counters;
+	int leader {-1};
+public:
+	static constexpr const char* names[] {"cycles", "instructions", "cache_misses", "branch_misses"};
+	Perf_counters() {
+#ifdef __linux__
+		const uint64_t configs[] {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+		for (size_t i = 0; i < 4; ++i) {
+			perf_event_attr attr {};
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[i];
+			attr.disabled = leader < 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			int fd {static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0))};
+			if (fd < 0) continue;
+			if (leader < 0) leader = fd;
+			counters.push_back({names[i], fd});
+		}
+#endif
+	}
+	Perf_counters(const Perf_counters&) = delete;
+	Perf_counters& operator=(const Perf_counters&) = delete;
+	~Perf_counters() {
+#ifdef __linux__
+		for (const Counter& counter : counters) ::close(counter.fd);
+#endif
+	}
+
+	bool available() const {return leader >= 0;}
+	size_t size() const {return counters.size();}
+	const char* name(size_t i) const {return counters[i].name;}
+
+	void start() {
+#ifdef __linux__
+		if (leader < 0) return;
+		::ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		::ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+	void stop() {
+#ifdef __linux__
+		if (leader >= 0) ::ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+	// counts since the last start, in the order of name(i)
+	std::vector<uint64_t> read() const {
+		std::vector<uint64_t> values(counters.size(), 0);
+#ifdef __linux__
+		if (leader < 0) return values;
+		// group read format is the number of counters followed by their values
+		std::vector<uint64_t> buffer(counters.size() + 1, 0);
+		if (::read(leader, buffer.data(), buffer.size() * sizeof(uint64_t)) > 0)
+			for (size_t i = 0; i < counters.size() && i < buffer[0]; ++i) values[i] = buffer[i + 1];
+#endif
+		return values;
+	}
+};
+
+
+struct Bench_config {
+	std::vector<size_t> sizes;						// replaces every benchmark's own sizes when given
+	double scale {1.0};								// multiplies every benchmark's own sizes
+	std::vector<Key_dist> dists {Key_dist::random};	// for benchmarks drawing keys
+	size_t warmup {1};
+	size_t trials {5};
+	bool counters {false};
+	bool list {false};
+	uint64_t seed {42};
+	std::vector<std::string> filters;				// benchmarks whose name contains any of them, all when empty
+	std::string json;								// file the results are written to
+};
+
+// one timed phase of one benchmark at one size and distribution, times in nanoseconds
+struct Bench_result {
+	std::string benchmark, phase, dist;
+	size_t size {0}, items {0}, trials {0};
+	double min {0}, p10 {0}, median {0}, p90 {0}, max {0}, mean {0};
+	std::vector<std::pair<std::string, double>> counters;	// medians over the trials
+	std::vector<std::pair<std::string, double>> notes;		// values the benchmark reports, like results to check
+};
+
+// linear interpolation between the closest ranks of sorted values
+inline double bench_percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty()) return 0;
+	double rank {p * (sorted.size() - 1)};
+	size_t low {static_cast<size_t>(rank)};
+	if (low + 1 >= sorted.size()) return sorted.back();
+	return sorted[low] + (rank - low) * (sorted[low + 1] - sorted[low]);
+}
+
+
+// timed region of a single trial, the whole body when start and stop are not called
+class Bench_trial {
+	using clk = std::chrono::steady_clock;
+	clk::time_point begin;
+	double elapsed {0};
+	bool running {false}, used {false};
+	Perf_counters* perf;
+	std::vector<uint64_t> counts;
+public:
+	explicit Bench_trial(Perf_counters* p) : perf{p}, counts(p? p->size() : 0, 0) {}
+	void start() {
+		used = running = true;
+		if (perf) perf->start();
+		begin = clk::now();
+	}
+	void stop() {
+		if (!running) return;
+		auto end = clk::now();
+		if (perf) {
+			perf->stop();
+			std::vector<uint64_t> values {perf->read()};
+			for (size_t i = 0; i < counts.size(); ++i) counts[i] += values[i];
+		}
+		elapsed += std::chrono::duration<double, std::nano>(end - begin).count();
+		running = false;
+	}
+	bool started() const {return used;}
+	double nanoseconds() const {return elapsed;}
+	const std::vector<uint64_t>& counters() const {return counts;}
+};
+
+
+// what a benchmark sees of the run it is part of
+class Bench_state {
+	std::string bench;
+	size_t n;
+	Key_dist key_dist;
+	const Bench_config& config;
+	Perf_counters* perf;
+	std::vector<Bench_result>& results;
+	std::vector<int> drawn, probed;
+	std::mt19937_64 gen;
+	size_t first_result;	// notes only attach to this benchmark's phases
+public:
+	Bench_state(std::string name, size_t size, Key_dist dist, const Bench_config& c, Perf_counters* p,
+		std::vector<Bench_result>& out) :
+		bench{std::move(name)}, n{size}, key_dist{dist}, config{c}, perf{p}, results{out},
+		gen{c.seed + size}, first_result{out.size()} {}
+
+	size_t size() const {return n;}
+	Key_dist dist() const {return key_dist;}
+	// size keys from the distribution, the same for every phase
+	const std::vector<int>& keys() {
+		if (drawn.size() != n) drawn = bench_keys(n, key_dist, config.seed);
+		return drawn;
+	}
+	// another independent draw from the distribution, for lookups
+	const std::vector<int>& probes() {
+		if (probed.size() != n) probed = bench_keys(n, key_dist, config.seed ^ 0x9e3779b97f4a7c15ull);
+		return probed;
+	}
+	// seeded generator for building inputs
+	std::mt19937_64& rng() {return gen;}
+	int randint(int high) {return std::uniform_int_distribution<int>{0, high}(gen);}
+
+	// body() or body(trial) over warmup and trials, items is the work done per trial (size by default)
+	template <typename Body>
+	void run(const std::string& phase, Body&& body, size_t items = 0) {
+		std::vector<double> times;
+		std::vector<std::vector<double>> counts(perf? perf->size() : 0);
+		for (size_t t = 0; t < config.warmup + config.trials; ++t) {
+			Bench_trial trial {perf};
+			if constexpr (std::is_invocable<Body&, Bench_trial&>::value) {
+				body(trial);
+				if (!trial.started()) throw std::logic_error(bench + " " + phase + " never started its trial");
+			}
+			else {
+				trial.start();
+				body();
+			}
+			trial.stop();
+			if (t < config.warmup) continue;
+			times.push_back(trial.nanoseconds());
+			for (size_t i = 0; i < counts.size(); ++i) counts[i].push_back(static_cast<double>(trial.counters()[i]));
+		}
+
+		Bench_result result;
+		result.benchmark = bench;
+		result.phase = phase;
+		result.dist = key_dist_name(key_dist);
+		result.size = n;
+		result.items = items? items : n;
+		result.trials = times.size();
+		std::sort(times.begin(), times.end());
+		if (!times.empty()) {
+			result.min = times.front();
+			result.max = times.back();
+			double total {0};
+			for (double time : times) total += time;
+			result.mean = total / times.size();
+		}
+		result.p10 = bench_percentile(times, 0.1);
+		result.median = bench_percentile(times, 0.5);
+		result.p90 = bench_percentile(times, 0.9);
+		for (size_t i = 0; i < counts.size(); ++i) {
+			std::sort(counts[i].begin(), counts[i].end());
+			result.counters.emplace_back(perf->name(i), bench_percentile(counts[i], 0.5));
+		}
+		results.push_back(std::move(result));
+	}
+
+	// attach a value to the last phase run, to check results or explain times (matches found, vertices settled)
+	void note(const std::string& name, double value) {
+		if (results.size() == first_result) throw std::logic_error(bench + " noted " + name + " before running a phase");
+		results.back().notes.emplace_back(name, value);
+	}
+};
+
+
+inline std::string bench_json_string(const std::string& s) {
+	std::string quoted {"\""};
+	for (char c : s) {
+		if (c == '"' || c == '\\') quoted += '\\';
+		quoted += c;
+	}
+	return quoted + '"';
+}
+
+inline std::string bench_json(const Bench_result& r) {
+	std::ostringstream out;
+	out << std::setprecision(12);
+	out << "{\"benchmark\": " << bench_json_string(r.benchmark) << ", \"phase\": " << bench_json_string(r.phase)
+		<< ", \"size\": " << r.size << ", \"dist\": " << bench_json_string(r.dist) << ", \"items\": " << r.items
+		<< ", \"trials\": " << r.trials << ", \"min_ns\": " << r.min << ", \"p10_ns\": " << r.p10
+		<< ", \"median_ns\": " << r.median << ", \"p90_ns\": " << r.p90 << ", \"max_ns\": " << r.max
+		<< ", \"mean_ns\": " << r.mean;
+	auto object = [&](const char* name, const std::vector<std::pair<std::string, double>>& values) {
+		if (values.empty()) return;
+		out << ", \"" << name << "\": {";
+		for (size_t i = 0; i < values.size(); ++i)
+			out << (i? ", " : "") << bench_json_string(values[i].first) << ": " << values[i].second;
+		out << '}';
+	};
+	object("counters", r.counters);
+	object("notes", r.notes);
+	out << '}';
+	return out.str();
+}
+
+
+// registered benchmarks run by filter, size and distribution
+class Bench_suite {
+	struct Bench {
+		std::string name;
+		std::vector<size_t> sizes;
+		bool keyed;
+		std::function<void(Bench_state&)> body;
+	};
+	std::vector<Bench> benches;
+	std::vector<Bench_result> all;
+
+	static bool selected(const std::string& name, const Bench_config& config) {
+		if (config.filters.empty()) return true;
+		for (const std::string& filter : config.filters)
+			if (name.find(filter) != std::string::npos) return true;
+		return false;
+	}
+	static void print(std::ostream& out, const Bench_result& r) {
+		out << "  " << std::left << std::setw(36) << r.phase << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << r.median / 1e6 << std::setw(12) << r.p10 / 1e6 << std::setw(12) << r.p90 / 1e6
+			<< std::setprecision(2) << std::setw(12) << r.median / r.items;
+		for (const auto& counter : r.counters) out << std::setw(16) << counter.second / r.items;
+		for (const auto& note : r.notes) out << "  " << note.first << ' ' << std::setprecision(0) << note.second;
+		out << std::defaultfloat << '\n';
+	}
+public:
+	// body(state) runs at each of sizes, keyed ones once per requested key distribution
+	template <typename Body>
+	void add(std::string name, std::vector<size_t> sizes, bool keyed, Body&& body) {
+		benches.push_back({std::move(name), std::move(sizes), keyed, std::forward<Body>(body)});
+	}
+
+	const std::vector<Bench_result>& results() const {return all;}
+
+	void run(const Bench_config& config, std::ostream& out = std::cout) {
+		if (config.list) {
+			for (const Bench& bench : benches) if (selected(bench.name, config)) out << bench.name << '\n';
+			return;
+		}
+		std::unique_ptr<Perf_counters> perf;
+		if (config.counters) {
+			perf.reset(new Perf_counters);
+			if (!perf->available()) {
+				out << "hardware counters unavailable (check perf_event_paranoid), timing only\n";
+				perf.reset();
+			}
+		}
+		std::ofstream json;
+		if (!config.json.empty()) {
+			json.open(config.json);
+			if (!json) throw std::runtime_error("Cannot write " + config.json);
+		}
+		for (const Bench& bench : benches) {
+			if (!selected(bench.name, config)) continue;
+			std::vector<size_t> sizes {config.sizes.empty()? bench.sizes : config.sizes};
+			std::vector<Key_dist> dists {bench.keyed? config.dists : std::vector<Key_dist>{Key_dist::sequential}};
+			for (size_t size : sizes) {
+				if (config.sizes.empty()) size = std::max<size_t>(1, static_cast<size_t>(size * config.scale));
+				for (Key_dist dist : dists) {
+					size_t first {all.size()};
+					out << bench.name << " n=" << size;
+					if (bench.keyed) out << ' ' << key_dist_name(dist);
+					out << '\n' << "  " << std::left << std::setw(36) << "phase" << std::right << std::setw(12)
+						<< "median ms" << std::setw(12) << "p10 ms" << std::setw(12) << "p90 ms" << std::setw(12) << "ns/item";
+					if (perf) for (size_t i = 0; i < perf->size(); ++i) out << std::setw(16) << std::string{perf->name(i)} + "/item";
+					out << '\n';
+					Bench_state state {bench.name, size, dist, config, perf.get(), all};
+					bench.body(state);
+					for (size_t r = first; r < all.size(); ++r) {
+						if (!bench.keyed) all[r].dist = "none";
+						print(out, all[r]);
+						if (json) json << bench_json(all[r]) << '\n';
+					}
+					out << std::endl;
+				}
+			}
+		}
+	}
+};
+
+
+inline std::vector<std::string> bench_split(const std::string& list) {
+	std::vector<std::string> parts;
+	std::string part;
+	std::istringstream in {list};
+	while (std::getline(in, part, ',')) if (!part.empty()) parts.push_back(part);
+	return parts;
+}
+
+inline const char* bench_usage() {
+	return "options:\n"
+		"  --filter a,b      only benchmarks whose name contains a or b\n"
+		"  --sizes 1000,1e6  sizes to run every selected benchmark at instead of its own\n"
+		"  --scale 0.1       multiply every benchmark's own sizes\n"
+		"  --dist d,...      key distributions: sequential, random, zipf or all (default random)\n"
+		"  --trials 5        timed trials per phase\n"
+		"  --warmup 1        untimed trials before them\n"
+		"  --seed 42         seed of every key and input\n"
+		"  --counters        hardware counters through perf_event_open\n"
+		"  --json file       one json result per line\n"
+		"  --list            names of the selected benchmarks\n";
+}
+
+// command line as above, throws invalid_argument on anything else
+inline Bench_config bench_config(int argc, char** argv) {
+	Bench_config config;
+	auto number = [](const std::string& text) {
+		size_t used {0};
+		double value {std::stod(text, &used)};
+		if (used != text.size() || value < 0) throw std::invalid_argument("bad number " + text);
+		return value;
+	};
+	for (int i = 1; i < argc; ++i) {
+		std::string arg {argv[i]};
+		auto value = [&]() -> std::string {
+			if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+			return argv[++i];
+		};
+		if (arg == "--filter") config.filters = bench_split(value());
+		else if (arg == "--sizes") {
+			config.sizes.clear();
+			for (const std::string& size : bench_split(value())) config.sizes.push_back(static_cast<size_t>(number(size)));
+		}
+		else if (arg == "--scale") config.scale = number(value());
+		else if (arg == "--dist") {
+			config.dists.clear();
+			for (const std::string& dist : bench_split(value())) {
+				if (dist == "sequential") config.dists.push_back(Key_dist::sequential);
+				else if (dist == "random") config.dists.push_back(Key_dist::random);
+				else if (dist == "zipf") config.dists.push_back(Key_dist::zipf);
+				else if (dist == "all") config.dists.insert(config.dists.end(), {Key_dist::sequential, Key_dist::random, Key_dist::zipf});
+				else throw std::invalid_argument("unknown distribution " + dist);
+			}
+		}
+		else if (arg == "--trials") config.trials = std::max<size_t>(1, static_cast<size_t>(number(value())));
+		else if (arg == "--warmup") config.warmup = static_cast<size_t>(number(value()));
+		else if (arg == "--seed") config.seed = static_cast<uint64_t>(number(value()));
+		else if (arg == "--counters") config.counters = true;
+		else if (arg == "--json") config.json = value();
+		else if (arg == "--list") config.list = true;
+		else throw std::invalid_argument("unknown option " + arg);
+	}
+	return config;
+}
+
+}	// end namespace sal
@@ -1,264 +1,922 @@
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <set>
+#include "benchmark.h"
 #include "../matrix.h"
 #include "../vector.h"
+#include "../list.h"
 #include "../tree.h"
 #include "../interval.h"
-#include "../../algo/utility.h"
+#include "../graph.h"
+#include "../graph/search.h"
+#include "../graph/shortest.h"
+#include "../graph/dynamic.h"
+#include "../graph/mapped.h"
 
 using namespace std;
 using namespace sal;
-constexpr int test_size = 10000000;
+
+// every profile is a benchmark in the suite at the bottom, run it with --filter and see bench_usage for the rest
+// sizes below are each benchmark's own, the old fixed test size was 10000000
 
 // higher level framework
 template <typename Indexable>
-void profile_indexable(Indexable&& table) {
-	Timer time;
-	int sum {0};
-	for (int i = 0; i < test_size; ++i)
-		sum += table[randint(test_size-1)];
-	cout << "random reads: " << time.tonow() / 1000.0 << " sum val " << sum << endl;
+void profile_indexable(Bench_state& s, Indexable& table) {
+	const vector<int>& index {s.keys()};
+	s.run("keyed reads", [&] {
+		int sum {0};
+		for (int i : index) sum += table[i];
+		do_not_optimize(sum);
+	});
+	s.run("keyed writes", [&] {for (int i : index) table[i] = 0;});
+}
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i)
-		table[randint(test_size-1)] = 0;
-	cout << "random writes: " << time.tonow() / 1000.0 << endl;
+// make() gives a new empty vector with the size reserved
+template <typename Vector, typename Make>
+void profile_vector(Bench_state& s, Make&& make) {
+	int n {static_cast<int>(s.size())};
+	auto filled = [&] {
+		Vector vec(make());
+		for (int i = 0; i < n; ++i) vec.push_back(i);
+		return vec;
+	};
+	s.run("initialization", [&](Bench_trial& trial) {
+		Vector vec(make());
+		trial.start();
+		for (int i = 0; i < n; ++i) vec.push_back(i);
+		trial.stop();
+	});
+	Vector table(filled());
+	profile_indexable(s, table);
+
+	s.run("sequential push back", [&](Bench_trial& trial) {
+		Vector vec(filled());
+		trial.start();
+		for (int i = 0; i < n; ++i) vec.push_back(i);
+		trial.stop();
+	});
+	s.run("sequential emplace back", [&](Bench_trial& trial) {
+		Vector vec(filled());
+		trial.start();
+		for (int i = 0; i < n; ++i) vec.emplace_back(i);
+		trial.stop();
+	});
+	s.run("iteration write", [&] {for (auto& elem : table) elem = 0;});
 }
 
-template <typename Vector>
-void profile_vector(Vector&& vec) {
-	Timer time;
-	for (int i = 0; i < test_size; ++i)
-		vec.push_back(i);
-	cout << "sequential push back: " << time.tonow() / 1000.0 << endl;
+template <typename Set>
+void profile_set(Bench_state& s) {
+	const vector<int>& keys {s.keys()};
+	const vector<int>& probes {s.probes()};
+	auto fill = [&](Set& set) {for (int key : keys) set.insert(key);};
+	s.run("insert", [&](Bench_trial& trial) {
+		Set set;
+		trial.start();
+		fill(set);
+		trial.stop();
+	});
+	s.run("reverse order insert", [&](Bench_trial& trial) {
+		Set set;
+		trial.start();
+		for (auto key = keys.rbegin(); key != keys.rend(); ++key) set.insert(*key);
+		trial.stop();
+	});
+
+	Set single_set;
+	fill(single_set);
+	s.run("iteration", [&] {
+		long long sum {0};
+		for (auto& elem : single_set) sum += elem;
+		do_not_optimize(sum);
+	});
+	s.run("find", [&] {
+		for (int key : probes) do_not_optimize(single_set.find(key));
+	});
+	s.run("find nearby", [&] {
+		for (size_t i = 0; i < probes.size(); i += 5)
+			for (int j = 0; j < 5; ++j) do_not_optimize(single_set.find(probes[i] + j));
+	});
+
+	s.run("clear", [&](Bench_trial& trial) {
+		Set set;
+		fill(set);
+		trial.start();
+		set.clear();
+		trial.stop();
+	});
+	s.run("erase", [&](Bench_trial& trial) {
+		Set set;
+		fill(set);
+		trial.start();
+		for (int key : keys) set.erase(key);
+		trial.stop();
+	});
+}
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i)
-		vec.emplace_back(i);
-	cout << "sequential emplace back: " << time.tonow() / 1000.0 << endl;
+// path copied versions cost an allocation per level, against the plain treap's set profile
+void profile_persistent_treap(Bench_state& s) {
+	const vector<int>& keys {s.keys()};
+	const vector<int>& probes {s.probes()};
+	auto fill = [&](Persistent_treap<int>& set) {for (int key : keys) set.insert(key);};
+	s.run("insert", [&](Bench_trial& trial) {
+		Persistent_treap<int> set;
+		trial.start();
+		fill(set);
+		trial.stop();
+	});
+
+	Persistent_treap<int> single_set;
+	fill(single_set);
+	s.run("snapshot iteration", [&] {
+		auto snap = single_set.snapshot();
+		long long sum {0};
+		for (int elem : snap) sum += elem;
+		do_not_optimize(sum);
+	});
+	s.run("snapshot find", [&] {
+		auto snap = single_set.snapshot();
+		for (int key : probes) do_not_optimize(snap.find(key));
+	});
+	// a reader scanning snapshots while the writer churns, items are the writes
+	s.run("writes under scanning reader", [&] {
+		std::atomic<bool> done {false};
+		std::thread reader {[&] {
+			while (!done.load()) {
+				auto snap = single_set.snapshot();
+				long long sum {0};
+				for (int elem : snap) sum += elem;
+				do_not_optimize(sum);
+			}
+		}};
+		for (size_t i = 0; i < probes.size(); ++i) {
+			if (i & 1) single_set.insert(probes[i]);
+			else single_set.erase(probes[i]);
+		}
+		done = true;
+		reader.join();
+	}, probes.size());
+
+	s.run("erase", [&](Bench_trial& trial) {
+		Persistent_treap<int> set;
+		fill(set);
+		trial.start();
+		for (int key : keys) set.erase(key);
+		trial.stop();
+	});
+}
 
-	time.restart();
-	for (auto& elem : vec) elem = 0;
-	cout << "iteration write: " << time.tonow() / 1000.0 << endl;
+template <typename T>
+vector<T> profile_values(Bench_state& s, size_t count, int high) {
+	vector<T> values(count);
+	for (T& value : values) value = static_cast<T>(s.randint(high));
+	return values;
 }
 
-template <typename Set>
-void profile_set(Set& single_set) {
-	Timer time;
-	for (int i = 0; i < test_size; ++i)
-		single_set.insert(i);
-	cout << "sequential insert: " << time.tonow() / 1000.0 << endl;
-
-	time.restart();
-	for (auto& elem : single_set) (void)elem;
-	cout << "iteration: " << time.tonow() / 1000.0 << endl;	
-
-	time.restart();
-	single_set.clear();
-	cout << "clear: " << time.tonow() / 1000.0 << endl;
-
-	time.restart();
-	for (int i = test_size - 1; i >= 0; --i)
-		single_set.insert(i);
-	cout << "reverse order insert: " << time.tonow() / 1000.0 << endl;
-
-	time.restart();
-	int find_start = randint(test_size - 1);
-	for (int i = 0; i < test_size; ++i)
-		single_set.find((find_start + i) % test_size);
-	cout << "find: " << time.tonow() / 1000.0 << endl;
-	
-	time.restart();
-	for (int i = 0; i < test_size; i += 5) {
-		for (int j = 0; j < 5; ++j) single_set.find((find_start + i) % test_size);
-	}
-	cout << "find nearby: " << time.tonow() / 1000.0 << endl;
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i)
-		single_set.erase(i);
-	cout << "erase: " << time.tonow() / 1000.0 << endl;
+// specific implementations to test
+void profile_persistent_vector(Bench_state& s) {
+	size_t n {s.size()};
+	profile_vector<Persistent_vector<int>>(s, [n] {return Persistent_vector<int>(n);});
 }
 
+void profile_fixed_vector(Bench_state& s) {
+	size_t n {s.size()};
+	// capacity is fixed, leave room for pushing twice as many after initialization
+	profile_vector<Fixed_vector<int>>(s, [n] {return Fixed_vector<int>(3 * n);});
+	s.run("additional reservation", [&](Bench_trial& trial) {
+		Fixed_vector<int> table(n);
+		for (size_t i = 0; i < n; ++i) table.push_back(static_cast<int>(i));
+		trial.start();
+		table.reserve(3 * n);
+		trial.stop();
+	});
+}
+
+void profile_std_vector(Bench_state& s) {
+	size_t n {s.size()};
+	profile_vector<vector<int>>(s, [n] {
+		vector<int> table;
+		table.reserve(n);
+		return table;
+	});
+}
+
+// growing from empty, where the growth strategy matters
+template <typename Vector, typename Make>
+void profile_growth(Bench_state& s, const char* name, Make&& make) {
+	int n {static_cast<int>(s.size())};
+	s.run(name, [&](Bench_trial& trial) {
+		Vector vec;
+		trial.start();
+		for (int i = 0; i < n; ++i) vec.emplace_back(make(i));
+		trial.stop();
+	});
+}
+
+void profile_vector_growth(Bench_state& s) {
+	auto number = [](int i) {return i;};
+	profile_growth<Persistent_vector<int>>(s, "persistent vector", number);
+	profile_growth<Fast_vector<int>>(s, "fast vector", number);
+	profile_growth<Fast_vector<int, Huge_page_allocator<int>>>(s, "fast vector huge pages", number);
+	profile_growth<vector<int>>(s, "std vector", number);
+	auto text = [](int i) {return std::string(i & 15, 'a');};
+	profile_growth<Fast_vector<std::string>>(s, "fast vector strings", text);
+	profile_growth<vector<std::string>>(s, "std vector strings", text);
+}
+
+// message log use: appending, scanning, loading from a stream and dropping repeats
+template <typename List>
+void profile_log(Bench_state& s, const std::string& name, const std::string& text) {
+	size_t n {s.size()};
+	List log;
+	s.run(name + " append", [&](Bench_trial& trial) {
+		List fresh;
+		trial.start();
+		for (size_t i = 0; i < n; ++i) fresh.push_back(static_cast<int>(i));
+		trial.stop();
+		log = std::move(fresh);
+	});
+	s.run(name + " scan", [&] {
+		long long sum {0};
+		for (int v : log) sum += v;
+		do_not_optimize(sum);
+	});
+	s.run(name + " stream load", [&](Bench_trial& trial) {
+		std::istringstream is {text};
+		List loaded;
+		trial.start();
+		int v;
+		while (is >> v) loaded.push_back(v);
+		trial.stop();
+		do_not_optimize(loaded);
+	});
+}
+// adapts the list interface to the std one profile_log uses
+template <typename T>
+struct Profile_unrolled : Unrolled_list<T> {
+	void push_back(T d) {this->append(d);}
+};
+
+void profile_list(Bench_state& s) {
+	std::ostringstream os;
+	for (size_t i = 0; i < s.size(); ++i) os << s.randint(1000) << ' ';
+	profile_log<std::list<int>>(s, "std list", os.str());
+	profile_log<Profile_unrolled<int>>(s, "unrolled list", os.str());
+
+	std::istringstream is {os.str()};
+	Unrolled_list<int> log;
+	is >> log;
+	s.run("unrolled list remove dup", [&](Bench_trial& trial) {
+		Unrolled_list<int> copy {log};
+		trial.start();
+		copy.remove_dup();
+		trial.stop();
+	});
+}
+
+// square matrices of the size, repeated so each trial does about 10^8 multiply adds
+void profile_mat_mul(Bench_state& s) {
+	size_t N {s.size()};
+	Matrix<int> A {N, N, profile_values<int>(s, N*N, (int)N)};
+	Matrix<int> B {N, N, profile_values<int>(s, N*N, (int)N)};
+	size_t reps {std::max<size_t>(1, 100000000 / (N*N*N))};
+
+	s.run("multiplication", [&] {
+		for (size_t i = 0; i < reps; ++i) do_not_optimize(A * B);
+	}, reps);
+	s.run("parallel multiplication", [&] {
+		for (size_t i = 0; i < reps; ++i) do_not_optimize(mul(A, B, par));
+	}, reps);
+}
+
+// size many small products, the allocation and runtime dimensions dominate at these sizes
+void profile_fixed_matrix(Bench_state& s) {
+	size_t n {s.size()};
+	vector<double> values {profile_values<double>(s, 16, 3)};
+	for (double& value : values) value = value / 4 + 0.25;
+	Matrix<double> transform {4, 4, vector<double>{values}};
+	Fixed_matrix<double, 4, 4> fixed_transform {transform};
+
+	s.run("4x4 dynamic transforms", [&] {
+		Matrix<double> res {sal::identity<double>(4)};
+		for (size_t i = 0; i < n; ++i) {
+			res *= transform;
+			res *= 0.25;
+		}
+		do_not_optimize(res.get(0, 0));
+	}, n);
+	s.run("4x4 fixed transforms", [&] {
+		Fixed_matrix<double, 4, 4> res {Fixed_matrix<double, 4, 4>::identity()};
+		for (size_t i = 0; i < n; ++i) {
+			res *= fixed_transform;
+			res *= 0.25;
+		}
+		do_not_optimize(res.get(0, 0));
+	}, n);
+
+	// fibonacci numbers mod 2^64 through powers of the recurrence matrix
+	s.run("2x2 dynamic recurrence powers", [&] {
+		unsigned long long sum {0};
+		for (size_t i = 0; i < n; i += 64) {
+			Matrix<unsigned long long> fib {{1, 1}, {1, 0}};
+			sum += fib.pow(i).get(0, 1);
+		}
+		do_not_optimize(sum);
+	}, n / 64);
+	s.run("2x2 fixed recurrence powers", [&] {
+		unsigned long long sum {0};
+		for (size_t i = 0; i < n; i += 64) {
+			Fixed_matrix<unsigned long long, 2, 2> fib {1, 1, 1, 0};
+			sum += fib.pow(i).get(0, 1);
+		}
+		do_not_optimize(sum);
+	}, n / 64);
+}
+
+// image sized, power of two strides are the worst case for column reads
+void profile_transpose(Bench_state& s) {
+	size_t N {s.size()};
+	Matrix<int> A {N, N, profile_values<int>(s, N*N, (int)N)};
+
+	std::vector<int> naive(N*N);
+	s.run("column strided transpose", [&] {
+		for (size_t i = 0; i < N; ++i)
+			for (size_t j = 0; j < N; ++j) naive[i*N + j] = A.get(j, i);
+	}, N*N);
+	s.run("blocked transpose", [&] {do_not_optimize(A.transpose());}, N*N);
+	s.run("in place transpose", [&] {A.transpose_in_place();}, N*N);
+	s.run("in place rotate", [&] {A.rotate();}, N*N);
+	Matrix<int> B {N / 2, N * 2, profile_values<int>(s, N*N, (int)N)};
+	s.run("blocked rotate copy", [&] {B.rotate();}, N*N);
+}
+
+
+void profile_basic_tree(Bench_state& s) {profile_set<Basic_tree<int>>(s);}
+void profile_std_set(Bench_state& s) {profile_set<std::set<int>>(s);}
+void profile_treap(Bench_state& s) {profile_set<Basic_treap<int>>(s);}
+void profile_btree(Bench_state& s) {profile_set<Btree_set<int>>(s);}
+
+void profile_interval_set(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	auto fill = [&](Interval_set<int>& interval_set) {
+		for (int i = 0; i < n; ++i) {
+			int low {i};
+			int width {2*i};
+			interval_set.insert({low, low + width});
+		}
+	};
+	s.run("sequential interval insert", [&](Bench_trial& trial) {
+		Interval_set<int> interval_set;
+		trial.start();
+		fill(interval_set);
+		trial.stop();
+	});
 
-// specific implementations to test
-void profile_persistent_vector() {
-	cout << "persistent vector\n";
-	Timer time;
-	Persistent_vector<int> table {test_size};
-	for (int i = 0; i < test_size; ++i)
-		table.push_back(i);
-	cout << "initialization: " << time.tonow() / 1000.0 << endl;	
-	profile_indexable(table);
-	profile_vector(table);
-	cout << endl;
-}
-
-void profile_fixed_vector() {
-	cout << "fixed vector\n";
-	Timer time;
-	Fixed_vector<int> table {test_size};
-	for (int i = 0; i < test_size; ++i)
-		table.push_back(i);
-	cout << "initialization: " << time.tonow() / 1000.0 << endl;	
-	profile_indexable(table);
-	time.restart();
-	table.reserve(3 * test_size);
-	cout << "additional reservation time: " << time.tonow() / 1000.0 << endl;
-	profile_vector(table);
-	cout << endl;
-}
-
-void profile_std_vector() {
-	cout << "std vector\n";
-	Timer time;
-	vector<int> table;
-	table.reserve(test_size);
-	for (int i = 0; i < test_size; ++i)
-		table.push_back(i);
-	cout << "initialization: " << time.tonow() / 1000.0 << endl;	
-	profile_indexable(table);
-	profile_vector(table);
-	cout << endl;
-}
-
-void profile_mat_mul() {
-	// square matrices
-	size_t N = 50;
-	sal::Matrix<int> A {N, N, sal::randgen(0, (int)N*N, N*N)};
-	sal::Matrix<int> B {N, N, sal::randgen(0, (int)N*N, N*N)};
-
-	sal::Timer time;
-	for (size_t i = 0; i < test_size; ++i)
-		A *= B;
-	cout << "Matrix multiplication: " << time.tonow() / 1000.0 << "ms\n";
-}
-
-
-
-void profile_basic_tree() {
-	cout << "basic tree\n";
-	Basic_tree<int> tree_set;
-	profile_set(tree_set);
-	cout << endl;
-}
-
-void profile_std_set() {
-	cout << "std set\n";
-	std::set<int> std_set;
-	profile_set(std_set);
-	cout << endl;
-}
-
-void profile_treap() {
-	cout << "treap\n";
-	Basic_treap<int> treap_set;
-	profile_set(treap_set);
-	cout << endl;
-}
-
-void profile_interval_set() {
-	cout << "interval set\n";
 	Interval_set<int> interval_set;
-	Timer time;
-	for (int i = 0; i < test_size; ++i) {
-		int low {i};
-		int width {2*i};
-		interval_set.insert({low, low + width});
-	}
-	cout << "sequential interval insert: " << time.tonow() / 1000.0 << endl;
+	fill(interval_set);
+	s.run("sequential find any overlapping", [&] {
+		for (int i = 0; i < n; ++i) do_not_optimize(interval_set.find(i, i + 10));
+	});
+	s.run("sequential find smallest overlapping", [&] {
+		for (int i = 0; i < n; ++i) do_not_optimize(interval_set.find_first(i, i + 10));
+	});
+	s.run("sequential find exact interval", [&] {
+		for (int i = 0; i < n; ++i) do_not_optimize(interval_set.find_exact(i, i + 2*i));
+	});
+
+	s.run("sequential erase", [&](Bench_trial& trial) {
+		Interval_set<int> erased;
+		fill(erased);
+		trial.start();
+		for (int i = 0; i < n; ++i) erased.erase({i, i + 2*i});
+		trial.stop();
+		if (!erased.empty()) {cout << "FAILED...Interval set erase " << erased.size() << endl;}
+	});
+}
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i) {
-		int low {i};
-		int width {10};
-		interval_set.find(low, low + width);
+// many short intervals over a long axis like reads on a genome, find all overlaps of short queries
+void profile_interval_index(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	std::vector<Interval<int>> intervals, queries;
+	for (int i = 0; i < n; ++i) {
+		int low {s.randint(100 * n)};
+		intervals.push_back({low, low + s.randint(1000)});
 	}
-	cout << "sequential find any overlapping: " << time.tonow() / 1000.0 << endl;
-
-	time.restart();
-	for (int i = 0; i < test_size; ++i) {
-		int low {i};
-		int width {10};
-		interval_set.find_first(low, low + width);
+	for (int i = 0; i < n; ++i) {
+		int low {s.randint(100 * n)};
+		queries.push_back({low, low + s.randint(100)});
 	}
-	cout << "sequential find smallest overlapping: " << time.tonow() / 1000.0 << endl;
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i) {
-		int low {i};
-		int width {2*i};
-		interval_set.find_exact(low, low + width);
-	}
-	cout << "sequential find exact interval: " << time.tonow() / 1000.0 << endl;
+	s.run("interval set build", [&](Bench_trial& trial) {
+		Interval_set<int> interval_set;
+		trial.start();
+		for (const auto& interval : intervals) interval_set.insert(interval);
+		trial.stop();
+	});
+	s.run("interval index build", [&](Bench_trial& trial) {
+		trial.start();
+		Interval_index<int> index {intervals.begin(), intervals.end()};
+		trial.stop();
+	});
 
-	time.restart();
-	for (int i = 0; i < test_size; ++i) {
-		int low {i};
-		int width {2*i};
-		interval_set.erase({low, low + width});
-	}
-	cout << "sequential erase: " << time.tonow() / 1000.0 << endl;
-	if (!interval_set.empty()) {cout << "FAILED...Interval set erase " << interval_set.size() << endl;}
+	Interval_set<int> interval_set;
+	for (const auto& interval : intervals) interval_set.insert(interval);
+	Interval_index<int> index {intervals.begin(), intervals.end()};
+	size_t matches {0};
+	s.run("interval set find all", [&] {
+		matches = 0;
+		for (const auto& query : queries) matches += interval_set.find_all(query).size();
+	});
+	s.note("matches", matches);
+	s.run("interval index streamed", [&] {
+		matches = 0;
+		for (const auto& query : queries) index.for_each_overlap(query, [&](const Interval<int>&) {++matches;});
+	});
+	s.note("matches", matches);
+	s.run("interval index batched", [&] {
+		matches = 0;
+		index.query_many(queries.begin(), queries.end(), [&](size_t, const Interval<int>&) {++matches;});
+	});
+	s.note("matches", matches);
 }
 
 struct Rect {
 	int xl, xh, yl, yh;
 };
 
-void profile_plane_set() {
+void profile_plane_set(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
 	std::vector<Rect> lines;
 	static constexpr int half_width = 5;
 	// the bounding box size of the plane also impacts performance (significant in lookup)
-	for (int i = 0; i < test_size/100; ++i) {
-		int x_center {randint(test_size / 100)};
-		int y_center {randint(test_size / 100)};
+	for (int i = 0; i < n; ++i) {
+		int x_center {s.randint(n)};
+		int y_center {s.randint(n)};
 		// odd and even decide whether line will be vertical or horizontal
 		if (i & 1) lines.push_back({x_center - half_width, x_center + half_width, y_center, y_center});
 		else 	   lines.push_back({x_center, x_center , y_center - half_width, y_center + half_width});
 	}
-	cout << "plane set\n";
-	Timer time;
-	sal::Plane_set<int> planes;
-	for (const auto& line : lines) {
-		planes.insert(line.xl, line.xh, line.yl, line.yh);
+	auto fill = [&](Plane_set<int>& planes) {
+		for (const auto& line : lines) planes.insert(line.xl, line.xh, line.yl, line.yh);
+	};
+	s.run("random insert", [&](Bench_trial& trial) {
+		Plane_set<int> planes;
+		trial.start();
+		fill(planes);
+		trial.stop();
+	});
+
+	Plane_set<int> planes;
+	fill(planes);
+	s.run("random queries (always hit)", [&] {
+		for (const auto& line : lines) do_not_optimize(planes.find(line.xl, line.xh, line.yl, line.yh));
+	});
+	s.run("random queries (rare hit)", [&] {
+		for (const auto& line : lines) do_not_optimize(planes.find(line.yl, line.yh, line.xl, line.xh));
+	});
+}
+
+// same points as degenerate rectangles in a plane set, against the quadtree's emptiness queries
+void profile_quadtree(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	int extent {10 * n};
+	std::vector<std::pair<int,int>> points;
+	for (int i = 0; i < n; ++i) points.push_back({s.randint(extent), s.randint(extent)});
+	std::vector<Rect> queries;
+	for (int i = 0; i < n; ++i) {
+		int x {s.randint(extent)}, y {s.randint(extent)};
+		queries.push_back({x, x + s.randint(200), y, y + s.randint(200)});
+	}
+	std::vector<std::pair<int,int>> nearest;
+	for (int i = 0; i < n / 10; ++i) nearest.push_back({s.randint(extent), s.randint(extent)});
+
+	s.run("plane set insert", [&](Bench_trial& trial) {
+		Plane_set<int> planes;
+		trial.start();
+		for (const auto& point : points) planes.insert(point.first, point.first, point.second, point.second);
+		trial.stop();
+	});
+	Plane_set<int> planes;
+	for (const auto& point : points) planes.insert(point.first, point.first, point.second, point.second);
+	size_t hits {0};
+	s.run("plane set rectangle queries", [&] {
+		hits = 0;
+		for (const auto& r : queries) hits += planes.find(r.xl, r.xh, r.yl, r.yh) != planes.end();
+	});
+	s.note("hits", hits);
+
+	s.run("quadtree batch insert", [&](Bench_trial& trial) {
+		Quadtree<int> quad;
+		trial.start();
+		quad.insert(points.begin(), points.end());
+		trial.stop();
+	});
+	Quadtree<int> quad;
+	quad.insert(points.begin(), points.end());
+	s.run("quadtree rectangle queries", [&] {
+		hits = 0;
+		for (const auto& r : queries) hits += !quad.empty(r.xl, r.xh, r.yl, r.yh);
+	});
+	s.note("hits", hits);
+	size_t total {0};
+	s.run("quadtree rectangle counts", [&] {
+		total = 0;
+		for (const auto& r : queries) total += quad.count(r.xl, r.xh, r.yl, r.yh);
+	});
+	s.note("total", total);
+	s.run("quadtree 8 nearest", [&] {
+		for (const auto& point : nearest) do_not_optimize(quad.k_nearest(point.first, point.second, 8));
+	}, nearest.size());
+}
+
+
+// times f(), keeping what its last trial returned in result
+template <typename Result, typename F>
+void profile_result(Bench_state& s, const std::string& phase, Result& result, F&& f) {
+	s.run(phase, [&](Bench_trial& trial) {
+		trial.start();
+		Result computed {f()};
+		trial.stop();
+		result = std::move(computed);
+	});
+}
+
+template <typename Property_map>
+void profile_compare(Property_map& a, Property_map& b, size_t n, const char* what) {
+	for (size_t v = 0; v < n; ++v)
+		if (a[v].distance != b[v].distance) {
+			cout << "FAILED..." << what << " distances differ at " << v << endl;
+			break;
+		}
+}
+
+void profile_shortest(Bench_state& s) {
+	// sparse random graph with a path through every vertex so all are reachable
+	int n {static_cast<int>(s.size())};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1), s.randint(1000));
+	for (int i = 1; i < n; ++i) edges.emplace_back(i - 1, i, 100000);
+	digraph_csr<int> g {edges.begin(), edges.end()};
+
+	using Paths = decltype(dijkstra<Dense_property>(g, 0));
+	Paths serial, frontier, stepped, heaped, radix, dial;
+	profile_result(s, "bellman ford", serial, [&] {return bellman_ford<Dense_property>(g, 0);});
+	profile_result(s, "parallel frontier bellman ford", frontier, [&] {return bellman_ford<Dense_property>(g, 0, par);});
+	profile_result(s, "delta stepping", stepped, [&] {return delta_stepping<Dense_property>(g, 0);});
+	profile_result(s, "dijkstra indexed heap", heaped, [&] {return dijkstra<Dense_property, Indexed_queue>(g, 0);});
+	profile_result(s, "dijkstra radix heap (auto)", radix, [&] {return dijkstra<Dense_property>(g, 0);});
+	profile_result(s, "dijkstra dial buckets", dial, [&] {return dijkstra<Dense_property, Dial_queue>(g, 0);});
+	profile_compare(frontier, heaped, n, "parallel bellman ford");
+	profile_compare(radix, heaped, n, "radix heap dijkstra");
+	profile_compare(dial, heaped, n, "dial dijkstra");
+	profile_compare(stepped, heaped, n, "delta stepping");
+}
+
+// dense graphs with half of all edges and sparse ones with 8 per vertex, against a dijkstra from every source
+void profile_all_pairs(Bench_state& s) {
+	size_t n {s.size()};
+	auto per_source = [n](const digraph_csr<size_t>& g) {
+		Matrix<int> res {n, n, POS_INF(int)};
+		for (size_t u = 0; u < n; ++u) {
+			auto property = dijkstra<Dense_property>(g, u);
+			for (size_t v = 0; v < n; ++v) res.get(u, v) = property[v].distance;
+		}
+		return res;
+	};
+	auto check = [](const Matrix<int>& a, const Matrix<int>& b, const char* what) {
+		if (a != b) cout << "FAILED..." << what << " distances differ\n";
+	};
+	for (bool dense : {true, false}) {
+		std::vector<WEdge<size_t>> edges;
+		Matrix<int> weights {n, n, POS_INF(int)};
+		auto add = [&](size_t u, size_t v) {
+			edges.emplace_back(u, v, s.randint(1000));
+			weights.get(u, v) = edges.back().weight;
+		};
+		if (dense) {for (size_t u = 0; u < n; ++u) for (size_t v = 0; v < n; ++v) if (s.randint(1)) add(u, v);}
+		else for (size_t i = 0; i < 8*n; ++i) add(s.randint(n - 1), s.randint(n - 1));
+		// the last vertex pins the csr vertex count
+		add(n - 1, 0);
+		digraph_csr<size_t> g {edges.begin(), edges.end()};
+		digraph_mat<int> mat {weights};
+		std::string kind {dense? " dense" : " sparse"};
+
+		Matrix<int> expected, floyd, parallel_floyd, reweighted, parallel_reweighted;
+		profile_result(s, "dijkstra per source" + kind, expected, [&] {return per_source(g);});
+		profile_result(s, "floyd warshall" + kind, floyd, [&] {return floyd_warshall(mat).distance;});
+		profile_result(s, "parallel floyd warshall" + kind, parallel_floyd, [&] {return floyd_warshall(mat, false, par).distance;});
+		profile_result(s, "johnson" + kind, reweighted, [&] {return johnson(g).distance;});
+		profile_result(s, "parallel johnson" + kind, parallel_reweighted, [&] {return johnson(g, false, par).distance;});
+		// dijkstra leaves a vertex's distance to itself at 0 too
+		check(floyd, expected, "floyd warshall");
+		check(parallel_floyd, expected, "parallel floyd warshall");
+		check(reweighted, expected, "johnson");
+		check(parallel_reweighted, expected, "parallel johnson");
 	}
-	cout << "random insert: " << time.tonow() / 1000.0 << endl;
+}
 
-	time.restart();
-	for (const auto& line : lines) {
-		planes.find(line.xl, line.xh, line.yl, line.yh);	// every one is a hit
+void profile_semiring(Bench_state& s) {
+	// random graph with a quarter of the edges, queries within 8 hops by repeated squaring
+	size_t n {s.size()}, hops {8};
+	std::vector<WEdge<size_t>> edges;
+	for (size_t u = 0; u < n; ++u) for (size_t v = 0; v < n; ++v) if (s.randint(3) == 0) edges.emplace_back(u, v, s.randint(1000));
+	digraph_mat<int> mat {edges.begin(), edges.end(), n};
+	digraph_bits bits {n};
+	for (const auto& edge : edges) bits.add_edge(edge.source, edge.dest);
+
+	// the hand written loops: the same squarings with min and add, or and and, inline
+	auto hand_pow = [n, hops](Matrix<int> a, auto&& product) {
+		Matrix<int> res {a};
+		for (size_t e = 1; e < hops; e *= 2) {
+			Matrix<int> next {n, n, 0};
+			product(res, res, next);
+			res = std::move(next);
+		}
+		return res;
+	};
+	auto min_plus = [n](const Matrix<int>& a, const Matrix<int>& b, Matrix<int>& c) {
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = 0; j < n; ++j) c.get(i, j) = POS_INF(int);
+			for (size_t p = 0; p < n; ++p) {
+				int a_ip {a.get(i, p)};
+				if (a_ip == POS_INF(int)) continue;
+				for (size_t j = 0; j < n; ++j)
+					if (b.get(p, j) != POS_INF(int)) c.get(i, j) = std::min(c.get(i, j), a_ip + b.get(p, j));
+			}
+		}
+	};
+	auto or_and = [n](const Matrix<int>& a, const Matrix<int>& b, Matrix<int>& c) {
+		for (size_t i = 0; i < n; ++i)
+			for (size_t p = 0; p < n; ++p)
+				if (a.get(i, p)) for (size_t j = 0; j < n; ++j) c.get(i, j) |= b.get(p, j);
+	};
+
+	Matrix<int> hand_distances, distances, parallel_distances;
+	profile_result(s, "hand min plus", hand_distances, [&] {return hand_pow(hop_weights(mat), min_plus);});
+	profile_result(s, "min plus pow", distances, [&] {return hop_distances(mat, hops);});
+	profile_result(s, "parallel min plus pow", parallel_distances, [&] {return hop_distances(mat, hops, par);});
+	if (distances != hand_distances || parallel_distances != hand_distances) cout << "FAILED...min plus distances differ\n";
+
+	Matrix<int> within {n, n, 0};
+	for (size_t u = 0; u < n; ++u) {
+		within.get(u, u) = 1;
+		for (size_t v = 0; v < n; ++v) within.get(u, v) |= mat.is_edge(u, v);
 	}
-	cout << "random queries (always hit): " << time.tonow() / 1000.0 << endl;
+	Matrix<int> hand_reach, reach;
+	profile_result(s, "hand or and", hand_reach, [&] {return hand_pow(within, or_and);});
+	profile_result(s, "or and pow", reach, [&] {return pow<Or_and<int>>(within, hops);});
+	if (reach != hand_reach) cout << "FAILED...or and reachability differs\n";
+	size_t reached {0};
+	s.run("bit matrix reachable within", [&] {reached = reachable_within(bits, hops).num_edge();});
+	size_t expected_reached {0};
+	for (size_t i = 0; i < n*n; ++i) expected_reached += reach.data()[i];
+	if (reached != expected_reached) cout << "FAILED...bit matrix reachability differs\n";
+}
 
-	time.restart();
-	for (const auto& line : lines) {
-		planes.find(line.yl, line.yh, line.xl, line.xh);	// hits will be very rare
+void profile_bfs(Bench_state& s) {
+	// sparse random undirected graph, small world so most levels are wide
+	size_t n {s.size()};
+	std::vector<UEdge<size_t>> edges;
+	for (size_t i = 0; i < 8*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1));
+	graph_csr<size_t> g {edges.begin(), edges.end()};
+
+	using Levels = decltype(bfs<Dense_property>(g, 0));
+	Levels serial, levels;
+	profile_result(s, "bfs", serial, [&] {return bfs<Dense_property>(g, 0);});
+	profile_result(s, "direction optimizing parallel bfs", levels, [&] {return bfs(g, 0, par);});
+	profile_compare(levels, serial, n, "parallel bfs");
+}
+
+// depth first forests of a sparse random digraph, dense and hashed properties and an adjacency list
+void profile_dfs(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1), 1);
+	digraph_csr<int> g {edges.begin(), edges.end()};
+	digraph<int> list;
+	for (int v = 0; v < n; ++v) list.add_vertex(v);
+	for (const auto& edge : edges) list.add_edge(edge.source, edge.dest, edge.weight);
+
+	s.run("csr dfs", [&] {do_not_optimize(dfs<Dense_property>(g));});
+	s.run("csr dfs hashed property", [&] {do_not_optimize(dfs(g));});
+	s.run("adjacency list dfs", [&] {do_not_optimize(dfs(list));});
+}
+
+// random dag with edges from lower to higher vertices, then components of random graphs
+void profile_topological(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) {
+		int u {s.randint(n - 2)};
+		edges.emplace_back(u, u + 1 + s.randint(n - u - 2), 1);
 	}
-	cout << "random queries (rare hit): " << time.tonow() / 1000.0 << endl;
+	digraph_csr<int> dag {edges.begin(), edges.end()};
+	std::vector<int> order;
+	s.run("topological sort", [&] {
+		order.clear();
+		topological_sort(dag, std::back_inserter(order));
+	});
+	s.note("vertices", order.size());
+	s.run("parallel topological sort", [&] {
+		order.clear();
+		topological_sort(dag, std::back_inserter(order), par);
+	});
+	for (auto& edge : edges) edge.weight = s.randint(100) - 20;
+	digraph_csr<int> weighted {edges.begin(), edges.end()};
+	using Paths = decltype(shortest_dag<Dense_property>(weighted, 0));
+	Paths serial, leveled;
+	profile_result(s, "shortest dag", serial, [&] {return shortest_dag<Dense_property>(weighted, 0);});
+	profile_result(s, "level parallel shortest dag", leveled, [&] {return shortest_dag<Dense_property>(weighted, 0, par);});
+	profile_compare(leveled, serial, n, "level parallel shortest dag");
+
+	std::vector<UEdge<int>> sparse;
+	for (int i = 0; i < 2*n; ++i) sparse.emplace_back(s.randint(n - 1), s.randint(n - 1));
+	graph_csr<int> u {sparse.begin(), sparse.end()};
+	std::vector<int> labels;
+	s.run("parallel connected components", [&] {labels = connected_components(u, par);});
+	size_t roots {0};
+	for (int v = 0; v < n; ++v) if (labels[v] == v) ++roots;
+	s.note("components", roots);
+
+	digraph<int> g;
+	for (int v = 0; v < n; ++v) g.add_vertex(v);
+	for (int i = 0; i < 2*n; ++i) g.add_edge(s.randint(n - 1), s.randint(n - 1));
+	size_t components {0};
+	s.run("strongly connected", [&] {components = strongly_connected(g).size();});
+	s.note("components", components);
+}
+
+// prim's on a sparse random connected graph, adjacency list and csr, then by queue on narrow weights
+void profile_min_span_tree(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1), 1 + s.randint(1000));
+	for (int i = 1; i < n; ++i) edges.emplace_back(i - 1, i, 100000);
+	graph_csr<int> g {edges.begin(), edges.end()};
+	graph<int> list;
+	for (const auto& edge : edges) list.add_edge(edge.source, edge.dest, edge.weight);
+
+	s.run("csr min span tree", [&] {do_not_optimize(min_span_tree<Dense_property>(g));});
+	s.run("adjacency list min span tree", [&] {do_not_optimize(min_span_tree(list));});
+
+	// weights spanning 1000 get dial's buckets automatically
+	for (auto& edge : edges) edge.weight = 1 + edge.weight % 1000;
+	graph_csr<int> narrow {edges.begin(), edges.end()};
+	s.run("narrow min span tree indexed heap", [&] {do_not_optimize(min_span_tree<Dense_property, Indexed_queue>(narrow));});
+	s.run("narrow min span tree dial buckets (auto)", [&] {do_not_optimize(min_span_tree<Dense_property>(narrow));});
+}
+
+void profile_bit_matrix(Bench_state& s) {
+	// dense unweighted graph, 10% of the edges present
+	size_t n {s.size()};
+	std::vector<UEdge<size_t>> edges;
+	for (size_t i = 0; i < n*n/20; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1));
+	graph_mat<int> mat {edges.begin(), edges.end(), n};
+	graph_bits bits {edges.begin(), edges.end(), n};
+
+	size_t matrix_total {0}, bits_total {0};
+	s.run("matrix neighbour iteration", [&] {
+		matrix_total = 0;
+		for (size_t u : mat) for (auto v = mat.vertex(u).begin(); v != mat.vertex(u).end(); ++v) matrix_total += *v;
+	});
+	s.run("bit matrix neighbour iteration", [&] {
+		bits_total = 0;
+		for (size_t u : bits) for (auto v = bits.vertex(u).begin(); v != bits.vertex(u).end(); ++v) bits_total += *v;
+	});
+	if (matrix_total != bits_total) cout << "FAILED...bit matrix neighbours mismatch\n";
+	s.run("matrix degrees", [&] {
+		matrix_total = 0;
+		for (size_t u : mat) matrix_total += mat.degree(u);
+	});
+	s.run("bit matrix degrees", [&] {
+		bits_total = 0;
+		for (size_t u : bits) bits_total += bits.degree(u);
+	});
+	if (matrix_total != bits_total) cout << "FAILED...bit matrix degrees mismatch\n";
+	size_t triangles {0};
+	s.run("triangles", [&] {triangles = triangle_count(bits);});
+	s.note("triangles", triangles);
+	s.run("transitive closure", [&] {do_not_optimize(transitive_closure(bits));});
 }
 
-int main() {
-	// profile_mat_mul();
+void profile_dynamic_shortest(Bench_state& s) {
+	// weight changes on a fixed graph, repairing against recomputing dijkstra
+	int n {static_cast<int>(s.size())}, updates {1000};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1), 1 + s.randint(1000));
+	// repairs change the graph, so every trial starts from a new one
+	auto build = [&](digraph<int>& g) {
+		for (int v = 0; v < n; ++v) g.add_vertex(v);
+		for (const auto& edge : edges) g.add_edge(edge.source, edge.dest, edge.weight);
+	};
+	digraph<int> g;
+	build(g);
+	std::vector<WEdge<int>> changes;
+	for (int i = 0; i < updates; ++i) changes.emplace_back(s.randint(n - 1), s.randint(n - 1), 1 + s.randint(1000));
+
+	s.run("initial dijkstra", [&] {Dynamic_shortest<digraph<int>, Dense_property> paths {g, 0};});
+	size_t affected {0};
+	s.run("repairs", [&](Bench_trial& trial) {
+		digraph<int> changing;
+		build(changing);
+		Dynamic_shortest<digraph<int>, Dense_property> paths {changing, 0};
+		affected = 0;
+		trial.start();
+		for (const auto& change : changes) {
+			paths.update_edge(change.source, change.dest, change.weight);
+			affected += paths.last_affected();
+		}
+		trial.stop();
+	}, updates);
+	s.note("vertices settled", affected);
+	s.run("recompute", [&] {do_not_optimize(dijkstra<Dense_property>(g, 0));}, 1);
+}
+
+// the page cache stays warm after the first trial, so mapping and bfs on it measure page faults not the disk
+void profile_mapped(Bench_state& s) {
+	int n {static_cast<int>(s.size())};
+	std::vector<WEdge<int>> edges;
+	for (int i = 0; i < 8*n; ++i) edges.emplace_back(s.randint(n - 1), s.randint(n - 1), s.randint(1000));
+
+	s.run("build from edge list", [&] {digraph_csr<int> g {edges.begin(), edges.end()};});
+	s.run("two pass streaming write", [&] {
+		write_graph<int,int>("sal_profile_graph.bin", edges.begin(), edges.end(), true);
+	});
+	s.run("map", [&] {do_not_optimize(map_graph<digraph_csr<int>>("sal_profile_graph.bin"));});
+	s.run("first bfs on mapped", [&](Bench_trial& trial) {
+		auto mapped = map_graph<digraph_csr<int>>("sal_profile_graph.bin");
+		trial.start();
+		do_not_optimize(bfs(mapped, 0, par));
+		trial.stop();
+	});
+	digraph_csr<int> g {edges.begin(), edges.end()};
+	s.run("bfs on built", [&] {do_not_optimize(bfs(g, 0, par));});
+	std::remove("sal_profile_graph.bin");
+}
+
+int main(int argc, char** argv) {
+	Bench_config config;
+	try {config = bench_config(argc, argv);}
+	catch (const std::exception& e) {
+		cerr << e.what() << '\n' << bench_usage();
+		return 1;
+	}
 
-	// profile_persistent_vector();
-	// profile_fixed_vector();
-	// profile_std_vector();
+	Bench_suite suite;
+	// keyed benchmarks read, write, insert and find at the drawn keys
+	suite.add("mat mul", {50, 200, 1000}, false, profile_mat_mul);
+	suite.add("transpose", {4096}, false, profile_transpose);
+	suite.add("fixed matrix", {1000000}, false, profile_fixed_matrix);
+
+	suite.add("persistent vector", {1000000, 10000000}, true, profile_persistent_vector);
+	suite.add("fixed vector", {1000000, 10000000}, true, profile_fixed_vector);
+	suite.add("std vector", {1000000, 10000000}, true, profile_std_vector);
+	// trivial elements grow through realloc like Persistent_vector, std vector copies each time
+	// fast vector ~ persistent vector, about 3 times faster than std vector
+	// huge pages have no realloc so growth copies, they pay off in random access to big vectors instead
+	// non trivial elements are move constructed, within 5% of std vector
+	suite.add("vector growth", {10000000}, false, profile_vector_growth);
+	suite.add("list", {1000000}, false, profile_list);
 
 	// compared to std set
 	// 1.1 times slower insert (for all cases), 1.12 times faster iteration, same clear speed, 1.3 times faster find
 	// 1.05 times slower erase
-	// profile_basic_tree();
+	suite.add("basic tree", {100000, 1000000}, true, profile_basic_tree);
 	// 4 times faster insert (for all cases), 1.532 times slower iteration (!?), same clear speed, 2 times faster find
 	// 2 times faster erase
-	// profile_treap();
-	// profile_std_set();
+	suite.add("treap", {100000, 1000000}, true, profile_treap);
+	suite.add("persistent treap", {100000, 1000000}, true, profile_persistent_treap);
+	suite.add("std set", {100000, 1000000}, true, profile_std_set);
+	suite.add("btree", {100000, 1000000}, true, profile_btree);
 
 	// treap version is 4 times faster than RB version as with sets - use Treaps!
 	// finding any overlapping interval is 2 orders of magnitude faster than finding smallest and exact
 	// finding all is much slower
-	// profile_interval_set();
-
-	profile_plane_set();
-}
\ No newline at end of file
+	suite.add("interval set", {100000, 1000000}, false, profile_interval_set);
+	suite.add("interval index", {1000000}, false, profile_interval_index);
+
+	suite.add("plane set", {100000}, false, profile_plane_set);
+	suite.add("quadtree", {100000}, false, profile_quadtree);
+
+	suite.add("shortest", {1000000}, false, profile_shortest);
+	suite.add("all pairs", {256, 1024}, false, profile_all_pairs);
+	suite.add("semiring", {256, 512}, false, profile_semiring);
+	suite.add("bfs", {1000000}, false, profile_bfs);
+	suite.add("dfs", {200000}, false, profile_dfs);
+	suite.add("topological sort", {200000}, false, profile_topological);
+	suite.add("min span tree", {200000}, false, profile_min_span_tree);
+	suite.add("bit matrix", {4000}, false, profile_bit_matrix);
+	suite.add("dynamic shortest", {200000}, false, profile_dynamic_shortest);
+	suite.add("mapped", {1000000}, false, profile_mapped);
+
+	try {suite.run(config);}
+	catch (const std::exception& e) {
+		cerr << e.what() << '\n';
+		return 1;
+	}
+}
@@ -1,10 +1,16 @@
 #include <algorithm>
 #include <iostream>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include "../../algo/macros.h"
 #include "../matrix.h"
 #include "../heap.h"
+#include "../stats.h"
 #include "../tree.h"
 #include "../list.h"
 #include "../interval.h"
@@ -13,7 +19,10 @@
 #include "../graph/utility.h"
 #include "../graph/shortest.h"
 #include "../graph/linear.h"
+#include "../graph/dynamic.h"
+#include "../graph/mapped.h"
 #include "../vector.h"
+#include "../infint.h"
 #include "../bits/bitgrid.h"
 
 using namespace std;
@@ -31,6 +40,86 @@ void test_list(bool print) {
 	if (print) cout << l;
 }
 
+void test_unrolled_list(bool print) {
+	sal::Unrolled_list<int, 4> l {1, 4, 2, 5, 3, 7, 6};
+	if (print) cout << l;
+	l.insert(0);
+	l.append(8);
+	if (l.size() != 9 || *l.kth_last(1) != 8 || *l.kth_last(9) != 0 || l.kth_last(10) || l.kth_last(0))
+		cout << "FAILED...Unrolled list insert and append\n";
+	l.insert_after(9, l.kth_last(3));
+	l.erase(4);
+	l.erase(100);
+	std::vector<int> expected {0,1,2,5,3,7,9,6,8};
+	if (!std::equal(l.begin(), l.end(), expected.begin(), expected.end())) cout << "FAILED...Unrolled list insert after and erase\n";
+
+	// against std::list on random operations, small chunks so they split and merge often
+	sal::Unrolled_list<int, 4> random;
+	std::list<int> reference;
+	for (int i = 0; i < 5000; ++i) {
+		int val {static_cast<int>(static_cast<unsigned>(randint_seeded()) % 50)};
+		switch (static_cast<unsigned>(randint_seeded()) % 5) {
+			case 0: random.insert(val); reference.push_front(val); break;
+			case 1: random.append(val); reference.push_back(val); break;
+			case 2: {
+				auto found = std::find(reference.begin(), reference.end(), val);
+				if (found != reference.end()) reference.erase(found);
+				random.erase(val);
+				break;
+			}
+			default: {
+				if (reference.empty()) break;
+				size_t k {static_cast<unsigned>(randint_seeded()) % reference.size() + 1};
+				random.insert_after(val, random.kth_last(k));
+				reference.insert(std::next(reference.end(), -static_cast<long>(k) + 1), val);
+			}
+		}
+		if (random.size() != reference.size()) {cout << "FAILED...Unrolled list random size\n"; break;}
+	}
+	if (!std::equal(random.begin(), random.end(), reference.begin(), reference.end())) cout << "FAILED...Unrolled list random operations\n";
+	random.remove_dup();
+	std::set<int> seen;
+	reference.remove_if([&](int val) {return !seen.insert(val).second;});
+	if (!std::equal(random.begin(), random.end(), reference.begin(), reference.end())) cout << "FAILED...Unrolled list remove duplicates\n";
+	random.append(1000);
+	if (*random.kth_last(1) != 1000) cout << "FAILED...Unrolled list append after remove duplicates\n";
+
+	// erasing all but the last element of every chunk front to back keeps chunks half full
+	// instead of leaving one element in each
+	sal::Unrolled_list<int, 8> sparse;
+	std::vector<int> kept;
+	for (int i = 0; i < 800; ++i) sparse.append(i);
+	bool bounded {true};
+	for (int i = 0; i < 800; ++i) {
+		if (i % 8 == 7) {kept.push_back(i); continue;}
+		sparse.erase(i);
+		bounded = bounded && sparse.chunk_count() <= 2 * sparse.size() / 8 + 2;
+	}
+	if (!bounded || sparse.chunk_count() > 2 * sparse.size() / 8 + 2 || *sparse.kth_last(1) != 799 ||
+		!std::equal(sparse.begin(), sparse.end(), kept.begin(), kept.end())) cout << "FAILED...Unrolled list chunk fill\n";
+
+	// bulk loading, copies and non trivial elements
+	std::istringstream words {"log lines are appended to the end of the log"};
+	sal::Unrolled_list<std::string> log;
+	words >> log;
+	sal::Unrolled_list<std::string> copy {log};
+	copy.remove_dup();
+	std::ostringstream out;
+	out << copy;
+	if (log.size() != 10 || out.str() != "log lines are appended to the end of \n") cout << "FAILED...Unrolled list stream\n";
+	sal::Unrolled_list<std::string> moved {std::move(log)};
+	if (!log.empty() || moved.size() != 10 || *moved.kth_last(1) != "log") cout << "FAILED...Unrolled list move\n";
+	moved.clear();
+	moved.append("again");
+	if (moved.size() != 1 || *moved.begin() != "again") cout << "FAILED...Unrolled list reuse after clear\n";
+
+	sal::Basic_list<int> dup {3, 1, 3, 2, 1, 3};
+	dup.remove_dup();
+	std::ostringstream dup_out;
+	dup_out << dup;
+	if (dup_out.str() != "3 1 2 \n") cout << "FAILED...List remove duplicates\n";
+}
+
 void test_mul(bool print) {
 	sal::Matrix<int> A {{2, 5, 6},
 				   		{3, 4, -3},
@@ -49,6 +138,91 @@ void test_mul(bool print) {
 	
 }
 
+// blocked kernel against the naive loop, sizes chosen to leave partial tiles on every edge
+template <typename T>
+void test_gemm_type(size_t m, size_t n, size_t k, const char* name) {
+	std::vector<T> a, b;
+	for (size_t i = 0; i < m*k; ++i) a.push_back(static_cast<T>(randint_seeded() % 17));
+	for (size_t i = 0; i < k*n; ++i) b.push_back(static_cast<T>(randint_seeded() % 13));
+	sal::Matrix<T> A {m, k, std::vector<T>{a}};
+	sal::Matrix<T> B {k, n, std::vector<T>{b}};
+	std::vector<T> expected(m*n, 0);
+	sal::gemm_naive(m, n, k, a.data(), k, 1, b.data(), n, 1, expected.data(), n, 1);
+	if (A*B != sal::Matrix<T>{m, n, std::move(expected)}) cout << "FAILED...Blocked matrix multiplication " << name << endl;
+
+	// transposed view of B through strides
+	std::vector<T> c(m*n, 0), c_t(m*n, 0);
+	auto B_t = B.transpose();
+	sal::gemm(m, n, k, a.data(), k, 1, &B_t.get(0,0), 1, k, c.data(), n, 1);
+	sal::gemm_naive(m, n, k, a.data(), k, 1, b.data(), n, 1, c_t.data(), n, 1);
+	if (c != c_t) cout << "FAILED...Strided matrix multiplication " << name << endl;
+}
+
+void test_gemm(bool print) {
+	test_gemm_type<int>(67, 45, 300, "int");
+	test_gemm_type<float>(130, 37, 19, "float");
+	test_gemm_type<double>(29, 70, 261, "double");
+	test_gemm_type<long long>(9, 9, 80, "long long");
+}
+
+// nested fork join, each task forks its own children
+long long parallel_sum(sal::Thread_pool& pool, const std::vector<int>& vals, size_t lo, size_t hi) {
+	if (hi - lo <= 1000) {
+		long long sum {0};
+		for (size_t i = lo; i < hi; ++i) sum += vals[i];
+		return sum;
+	}
+	size_t mid {lo + (hi - lo) / 2};
+	long long left {0};
+	sal::Task_group group {pool};
+	group.run([&]() {left = parallel_sum(pool, vals, lo, mid);});
+	long long right {parallel_sum(pool, vals, mid, hi)};
+	group.wait();
+	return left + right;
+}
+
+void test_parallel(bool print) {
+	sal::Thread_pool pool {4};
+	std::vector<int> vals;
+	long long expected {0};
+	for (int i = 0; i < 100000; ++i) {vals.push_back(randint_seeded() % 1000); expected += vals.back();}
+	if (parallel_sum(pool, vals, 0, vals.size()) != expected) cout << "FAILED...Thread pool nested tasks\n";
+
+	std::vector<int> doubled(vals.size());
+	sal::parallel_for(0, vals.size(), 777, [&](size_t lo, size_t hi) {
+		for (size_t i = lo; i < hi; ++i) doubled[i] = 2 * vals[i];
+	}, pool);
+	for (size_t i = 0; i < vals.size(); ++i) 
+		if (doubled[i] != 2 * vals[i]) {cout << "FAILED...Parallel for\n"; break;}
+
+	bool caught {false};
+	try {
+		sal::Task_group group {pool};
+		group.run([]() {throw std::runtime_error("task failure");});
+		group.wait();
+	}
+	catch (const std::runtime_error&) {caught = true;}
+	if (!caught) cout << "FAILED...Task group exception\n";
+
+	// policy overloads give the same results as the serial operators
+	// small integers so floating point results are exact
+	auto random_doubles = [](size_t rows, size_t cols, int range) {
+		std::vector<double> elems;
+		for (size_t i = 0; i < rows*cols; ++i) elems.push_back(static_cast<unsigned>(randint_seeded()) % range);
+		return sal::Matrix<double>{rows, cols, std::move(elems)};
+	};
+	sal::Matrix<double> A {random_doubles(300, 200, 10)};
+	sal::Matrix<double> B {random_doubles(200, 250, 10)};
+	sal::Matrix<double> C {random_doubles(300, 250, 10)};
+	if (sal::mul(A, B, sal::par) != A*B || sal::mul(A, B, sal::seq) != A*B) cout << "FAILED...Parallel matrix multiplication\n";
+	if (sal::add(C, C, sal::par) != C + C) cout << "FAILED...Parallel matrix addition\n";
+	if (sal::sub(C, A*B, sal::par) != C - A*B) cout << "FAILED...Parallel matrix subtraction\n";
+	if (sal::transpose(C, sal::par) != C.transpose()) cout << "FAILED...Parallel matrix transpose\n";
+	sal::Matrix<double> D {random_doubles(48, 48, 2)};
+	sal::Matrix<double> D_pow {D};
+	if (sal::pow(D, 3, sal::par) != D_pow.pow(3)) cout << "FAILED...Parallel matrix power\n";
+}
+
 void test_pow(bool print) {
 	sal::Matrix<int> F {{1, 1},
 				   		{1, 0}};
@@ -56,6 +230,106 @@ void test_pow(bool print) {
 		cout << "FAILED...Matrix exponentiation\n";
 }
 
+// element by element against the naive definitions, sizes leave partial blocks on both sides
+void test_matrix_view(bool print) {
+	auto numbered = [](size_t rows, size_t cols) {
+		std::vector<int> elems;
+		for (size_t i = 0; i < rows*cols; ++i) elems.push_back(static_cast<int>(i));
+		return sal::Matrix<int>{rows, cols, std::move(elems)};
+	};
+	for (auto dims : std::vector<std::pair<size_t,size_t>>{{1,1},{3,7},{37,5},{70,131},{100,100},{257,257}}) {
+		size_t rows {dims.first}, cols {dims.second};
+		sal::Matrix<int> A {numbered(rows, cols)};
+		sal::Matrix<int> A_t {A.transpose()}, A_tp {sal::transpose(A, sal::par)}, A_r {A};
+		A_r.rotate();
+		bool transposed {A_t.row() == cols && A_t.col() == rows && A_t == A_tp};
+		bool rotated {A_r.row() == cols && A_r.col() == rows};
+		for (size_t i = 0; i < cols; ++i)
+			for (size_t j = 0; j < rows; ++j) {
+				transposed = transposed && A_t.get(i,j) == A.get(j,i);
+				rotated = rotated && A_r.get(i,j) == A.get(rows-1-j, i);
+			}
+		if (!transposed) cout << "FAILED...Blocked transpose " << rows << 'x' << cols << endl;
+		if (!rotated) cout << "FAILED...Blocked rotate " << rows << 'x' << cols << endl;
+		sal::Matrix<int> A_i {A};
+		A_i.transpose_in_place();
+		if (A_i != A_t) cout << "FAILED...In place transpose " << rows << 'x' << cols << endl;
+	}
+
+	sal::Matrix<int> A {numbered(4, 6)};
+	auto A_t = A.transposed_view();
+	if (A_t.row() != 6 || A_t.col() != 4 || A_t.get(5, 1) != A.get(1, 5) || sal::Matrix<int>{A_t} != A.transpose())
+		cout << "FAILED...Transposed view\n";
+	auto sub = A.block(1, 2, 2, 3);
+	if (sub.get(1, 2) != A.get(2, 4) || sub.transposed().get(2, 1) != A.get(2, 4) || sub.col_view(1).get(1, 0) != A.get(2, 3))
+		cout << "FAILED...Block view\n";
+	sub.get(0, 0) = -1;
+	if (A.get(1, 2) != -1) cout << "FAILED...Mutable view\n";
+	auto add = [](int& res, const int& elem) {res += elem;};
+	if (A_t.row_op(2, add) != sal::col_sum(A, 2) || A_t.col_op(3, add) != sal::row_sum(A, 3) ||
+		A.row_view(2).row_op(0, add) != sal::row_sum(A, 2))
+		cout << "FAILED...View row and col operations\n";
+
+	// products through strides give the same as products of copies
+	sal::Matrix<int> B {numbered(4, 5)};
+	if (A_t * B.view() != A.transpose() * B) cout << "FAILED...Transposed view multiplication\n";
+	sal::Matrix<int> C {numbered(5, 4)};
+	sal::Matrix<int> D {A_t * C.transposed_view()};
+	sal::Matrix<int> AC {A.transpose()};
+	AC *= C.transposed_view();
+	if (D != A.transpose() * C.transpose() || AC != D) cout << "FAILED...Transposed view multiplication\n";
+	if (print) cout << D << endl;
+}
+
+// whether a * b compiles, fixed matrices of mismatched sizes shouldn't
+template <typename A, typename B, typename = void>
+struct Can_multiply : std::false_type {};
+template <typename A, typename B>
+struct Can_multiply<A, B, std::void_t<decltype(std::declval<A>() * std::declval<B>())>> : std::true_type {};
+
+void test_fixed_matrix(bool print) {
+	using F2 = sal::Fixed_matrix<long long, 2, 2>;
+	constexpr F2 fib {1, 1, 
+					  1, 0};
+	// evaluated by the compiler
+	constexpr F2 fib_90 {sal::pow(fib, 90)};
+	static_assert(fib_90.get(0, 1) == 2880067194370816120LL, "constexpr fixed matrix power");
+	static_assert(sal::pow(fib, 5) == F2{8, 5, 5, 3}, "constexpr fixed matrix power");
+	static_assert(!Can_multiply<sal::Fixed_matrix<int,2,3>, sal::Fixed_matrix<int,2,3>>::value &&
+		Can_multiply<sal::Fixed_matrix<int,2,3>, sal::Fixed_matrix<int,3,4>>::value, "fixed matrix dimension checks");
+	if (print) cout << fib_90 << endl;
+
+	constexpr sal::Fixed_matrix<int, 2, 3> A {1, 2, 3,
+											  4, 5, 6};
+	constexpr sal::Fixed_matrix<int, 3, 2> A_t {A.transpose()};
+	static_assert(A_t.get(2, 1) == 6 && A_t.get(0, 1) == 4, "constexpr fixed matrix transpose");
+	sal::Matrix<int> A_dyn {A};
+	if (A_dyn.row() != 2 || A_dyn.col() != 3 || sal::Matrix<int>{A * A_t} != A_dyn * A_dyn.transpose() || 
+		sal::Matrix<int>{A_t} != A_dyn.transpose())
+		cout << "FAILED...Fixed matrix conversion to matrix\n";
+	if (sal::Fixed_matrix<int, 2, 3>{A_dyn} != A || sal::Fixed_matrix<int, 3, 2>{A_dyn.transposed_view()} != A_t)
+		cout << "FAILED...Fixed matrix conversion from matrix\n";
+	bool threw {false};
+	try {sal::Fixed_matrix<int, 3, 3> wrong {A_dyn};}
+	catch (const std::runtime_error&) {threw = true;}
+	if (!threw) cout << "FAILED...Fixed matrix conversion size check\n";
+	if (sal::view(A_t) * A_dyn.view() != A_dyn.transpose() * A_dyn) cout << "FAILED...Fixed matrix view\n";
+
+	// 8 x 8 products are past the unrolling limit and loop instead, small integers keep them exact
+	using F8 = sal::Fixed_matrix<double, 8, 8>;
+	std::vector<double> elems;
+	for (size_t i = 0; i < 64; ++i) elems.push_back(static_cast<unsigned>(randint_seeded()) % 4);
+	sal::Matrix<double> B_dyn {8, 8, std::move(elems)};
+	F8 B {B_dyn};
+	sal::Matrix<double> B_dyn_3 {B_dyn};
+	B_dyn_3.pow(3);
+	if (sal::Matrix<double>{sal::pow(B, 3)} != B_dyn_3) cout << "FAILED...Fixed matrix looped product\n";
+	F8 B_sum {B + B - B};
+	B_sum *= 2.0;
+	B_sum -= B;
+	if (B_sum != B || (B *= F8::identity()) != F8{B_dyn}) cout << "FAILED...Fixed matrix arithmetic\n";
+}
+
 void test_heap(bool print) {
 	sal::Heap<int> h2 {3, 4, 6, 5, 1, 8, 11, 12};
 	if (print) sal::print(h2);
@@ -109,6 +383,28 @@ void test_heap(bool print) {
 		if (print) std::cout << top << ':' << property[top].distance << endl;
 	}
 	cout << endl;
+
+	// indexed heap keeps positions, key is O(1) and changes to values are fixed through handles
+	sal::Indexed_heap<int, Cmp, std::unordered_map<int,size_t>, 4> ih {Cmp{property}};
+	for (int v : order) { property[v].distance = v % 6 + 1; ih.insert(v); }
+	if (!ih.is_heap() || ih.size() != order.size()) cout << "FAILED...Indexed heap construction\n";
+	if (ih.key(7) != 0 || !ih.contains(12)) cout << "FAILED...Indexed heap find key\n";
+	property[5].distance = 0;
+	ih.decrease_key(ih.key(5));
+	if (ih.top() != 5 || !ih.is_heap()) cout << "FAILED...Indexed heap decrease key\n";
+	property[6].distance = 10;
+	ih.sift_down(ih.key(6));
+	size_t prev {0};
+	while (!ih.empty()) {
+		int top {ih.extract_top()};
+		if (property[top].distance < prev || ih.contains(top)) cout << "FAILED...Indexed heap extract\n";
+		prev = property[top].distance;
+	}
+
+	sal::Indexed_heap<size_t, std::less<size_t>, sal::Dense_index<size_t>> dh;
+	for (size_t v : {5, 3, 8, 1, 9, 0}) dh.insert(v);
+	for (size_t v : {0, 1, 3, 5, 8, 9}) 
+		if (dh.extract_top() != v) cout << "FAILED...Dense indexed heap order\n";
 }
 
 void test_tree(bool print) {
@@ -152,6 +448,48 @@ void test_tree(bool print) {
 
 }
 
+void test_node_pool(bool print) {
+	struct Node {
+		int key;
+		Node(int k) : key{k} {}
+	};
+	sal::Node_pool<Node> pool;
+	Node* a {pool.create(1)};
+	Node* b {pool.create(2)};
+	if (a->key != 1 || b->key != 2 || pool.capacity() == 0) cout << "FAILED...Node pool create\n";
+	// freed node is the next one handed out
+	pool.destroy(a);
+	if (pool.create(3) != a || a->key != 3) cout << "FAILED...Node pool reuse\n";
+	size_t before {pool.capacity()};
+	for (int i = 0; i < 1000; ++i) pool.create(i);
+	if (pool.capacity() < 1002 || pool.capacity() == before) cout << "FAILED...Node pool growth\n";
+	pool.release();
+	if (pool.capacity() != 0) cout << "FAILED...Node pool release\n";
+
+	// trees with pooled, plain, and non-trivially destructible nodes
+	sal::Basic_tree<int> pooled;
+	sal::Tree<sal::Basic_node<int>, sal::New_allocator<sal::Basic_node<int>>> plain;
+	sal::Basic_tree<std::string> strings;
+	for (int i = 0; i < 2000; ++i) {
+		int val {randint_seeded() % 500};
+		pooled.insert(val);
+		plain.insert(val);
+		strings.insert(std::to_string(val));
+		if (i % 3 == 0) {pooled.erase(val); plain.erase(val); strings.erase(std::to_string(val));}
+	}
+	auto plain_itr = plain.begin();
+	for (int val : pooled) {
+		if (plain_itr == plain.end() || *plain_itr != val) {cout << "FAILED...Pooled tree operations\n"; break;}
+		++plain_itr;
+	}
+	if (plain_itr != plain.end() || !pooled.valid() || !strings.valid()) cout << "FAILED...Pooled tree operations\n";
+	pooled.clear();
+	strings.clear();
+	if (!pooled.empty() || !strings.empty()) cout << "FAILED...Pooled tree clear\n";
+	pooled.insert(5);
+	if (pooled.find(5) == pooled.end()) cout << "FAILED...Pooled tree reuse after clear\n";
+}
+
 void test_order_tree(bool print) {
 	sal::Order_tree<int> t {5, 3, 7, 1, 9, 4, 2, 0, 10, 8, 6};
 
@@ -161,6 +499,9 @@ void test_order_tree(bool print) {
 
 	if (t.rank(node.get()) != rank) cout << "FAILED...Order tree rank\n";
 
+	t.erase(3);
+	node = t.select(rank);
+	if (node == t.end() || node->key != 4 || t.size() != 10) cout << "FAILED...Order tree erase\n";
 }
 
 void test_treap(bool print) {
@@ -183,6 +524,304 @@ void test_treap(bool print) {
 	}
 	if (i != 101) cout << "FAILED...Treap number of elements\n";
 
+	// independent trees on separate threads share no mutable state (nil is never written)
+	auto churn = [](bool& ok) {
+		sal::Basic_treap<int> treap;
+		sal::Basic_tree<int> tree;
+		for (int v = 0; v < 20000; ++v) {
+			treap.insert((v * 7919) % 10007);
+			tree.insert((v * 7919) % 10007);
+			if (v % 2) {treap.erase((v * 104729) % 10007); tree.erase((v * 104729) % 10007);}
+		}
+		int prev {-1};
+		for (int v : treap) {if (v < prev) ok = false; prev = v;}
+		ok = ok && tree.valid();
+	};
+	bool ok_a {true}, ok_b {true};
+	std::thread a {churn, std::ref(ok_a)};
+	std::thread b {churn, std::ref(ok_b)};
+	a.join();
+	b.join();
+	if (!ok_a || !ok_b) cout << "FAILED...Trees on independent threads\n";
+}
+
+void test_treap_bulk(bool print) {
+	using Treap = sal::Basic_treap<int>;
+	using Node = sal::Treap_node<int>;
+	// sorted, heap ordered on priority, and parents consistent
+	auto valid = [](const Treap& t) {
+		bool ok {true};
+		int prev {std::numeric_limits<int>::min()};
+		t.inorder_walk([&](const Node* node) {
+			if (node->key <= prev) ok = false;
+			prev = node->key;
+			for (const Node* child : {node->left, node->right})
+				if (child != Node::nil && (child->parent != node || child->priority < node->priority)) ok = false;
+		});
+		return ok;
+	};
+	auto keys = [](const Treap& t) {
+		std::vector<int> k;
+		for (auto itr = t.begin(); itr != t.end(); ++itr) k.push_back(*itr);
+		return k;
+	};
+	std::vector<int> evens, threes;
+	for (int v = 0; v < 3000; v += 2) evens.push_back(v);
+	for (int v = 0; v < 3000; v += 3) threes.push_back(v);
+
+	Treap a, b;
+	a.build_from_sorted(evens.begin(), evens.end());
+	if (!valid(a) || keys(a) != evens) cout << "FAILED...Treap build from sorted\n";
+
+	Treap right {a.split(1000)};
+	if (!valid(a) || !valid(right) || a.size() != 500 || right.size() != 1000 || *right.begin() != 1000)
+		cout << "FAILED...Treap split\n";
+	// halves share one arena until joined back
+	a.join(std::move(right));
+	if (!valid(a) || keys(a) != evens || !right.empty()) cout << "FAILED...Treap join\n";
+	// halves modified on separate threads allocate and free through the shared arena's lock
+	right = a.split(1500);
+	auto churn = [](Treap& t, int lo) {
+		for (int v = 0; v < 5000; ++v) {
+			int key {lo + (v * 7919) % 1499};
+			if (t.find(key) == t.end()) t.insert(key);
+			if (v % 2) t.erase(lo + (v * 104729) % 1499);
+		}
+	};
+	std::thread left_thread {churn, std::ref(a), 0};
+	std::thread right_thread {churn, std::ref(right), 1500};
+	left_thread.join();
+	right_thread.join();
+	bool halves_ok {valid(a) && valid(right) && keys(a).back() < 1500 && *right.begin() >= 1500};
+	a.join(std::move(right));
+	if (!halves_ok || !valid(a)) cout << "FAILED...Treap split halves on separate threads\n";
+	a.build_from_sorted(evens.begin(), evens.end());
+
+	std::vector<int> expected;
+	b.build_from_sorted(threes.begin(), threes.end());
+	std::set_union(evens.begin(), evens.end(), threes.begin(), threes.end(), std::back_inserter(expected));
+	a.unite(std::move(b));
+	if (!valid(a) || keys(a) != expected || !b.empty()) cout << "FAILED...Treap union\n";
+
+	a.build_from_sorted(evens.begin(), evens.end());
+	b.build_from_sorted(threes.begin(), threes.end());
+	expected.clear();
+	std::set_intersection(evens.begin(), evens.end(), threes.begin(), threes.end(), std::back_inserter(expected));
+	a.intersect(std::move(b));
+	if (!valid(a) || keys(a) != expected) cout << "FAILED...Treap intersection\n";
+
+	a.build_from_sorted(evens.begin(), evens.end());
+	b.build_from_sorted(threes.begin(), threes.end());
+	expected.clear();
+	std::set_difference(evens.begin(), evens.end(), threes.begin(), threes.end(), std::back_inserter(expected));
+	a.subtract(std::move(b));
+	if (!valid(a) || keys(a) != expected) cout << "FAILED...Treap difference\n";
+
+	a.erase(100, 1999);
+	expected.erase(std::remove_if(expected.begin(), expected.end(), [](int v){return v >= 100 && v <= 1999;}), expected.end());
+	if (!valid(a) || keys(a) != expected) cout << "FAILED...Treap range erase\n";
+
+	// parallel union of large random sets agrees with the sequential one
+	std::vector<int> x, y;
+	for (int i = 0; i < 100000; ++i) {x.push_back(randint_seeded() % 400000); y.push_back(randint_seeded() % 400000);}
+	std::sort(x.begin(), x.end());
+	x.erase(std::unique(x.begin(), x.end()), x.end());
+	std::sort(y.begin(), y.end());
+	y.erase(std::unique(y.begin(), y.end()), y.end());
+	Treap px, py, sx, sy;
+	px.build_from_sorted(x.begin(), x.end());
+	py.build_from_sorted(y.begin(), y.end());
+	sx.build_from_sorted(x.begin(), x.end());
+	sy.build_from_sorted(y.begin(), y.end());
+	// own pool so the recursion forks even on a single core
+	sal::Thread_pool pool {4};
+	px.unite(std::move(py), sal::par, pool);
+	sx.unite(std::move(sy));
+	if (!valid(px) || keys(px) != keys(sx)) cout << "FAILED...Treap parallel union\n";
+}
+
+void test_persistent_treap(bool print) {
+	sal::Persistent_treap<int> t {5, 3, 8, 1, 4};
+	auto before = t.snapshot();
+	if (!t.insert(7) || t.insert(7) || !t.erase(3) || t.erase(3) || t.size() != 5 || !t.contains(7))
+		cout << "FAILED...Persistent treap modifiers\n";
+	// the older version is untouched
+	std::vector<int> old_keys {before.begin(), before.end()};
+	auto after = t.snapshot();
+	std::vector<int> new_keys {after.begin(), after.end()};
+	if (print) {for (int k : new_keys) cout << k << ' '; cout << endl;}
+	if (old_keys != std::vector<int>{1,3,4,5,8} || new_keys != std::vector<int>{1,4,5,7,8} || 
+		!before.contains(3) || after.contains(3) || after.select(3) != 7 || *after.find(8) != 8 || after.find(3))
+		cout << "FAILED...Persistent treap snapshots\n";
+
+	// against std::set, nodes of dropped versions come back once no snapshot can reach them
+	std::set<int> reference {new_keys.begin(), new_keys.end()};
+	for (int i = 0; i < 5000; ++i) {
+		int key {static_cast<int>(static_cast<unsigned>(randint_seeded()) % 1000)};
+		if (randint_seeded() & 1) {
+			if (t.insert(key) != reference.insert(key).second) {cout << "FAILED...Persistent treap insert\n"; break;}
+		}
+		else if (t.erase(key) != (reference.erase(key) == 1)) {cout << "FAILED...Persistent treap erase\n"; break;}
+	}
+	auto last = t.snapshot();
+	if (last.size() != reference.size() || !std::equal(last.begin(), last.end(), reference.begin(), reference.end()))
+		cout << "FAILED...Persistent treap random operations\n";
+	if (!std::equal(before.begin(), before.end(), old_keys.begin(), old_keys.end())) cout << "FAILED...Persistent treap old snapshot\n";
+	before.close();
+	after.close();
+	last.close();
+	t.reclaim();
+	if (t.retired_count() != 0) cout << "FAILED...Persistent treap reclaim\n";
+
+	// one writer, readers iterating snapshots without locks
+	sal::Persistent_treap<int> shared;
+	for (int i = 0; i < 1000; i += 2) shared.insert(i);
+	std::atomic<bool> done {false};
+	std::atomic<int> bad {0};
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 4; ++r) readers.emplace_back([&] {
+		while (!done.load()) {
+			auto snap = shared.snapshot();
+			size_t count {0};
+			int prev {-1};
+			for (int key : snap) {
+				if (key <= prev) ++bad;
+				prev = key;
+				++count;
+			}
+			if (count != snap.size()) ++bad;
+		}
+	});
+	for (int i = 0; i < 20000; ++i) {
+		int key {static_cast<int>(static_cast<unsigned>(randint_seeded()) % 2000)};
+		if (i & 1) shared.insert(key);
+		else shared.erase(key);
+	}
+	done = true;
+	for (auto& reader : readers) reader.join();
+	if (bad.load()) cout << "FAILED...Persistent treap concurrent readers\n";
+}
+
+void test_btree(bool print) {
+	sal::Btree_set<int> t {5, 3, 7, 1, 9, 4, 2, 0, 10, 8, 6};
+	auto node = t.find(4);
+	if (node == t.end() || *node != 4 || t.size() != 11) cout << "FAILED...Btree find\n";
+	t.erase(4);
+	if (t.find(4) != t.end() || t.size() != 10 || !t.valid()) cout << "FAILED...Btree erase\n";
+
+	// small nodes give a deep tree so splits, borrows and merges all happen
+	sal::Btree_set<int, 16> deep;
+	std::set<int> reference;
+	for (int i = 0; i < 20000; ++i) {
+		int val {randint_seeded() % 5000};
+		if (i % 3 == 2) {
+			if (deep.erase(val) != reference.erase(val)) {cout << "FAILED...Btree erase count\n"; break;}
+		}
+		else if (deep.insert(val).second != reference.insert(val).second) {cout << "FAILED...Btree insert\n"; break;}
+	}
+	if (!deep.valid() || deep.size() != reference.size() || !std::equal(deep.begin(), deep.end(), reference.begin()))
+		cout << "FAILED...Btree random operations\n";
+	auto lower = deep.lower_bound(2500);
+	if (lower == deep.end() || *lower != *reference.lower_bound(2500)) cout << "FAILED...Btree lower bound\n";
+	auto last = deep.end();
+	--last;
+	if (*last != *reference.rbegin()) cout << "FAILED...Btree reverse iteration\n";
+	for (int v : reference) deep.erase(v);
+	if (!deep.empty() || !deep.valid()) cout << "FAILED...Btree erase all\n";
+
+	sal::Btree_map<std::string, int> counts;
+	for (int i = 0; i < 1000; ++i) ++counts[std::to_string(i % 100)];
+	auto count = counts.find("42");
+	if (counts.size() != 100 || count == counts.end() || count.value() != 10 || !counts.valid())
+		cout << "FAILED...Btree map\n";
+}
+
+void test_quadtree(bool print) {
+	std::vector<std::pair<int,int>> points;
+	for (int i = 0; i < 5000; ++i) points.push_back({randint_seeded() % 1000, randint_seeded() % 1000});
+	// cells of 2 x 2 starting from (-1000, -1000)
+	sal::Quadtree<int> q {2, -1000, -1000};
+	q.insert(points.begin(), points.end());
+	std::set<std::pair<int,int>> cells;
+	for (const auto& p : points) cells.insert({(p.first + 1000) / 2, (p.second + 1000) / 2});
+	if (q.size() != cells.size() || !std::is_sorted(q.cells().begin(), q.cells().end())) cout << "FAILED...Quadtree batch insert\n";
+	if (!q.contains(points[10].first, points[10].second)) cout << "FAILED...Quadtree contains\n";
+
+	// rectangle counts against brute force over the cells
+	for (int i = 0; i < 100; ++i) {
+		int xl {randint_seeded() % 1000}, yl {randint_seeded() % 1000};
+		int xh {xl + std::abs(randint_seeded() % 300)}, yh {yl + std::abs(randint_seeded() % 300)};
+		size_t expected {0};
+		for (const auto& c : cells)
+			if (c.first >= (xl + 1000) / 2 && c.first <= (xh + 1000) / 2 && c.second >= (yl + 1000) / 2 && c.second <= (yh + 1000) / 2) ++expected;
+		if (q.count(xl, xh, yl, yh) != expected || q.empty(xl, xh, yl, yh) != (expected == 0)) {
+			cout << "FAILED...Quadtree rectangle query\n";
+			break;
+		}
+	}
+	if (!q.empty(1500, 1600, 0, 10) || q.count(-1000, 1000, -1000, 1000) != cells.size()) cout << "FAILED...Quadtree rectangle query\n";
+
+	// nearest cells come out in distance order and match the brute force kth distance
+	auto cell_distance = [](const std::pair<int,int>& corner, int x, int y) {
+		// distance from (x, y) to the 2 x 2 cell
+		double dx {std::max({corner.first - x, 0, x - (corner.first + 2)}) / 2.0};
+		double dy {std::max({corner.second - y, 0, y - (corner.second + 2)}) / 2.0};
+		return dx*dx + dy*dy;
+	};
+	auto nearest = q.k_nearest(250, 250, 10);
+	std::vector<double> brute;
+	for (const auto& c : cells) brute.push_back(cell_distance({c.first * 2 - 1000, c.second * 2 - 1000}, 250, 250));
+	std::sort(brute.begin(), brute.end());
+	if (nearest.size() != 10 || cell_distance(nearest.back(), 250, 250) != brute[9]) cout << "FAILED...Quadtree k nearest\n";
+	for (size_t i = 1; i < nearest.size(); ++i)
+		if (cell_distance(nearest[i-1], 250, 250) > cell_distance(nearest[i], 250, 250)) cout << "FAILED...Quadtree k nearest order\n";
+
+	sal::Quadtree<int> loaded;
+	loaded.build_from_sorted(q.cells().begin(), q.cells().end());
+	loaded.erase(0, 0);
+	loaded.insert(0, 0);
+	if (!loaded.contains(0, 0) || loaded.count(0, 0, 0, 0) != 1) cout << "FAILED...Quadtree bulk load\n";
+}
+
+void test_infint(bool print) {
+	// (10^n - 1)^2 = 99..9800..01, sizes cross every multiplication tier
+	for (size_t n : {10, 500, 5000, 40000}) {
+		Infint nines {std::string(n, '9')};
+		std::string expected {std::string(n - 1, '9') + '8' + std::string(n - 1, '0') + '1'};
+		if ((nines * nines).str() != expected) cout << "FAILED...Infint multiply " << n << " digits\n";
+	}
+	// division inverts multiplication and leaves the remainder, on both division paths
+	auto random_digits = [](size_t n) {
+		std::string s {std::to_string(1 + std::abs(randint_seeded() % 9))};
+		while (s.size() < n) s += std::to_string(std::abs(randint_seeded() % 10));
+		return Infint{s};
+	};
+	for (size_t n : {20, 3000}) {
+		Infint a {random_digits(2 * n)}, b {random_digits(n)}, r {random_digits(n / 2)};
+		Infint product {a * b + r};
+		if (product / b != a || product % b != r || (-product) / b != -a || (-product) % b != -r)
+			cout << "FAILED...Infint divide " << n << " digits\n";
+	}
+	// decimal conversion round trips, long enough for the divide and conquer split of binary limbs
+	for (size_t n : {19, 20, 700, 9000}) {
+		std::string s {random_digits(n).str()};
+		s.replace(s.size() / 2, 45, std::string(45, '0'));
+		if (Infint{s}.str() != s || Infint{'-' + s}.str() != '-' + s || Infint{s}.digit_num() != s.size())
+			cout << "FAILED...Infint string conversion " << n << " digits\n";
+	}
+	// operations into existing numbers agree with the operators when out is also an operand
+	Infint a {random_digits(30)}, b {-random_digits(25)}, out {a};
+	Infint::add(out, out, out);
+	if (out != a * 2) cout << "FAILED...Infint add in place\n";
+	Infint::subtract(out, b, out);
+	if (out != b - a * 2) cout << "FAILED...Infint subtract in place\n";
+	Infint::multiply(out, out, b);
+	if (out != (b - a * 2) * b) cout << "FAILED...Infint multiply in place\n";
+	Infint q {a}, r;
+	Infint::divide(q, r, q, b);
+	if (q != a / b || r != a % b || q * b + r != a) cout << "FAILED...Infint divide in place\n";
+	if ((a + b) - (b + a) != Infint::zero || -(a - a) != Infint::zero || a - (a + b) != -b)
+		cout << "FAILED...Infint rvalue operators\n";
 }
 
 void test_interval_set(bool print) {
@@ -216,6 +855,50 @@ void test_interval_set(bool print) {
 	if (all_intervals.size() != 2) cout << "FAILED...Interval set find all\n";
 }
 
+// against brute force on random intervals, results stream in sorted order
+void test_interval_index(bool print) {
+	sal::Interval_index<int> t {{16,21}, {8,9}, {5,8}, {15,23}, {25,30}, {0, 3}, {6, 10}, {17,19}, {26,26}, {19,20}};
+	std::vector<sal::Interval<int>> found;
+	t.query(20, 27, std::back_inserter(found));
+	if (found != std::vector<sal::Interval<int>>{{15,23},{16,21},{19,20},{25,30},{26,26}}) 
+		cout << "FAILED...Interval index query\n";
+	if (t.count(11, 14) != 0 || t.count(26, 26) != 2 || t.count(-5, 100) != 10) cout << "FAILED...Interval index count\n";
+	t.for_each_overlap(2, 4, [&](const sal::Interval<int>& interval) {
+		if (t.id(interval) != 5) cout << "FAILED...Interval index id\n";
+	});
+	if (print) for (const auto& interval : t) cout << '[' << interval.low << ',' << interval.high << "] ";
+	if (print) cout << endl;
+
+	std::vector<sal::Interval<int>> intervals, queries;
+	for (int i = 0; i < 3000; ++i) {
+		int low {static_cast<int>(static_cast<unsigned>(randint_seeded()) % 10000)};
+		intervals.push_back({low, low + static_cast<int>(static_cast<unsigned>(randint_seeded()) % (i % 7 == 0? 2000 : 50))});
+	}
+	for (int i = 0; i < 500; ++i) {
+		int low {static_cast<int>(static_cast<unsigned>(randint_seeded()) % 11000) - 500};
+		queries.push_back({low, low + static_cast<int>(static_cast<unsigned>(randint_seeded()) % 300)});
+	}
+	sal::Interval_index<int> index {intervals.begin(), intervals.end()};
+	std::vector<std::vector<size_t>> batched(queries.size());
+	index.query_many(queries.begin(), queries.end(), [&](size_t q, const sal::Interval<int>& interval) {
+		batched[q].push_back(index.id(interval));
+	});
+	for (size_t q = 0; q < queries.size(); ++q) {
+		std::vector<size_t> expected, streamed;
+		for (size_t i = 0; i < intervals.size(); ++i) 
+			if (intervals[i].low <= queries[q].high && intervals[i].high >= queries[q].low) expected.push_back(i);
+		index.for_each_overlap(queries[q], [&](const sal::Interval<int>& interval) {streamed.push_back(index.id(interval));});
+		if (!std::is_sorted(streamed.begin(), streamed.end(), [&](size_t a, size_t b) {return intervals[a].low < intervals[b].low;}))
+			cout << "FAILED...Interval index sorted results\n";
+		std::sort(streamed.begin(), streamed.end());
+		std::sort(batched[q].begin(), batched[q].end());
+		if (streamed != expected) {cout << "FAILED...Interval index overlaps\n"; break;}
+		if (batched[q] != expected) {cout << "FAILED...Interval index batched overlaps\n"; break;}
+	}
+	sal::Interval_index<int> none;
+	if (none.count(0, 10) != 0) cout << "FAILED...Empty interval index\n";
+}
+
 struct Rect {
 	int xl,xh, yl,yh;
 };
@@ -343,7 +1026,57 @@ void test_bfs(bool print) {
 		if (parent == 's') {cout << endl; break;}
 		cout << " <- ";
 	}
-	if (property['u'].distance != 3) cout << "FAILED...Breadth first search\n";
+	std::map<char, size_t> distances {{'s',0},{'r',1},{'w',1},{'v',2},{'t',2},{'x',2},{'u',3},{'y',3}};
+	for (const auto& v : distances)
+		if (property[v.first].distance != v.second) cout << "FAILED...Breadth first search\n";
+}
+
+void test_parallel_bfs(bool print) {
+	sal::Thread_pool pool {4};
+	// parents have to be one level closer and joined by an edge
+	auto check = [](const auto& g, const auto& serial, auto& parallel, const char* name) {
+		for (size_t v = 0; v < g.num_vertex(); ++v) {
+			if (parallel[v].distance != serial.at(v).distance) {cout << "FAILED..." << name << " distance\n"; return;}
+			if (v != 0 && parallel[v].distance != POS_INF(size_t) && 
+				(!g.is_edge(parallel[v].parent, v) || parallel[parallel[v].parent].distance + 1 != parallel[v].distance)) {
+				cout << "FAILED..." << name << " parent\n"; 
+				return;
+			}
+		}
+	};
+
+	sal::graph_csr<size_t> u {{0,1},{0,2},{1,2},{3,2},{4,5}};
+	auto small = sal::bfs(u, 0, sal::par, pool);
+	if (print) for (size_t v = 0; v < u.num_vertex(); ++v) PRINTLINE(v << " <- " << small[v].parent << '\t' << small[v].distance);
+	if (small[3].distance != 2 || small[3].parent != 2 || small[4].distance != POS_INF(size_t)) 
+		cout << "FAILED...Parallel BFS\n";
+
+	sal::digraph_mat<int> m {{0,1},{1,2},{2,0},{2,3},{4,3}};
+	auto mat = sal::bfs(m, 0, sal::par, pool);
+	if (mat[3].distance != 3 || mat[3].parent != 2 || mat[4].distance != POS_INF(size_t)) 
+		cout << "FAILED...Parallel BFS adjacency matrix\n";
+	sal::graph_mat<int> um {{0,1},{1,2},{2,3},{4,3}};
+	auto umat = sal::bfs(um, 4, sal::par, pool);
+	if (umat[0].distance != 4 || umat[0].parent != 1) cout << "FAILED...Parallel BFS undirected adjacency matrix\n";
+
+	// large enough to switch to bottom up and back
+	std::vector<sal::UEdge<size_t>> edges;
+	size_t n {20000};
+	for (size_t i = 0; i < 8*n; ++i) 
+		edges.emplace_back(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n);
+	// long tail keeps some levels small
+	for (size_t i = n; i < n + 100; ++i) edges.emplace_back(i - 1, i);
+	sal::digraph_csr<size_t> d {edges.begin(), edges.end()};
+	auto serial_d = sal::bfs<sal::Dense_property>(d, 0);
+	auto parallel_d = sal::bfs(d, 0, sal::par, pool);
+	check(d, serial_d, parallel_d, "Parallel BFS directed CSR");
+	sal::graph_csr<size_t> ud {edges.begin(), edges.end()};
+	auto serial_ud = sal::bfs<sal::Dense_property>(ud, 0);
+	auto parallel_ud = sal::bfs(ud, 0, sal::par, pool);
+	check(ud, serial_ud, parallel_ud, "Parallel BFS undirected CSR");
+	sal::Thread_pool single {1};
+	auto serial_pool = sal::bfs(ud, 0, sal::par, single);
+	check(ud, serial_ud, serial_pool, "Parallel BFS single thread");
 }
 
 void test_dfs(bool print) {
@@ -412,6 +1145,78 @@ void test_strongly_connected(bool print) {
 	}
 }
 
+void test_parallel_order(bool print) {
+	sal::Thread_pool pool {4};
+	// long chains don't overflow the stack
+	std::vector<sal::WEdge<int>> chain;
+	int length {1000000};
+	for (int i = 1; i < length; ++i) chain.emplace_back(i - 1, i, 1);
+	sal::digraph_csr<int> long_chain {chain.begin(), chain.end()};
+	std::vector<int> chain_order;
+	sal::topological_sort(long_chain, std::back_inserter(chain_order));
+	if (chain_order.size() != static_cast<size_t>(length) || chain_order.front() != length - 1 || chain_order.back() != 0 ||
+		sal::has_cycle(long_chain)) cout << "FAILED...Explicit stack DFS long chain\n";
+	// each edge is examined once, even after returning to a vertex from a child
+	sal::digraph_csr<int> loop {{0,1},{1,0},{1,2}};
+	sal::DFS_visitor<sal::Op_stats<>> depth;
+	sal::dfs<sal::Dense_property>(loop, depth);
+	if (depth.stats[sal::Stat::back_edge] != 1) cout << "FAILED...Explicit stack DFS back edges\n";
+
+	// random dag with edges from lower to higher vertices, some negative
+	int n {20000};
+	std::vector<sal::WEdge<int>> edges;
+	for (int i = 0; i < 4*n; ++i) {
+		int u {static_cast<int>(static_cast<unsigned>(randint_seeded()) % (n - 1))};
+		int v {u + 1 + static_cast<int>(static_cast<unsigned>(randint_seeded()) % (n - u - 1))};
+		edges.emplace_back(u, v, static_cast<int>(static_cast<unsigned>(randint_seeded()) % 100) - 20);
+	}
+	edges.emplace_back(0, n - 1, 0);
+	sal::digraph_csr<int> dag {edges.begin(), edges.end()};
+	auto levels = sal::topological_levels(dag, sal::par, pool);
+	std::vector<size_t> level_of(n, n);
+	for (size_t l = 0; l < levels.size(); ++l) for (int v : levels[l]) level_of[v] = l;
+	for (const auto& e : edges) 
+		if (level_of[e.source] >= level_of[e.dest]) {cout << "FAILED...Parallel topological levels\n"; break;}
+	std::vector<int> order;
+	if (!sal::topological_sort(dag, std::back_inserter(order), sal::par, pool) || order.size() != static_cast<size_t>(n))
+		cout << "FAILED...Parallel topological sort\n";
+	if (print) PRINTLINE(levels.size() << " levels");
+	sal::digraph_csr<int> cycle {{0,1},{1,2},{2,1},{3,0}};
+	std::vector<int> partial;
+	if (sal::topological_sort(cycle, std::back_inserter(partial), sal::par, pool) || partial != std::vector<int>{3,0})
+		cout << "FAILED...Parallel topological sort cycle\n";
+
+	auto serial = sal::shortest_dag<sal::Dense_property>(dag, 0);
+	auto leveled = sal::shortest_dag<sal::Dense_property>(dag, 0, sal::par, pool);
+	for (int v = 0; v < n; ++v)
+		if (leveled[v].distance != serial[v].distance) {cout << "FAILED...Parallel shortest dag distance\n"; break;}
+	if (!sal::is_shortest(leveled, dag, 0)) cout << "FAILED...Parallel shortest dag\n";
+	if (!sal::shortest_dag(cycle, 3, sal::par, pool).empty()) cout << "FAILED...Parallel shortest dag cycle\n";
+
+	// components against strongly connected components of the same undirected graph
+	std::vector<sal::UEdge<int>> sparse;
+	for (int i = 0; i < n / 2; ++i) 
+		sparse.emplace_back(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n);
+	// csr graphs end at the largest vertex with an edge
+	sparse.emplace_back(n - 1, n - 1);
+	sal::graph_csr<int> u {sparse.begin(), sparse.end()};
+	sal::graph<int> list;
+	for (int v = 0; v < n; ++v) list.add_vertex(v);
+	for (const auto& e : sparse) list.add_edge(e.source, e.dest);
+	auto labels = sal::connected_components(u, sal::par, pool);
+	auto sets = sal::strongly_connected(list);
+	std::set<int> roots;
+	for (const auto& component : sets) {
+		int smallest {*std::min_element(component.begin(), component.end())};
+		roots.insert(smallest);
+		for (int v : component) if (labels[v] != smallest) {cout << "FAILED...Parallel connected components\n"; break;}
+	}
+	if (labels.size() != static_cast<size_t>(n) || roots.size() != sets.size()) cout << "FAILED...Parallel connected components\n";
+	if (print) PRINTLINE(sets.size() << " components");
+	sal::Thread_pool single {1};
+	if (sal::connected_components(u, sal::par, single) != labels) cout << "FAILED...Parallel connected components single thread\n";
+}
+
 void test_mst(bool print) {
 	sal::graph<char> circuit {{'a','b',4},{'a','h',8},{'b','h',11},{'b','c',8},{'c','i',2},
 					{'c','f',4},{'c','d',7},{'d','f',14},{'d','e',9},{'e','f',10},{'f','g',2},
@@ -440,7 +1245,10 @@ void test_matrix(bool print) {
 	id3.resize(2,2);
 	if (print) cout << id3 << endl;
 	test_mul(print);
+	test_gemm(print);
 	test_pow(print);
+	test_matrix_view(print);
+	test_fixed_matrix(print);
 }
 
 void test_bellman_ford(bool print) {
@@ -478,6 +1286,45 @@ void test_dijkstra(bool print) {
 	if (!sal::is_shortest(non_neg_shortest, g, 's')) PRINTLINE("FAILED...Djikstra non-negative shortest path");
 }
 
+void test_dynamic_shortest(bool print) {
+	sal::digraph<char> g {{'s','t',10},{'s','y',5},{'t','y',2},{'t','x',1},{'x','z',4},{'y','t',3},
+						{'y','x',9},{'y','z',2},{'z','s',7},{'z','x',6}};
+	sal::Dynamic_shortest<sal::digraph<char>> paths {g, 's'};
+	// shortcut to x, then make the tree edge (s,y) expensive
+	paths.update_edge('s', 'x', 1);
+	if (paths['x'].distance != 1 || paths['x'].parent != 's' || paths['z'].distance != 5)
+		cout << "FAILED...Dynamic shortest path decrease\n";
+	paths.update_edge('s', 'y', 20);
+	if (print) for (char v : g) PRINTLINE(v << " <- " << paths[v].parent << '\t' << paths[v].distance);
+	auto repaired = paths.paths();
+	if (paths['y'].distance != 12 || paths['y'].parent != 't' || paths['t'].distance != 10 || !sal::is_shortest(repaired, g, 's'))
+		cout << "FAILED...Dynamic shortest path increase\n";
+	// non tree edge increase touches nothing
+	paths.update_edge('z', 'x', 100);
+	if (paths.last_affected() != 0) cout << "FAILED...Dynamic shortest path non tree edge\n";
+
+	// random updates against recomputing
+	int n {300};
+	sal::digraph<int> r;
+	for (int v = 0; v < n; ++v) r.add_vertex(v);
+	for (int i = 0; i < 5*n; ++i) 
+		r.add_edge(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n, 
+			1 + static_cast<unsigned>(randint_seeded()) % 50);
+	sal::Dynamic_shortest<sal::digraph<int>, sal::Dense_property> dynamic {r, 0};
+	for (int i = 0; i < 500; ++i) {
+		int u = static_cast<unsigned>(randint_seeded()) % n, v = static_cast<unsigned>(randint_seeded()) % n;
+		dynamic.update_edge(u, v, static_cast<unsigned>(randint_seeded()) % 100);
+		auto expected = sal::dijkstra<sal::Dense_property>(r, 0);
+		auto repaired_random = dynamic.paths();
+		bool same {true};
+		for (int x = 0; x < n; ++x) same = same && dynamic[x].distance == expected[x].distance;
+		if (!same || !sal::is_shortest(repaired_random, r, 0)) {
+			cout << "FAILED...Dynamic shortest path random updates\n";
+			break;
+		}
+	}
+}
+
 void test_difference_constraint(bool print) {
 	// solution size is # of cols for constraint matrix A
 	sal::Constraint_sys<int> system {{1,2,0},{1,5,-1},{2,5,1},{3,1,5},{4,1,4},{4,3,-1},
@@ -489,6 +1336,226 @@ void test_difference_constraint(bool print) {
 			PRINTLINE("FAILED...Difference constraint feasibility with Bellman-Ford");
 }
 
+void test_parallel_shortest(bool print) {
+	sal::Thread_pool pool {4};
+	sal::digraph<char> g {{'s','t',6},{'s','y',7},{'t','y',8},{'t','x',5},{'t','z',-4},
+						{'x','t',-2},{'y','x',-3},{'y','z',9},{'z','s',2},{'z','x',7}};
+	auto serial = sal::bellman_ford(g, 's');
+	auto frontier = sal::bellman_ford(g, 's', sal::par, pool);
+	if (print) for (char v : g) PRINTLINE(v << " <- " << frontier[v].parent << '\t' << frontier[v].distance);
+	if (!sal::is_shortest(frontier, g, 's')) PRINTLINE("FAILED...Parallel bellman ford shortest path");
+	for (char v : g) 
+		if (frontier[v].distance != serial[v].distance) PRINTLINE("FAILED...Parallel bellman ford distance");
+
+	// negative weights fall back to bellman ford
+	auto stepped = sal::delta_stepping(g, 's', 0, pool);
+	if (!sal::is_shortest(stepped, g, 's')) PRINTLINE("FAILED...Delta stepping negative weights");
+
+	// negative cycle t -> z -> x -> t
+	sal::digraph<char> cycle {{'s','t',1},{'t','z',-4},{'z','x',1},{'x','t',2},{'x','y',1}};
+	if (!sal::bellman_ford(cycle, 's', sal::par, pool).empty() || !sal::delta_stepping(cycle, 's', 0, pool).empty())
+		PRINTLINE("FAILED...Parallel shortest path negative cycle");
+
+	// larger random graphs against dijkstra, dense ids through csr
+	std::vector<sal::WEdge<int>> edges;
+	int n {3000};
+	for (int i = 0; i < 6*n; ++i) 
+		edges.emplace_back(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n, 
+			static_cast<unsigned>(randint_seeded()) % 100);
+	for (int i = 1; i < n; ++i) edges.emplace_back(i - 1, i, 1000);
+	sal::digraph_csr<int> c {edges.begin(), edges.end()};
+	auto expected = sal::dijkstra<sal::Dense_property>(c, 0);
+	auto random_frontier = sal::bellman_ford<sal::Dense_property>(c, 0, sal::par, pool);
+	auto random_stepped = sal::delta_stepping<sal::Dense_property>(c, 0, 0, pool);
+	auto narrow_stepped = sal::delta_stepping<sal::Dense_property>(c, 0, 5, pool);
+	for (int v = 0; v < n; ++v) 
+		if (random_frontier[v].distance != expected[v].distance || random_stepped[v].distance != expected[v].distance ||
+			narrow_stepped[v].distance != expected[v].distance) {
+			PRINTLINE("FAILED...Parallel shortest path random graph distance");
+			break;
+		}
+	if (!sal::is_shortest(random_frontier, c, 0) || !sal::is_shortest(random_stepped, c, 0) || 
+		!sal::is_shortest(narrow_stepped, c, 0)) PRINTLINE("FAILED...Parallel shortest path random graph");
+
+	sal::Constraint_sys<int> system {{1,2,0},{1,5,-1},{2,5,1},{3,1,5},{4,1,4},{4,3,-1},
+									{5,3,-3},{5,4,-3}};
+	if (sal::feasible(system, 5, sal::par, pool) != sal::feasible(system, 5)) 
+		PRINTLINE("FAILED...Parallel difference constraint feasibility");
+	system.insert({1,4,-20});
+	if (!sal::feasible(system, 5, sal::par, pool).empty()) PRINTLINE("FAILED...Parallel difference constraint infeasibility");
+}
+
+void test_all_pairs(bool print) {
+	sal::Thread_pool pool {4};
+	const int inf {POS_INF(int)};
+	// negative edges without negative cycles, 5 only leaves so nothing reaches it
+	sal::digraph_mat<int> g {{0,1,3},{0,2,8},{0,4,-4},{1,3,1},{1,4,7},{2,1,4},{3,0,2},{3,2,-5},{4,3,6},{5,0,1}};
+	sal::Matrix<int> expected {{0, 1, -3, 2, -4, inf},
+							   {3, 0, -4, 1, -1, inf},
+							   {7, 4, 0, 5, 3, inf},
+							   {2, -1, -5, 0, -2, inf},
+							   {8, 5, 1, 6, 0, inf},
+							   {1, 2, -2, 3, -3, 0}};
+	auto floyd = sal::floyd_warshall(g, true);
+	if (print) cout << floyd.distance << endl;
+	if (floyd.distance != expected) cout << "FAILED...Floyd warshall distances\n";
+	if (floyd.path(2, 4) != std::vector<size_t>{2, 1, 3, 0, 4} || !floyd.path(0, 5).empty() || floyd.path(3, 3) != std::vector<size_t>{3})
+		cout << "FAILED...Floyd warshall paths\n";
+	std::vector<sal::WEdge<size_t,int>> small_edges;
+	for (size_t u = 0; u < g.num_vertex(); ++u)
+		for (size_t v = 0; v < g.num_vertex(); ++v) if (g.is_edge(u, v)) small_edges.emplace_back(u, v, g.weight(u, v));
+	sal::digraph_csr<size_t,int> small {small_edges.begin(), small_edges.end()};
+	auto reweighted = sal::johnson(small, true);
+	if (reweighted.distance != expected || reweighted.path(2, 4) != floyd.path(2, 4)) cout << "FAILED...Johnson distances\n";
+
+	// negative cycle 1 -> 3 -> 2 -> 1
+	sal::digraph_mat<int> cycle {{0,1,1},{1,3,1},{3,2,-5},{2,1,2}};
+	std::vector<sal::WEdge<size_t,int>> cycle_edges {{0,1,1},{1,3,1},{3,2,-5},{2,1,2}};
+	sal::digraph_csr<size_t,int> cycle_csr {cycle_edges.begin(), cycle_edges.end()};
+	if (!sal::floyd_warshall(cycle).empty() || !sal::floyd_warshall(cycle, false, sal::par, pool).empty() ||
+		!sal::johnson(cycle_csr).empty() || !sal::johnson(cycle_csr, false, sal::par, pool).empty())
+		cout << "FAILED...All pairs negative cycle\n";
+
+	// random graphs with partial tiles, negative weights come from potentials on non-negative ones
+	// so distance(u,v) = base distance(u,v) + p(u) - p(v)
+	size_t n {150};
+	std::vector<int> potential(n);
+	for (int& p : potential) p = static_cast<unsigned>(randint_seeded()) % 50;
+	std::vector<sal::WEdge<size_t,int>> base_edges, edges;
+	sal::Matrix<int> weights {n, n, inf};
+	for (size_t u = 0; u < n; ++u)
+		for (size_t v = 0; v < n; ++v) {
+			if (u == v || static_cast<unsigned>(randint_seeded()) % 10 >= 3) continue;
+			int w = static_cast<unsigned>(randint_seeded()) % 100;
+			base_edges.emplace_back(u, v, w);
+			edges.emplace_back(u, v, w + potential[u] - potential[v]);
+			weights.get(u, v) = edges.back().weight;
+		}
+	sal::digraph_csr<size_t,int> base {base_edges.begin(), base_edges.end()};
+	sal::digraph_csr<size_t,int> sparse {edges.begin(), edges.end()};
+	sal::digraph_mat<int> dense {weights};
+	auto serial_floyd = sal::floyd_warshall(dense, true);
+	auto parallel_floyd = sal::floyd_warshall(dense, true, sal::par, pool);
+	auto serial_johnson = sal::johnson(sparse, true);
+	auto parallel_johnson = sal::johnson(sparse, true, sal::par, pool);
+	sal::Matrix<int> in_place {weights};
+	sal::floyd_warshall(in_place, nullptr, sal::par, pool);
+	bool distances {true}, paths {true};
+	for (size_t u = 0; u < n; ++u) {
+		auto from = sal::dijkstra<sal::Dense_property>(base, u);
+		for (size_t v = 0; v < n; ++v) {
+			int d {from[v].distance + potential[u] - potential[v]};
+			distances = distances && serial_floyd.distance.get(u, v) == d && parallel_floyd.distance.get(u, v) == d &&
+				serial_johnson.distance.get(u, v) == d && parallel_johnson.distance.get(u, v) == d && in_place.get(u, v) == d;
+		}
+		// parents trace paths with the right lengths
+		for (const auto* res : {&serial_floyd, &parallel_floyd, &serial_johnson, &parallel_johnson}) {
+			size_t v {static_cast<size_t>(randint_seeded()) % n};
+			auto path = res->path(u, v);
+			int length {0};
+			for (size_t i = 1; i < path.size(); ++i) length += weights.get(path[i-1], path[i]);
+			paths = paths && path.front() == u && path.back() == v && length == res->distance.get(u, v);
+		}
+	}
+	if (!distances) cout << "FAILED...All pairs random distances\n";
+	if (!paths) cout << "FAILED...All pairs random paths\n";
+}
+
+void test_semiring(bool print) {
+	sal::Thread_pool pool {4};
+	const int inf {POS_INF(int)};
+	// shortest walks of exactly 2 edges on a 3 cycle, staying put costs 0 so the identity is 0 and inf
+	sal::Matrix<int> w {{0, 3, inf},
+						{inf, 0, 4},
+						{1, inf, 0}};
+	sal::Matrix<int> w2 {w};
+	w2.pow<sal::Min_plus<int>>(2);
+	if (print) cout << w2 << endl;
+	if (w2 != sal::Matrix<int>{{0, 3, 7}, {5, 0, 4}, {1, 4, 0}} || sal::pow<sal::Min_plus<int>>(w, 0) != sal::identity<int, sal::Min_plus<int>>(3))
+		cout << "FAILED...Min plus power\n";
+
+	// blocked kernels with partial tiles against the naive loop, through a transposed view too
+	size_t m {70}, k {90}, n {50};
+	sal::Matrix<int> a {m, k}, b {k, n}, b_t {n, k};
+	sal::Matrix<double> da {m, k}, db {k, n};
+	sal::Matrix<unsigned char> ba {m, k}, bb {k, n};
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < k; ++j) {
+			a.get(i, j) = randint_seeded() % 4 == 0? inf : static_cast<unsigned>(randint_seeded()) % 100;
+			da.get(i, j) = a.get(i, j) == inf? POS_INF(double) : a.get(i, j) * 0.5;
+			ba.get(i, j) = randint_seeded() % 20 == 0;
+		}
+	for (size_t i = 0; i < k; ++i)
+		for (size_t j = 0; j < n; ++j) {
+			b.get(i, j) = b_t.get(j, i) = randint_seeded() % 4 == 0? inf : static_cast<int>(static_cast<unsigned>(randint_seeded()) % 100) - 20;
+			db.get(i, j) = b.get(i, j) == inf? POS_INF(double) : b.get(i, j) * 0.5;
+			bb.get(i, j) = randint_seeded() % 20 == 0;
+		}
+	sal::Matrix<int> expected {m, n, inf};
+	sal::Matrix<unsigned char> expected_bits {m, n};
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j)
+			for (size_t p = 0; p < k; ++p) {
+				if (a.get(i, p) != inf && b.get(p, j) != inf) expected.get(i, j) = std::min(expected.get(i, j), a.get(i, p) + b.get(p, j));
+				expected_bits.get(i, j) |= ba.get(i, p) && bb.get(p, j);
+			}
+	sal::Matrix<int> through_view {a};
+	through_view.multiply<sal::Min_plus<int>>(b_t.transposed_view());
+	if (sal::mul<sal::Min_plus<int>>(a, b) != expected || through_view != expected || 
+		sal::mul<sal::Min_plus<int>>(a, b, sal::par) != expected) cout << "FAILED...Min plus product\n";
+	auto doubles = sal::mul<sal::Min_plus<double>>(da, db);
+	bool same {true};
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j)
+			same = same && (expected.get(i, j) == inf? doubles.get(i, j) == POS_INF(double) : doubles.get(i, j) == expected.get(i, j) * 0.5);
+	if (!same) cout << "FAILED...Min plus floating point product\n";
+	if (sal::mul<sal::Or_and<unsigned char>>(ba, bb) != expected_bits) cout << "FAILED...Boolean product\n";
+
+	// k hop queries on a random graph against k rounds of relaxation and walk counting
+	size_t v_num {120}, hops {5};
+	std::vector<sal::WEdge<size_t,int>> edges;
+	for (size_t u = 0; u < v_num; ++u)
+		for (size_t v = 0; v < v_num; ++v)
+			if (u != v && randint_seeded() % 25 == 0) edges.emplace_back(u, v, static_cast<unsigned>(randint_seeded()) % 50);
+	sal::digraph_mat<int> g {edges.begin(), edges.end(), v_num};
+	sal::Matrix<int> relaxed {sal::hop_weights(g)};
+	sal::Matrix<size_t> walks {sal::identity<size_t>(v_num)};
+	for (size_t round = 0; round < hops; ++round) {
+		sal::Matrix<int> next {relaxed};
+		sal::Matrix<size_t> longer {v_num, v_num};
+		for (size_t s = 0; s < v_num; ++s)
+			for (const auto& edge : edges) {
+				if (round + 1 < hops && relaxed.get(s, edge.source) != inf)
+					next.get(s, edge.dest) = std::min(next.get(s, edge.dest), relaxed.get(s, edge.source) + edge.weight);
+				longer.get(s, edge.dest) += walks.get(s, edge.source);
+			}
+		relaxed = std::move(next);
+		walks = std::move(longer);
+	}
+	if (sal::hop_distances(g, hops) != relaxed || sal::hop_distances(g, hops, sal::par) != relaxed)
+		cout << "FAILED...Hop bounded distances\n";
+	if (sal::count_walks(g, hops) != walks || sal::count_walks(g, hops, sal::par) != walks) cout << "FAILED...Walk counts\n";
+
+	// bit packed powers across word boundaries against bfs levels
+	sal::digraph_bits bits {v_num};
+	for (const auto& edge : edges) bits.add_edge(edge.source, edge.dest);
+	auto within = sal::reachable_within(bits, 3);
+	auto exact = sal::boolean_pow(bits, 2);
+	for (size_t s = 0; s < v_num; ++s) {
+		auto levels = sal::bfs<sal::Dense_property>(bits, s);
+		for (size_t v = 0; v < v_num; ++v) {
+			bool two_steps {false};
+			for (size_t x = 0; x < v_num; ++x) two_steps |= bits.is_edge(s, x) && bits.is_edge(x, v);
+			if (within.is_edge(s, v) != (levels[v].distance <= 3) || exact.is_edge(s, v) != two_steps) {
+				cout << "FAILED...Bit matrix k hop reachability\n";
+				s = v_num;
+				break;
+			}
+		}
+	}
+	if (sal::boolean_pow(bits, 0).num_edge() != v_num) cout << "FAILED...Bit matrix zeroth power\n";
+}
+
 void test_adjacency_matrix(bool print) {
 	// std::vector<sal::UEdge<size_t>> edges {{0,1},{0,2},{1,2},{3,2}};
 	// sal::graph_mat<int> g {edges.begin(), edges.end(), 4};
@@ -498,6 +1565,372 @@ void test_adjacency_matrix(bool print) {
 
 	sal::digraph_mat<int> h {{0,1},{0,2},{1,2},{3,2}};
 	if (print) std:: cout << h;
+	if (g.num_edge() != 4 || h.num_edge() != 4) cout << "FAILED...Adjacency matrix number of edges\n";
+
+	// in edges through a column view, reversed graph through the blocked transpose
+	sal::digraph_mat<int> h_t {sal::transpose(h)};
+	size_t in_degree {0};
+	auto in = h.in_weights(2);
+	for (size_t u = 0; u < in.row(); ++u) in_degree += in.get(u, 0) != POS_INF(int);
+	if (in_degree != 3 || h_t.degree(2) != 3 || !h_t.is_edge(1, 0) || h_t.is_edge(0, 1) || h_t.num_edge() != 4)
+		cout << "FAILED...Adjacency matrix transpose\n";
+}
+
+void test_bit_matrix(bool print) {
+	sal::graph_bits g {{0,1},{0,2},{1,2},{3,2}};
+	sal::graph_mat<int> m {{0,1},{0,2},{1,2},{3,2}};
+	if (print) cout << g;
+	if (g.num_vertex() != m.num_vertex() || g.num_edge() != m.num_edge()) cout << "FAILED...Bit matrix cardinality\n";
+	for (size_t u : m) {
+		if (g.degree(u) != m.degree(u)) cout << "FAILED...Bit matrix degree\n";
+		auto bit_edges = g.adjacent(u);
+		auto mat_edges = m.adjacent(u);
+		for (; mat_edges.first != mat_edges.second; ++mat_edges.first, ++bit_edges.first) 
+			if (bit_edges.first == bit_edges.second || *bit_edges.first != *mat_edges.first) 
+				cout << "FAILED...Bit matrix neighbour iteration\n";
+		if (bit_edges.first != bit_edges.second) cout << "FAILED...Bit matrix neighbour iteration\n";
+	}
+	if (sal::triangle_count(g) != 1) cout << "FAILED...Bit matrix triangle count\n";
+
+	// growing across word boundaries keeps existing edges
+	sal::digraph_bits d {{0,1},{1,63}};
+	d.add_edge(63, 64);
+	d.add_edge(64, 130);
+	d.add_edge(130, 0);
+	if (d.num_vertex() != 131 || d.num_edge() != 5 || !d.is_edge(1, 63) || !d.is_edge(130, 0) || d.is_edge(0, 130)) 
+		cout << "FAILED...Bit matrix growth\n";
+	d.remove_edge(63, 64);
+	if (d.num_edge() != 4 || d.is_edge(63, 64) || d.degree(63) != 0) cout << "FAILED...Bit matrix remove edge\n";
+	auto reach = sal::transitive_closure(d);
+	if (!reach.is_edge(0, 63) || reach.is_edge(0, 64) || !reach.is_edge(64, 63) || reach.is_edge(0, 0) || 
+		reach.is_edge(130, 130)) cout << "FAILED...Bit matrix transitive closure\n";
+
+	// random graphs against the adjacency list and brute force
+	size_t n {150};
+	std::vector<sal::UEdge<size_t>> edges;
+	for (size_t i = 0; i < 2000; ++i) 
+		edges.emplace_back(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n);
+	sal::graph_bits r {edges.begin(), edges.end(), n};
+	sal::graph<size_t> l {edges.begin(), edges.end()};
+	if (r.num_edge() != l.num_edge()) cout << "FAILED...Bit matrix random cardinality\n";
+	size_t triangles {0};
+	for (size_t u = 0; u < n; ++u)
+		for (size_t v = u + 1; v < n; ++v)
+			for (size_t w = v + 1; w < n; ++w) triangles += r.is_edge(u, v) && r.is_edge(v, w) && r.is_edge(u, w);
+	if (sal::triangle_count(r) != triangles) cout << "FAILED...Bit matrix random triangle count\n";
+
+	sal::digraph_bits rd {edges.begin(), edges.begin() + 200, n};
+	auto closure = sal::transitive_closure(rd);
+	for (size_t u = 0; u < n; ++u) {
+		auto levels = sal::bfs(rd, u, sal::par);
+		for (size_t v = 0; v < n; ++v) {
+			// u reaches itself through a cycle back from some reached vertex
+			bool reached {v == u? false : levels[v].distance != POS_INF(size_t)};
+			if (v == u) for (size_t w = 0; w < n; ++w) reached |= levels[w].distance != POS_INF(size_t) && rd.is_edge(w, u);
+			if (closure.is_edge(u, v) != reached) {cout << "FAILED...Bit matrix random transitive closure\n"; u = n; break;}
+		}
+	}
+	auto hops = sal::dijkstra<sal::Dense_property>(r, 0);
+	auto levels = sal::bfs<sal::Dense_property>(r, 0);
+	for (size_t v = 0; v < n; ++v) 
+		if (hops[v].distance != levels[v].distance) {cout << "FAILED...Bit matrix shortest path\n"; break;}
+}
+
+void test_csr_graph(bool print) {
+	std::vector<sal::WEdge<char>> edges {{'s','t',10},{'s','y',5},{'t','y',2},{'t','x',1},{'x','z',4},{'y','t',3},
+						{'y','x',9},{'y','z',2},{'z','s',7},{'z','x',6}};
+	sal::digraph<char> g {edges.begin(), edges.end()};
+	sal::digraph_csr<char> c {edges.begin(), edges.end()};
+	if (print) cout << c << endl;
+
+	if (c.num_vertex() != g.num_vertex() || c.num_edge() != g.num_edge()) 
+		cout << "FAILED...CSR graph cardinality\n";
+	for (char u : g) {
+		if (c.degree(u) != g.degree(u)) cout << "FAILED...CSR graph degree\n";
+		for (char v : g)
+			if (c.is_edge(u, v) != g.is_edge(u, v) || c.weight(u, v) != g.weight(u, v)) 
+				cout << "FAILED...CSR graph edge\n";
+	}
+
+	// same algorithms run unmodified
+	auto csr_shortest = sal::dijkstra(c, 's');
+	auto list_shortest = sal::dijkstra(g, 's');
+	for (char v : g) 
+		if (csr_shortest[v].distance != list_shortest[v].distance) cout << "FAILED...CSR graph dijkstra\n";
+	if (!sal::is_shortest(csr_shortest, c, 's')) cout << "FAILED...CSR graph dijkstra\n";
+
+	auto csr_bellman = sal::bellman_ford(c, 's');
+	if (!sal::is_shortest(csr_bellman, c, 's')) cout << "FAILED...CSR graph bellman ford\n";
+
+	// integer vertices are their own ids, undirected stores both directions
+	sal::graph_csr<int> u {{0,1},{0,2},{1,2},{3,2},{1,2}};
+	if (u.num_vertex() != 4 || u.num_edge() != 4 || u.degree(2) != 3 || !u.is_edge(2, 3)) 
+		cout << "FAILED...CSR undirected graph\n";
+	auto bfs_property = sal::bfs(u, 0);
+	if (bfs_property[3].distance != 2 || bfs_property[3].parent != 2) cout << "FAILED...CSR graph BFS\n";
+	auto dfs_property = sal::dfs(u);
+	if (dfs_property[0].start != 1 || dfs_property[0].finish != 8) cout << "FAILED...CSR graph DFS\n";
+}
+
+// round trips through mapped files, removed afterwards
+void test_mapped(bool print) {
+	std::vector<sal::WEdge<char>> edges {{'s','t',10},{'s','y',5},{'t','y',2},{'t','x',1},{'x','z',4},{'y','t',3},
+						{'y','x',9},{'y','z',2},{'z','s',7},{'z','x',6}};
+	sal::digraph_csr<char> c {edges.begin(), edges.end()};
+	sal::write_graph("sal_test_graph.bin", c);
+	{
+		auto mapped = sal::map_graph<sal::digraph_csr<char>>("sal_test_graph.bin");
+		if (print) cout << mapped << endl;
+		if (mapped.num_vertex() != c.num_vertex() || mapped.num_edge() != c.num_edge()) 
+			cout << "FAILED...Mapped graph cardinality\n";
+		for (char u : c)
+			for (char v : c)
+				if (mapped.is_edge(u, v) != c.is_edge(u, v) || mapped.weight(u, v) != c.weight(u, v)) 
+					cout << "FAILED...Mapped graph edge\n";
+		// copies share the mapping
+		sal::digraph_csr<char> copy {mapped};
+		auto shortest = sal::dijkstra(copy, 's');
+		if (shortest['x'].distance != 9 || !sal::is_shortest(shortest, copy, 's')) cout << "FAILED...Mapped graph dijkstra\n";
+	}
+	bool caught {false};
+	try {sal::map_graph<sal::graph_csr<char>>("sal_test_graph.bin");}
+	catch (const std::runtime_error&) {caught = true;}
+	if (!caught) cout << "FAILED...Mapped graph direction check\n";
+
+	// streaming conversion matches building in memory, duplicates keep the last weight
+	std::vector<sal::WEdge<int>> int_edges {{0,1,4},{0,7,8},{1,7,11},{1,2,8},{2,8,2},{2,5,4},{2,3,7},{3,5,14},
+						{3,4,9},{4,5,10},{5,6,2},{6,8,6},{7,8,7},{6,7,1},{1,2,3},{9,9,5},{12,0,1}};
+	sal::graph_csr<int> u {int_edges.begin(), int_edges.end()};
+	sal::write_graph<int,int>("sal_test_graph.bin", int_edges.begin(), int_edges.end(), false);
+	{
+		auto mapped = sal::map_graph<sal::graph_csr<int>>("sal_test_graph.bin");
+		if (mapped.num_vertex() != u.num_vertex() || mapped.num_edge() != u.num_edge() || mapped.weight(2, 1) != 3)
+			cout << "FAILED...Streamed mapped graph\n";
+		for (int x : u)
+			for (int y : u)
+				if (mapped.is_edge(x, y) != u.is_edge(x, y) || mapped.weight(x, y) != u.weight(x, y))
+					cout << "FAILED...Streamed mapped graph\n";
+		auto bfs_property = sal::bfs(mapped, 0, sal::par);
+		if (bfs_property[8].distance != 2 || bfs_property[10].distance != POS_INF(size_t)) 
+			cout << "FAILED...Mapped graph parallel BFS\n";
+	}
+	sal::write_graph<char,int>("sal_test_graph.bin", edges.begin(), edges.end(), true);
+	if (sal::map_graph<sal::digraph_csr<char>>("sal_test_graph.bin").num_edge() != c.num_edge())
+		cout << "FAILED...Streamed mapped digraph\n";
+	std::remove("sal_test_graph.bin");
+
+	sal::Matrix<double> m {{1.5, 2, 3}, {4, 5, 6}};
+	sal::write_matrix("sal_test_matrix.bin", m.transposed_view());
+	{
+		sal::Mapped_matrix<double> mapped {"sal_test_matrix.bin"};
+		if (mapped.row() != 3 || mapped.col() != 2 || mapped.copy() != m.transpose() || mapped.view().get(0, 0) != 1.5)
+			cout << "FAILED...Mapped matrix\n";
+		// used as an operand without copying
+		if (m * mapped.view() != m * m.transpose()) cout << "FAILED...Mapped matrix multiplication\n";
+	}
+	caught = false;
+	try {sal::Mapped_matrix<float> wrong {"sal_test_matrix.bin"};}
+	catch (const std::runtime_error&) {caught = true;}
+	if (!caught) cout << "FAILED...Mapped matrix type check\n";
+	std::remove("sal_test_matrix.bin");
+}
+
+void test_dense_property(bool print) {
+	// dijkstra example graph with s,t,x,y,z as 0,1,2,3,4
+	std::vector<sal::WEdge<size_t>> edges {{0,1,10},{0,3,5},{1,3,2},{1,2,1},{2,4,4},{3,1,3},
+						{3,2,9},{3,4,2},{4,0,7},{4,2,6}};
+	sal::digraph_csr<size_t> c {edges.begin(), edges.end()};
+	sal::digraph_mat<int> m {edges.begin(), edges.end(), 5};
+
+	auto hashed = sal::dijkstra(c, 0);
+	auto dense = sal::dijkstra<sal::Dense_property>(c, 0);
+	auto dense_mat = sal::dijkstra<sal::Dense_property>(m, 0);
+	if (print) for (auto v : dense) PRINTLINE(v.first << " <- " << v.second.parent << '\t' << v.second.distance);
+	if (dense.size() != 5 || dense[1].distance != 8 || dense[2].distance != 9 || dense[3].distance != 5 || 
+		dense[4].distance != 7) cout << "FAILED...Dense property dijkstra\n";
+	for (size_t v : c) 
+		if (dense[v].distance != hashed[v].distance || dense_mat[v].distance != hashed[v].distance) 
+			cout << "FAILED...Dense property dijkstra\n";
+	if (!sal::is_shortest(dense, c, 0) || !sal::is_shortest(dense_mat, m, 0)) 
+		cout << "FAILED...Dense property dijkstra\n";
+
+	auto dense_bellman = sal::bellman_ford<sal::Dense_property>(c, 0);
+	if (dense_bellman.empty() || !sal::is_shortest(dense_bellman, c, 0)) 
+		cout << "FAILED...Dense property bellman ford\n";
+
+	sal::graph_csr<int> u {{0,1},{0,2},{1,2},{3,2}};
+	auto bfs_property = sal::bfs<sal::Dense_property>(u, 0);
+	if (bfs_property[3].distance != 2 || bfs_property[3].parent != 2) cout << "FAILED...Dense property BFS\n";
+	auto dfs_property = sal::dfs<sal::Dense_property>(u);
+	auto dfs_hashed = sal::dfs(u);
+	for (int v : u)
+		if (dfs_property[v].start != dfs_hashed[v].start || dfs_property[v].finish != dfs_hashed[v].finish)
+			cout << "FAILED...Dense property DFS\n";
+
+	// circuit from mst test with a to i as 0 to 8
+	sal::graph_csr<int> circuit {{0,1,4},{0,7,8},{1,7,11},{1,2,8},{2,8,2},{2,5,4},{2,3,7},{3,5,14},
+					{3,4,9},{4,5,10},{5,6,2},{8,7,7},{8,6,6},{7,6,1}};
+	auto mst = sal::min_span_tree<sal::Dense_property>(circuit);
+	int mst_weight {0};
+	for (auto v : mst) if (v.first != v.second.parent) mst_weight += v.second.distance;
+	if (mst_weight != 37) cout << "FAILED...Dense property minimum spanning tree " << mst_weight << endl;
+}
+
+void test_stats(bool print) {
+	static_assert(std::is_empty<sal::No_stats>::value && std::is_empty<sal::No_stats::Timing>::value, "disabled stats should be empty");
+
+	// dijkstra example graph with s,t,x,y,z as 0,1,2,3,4, and an unreachable 5
+	std::vector<sal::WEdge<size_t>> edges {{0,1,10},{0,3,5},{1,3,2},{1,2,1},{2,4,4},{3,1,3},
+						{3,2,9},{3,4,2},{4,0,7},{4,2,6},{5,0,1}};
+	sal::digraph_csr<size_t> c {edges.begin(), edges.end()};
+
+	sal::Shortest_visitor<sal::Op_stats<>> bellman;
+	auto bellman_paths = sal::bellman_ford<sal::Dense_property>(c, 0, bellman);
+	if (!sal::is_shortest(bellman_paths, c, 0)) cout << "FAILED...Stats bellman ford shortest path\n";
+	// every pass relaxes every edge
+	if (bellman.stats[sal::Stat::pass] == 0 || bellman.stats[sal::Stat::relax] != bellman.stats[sal::Stat::pass] * edges.size() ||
+		bellman.stats[sal::Stat::improve] < 4) cout << "FAILED...Stats bellman ford counts\n";
+
+	// each vertex sampled as it settles, the heap's sifts count into the visitor's stats
+	sal::DJ_visitor<sal::Op_stats<1>> counted;
+	auto counted_paths = sal::dijkstra<sal::Dense_property, sal::Indexed_queue>(c, 0, counted);
+	auto plain_paths = sal::dijkstra<sal::Dense_property>(c, 0);
+	for (size_t v : c) if (counted_paths[v].distance != plain_paths[v].distance) cout << "FAILED...Stats dijkstra changed result\n";
+	if (print) counted.stats.for_each([](const char* name, size_t count) {PRINTLINE(name << ' ' << count);});
+	if (counted.stats[sal::Stat::settle] != 5 || counted.stats.sample_count(sal::Stat::settle) != 5 ||
+		counted.stats[sal::Stat::relax] != 10 || counted.stats[sal::Stat::improve] < 4 ||
+		counted.stats[sal::Stat::sift_up] + counted.stats[sal::Stat::sift_down] == 0)
+		cout << "FAILED...Stats dijkstra counts\n";
+	size_t exported {0};
+	counted.stats.for_each([&](const char*, size_t count) {exported += count;});
+	counted.stats.reset();
+	if (exported == 0 || counted.stats[sal::Stat::settle] != 0 || counted.stats.latency(sal::Stat::settle) != 0)
+		cout << "FAILED...Stats reset\n";
+
+	sal::graph_csr<int> circuit {{0,1,4},{0,7,8},{1,7,11},{1,2,8},{2,8,2},{2,5,4},{2,3,7},{3,5,14},
+					{3,4,9},{4,5,10},{5,6,2},{8,7,7},{8,6,6},{7,6,1}};
+	sal::MST_visitor<sal::Op_stats<>> prim;
+	sal::min_span_tree<sal::Dense_property>(circuit, prim);
+	// both directions of every edge are looked at once
+	if (prim.stats[sal::Stat::settle] != 9 || prim.stats[sal::Stat::relax] != 28) cout << "FAILED...Stats minimum spanning tree\n";
+
+	// the cycle through 0, 1 and 3 has a back edge whatever the order
+	sal::DFS_visitor<sal::Op_stats<>> depth;
+	sal::dfs<sal::Dense_property>(c, depth);
+	if (depth.stats[sal::Stat::discover] != 6 || depth.stats[sal::Stat::back_edge] == 0) cout << "FAILED...Stats DFS\n";
+
+	// ascending inserts into a max heap float to the top every time
+	sal::Heap<int, std::greater<int>, sal::Op_stats<>> heap {std::greater<int>{}};
+	for (int i = 0; i < 8; ++i) heap.insert(i);
+	if (heap.stats()[sal::Stat::sift_up] != 0+1+1+2+2+2+2+3) cout << "FAILED...Stats heap sift up\n";
+	heap.extract_top();
+	if (heap.stats()[sal::Stat::sift_down] == 0 || heap.top() != 6) cout << "FAILED...Stats heap sift down\n";
+
+	// sorted inserts keep rotating a red black tree, a treap rotates on insert and erase
+	sal::Tree<sal::Basic_node<int>, sal::Node_pool<sal::Basic_node<int>>, sal::Op_stats<>> tree;
+	for (int i = 0; i < 100; ++i) tree.insert(i);
+	if (tree.stats()[sal::Stat::rotate] == 0 || tree.size() != 100) cout << "FAILED...Stats tree rotations\n";
+	sal::Treap<sal::Treap_node<int>, sal::Node_pool<sal::Treap_node<int>>, sal::Op_stats<>> treap;
+	for (int i = 0; i < 100; ++i) treap.insert(i);
+	size_t inserted {treap.stats()[sal::Stat::rotate]};
+	for (int i = 0; i < 100; ++i) treap.erase(i * 37 % 100);
+	if (inserted == 0 || treap.stats()[sal::Stat::rotate] <= inserted || !treap.empty()) cout << "FAILED...Stats treap rotations\n";
+	// counts move with the treap, shared counters survive a move too
+	size_t rotations {treap.stats()[sal::Stat::rotate]};
+	auto moved = std::move(treap);
+	decltype(moved) assigned;
+	assigned = std::move(moved);
+	sal::Op_stats<> shared;
+	sal::Treap<sal::Treap_node<int>, sal::Node_pool<sal::Treap_node<int>>, sal::Stats_ref<sal::Op_stats<>>> counting {shared};
+	for (int i = 0; i < 100; ++i) counting.insert(i);
+	auto counting_moved = std::move(counting);
+	counting_moved.insert(100);
+	if (assigned.stats()[sal::Stat::rotate] != rotations || shared[sal::Stat::rotate] == 0) cout << "FAILED...Stats treap moves\n";
+}
+
+void test_integer_queues(bool print) {
+	// duplicate keys and pushes at the last popped key
+	sal::Radix_heap<unsigned, int> radix;
+	sal::Bucket_queue<unsigned, int> dial {16};
+	std::vector<unsigned> keys {5,3,9,3,12,7};
+	for (unsigned key : keys) {radix.push(key, key); dial.push(key, key);}
+	std::vector<unsigned> popped, bucketed;
+	bool repeated {false};
+	while (!radix.empty()) {
+		unsigned key {radix.top_key()};
+		popped.push_back(key);
+		if (radix.top() != static_cast<int>(key)) cout << "FAILED...Radix heap item\n";
+		radix.pop();
+		if (key == 7 && !repeated) {radix.push(7, 7); repeated = true;}
+		if (key == 9) radix.push(20, 20);
+	}
+	while (!dial.empty()) {
+		bucketed.push_back(dial.top_key());
+		dial.pop();
+		if (bucketed.back() == 7) dial.push(18, 18);
+	}
+	if (popped != std::vector<unsigned>{3,3,5,7,7,9,12,20}) cout << "FAILED...Radix heap order\n";
+	if (bucketed != std::vector<unsigned>{3,3,5,7,9,12,18}) cout << "FAILED...Bucket queue order\n";
+	// a 64 bit radix heap against sorting
+	sal::Radix_heap<unsigned long long, size_t> wide;
+	std::vector<unsigned long long> wide_keys;
+	for (size_t i = 0; i < 1000; ++i) wide_keys.push_back(static_cast<unsigned long long>(static_cast<unsigned>(randint_seeded())) << (i % 32));
+	for (size_t i = 0; i < wide_keys.size(); ++i) wide.push(wide_keys[i], i);
+	std::sort(wide_keys.begin(), wide_keys.end());
+	for (unsigned long long key : wide_keys) {
+		if (wide.top_key() != key) {cout << "FAILED...Radix heap 64 bit order\n"; break;}
+		wide.pop();
+	}
+
+	// every queue policy finds the same distances
+	std::vector<sal::WEdge<int>> edges;
+	int n {2000};
+	for (int i = 0; i < 8*n; ++i) 
+		edges.emplace_back(static_cast<unsigned>(randint_seeded()) % n, static_cast<unsigned>(randint_seeded()) % n, 
+			static_cast<unsigned>(randint_seeded()) % 100);
+	for (int i = 1; i < n; ++i) edges.emplace_back(i - 1, i, 1000);
+	sal::digraph_csr<int> c {edges.begin(), edges.end()};
+	auto indexed = sal::dijkstra<sal::Dense_property, sal::Indexed_queue>(c, 0);
+	auto automatic = sal::dijkstra<sal::Dense_property>(c, 0);
+	auto radix_paths = sal::dijkstra<sal::Dense_property, sal::Radix_queue>(c, 0);
+	auto dial_paths = sal::dijkstra<sal::Dense_property, sal::Dial_queue>(c, 0);
+	for (int v = 0; v < n; ++v)
+		if (automatic[v].distance != indexed[v].distance || radix_paths[v].distance != indexed[v].distance ||
+			dial_paths[v].distance != indexed[v].distance) {
+			cout << "FAILED...Integer queue dijkstra distance\n";
+			break;
+		}
+	if (!sal::is_shortest(radix_paths, c, 0) || !sal::is_shortest(dial_paths, c, 0)) cout << "FAILED...Integer queue dijkstra\n";
+	sal::digraph<char> g {{'s','t',10},{'s','y',5},{'t','y',2},{'t','x',1},{'x','z',4},{'y','t',3},
+						{'y','x',9},{'y','z',2},{'z','s',7},{'z','x',6}};
+	auto hashed_dial = sal::dijkstra<sal::Hashed_property, sal::Dial_queue>(g, 's');
+	if (hashed_dial['x'].distance != 9 || !sal::is_shortest(hashed_dial, g, 's')) cout << "FAILED...Integer queue hashed dijkstra\n";
+
+	// spanning trees of the same weight, also shifted to negative weights and spread past the bucket limit
+	auto tree_weight = [](const auto& mst) {
+		long long weight {0};
+		for (auto v : mst) if (v.first != v.second.parent) weight += v.second.distance;
+		return weight;
+	};
+	std::vector<sal::WEdge<int>> circuit_edges {{0,1,4},{0,7,8},{1,7,11},{1,2,8},{2,8,2},{2,5,4},{2,3,7},{3,5,14},
+					{3,4,9},{4,5,10},{5,6,2},{8,7,7},{8,6,6},{7,6,1}};
+	for (int shift : {0, -20}) {
+		std::vector<sal::WEdge<int>> shifted {circuit_edges};
+		for (auto& e : shifted) e.weight += shift;
+		sal::graph_csr<int> circuit {shifted.begin(), shifted.end()};
+		auto bucketed_tree = sal::min_span_tree<sal::Dense_property, sal::Dial_queue>(circuit);
+		auto indexed_tree = sal::min_span_tree<sal::Dense_property, sal::Indexed_queue>(circuit);
+		if (print) PRINTLINE(tree_weight(bucketed_tree) << ' ' << tree_weight(indexed_tree));
+		if (tree_weight(bucketed_tree) != 37 + 8 * shift || tree_weight(indexed_tree) != 37 + 8 * shift)
+			cout << "FAILED...Integer queue minimum spanning tree\n";
+	}
+	for (auto& e : edges) e.weight = e.weight * 1000 - 50000;
+	sal::graph_csr<int> spread {edges.begin(), edges.end()};
+	if (tree_weight(sal::min_span_tree<sal::Dense_property>(spread)) != 
+		tree_weight(sal::min_span_tree<sal::Dense_property, sal::Indexed_queue>(spread)) ||
+		tree_weight(sal::min_span_tree<sal::Dense_property, sal::Dial_queue>(spread)) != 
+		tree_weight(sal::min_span_tree<sal::Dense_property, sal::Indexed_queue>(spread)))
+		cout << "FAILED...Integer queue spread minimum spanning tree\n";
 }
 
 void test_vector(bool print) {
@@ -541,6 +1974,62 @@ void test_vector(bool print) {
 	if (print) PRINTLINE("FINISHED testing vectors");
 }
 
+// counts live instances so leaks and double destruction show up
+struct Tracked {
+	static int live;
+	std::string name;
+	Tracked(std::string n) : name{std::move(n)} {++live;}
+	Tracked(const Tracked& t) : name{t.name} {++live;}
+	Tracked(Tracked&& t) noexcept : name{std::move(t.name)} {++live;}
+	Tracked& operator=(const Tracked&) = default;
+	~Tracked() {--live;}
+};
+int Tracked::live = 0;
+
+namespace sal {
+// owns its int but never points into itself, so realloc can move it
+template <>
+struct Is_trivially_relocatable<std::unique_ptr<int>> : std::true_type {};
+}
+
+void test_fast_vector(bool print) {
+	{
+		sal::Fast_vector<Tracked> tracked;
+		for (int i = 0; i < 1000; ++i) tracked.emplace_back(std::to_string(i));
+		// argument referring to an element that moves when growing
+		while (tracked.size() != tracked.capacity()) tracked.emplace_back("x");
+		tracked.emplace_back(tracked[0]);
+		if (tracked.back().name != "0" || tracked[999].name != "999" || Tracked::live != (int)tracked.size())
+			cout << "FAILED...Fast vector growth with non trivial elements\n";
+		sal::Fast_vector<Tracked> copy {tracked};
+		tracked.resize(10, Tracked{"pad"});
+		tracked.shrink_to_fit();
+		if (tracked.capacity() != 10 || copy.size() <= 1000 || copy[500].name != "500" || Tracked::live != 10 + (int)copy.size())
+			cout << "FAILED...Fast vector copy and shrink\n";
+		copy = std::move(tracked);
+		tracked.clear();
+		if (copy.size() != 10 || copy[9].name != "9" || Tracked::live != 10) cout << "FAILED...Fast vector move\n";
+	}
+	if (Tracked::live != 0) cout << "FAILED...Fast vector destruction\n";
+
+	// aggregates are emplaced without a temporary, realloc moves trivially relocatable ones
+	sal::Fast_vector<sal::WEdge<int>> edges;
+	for (int i = 0; i < 100; ++i) edges.emplace_back(i, i + 1, i * 2);
+	if (edges.size() != 100 || edges[50].dest != 51 || edges[50].weight != 100) cout << "FAILED...Fast vector aggregates\n";
+	sal::Fast_vector<std::unique_ptr<int>> owners;
+	for (int i = 0; i < 100; ++i) owners.emplace_back(new int{i});
+	if (*owners[77] != 77) cout << "FAILED...Fast vector relocatable specialization\n";
+
+	// arena and huge page allocation
+	char arena[1 << 14];
+	std::pmr::monotonic_buffer_resource resource {arena, sizeof(arena)};
+	sal::Fast_vector<int, std::pmr::polymorphic_allocator<int>> pooled {std::pmr::polymorphic_allocator<int>{&resource}};
+	sal::Fast_vector<int, sal::Huge_page_allocator<int>> huge;
+	for (int i = 0; i < 1000; ++i) pooled.push_back(i);
+	huge.resize(1 << 20, 3);
+	if (pooled[999] != 999 || huge[12345] != 3 || huge.size() != (1 << 20)) cout << "FAILED...Fast vector allocators\n";
+}
+
 void test_bitgrid(bool print) {
 	sal::Bitgrid bg {5,7};
 	if (print) {bg.print(); cout << endl;}
@@ -572,24 +2061,46 @@ int main(int argc, char** argv) {
 	// test_heap(print);
 	test_tree(print);
 	// test_order_tree(print);
+	// test_node_pool(print);
 	// test_interval_set(print);
+	// test_interval_index(print);
 	// test_plane_set(print);
 	// test_treap(print);
+	// test_treap_bulk(print);
+	// test_persistent_treap(print);
+	// test_btree(print);
+	// test_quadtree(print);
+	// test_infint(print);
 	// test_list(print);
+	// test_unrolled_list(print);
 	// test_undirected_graph(print);
 	// test_directed_graph(print);
 	// test_matrix(print);
+	// test_parallel(print);
 	// test_bfs(print);
+	// test_parallel_bfs(print);
 	// test_dfs(print);
 	// test_topological_sort(print);
 	// test_transpose(print);
 	// test_strongly_connected(print);
+	// test_parallel_order(print);
 	// test_mst(print);
 	// test_bellman_ford(print);
 	// test_shortest_dag(print);
 	// test_dijkstra(print);
+	// test_dynamic_shortest(print);
 	// test_difference_constraint(print);
+	// test_parallel_shortest(print);
+	// test_all_pairs(print);
+	// test_semiring(print);
 	// test_adjacency_matrix(print);
+	// test_bit_matrix(print);
+	// test_csr_graph(print);
+	// test_mapped(print);
+	// test_dense_property(print);
+	// test_stats(print);
+	// test_integer_queues(print);
 	// test_vector(print);
+	// test_fast_vector(print);
 	// test_bitgrid(print);
 }
\ No newline at end of file
@@ -0,0 +1,511 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "../pool.h"
+// B+ tree, keys only in the leaves and inner nodes hold separators for routing
+// each node is a few cache lines of sorted keys (Node_bytes), leaves are linked for iteration
+// so lookups touch O(log_B n) nodes instead of O(lg n) and scans walk contiguous arrays
+// searching within a node of arithmetic keys counts the keys less than the target over every slot,
+// masking those past count, so the loop has no branches to mispredict and a trip count fixed at compile time;
+// slots are a multiple of 4 and GCC vectorizes it at -O2 for 8, 16 and 32 bit integers, float and double,
+// 64 bit integers need SSE4.2 (-msse4.2 or -march) for the compare and are otherwise counted one at a time
+// V = void gives a set, otherwise a map with values stored alongside the leaf keys
+// keys are compared with < only and must be default constructible
+// keys move between nodes, so insert and erase invalidate iterators
+namespace sal {
+
+// number of keys < key (insert position), branchless count over all N slots for arithmetic keys
+// slots past n hold stale or zeroed keys that the mask drops, 32 bit counters keep the lanes narrow
+template <size_t N, typename K>
+size_t node_lower_index(const K* keys, size_t n, const K& key, std::true_type) {
+	unsigned less {0};
+	unsigned count = n;
+	for (unsigned i = 0; i < N; ++i) less += (keys[i] < key) & (i < count);
+	return less;
+}
+template <size_t N, typename K>
+size_t node_lower_index(const K* keys, size_t n, const K& key, std::false_type) {
+	return std::lower_bound(keys, keys + n, key) - keys;
+}
+// number of keys <= key (child to descend into)
+template <size_t N, typename K>
+size_t node_upper_index(const K* keys, size_t n, const K& key, std::true_type) {
+	unsigned not_greater {0};
+	unsigned count = n;
+	for (unsigned i = 0; i < N; ++i) not_greater += !(key < keys[i]) & (i < count);
+	return not_greater;
+}
+template <size_t N, typename K>
+size_t node_upper_index(const K* keys, size_t n, const K& key, std::false_type) {
+	return std::upper_bound(keys, keys + n, key) - keys;
+}
+
+// leaf values, nothing for sets
+template <typename V, size_t N>
+struct Btree_values {
+	V values[N];
+	void move(size_t from, size_t to, size_t n) {
+		if (to < from) std::move(values + from, values + from + n, values + to);
+		else std::move_backward(values + from, values + from + n, values + to + n);
+	}
+	void move_to(Btree_values& other, size_t from, size_t to, size_t n) {
+		std::move(values + from, values + from + n, other.values + to);
+	}
+};
+template <size_t N>
+struct Btree_values<void, N> {
+	void move(size_t, size_t, size_t) {}
+	void move_to(Btree_values&, size_t, size_t, size_t) {}
+};
+
+template <typename K, typename V = void, size_t Node_bytes = 256>
+class Btree {
+	static constexpr size_t value_size {std::is_void<V>::value? 0 : sizeof(typename std::conditional<std::is_void<V>::value, char, V>::type)};
+public:
+	// slots per node, at least 4 so splits and merges always have room
+	// and a multiple of 4 so the masked node search fills whole vectors
+	static constexpr size_t leaf_slots {std::max<size_t>(4, Node_bytes / (sizeof(K) + value_size) / 4 * 4)};
+	static constexpr size_t inner_slots {std::max<size_t>(4, Node_bytes / (sizeof(K) + sizeof(void*)) / 4 * 4)};
+private:
+	static constexpr size_t min_leaf {leaf_slots / 2};
+	static constexpr size_t min_inner {inner_slots / 2};
+	// depth is bounded by the minimum fanout of 2
+	static constexpr size_t max_height {sizeof(size_t) * 8};
+	using Fast_search = std::integral_constant<bool, std::is_arithmetic<K>::value>;
+
+	struct Node {
+		size_t count {0};
+	};
+	struct Leaf : Node, Btree_values<V, leaf_slots> {
+		Leaf* prev {nullptr};
+		Leaf* next {nullptr};
+		K keys[leaf_slots];
+
+		// open a slot at pos, or close the one at pos
+		void shift_right(size_t pos) {
+			std::move_backward(keys + pos, keys + this->count, keys + this->count + 1);
+			this->move(pos, pos + 1, this->count - pos);
+			++this->count;
+		}
+		void shift_left(size_t pos) {
+			std::move(keys + pos + 1, keys + this->count, keys + pos);
+			this->move(pos + 1, pos, this->count - pos - 1);
+			--this->count;
+		}
+		// move the n slots starting at from to the back of other
+		void move_to(Leaf* other, size_t from, size_t n) {
+			std::move(keys + from, keys + from + n, other->keys + other->count);
+			Btree_values<V, leaf_slots>::move_to(*other, from, other->count, n);
+			other->count += n;
+		}
+	};
+	// children[i] holds keys in [keys[i-1], keys[i])
+	struct Inner : Node {
+		K keys[inner_slots];
+		Node* children[inner_slots + 1];
+
+		void insert_at(size_t pos, const K& key, Node* right) {
+			std::move_backward(keys + pos, keys + this->count, keys + this->count + 1);
+			std::move_backward(children + pos + 1, children + this->count + 1, children + this->count + 2);
+			keys[pos] = key;
+			children[pos + 1] = right;
+			++this->count;
+		}
+		// removes key pos and the child right of it
+		void erase_at(size_t pos) {
+			std::move(keys + pos + 1, keys + this->count, keys + pos);
+			std::move(children + pos + 2, children + this->count + 1, children + pos + 1);
+			--this->count;
+		}
+	};
+
+	Node* root {nullptr};
+	Leaf* first {nullptr};
+	Leaf* last {nullptr};
+	// number of inner levels above the leaves
+	size_t height {0};
+	size_t num_elems {0};
+	Node_pool<Leaf> leaves;
+	Node_pool<Inner> inners;
+
+	// root to leaf path, inner nodes and the child index taken in each
+	struct Path {
+		Inner* nodes[max_height];
+		size_t index[max_height];
+		size_t depth {0};
+	};
+	Leaf* descend(const K& key, Path& path) const {
+		Node* node {root};
+		for (size_t level = height; level > 0; --level) {
+			Inner* inner {static_cast<Inner*>(node)};
+			size_t i {node_upper_index<inner_slots>(inner->keys, inner->count, key, Fast_search{})};
+			path.nodes[path.depth] = inner;
+			path.index[path.depth++] = i;
+			node = inner->children[i];
+		}
+		return static_cast<Leaf*>(node);
+	}
+	Leaf* descend(const K& key) const {
+		Node* node {root};
+		for (size_t level = height; level > 0; --level) {
+			Inner* inner {static_cast<Inner*>(node)};
+			node = inner->children[node_upper_index<inner_slots>(inner->keys, inner->count, key, Fast_search{})];
+		}
+		return static_cast<Leaf*>(node);
+	}
+
+	// adds separator and right sibling above the node at depth, splitting up the path as needed
+	void insert_into_parent(Path& path, K separator, Node* right) {
+		while (path.depth > 0) {
+			--path.depth;
+			Inner* inner {path.nodes[path.depth]};
+			size_t pos {path.index[path.depth]};
+			if (inner->count < inner_slots) {
+				inner->insert_at(pos, separator, right);
+				return;
+			}
+			// full, split around the middle of the inner_slots + 1 keys
+			K keys[inner_slots + 1];
+			Node* children[inner_slots + 2];
+			std::move(inner->keys, inner->keys + pos, keys);
+			keys[pos] = std::move(separator);
+			std::move(inner->keys + pos, inner->keys + inner_slots, keys + pos + 1);
+			std::copy(inner->children, inner->children + pos + 1, children);
+			children[pos + 1] = right;
+			std::copy(inner->children + pos + 1, inner->children + inner_slots + 1, children + pos + 2);
+
+			constexpr size_t mid {inner_slots / 2};
+			Inner* sibling {inners.create()};
+			std::move(keys, keys + mid, inner->keys);
+			std::copy(children, children + mid + 1, inner->children);
+			inner->count = mid;
+			std::move(keys + mid + 1, keys + inner_slots + 1, sibling->keys);
+			std::copy(children + mid + 1, children + inner_slots + 2, sibling->children);
+			sibling->count = inner_slots - mid;
+			separator = std::move(keys[mid]);
+			right = sibling;
+		}
+		// split the root
+		Inner* new_root {inners.create()};
+		new_root->keys[0] = std::move(separator);
+		new_root->children[0] = root;
+		new_root->children[1] = right;
+		new_root->count = 1;
+		root = new_root;
+		++height;
+	}
+
+	// leaf at the end of path lost a key and is below min_leaf
+	void rebalance_leaf(Path& path, Leaf* leaf) {
+		Inner* parent {path.nodes[path.depth - 1]};
+		size_t i {path.index[path.depth - 1]};
+		Leaf* left {i > 0? static_cast<Leaf*>(parent->children[i - 1]) : nullptr};
+		Leaf* right {i < parent->count? static_cast<Leaf*>(parent->children[i + 1]) : nullptr};
+		if (left && left->count > min_leaf) {
+			leaf->shift_right(0);
+			leaf->keys[0] = std::move(left->keys[left->count - 1]);
+			left->Btree_values<V, leaf_slots>::move_to(*leaf, left->count - 1, 0, 1);
+			--left->count;
+			parent->keys[i - 1] = leaf->keys[0];
+			return;
+		}
+		if (right && right->count > min_leaf) {
+			right->move_to(leaf, 0, 1);
+			right->shift_left(0);
+			parent->keys[i] = right->keys[0];
+			return;
+		}
+		// merge into the left one of the pair
+		if (left) {leaf->move_to(left, 0, leaf->count); unlink_leaf(leaf); parent->erase_at(i - 1);}
+		else {right->move_to(leaf, 0, right->count); unlink_leaf(right); parent->erase_at(i);}
+		--path.depth;
+		rebalance_inner(path, parent);
+	}
+	void unlink_leaf(Leaf* leaf) {
+		if (leaf->prev) leaf->prev->next = leaf->next;
+		else first = leaf->next;
+		if (leaf->next) leaf->next->prev = leaf->prev;
+		else last = leaf->prev;
+		leaves.destroy(leaf);
+	}
+	// inner node at the end of path (not included in it) lost a key
+	void rebalance_inner(Path& path, Inner* inner) {
+		while (true) {
+			if (path.depth == 0) {
+				// root with a single child shrinks the tree
+				if (inner->count == 0) {
+					root = inner->children[0];
+					inners.destroy(inner);
+					--height;
+				}
+				return;
+			}
+			if (inner->count >= min_inner) return;
+			Inner* parent {path.nodes[path.depth - 1]};
+			size_t i {path.index[path.depth - 1]};
+			Inner* left {i > 0? static_cast<Inner*>(parent->children[i - 1]) : nullptr};
+			Inner* right {i < parent->count? static_cast<Inner*>(parent->children[i + 1]) : nullptr};
+			// rotate a key through the parent
+			if (left && left->count > min_inner) {
+				std::move_backward(inner->keys, inner->keys + inner->count, inner->keys + inner->count + 1);
+				std::move_backward(inner->children, inner->children + inner->count + 1, inner->children + inner->count + 2);
+				inner->keys[0] = std::move(parent->keys[i - 1]);
+				inner->children[0] = left->children[left->count];
+				++inner->count;
+				parent->keys[i - 1] = std::move(left->keys[left->count - 1]);
+				--left->count;
+				return;
+			}
+			if (right && right->count > min_inner) {
+				inner->keys[inner->count] = std::move(parent->keys[i]);
+				inner->children[inner->count + 1] = right->children[0];
+				++inner->count;
+				parent->keys[i] = std::move(right->keys[0]);
+				std::move(right->keys + 1, right->keys + right->count, right->keys);
+				std::move(right->children + 1, right->children + right->count + 1, right->children);
+				--right->count;
+				return;
+			}
+			// merge with the separator pulled down between them
+			size_t sep {left? i - 1 : i};
+			Inner* into {left? left : inner};
+			Inner* from {left? inner : right};
+			into->keys[into->count] = std::move(parent->keys[sep]);
+			std::move(from->keys, from->keys + from->count, into->keys + into->count + 1);
+			std::copy(from->children, from->children + from->count + 1, into->children + into->count + 1);
+			into->count += from->count + 1;
+			inners.destroy(from);
+			parent->erase_at(sep);
+			--path.depth;
+			inner = parent;
+		}
+	}
+
+	void destroy_subtree(Node* node, size_t level) {
+		if (level == 0) {leaves.destroy(static_cast<Leaf*>(node)); return;}
+		Inner* inner {static_cast<Inner*>(node)};
+		for (size_t i = 0; i <= inner->count; ++i) destroy_subtree(inner->children[i], level - 1);
+		inners.destroy(inner);
+	}
+
+public:
+	using key_type = K;
+	using value_type = K;
+	using mapped_type = V;
+
+	// iterates keys in order across the leaf chain
+	template <typename Leaf_ptr>
+	class Iterator {
+		Leaf_ptr leaf;
+		size_t pos;
+		const Btree* tree;
+		friend class Btree;
+		template <typename> friend class Iterator;
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = K;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const K*;
+		using reference = const K&;
+
+		Iterator(Leaf_ptr l, size_t p, const Btree* t) : leaf{l}, pos{p}, tree{t} {}
+		// iterator to const_iterator
+		template <typename Other_ptr>
+		Iterator(const Iterator<Other_ptr>& other) : leaf{other.leaf}, pos{other.pos}, tree{other.tree} {}
+		const K& operator*() const {return leaf->keys[pos];}
+		const K* operator->() const {return &leaf->keys[pos];}
+		// mapped value for maps
+		template <typename U = V>
+		auto& value() const {return leaf->values[pos];}
+
+		Iterator& operator++() {
+			if (++pos == leaf->count) {leaf = leaf->next; pos = 0;}
+			return *this;
+		}
+		Iterator operator++(int) {Iterator prev {*this}; ++*this; return prev;}
+		Iterator& operator--() {
+			if (!leaf) {leaf = tree->last; pos = leaf->count;}
+			else if (pos == 0) {leaf = leaf->prev; pos = leaf->count;}
+			--pos;
+			return *this;
+		}
+		Iterator operator--(int) {Iterator prev {*this}; --*this; return prev;}
+		template <typename Other_ptr>
+		bool operator==(const Iterator<Other_ptr>& other) const {return leaf == other.leaf && pos == other.pos;}
+		template <typename Other_ptr>
+		bool operator!=(const Iterator<Other_ptr>& other) const {return !(*this == other);}
+	};
+	using iterator = Iterator<Leaf*>;
+	using const_iterator = Iterator<const Leaf*>;
+
+	Btree() = default;
+	Btree(std::initializer_list<K> l) {
+		for (const auto& v : l) insert(v);
+	}
+	Btree(const Btree&) = delete;
+	Btree& operator=(const Btree&) = delete;
+	Btree(Btree&& other) noexcept {*this = std::move(other);}
+	Btree& operator=(Btree&& other) noexcept {
+		if (this != &other) {
+			clear();
+			root = other.root; first = other.first; last = other.last;
+			height = other.height; num_elems = other.num_elems;
+			leaves = std::move(other.leaves);
+			inners = std::move(other.inners);
+			other.root = nullptr; other.first = other.last = nullptr;
+			other.height = other.num_elems = 0;
+		}
+		return *this;
+	}
+	~Btree() {clear();}
+
+	// modifiers
+	// returns the key's position and whether it was inserted (false if already present)
+	template <typename... Value>
+	std::pair<iterator, bool> insert(const K& key, Value&&... value) {
+		static_assert(sizeof...(Value) == (std::is_void<V>::value? 0 : 1), "insert takes a key for sets, a key and value for maps");
+		if (!root) {
+			first = last = leaves.create();
+			root = first;
+		}
+		Path path;
+		Leaf* leaf {descend(key, path)};
+		size_t pos {node_lower_index<leaf_slots>(leaf->keys, leaf->count, key, Fast_search{})};
+		if (pos < leaf->count && !(key < leaf->keys[pos])) return {iterator{leaf, pos, this}, false};
+
+		if (leaf->count == leaf_slots) {
+			Leaf* right {leaves.create()};
+			leaf->move_to(right, min_leaf, leaf_slots - min_leaf);
+			leaf->count = min_leaf;
+			right->prev = leaf;
+			right->next = leaf->next;
+			if (leaf->next) leaf->next->prev = right;
+			else last = right;
+			leaf->next = right;
+			insert_into_parent(path, right->keys[0], right);
+			if (pos > min_leaf) {pos -= min_leaf; leaf = right;}
+		}
+		leaf->shift_right(pos);
+		leaf->keys[pos] = key;
+		assign_value(leaf, pos, std::forward<Value>(value)...);
+		++num_elems;
+		return {iterator{leaf, pos, this}, true};
+	}
+	// 1 if key was erased
+	size_t erase(const K& key) {
+		if (!root) return 0;
+		Path path;
+		Leaf* leaf {descend(key, path)};
+		size_t pos {node_lower_index<leaf_slots>(leaf->keys, leaf->count, key, Fast_search{})};
+		if (pos == leaf->count || key < leaf->keys[pos]) return 0;
+		leaf->shift_left(pos);
+		--num_elems;
+		// stale separators still route correctly, they only bound their subtrees
+		if (path.depth == 0) {
+			if (leaf->count == 0) clear();
+		}
+		else if (leaf->count < min_leaf) rebalance_leaf(path, leaf);
+		return 1;
+	}
+	void clear() {
+		if (!root) return;
+		if (!std::is_trivially_destructible<K>::value || !std::is_trivially_destructible<Btree_values<V, leaf_slots>>::value)
+			destroy_subtree(root, height);
+		leaves.release();
+		inners.release();
+		root = nullptr;
+		first = last = nullptr;
+		height = num_elems = 0;
+	}
+
+	// query
+	iterator find(const K& key) {
+		const_iterator found {static_cast<const Btree*>(this)->find(key)};
+		return iterator{const_cast<Leaf*>(found.leaf), found.pos, this};
+	}
+	const_iterator find(const K& key) const {
+		if (!root) return end();
+		const Leaf* leaf {descend(key)};
+		size_t pos {node_lower_index<leaf_slots>(leaf->keys, leaf->count, key, Fast_search{})};
+		if (pos == leaf->count || key < leaf->keys[pos]) return end();
+		return const_iterator{leaf, pos, this};
+	}
+	size_t count(const K& key) const {return find(key) != end();}
+	// first key >= key, for range scans
+	const_iterator lower_bound(const K& key) const {
+		if (!root) return end();
+		const Leaf* leaf {descend(key)};
+		size_t pos {node_lower_index<leaf_slots>(leaf->keys, leaf->count, key, Fast_search{})};
+		// separators route key to the last leaf whose keys can be <= key
+		if (pos == leaf->count) return const_iterator{leaf->next, 0, this};
+		return const_iterator{leaf, pos, this};
+	}
+	// first key > key
+	const_iterator upper_bound(const K& key) const {
+		const_iterator itr {lower_bound(key)};
+		if (itr != end() && !(key < *itr)) ++itr;
+		return itr;
+	}
+	// mapped value, default constructed if key wasn't present
+	template <typename U = V>
+	U& operator[](const K& key) {
+		iterator itr {find(key)};
+		if (itr == end()) itr = insert(key, U{}).first;
+		return itr.leaf->values[itr.pos];
+	}
+
+	size_t size() const {return num_elems;}
+	bool empty() const {return num_elems == 0;}
+
+	// iterators
+	iterator begin() 			 {return iterator{first, 0, this};}
+	iterator end() 				 {return iterator{nullptr, 0, this};}
+	const_iterator begin() const {return const_iterator{first, 0, this};}
+	const_iterator end() const 	 {return const_iterator{nullptr, 0, this};}
+
+	// keys sorted, bounded by separators, node occupancy within limits, all leaves at one depth
+	bool valid() const {
+		if (!root) return num_elems == 0 && first == nullptr;
+		size_t counted {0};
+		const Leaf* expected_leaf {first};
+		return valid(root, height, nullptr, nullptr, counted, expected_leaf) && counted == num_elems && !expected_leaf;
+	}
+
+private:
+	template <typename U>
+	void assign_value(Leaf* leaf, size_t pos, U&& value) {leaf->values[pos] = std::forward<U>(value);}
+	void assign_value(Leaf*, size_t) {}
+
+	bool valid(const Node* node, size_t level, const K* low, const K* high, size_t& counted, const Leaf*& expected_leaf) const {
+		bool is_root {node == root};
+		if (level == 0) {
+			const Leaf* leaf {static_cast<const Leaf*>(node)};
+			if (leaf != expected_leaf || leaf->count == 0 || (!is_root && leaf->count < min_leaf)) return false;
+			for (size_t i = 0; i < leaf->count; ++i) {
+				if (i > 0 && !(leaf->keys[i - 1] < leaf->keys[i])) return false;
+				if ((low && leaf->keys[i] < *low) || (high && !(leaf->keys[i] < *high))) return false;
+			}
+			counted += leaf->count;
+			expected_leaf = leaf->next;
+			return true;
+		}
+		const Inner* inner {static_cast<const Inner*>(node)};
+		if (inner->count == 0 || (!is_root && inner->count < min_inner)) return false;
+		for (size_t i = 0; i <= inner->count; ++i) {
+			const K* child_low {i == 0? low : &inner->keys[i - 1]};
+			const K* child_high {i == inner->count? high : &inner->keys[i]};
+			if (!valid(inner->children[i], level - 1, child_low, child_high, counted, expected_leaf)) return false;
+		}
+		return true;
+	}
+};
+
+template <typename T, size_t Node_bytes = 256>
+using Btree_set = Btree<T, void, Node_bytes>;
+template <typename K, typename V, size_t Node_bytes = 256>
+using Btree_map = Btree<K, V, Node_bytes>;
+
+}	// end namespace sal
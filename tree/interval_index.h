@@ -0,0 +1,170 @@
+#pragma once
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <vector>
+#include "interval_set.h"	// Interval
+
+namespace sal {
+
+// immutable interval index built once from a range of closed intervals
+// intervals are kept in an array sorted by low, and the array itself is the in order layout of an
+// implicit balanced tree: nodes at level k are the indices with k trailing 1 bits, children of x are x -/+ 2^(k-1)
+// each node carries the max high of its subtree in a parallel array, like Internode's max but without pointers
+// queries walk the implicit tree with a fixed stack and stream matches in sorted order, allocating nothing
+// small subtrees are scanned linearly since they share cache lines anyway
+template <typename T>
+class Interval_index {
+	std::vector<Interval<T>> elems;	// sorted by (low, high)
+	std::vector<T> max;				// max high of the subtree rooted at each index
+	std::vector<size_t> ids;		// position of each interval in the building range
+	int root_level {-1};
+
+	// subtrees of at most 2^(scan_level+1) - 1 intervals are scanned instead of walked
+	static constexpr int scan_level = 3;
+	struct Frame {
+		size_t x;
+		int k;
+		bool left_done;
+	};
+
+	template <typename Iter>
+	void build(Iter begin, Iter end) {
+		struct Entry {
+			Interval<T> interval;
+			size_t id;
+		};
+		std::vector<Entry> entries;
+		for (size_t id = 0; begin != end; ++begin, ++id) entries.push_back({*begin, id});
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+			return a.interval.low < b.interval.low ||
+				(a.interval.low == b.interval.low && (a.interval.high < b.interval.high ||
+				(a.interval.high == b.interval.high && a.id < b.id)));
+		});
+		elems.reserve(entries.size());
+		ids.reserve(entries.size());
+		for (const Entry& entry : entries) {
+			elems.push_back(entry.interval);
+			ids.push_back(entry.id);
+		}
+		augment();
+	}
+	// bottom up by levels, the rightmost node of a level may have its right subtree past the end,
+	// whose max is the max of the last complete subtree carried in last
+	void augment() {
+		size_t n {elems.size()};
+		max.resize(n);
+		if (n == 0) return;
+		size_t last_i {0};
+		T last {};
+		for (size_t i = 0; i < n; i += 2) {
+			last_i = i;
+			last = max[i] = elems[i].high;
+		}
+		int k {1};
+		for (; (size_t{1} << k) <= n; ++k) {
+			size_t x {size_t{1} << (k - 1)}, step {x << 2};
+			for (size_t i = (x << 1) - 1; i < n; i += step) {
+				T right {i + x < n? max[i + x] : last};
+				max[i] = std::max(elems[i].high, std::max(max[i - x], right));
+			}
+			last_i = (last_i >> k & 1)? last_i - x : last_i + x;
+			if (last_i < n && max[last_i] > last) last = max[last_i];
+		}
+		root_level = k - 1;
+	}
+
+public:
+	using value_type = Interval<T>;
+	using const_iterator = typename std::vector<Interval<T>>::const_iterator;
+
+	Interval_index() = default;
+	Interval_index(std::initializer_list<Interval<T>> l) {build(l.begin(), l.end());}
+	template <typename Iter>
+	Interval_index(Iter begin, Iter end) {build(begin, end);}
+
+	size_t size() const {return elems.size();}
+	bool empty() const {return elems.empty();}
+	// intervals in sorted order
+	const_iterator begin() const {return elems.begin();}
+	const_iterator end() const {return elems.end();}
+	const Interval<T>& operator[](size_t i) const {return elems[i];}
+	// position in the building range of an interval this index handed out, for looking up payloads
+	size_t id(const Interval<T>& found) const {return ids[&found - elems.data()];}
+
+	// f(interval) for every interval overlapping [low, high], in sorted order
+	template <typename F>
+	void for_each_overlap(T low, T high, F&& f) const {
+		if (root_level < 0) return;
+		size_t n {elems.size()};
+		// two frames per level at most
+		Frame stack[2 * (8 * sizeof(size_t) + 1)];
+		int top {0};
+		stack[top++] = {(size_t{1} << root_level) - 1, root_level, false};
+		while (top) {
+			Frame z {stack[--top]};
+			if (z.k <= scan_level) {
+				size_t first {z.x >> z.k << z.k};
+				size_t last {std::min(first + (size_t{1} << (z.k + 1)) - 1, n)};
+				for (size_t i = first; i < last && elems[i].low <= high; ++i)
+					if (elems[i].high >= low) f(elems[i]);
+			}
+			else if (!z.left_done) {
+				size_t left {z.x - (size_t{1} << (z.k - 1))};
+				stack[top++] = {z.x, z.k, true};
+				// a left child past the end still has nodes before it in its subtree
+				if (left >= n || max[left] >= low) stack[top++] = {left, z.k - 1, false};
+			}
+			else if (z.x < n && elems[z.x].low <= high) {
+				if (elems[z.x].high >= low) f(elems[z.x]);
+				stack[top++] = {z.x + (size_t{1} << (z.k - 1)), z.k - 1, false};
+			}
+		}
+	}
+	template <typename F>
+	void for_each_overlap(Interval<T> interval, F&& f) const {for_each_overlap(interval.low, interval.high, std::forward<F>(f));}
+
+	// overlapping intervals written to out, returns the end of the output
+	template <typename Out>
+	Out query(T low, T high, Out out) const {
+		for_each_overlap(low, high, [&](const Interval<T>& interval) {*out++ = interval;});
+		return out;
+	}
+	size_t count(T low, T high) const {
+		size_t overlapping {0};
+		for_each_overlap(low, high, [&](const Interval<T>&) {++overlapping;});
+		return overlapping;
+	}
+
+	// f(q, interval) for every interval overlapping the q-th query, queries visited by increasing low
+	// one merge pass: intervals starting before the current query's low are kept in an active list that
+	// is pruned as lows increase, so every active interval still overlaps; those starting inside the query
+	// are a contiguous run of the sorted array; O(n + m lg m + matches) for m queries
+	template <typename Iter, typename F>
+	void query_many(Iter begin, Iter end, F&& f) const {
+		std::vector<Interval<T>> queries {begin, end};
+		std::vector<size_t> order(queries.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {return queries[a].low < queries[b].low;});
+
+		std::vector<size_t> active;
+		size_t started {0};		// intervals with low < current query low have been moved to active
+		auto by_low = [](const Interval<T>& interval, T value) {return interval.low < value;};
+		for (size_t q : order) {
+			T low {queries[q].low}, high {queries[q].high};
+			size_t first {static_cast<size_t>(std::lower_bound(elems.begin() + started, elems.end(), low, by_low) - elems.begin())};
+			for (; started < first; ++started) active.push_back(started);
+			size_t kept {0};
+			for (size_t i : active) {
+				if (elems[i].high < low) continue;	// ended before this and every later query
+				active[kept++] = i;
+				if (low <= high) f(q, elems[i]);
+			}
+			active.resize(kept);
+			for (size_t i = first; i < elems.size() && elems[i].low <= high; ++i) f(q, elems[i]);
+		}
+	}
+};
+
+}	// end namespace sal
@@ -69,7 +69,7 @@ void interval_all_search(Node* interval, typename Node::key_type low, typename N
 		interval_all_search(interval->left, low, high, matched_intervals);
 	} 
 	// not already on the right side of the querying interval
-	if (interval->key < high && interval->right != Node::nil && interval->right->max >= low) {
+	if (interval->key <= high && interval->right != Node::nil && interval->right->max >= low) {
 		// might have intersecting interval on right
 		interval_all_search(interval->right, low, high, matched_intervals);
 	}
@@ -118,29 +118,30 @@ void restore_ancestor_max(Node* moved) {
 }
 
 // interval trees augmented from base RB-tree
-template <typename Node>
-class Interval_augment : public Tree<Node> {
-
+template <typename Node, typename Alloc = Node_pool<Node>>
+class Interval_augment : public Tree<Node, Alloc> {
+	using Base = Tree<Node, Alloc>;
 	using NP = Node*;
 	using T = typename Node::key_type;
-	using Tree<Node>::root;
-	using Tree<Node>::rb_insert;
-	using Tree<Node>::rb_delete;
-	using Tree<Node>::transplant;
-	using Tree<Node>::rb_insert_fixup;
+	using Base::alloc;
+	using Base::root;
+	using Base::rb_insert;
+	using Base::rb_delete;
+	using Base::transplant;
+	using Base::rb_insert_fixup;
 
 	// rotations, augmented by changing child and node's sizes
 	virtual void rotate_left(NP node) override {
 		// child always becomes the parent of node
 		NP child {node->right};
-		Tree<Node>::rotate_left(node);
+		Base::rotate_left(node);
 		// additional fixup for interval sets
 		update_max(node);
 		update_max(child);
 	}
 	virtual void rotate_right(NP node) override {
 		NP child {node->left};
-		Tree<Node>::rotate_right(node);
+		Base::rotate_right(node);
 		update_max(node);
 		update_max(child);
 	}
@@ -149,11 +150,11 @@ public:
 	using value_type = T;
 	using pointer = Node*;
 	using const_pointer = const Node*;
-	using iterator  = typename Tree<Node>::iterator;
-	using const_iterator = typename Tree<Node>::const_iterator;
+	using iterator  = typename Base::iterator;
+	using const_iterator = typename Base::const_iterator;
 
-	using Tree<Node>::size;
-	using Tree<Node>::empty;
+	using Base::size;
+	using Base::empty;
 
 	Interval_augment() = default;
 	Interval_augment(std::initializer_list<Interval<T>> l) {
@@ -161,11 +162,11 @@ public:
 	}
 
 	void insert(T low, T high) {
-		NP node {new Node(low, high)};
+		NP node {alloc.create(low, high)};
 		rb_insert(node, propagate_max_down<Node>);
 	};
 	void insert(Interval<T> interval) {
-		NP node {new Node(interval.low, interval.high)};
+		NP node {alloc.create(interval.low, interval.high)};
 		rb_insert(node, propagate_max_down<Node>);
 	}
 
@@ -204,43 +205,45 @@ public:
 
 
 // interval trees augmented from base Treap (random)
-template <typename Node>
-class Interval_treap : public Treap<Node> {
-
+template <typename Node, typename Alloc = Node_pool<Node>>
+class Interval_treap : public Treap<Node, Alloc> {
+	using Base = Treap<Node, Alloc>;
 	using NP = Node*;
 	using T = typename Node::key_type;
-	using Treap<Node>::root;
-	using Treap<Node>::treap_insert;
-	using Treap<Node>::treap_delete;
-	using Treap<Node>::transplant;
+	using Base::create_node;
+	using Base::root;
+	using Base::treap_insert;
+	using Base::treap_delete;
+	using Base::transplant;
 
 
 	// rotations, augmented by changing child and node's sizes
 	virtual void rotate_left(NP node) override {
 		// child always becomes the parent of node
 		NP child {node->right};
-		Treap<Node>::rotate_left(node);
+		Base::rotate_left(node);
 		// additional fixup for interval sets
 		update_max(node);
 		update_max(child);
 	}
 	virtual void rotate_right(NP node) override {
 		NP child {node->left};
-		Treap<Node>::rotate_right(node);
+		Base::rotate_right(node);
 		update_max(node);
 		update_max(child);
 	}
+	virtual void update_node(NP node) override {update_max(node);}
 
 public:
 	using value_type = T;
 	using pointer = Node*;
 	using const_pointer = const Node*;
-	using iterator  = typename Treap<Node>::iterator;
-	using const_iterator = typename Treap<Node>::const_iterator;
+	using iterator  = typename Base::iterator;
+	using const_iterator = typename Base::const_iterator;
 
-	using Treap<Node>::size;
-	using Treap<Node>::empty;
-	using Treap<Node>::inorder_walk;
+	using Base::size;
+	using Base::empty;
+	using Base::inorder_walk;
 
 	Interval_treap() = default;
 	Interval_treap(std::initializer_list<Interval<T>> l) {
@@ -248,11 +251,11 @@ public:
 	}
 
 	void insert(T low, T high) {
-		NP node {new Node(low, high)};
+		NP node {create_node(low, high)};
 		treap_insert(node, propagate_max_down<Node>);
 	};
 	void insert(Interval<T> interval) {
-		NP node {new Node(interval.low, interval.high)};
+		NP node {create_node(interval.low, interval.high)};
 		treap_insert(node, propagate_max_down<Node>);
 	}
 
@@ -312,8 +315,9 @@ struct Intertreap_node {
 	Intertreap_node *parent, *left, *right;
 	T key, high, max;
 	int priority;
-	Intertreap_node() : priority{std::numeric_limits<int>::max()} {}	// sentinel construction
-	Intertreap_node(const T& l, const T& h) : parent{nil}, left{nil}, right{nil}, key{l}, high{h}, max{h}, priority{rand()} {}
+	Intertreap_node() : max{std::numeric_limits<T>::lowest()}, priority{std::numeric_limits<int>::max()} {}	// sentinel construction
+	// priority assigned by the treap
+	Intertreap_node(const T& l, const T& h) : parent{nil}, left{nil}, right{nil}, key{l}, high{h}, max{h}, priority{0} {}
 	// convert to interval
 	operator Interval<T>() {return {key, high};}
 };
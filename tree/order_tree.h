@@ -36,24 +36,28 @@ template <typename Node>
 void grow_subtree_size(Node* start, const Node*) {
 	++start->size; // simply increment size of each ancestor going down
 }
+// called before deleting node, the spliced out node is either node or its successor
+// every ancestor of the spliced out node loses 1, and a successor takes over node's (reduced) size
 template <typename Node>
-void update_ancestor_size(Node* moved) {
-	moved = moved->parent;
-	while (moved != Node::nil) {
-		--moved->size;
-		moved = moved->parent;
-	}		
+void update_ancestor_size(Node* node) {
+	Node* removed {(node->left == Node::nil || node->right == Node::nil)? node : tree_min(node->right)};
+	for (Node* ancestor = removed->parent; ancestor != Node::nil; ancestor = ancestor->parent)
+		--ancestor->size;
+	if (removed != node) removed->size = node->size;
 }
 
-template <typename Node>
-class Order_augment : public Tree<Node> {
+template <typename Node, typename Alloc = Node_pool<Node>>
+class Order_augment : public Tree<Node, Alloc> {
+	using Base = Tree<Node, Alloc>;
 	using NP = Node*;
 	using T = typename Node::key_type;
-	using Tree<Node>::root;
-	using Tree<Node>::rb_insert;
-	using Tree<Node>::transplant;
-	using Tree<Node>::rb_insert_fixup;
-	using Tree<Node>::rb_delete_fixup;
+	using Base::root;
+	using Base::alloc;
+	using Base::rb_insert;
+	using Base::rb_delete;
+	using Base::transplant;
+	using Base::rb_insert_fixup;
+	using Base::rb_delete_fixup;
 
 	// order statistics operations
 	size_t os_rank(NP node) const {
@@ -69,33 +73,35 @@ class Order_augment : public Tree<Node> {
 	// rotations, augmented by changing child and node's sizes
 	virtual void rotate_left(NP node) override {
 		NP child {node->right};
-		Tree<Node>::rotate_left(node);
+		Base::rotate_left(node);
 		child->size = node->size;
 		node->size = node->left->size + node->right->size + 1;	
 	}
 	virtual void rotate_right(NP node) override {
 		NP child {node->left};
-		Tree<Node>::rotate_right(node);	
+		Base::rotate_right(node);	
 		child->size = node->size;
 		node->size = node->left->size + node->right->size + 1;
 	}
 
 public:
-	using iterator  = typename Tree<Node>::iterator;
-	using const_iterator = typename Tree<Node>::const_iterator;
+	using iterator  = typename Base::iterator;
+	using const_iterator = typename Base::const_iterator;
 	Order_augment() = default;
 	Order_augment(std::initializer_list<T> l) {
 		for (const auto& v : l) insert(v);
 	}
 
 	void insert(const T& data) {
-		NP node {new Node(data)};
+		NP node {alloc.create(data)};
 		rb_insert(node, grow_subtree_size<Node>);
 	};
 
 	void erase(const T& data) {
 		NP node {tree_find(root, data)};
-		if (node != Node::nil) rb_delete(node, update_ancestor_size<Node>);
+		if (node == Node::nil) return;
+		update_ancestor_size(node);
+		rb_delete(node, skip_delete_fixup<Node>);
 	}
 
 	// order statistics methods interface
@@ -0,0 +1,278 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../pool.h"	// node allocator
+// persistent treap for one writer and many lock free readers
+// nodes are immutable once published: insert and erase copy the path down to the change
+// (split and join like Treap's bulk operations) and publish the new root atomically,
+// so a reader that loaded a root iterates that version however many writes follow
+// the writer counts each node's parents across every live version, and a node no version reaches
+// any more is retired with the current epoch; readers announce the epoch they started in, and retired
+// nodes are freed once every reader started after their retirement, so readers never touch counts
+// only the writer thread may call the modifiers, readers take a snapshot()
+namespace sal {
+
+template <typename T>
+struct Persistent_treap_node {
+	using key_type = T;
+	const Persistent_treap_node* left;
+	const Persistent_treap_node* right;
+	T key;
+	int priority;
+	size_t size;		// nodes in the subtree
+	size_t refs {0};	// parents across versions plus 1 for a published root, writer only
+	Persistent_treap_node(const T& k, int p, const Persistent_treap_node* l, const Persistent_treap_node* r) :
+		left{l}, right{r}, key{k}, priority{p}, size{1 + (l? l->size : 0) + (r? r->size : 0)} {}
+};
+
+// at most Readers snapshots are open at once, more wait for one to close
+template <typename T, size_t Readers = 64, typename Alloc = Node_pool<Persistent_treap_node<T>>>
+class Persistent_treap {
+	using Node = Persistent_treap_node<T>;
+	using NP = const Node*;
+	// retired nodes are freed in batches of at least this many
+	static constexpr size_t reclaim_batch = 256;
+
+	std::atomic<NP> root {nullptr};
+	// 0 is an idle slot, otherwise the epoch its reader started in
+	mutable std::array<std::atomic<uint64_t>, Readers> readers {};
+	std::atomic<uint64_t> epoch {1};
+
+	// writer only
+	Alloc alloc;
+	std::vector<std::pair<uint64_t, NP>> retired;
+	uint32_t priority_state {0x9E3779B9u};
+
+	int next_priority() {
+		priority_state ^= priority_state << 13;
+		priority_state ^= priority_state >> 17;
+		priority_state ^= priority_state << 5;
+		return static_cast<int>(priority_state >> 2);
+	}
+	static void hold(NP node) {if (node) ++const_cast<Node*>(node)->refs;}
+	// the building functions return subtrees the caller has yet to hold, new nodes start with no holds
+	// a new node holding the given children
+	NP make(const T& key, int priority, NP left, NP right) {
+		hold(left);
+		hold(right);
+		return alloc.create(key, priority, left, right);
+	}
+	NP copy(NP node, NP left, NP right) {return make(node->key, node->priority, left, right);}
+	// a node no version reaches is retired and lets go of its children
+	void release(NP node) {
+		std::vector<NP> pending;
+		if (node) pending.push_back(node);
+		uint64_t now {epoch.load(std::memory_order_relaxed)};
+		while (!pending.empty()) {
+			NP u {pending.back()};
+			pending.pop_back();
+			if (--const_cast<Node*>(u)->refs) continue;
+			retired.emplace_back(now, u);
+			if (u->left) pending.push_back(u->left);
+			if (u->right) pending.push_back(u->right);
+		}
+	}
+
+	static NP find_node(NP node, const T& key) {
+		while (node && (key < node->key || node->key < key)) node = key < node->key? node->left : node->right;
+		return node;
+	}
+	// copies of the path to key, keys < key left and > key right (key itself is not in the tree)
+	std::pair<NP,NP> split(NP node, const T& key) {
+		if (!node) return {nullptr, nullptr};
+		if (node->key < key) {
+			auto parts = split(node->right, key);
+			return {copy(node, node->left, parts.first), parts.second};
+		}
+		auto parts = split(node->left, key);
+		return {parts.first, copy(node, parts.second, node->right)};
+	}
+	NP insert_node(NP node, const T& key, int priority) {
+		if (!node || priority < node->priority) {
+			auto parts = split(node, key);
+			return make(key, priority, parts.first, parts.second);
+		}
+		if (key < node->key) return copy(node, insert_node(node->left, key, priority), node->right);
+		return copy(node, node->left, insert_node(node->right, key, priority));
+	}
+	// every key of left before every key of right, copies of both inner spines
+	NP join(NP left, NP right) {
+		if (!left) return right;
+		if (!right) return left;
+		if (left->priority < right->priority) return copy(left, left->left, join(left->right, right));
+		return copy(right, join(left, right->left), right->right);
+	}
+	NP erase_node(NP node, const T& key) {
+		if (key < node->key) return copy(node, erase_node(node->left, key), node->right);
+		if (node->key < key) return copy(node, node->left, erase_node(node->right, key));
+		return join(node->left, node->right);
+	}
+	// the new version becomes visible to snapshots taken from now on
+	void publish(NP next) {
+		hold(next);
+		NP prev {root.exchange(next, std::memory_order_seq_cst)};
+		release(prev);
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (retired.size() >= reclaim_batch) reclaim();
+	}
+
+	void free_now(NP node) {alloc.destroy(const_cast<Node*>(node));}
+
+public:
+	using value_type = T;
+
+	// in order over one version, keeps its path on a stack
+	class const_iterator {
+		std::vector<NP> path;
+		void descend(NP node) {for (; node; node = node->left) path.push_back(node);}
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+		const_iterator() = default;
+		explicit const_iterator(NP root) {descend(root);}
+		const T& operator*() const {return path.back()->key;}
+		const T* operator->() const {return &path.back()->key;}
+		const_iterator& operator++() {
+			NP node {path.back()};
+			path.pop_back();
+			descend(node->right);
+			return *this;
+		}
+		const_iterator operator++(int) {const_iterator prev {*this}; ++*this; return prev;}
+		bool operator==(const const_iterator& other) const {
+			return path.empty()? other.path.empty() : !other.path.empty() && path.back() == other.path.back();
+		}
+		bool operator!=(const const_iterator& other) const {return !(*this == other);}
+	};
+
+	// one version, readable from any thread without locks while it's open
+	class Snapshot {
+		const Persistent_treap* treap {nullptr};
+		size_t slot {0};
+		NP top {nullptr};
+	public:
+		Snapshot() = default;
+		explicit Snapshot(const Persistent_treap& t) : treap{&t} {
+			// claim an idle slot for the epoch this reader starts in, waiting if all are taken
+			for (size_t i = 0, tried = 0; ; i = (i + 1) % Readers) {
+				if (++tried > Readers) {std::this_thread::yield(); tried = 0;}
+				uint64_t idle {0};
+				if (treap->readers[i].load(std::memory_order_relaxed) == 0 &&
+					treap->readers[i].compare_exchange_strong(idle, treap->epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst)) {
+					slot = i;
+					break;
+				}
+			}
+			// the root is loaded after announcing, so the writer either sees this reader or published first
+			top = treap->root.load(std::memory_order_seq_cst);
+		}
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+		Snapshot(Snapshot&& other) noexcept : treap{other.treap}, slot{other.slot}, top{other.top} {other.treap = nullptr;}
+		Snapshot& operator=(Snapshot&& other) noexcept {
+			if (this != &other) {
+				close();
+				treap = other.treap;
+				slot = other.slot;
+				top = other.top;
+				other.treap = nullptr;
+			}
+			return *this;
+		}
+		~Snapshot() {close();}
+		void close() {
+			if (treap) treap->readers[slot].store(0, std::memory_order_release);
+			treap = nullptr;
+			top = nullptr;
+		}
+
+		size_t size() const {return top? top->size : 0;}
+		bool empty() const {return !top;}
+		bool contains(const T& key) const {return find_node(top, key) != nullptr;}
+		// nullptr if not present, valid while the snapshot is open
+		const T* find(const T& key) const {
+			NP found {find_node(top, key)};
+			return found? &found->key : nullptr;
+		}
+		// k-th smallest from 0, through the subtree sizes
+		const T& select(size_t k) const {
+			NP node {top};
+			while (true) {
+				size_t left {node->left? node->left->size : 0};
+				if (k == left) return node->key;
+				if (k < left) node = node->left;
+				else {k -= left + 1; node = node->right;}
+			}
+		}
+		const_iterator begin() const {return const_iterator{top};}
+		const_iterator end() const {return const_iterator{};}
+	};
+
+	Persistent_treap() = default;
+	Persistent_treap(std::initializer_list<T> l) {for (const auto& v : l) insert(v);}
+	Persistent_treap(const Persistent_treap&) = delete;
+	Persistent_treap& operator=(const Persistent_treap&) = delete;
+	// no snapshot may be open
+	~Persistent_treap() {
+		release(root.exchange(nullptr));
+		for (auto& entry : retired) free_now(entry.second);
+		retired.clear();
+		alloc.release();
+	}
+
+	Snapshot snapshot() const {return Snapshot{*this};}
+
+	// writer side, false if nothing changed (set semantics)
+	bool insert(const T& key) {
+		NP current {root.load(std::memory_order_relaxed)};
+		if (find_node(current, key)) return false;
+		publish(insert_node(current, key, next_priority()));
+		return true;
+	}
+	bool erase(const T& key) {
+		NP current {root.load(std::memory_order_relaxed)};
+		if (!find_node(current, key)) return false;
+		publish(erase_node(current, key));
+		return true;
+	}
+	// reads of the current version from the writer thread, no snapshot needed
+	bool contains(const T& key) const {return find_node(root.load(std::memory_order_relaxed), key) != nullptr;}
+	size_t size() const {
+		NP current {root.load(std::memory_order_relaxed)};
+		return current? current->size : 0;
+	}
+	bool empty() const {return root.load(std::memory_order_relaxed) == nullptr;}
+
+	// frees retired nodes that no open snapshot started early enough to reach, returns how many
+	size_t reclaim() {
+		uint64_t oldest {epoch.load(std::memory_order_seq_cst)};
+		for (const auto& reader : readers) {
+			uint64_t started {reader.load(std::memory_order_seq_cst)};
+			if (started && started < oldest) oldest = started;
+		}
+		// retired in epoch order, a snapshot from epoch e may still reach nodes retired in e or later
+		size_t freed {0};
+		while (freed < retired.size() && retired[freed].first < oldest) free_now(retired[freed++].second);
+		retired.erase(retired.begin(), retired.begin() + freed);
+		return freed;
+	}
+	// nodes waiting for readers to move on
+	size_t retired_count() const {return retired.size();}
+	// reseed the priority generator, 0 is not a valid xorshift state
+	void seed(uint32_t s) {priority_state = s? s : 0x9E3779B9u;}
+};
+
+template <typename T>
+using Basic_persistent_treap = Persistent_treap<T>;
+
+}	// end namespace sal
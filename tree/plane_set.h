@@ -4,28 +4,31 @@
 namespace sal {
 
 // currently support only insert and query
-template <typename Node>
-class Plane_treap : public Treap<Node> {	// interval set of interval sets (2D plane for overlapping rectangles)
+template <typename Node, typename Alloc = Node_pool<Node>>
+class Plane_treap : public Treap<Node, Alloc> {	// interval set of interval sets (2D plane for overlapping rectangles)
 protected:
+	using Base = Treap<Node, Alloc>;
 	using T = typename Node::key_type;
-	using Treap<Node>::treap_insert;
-	using Treap<Node>::treap_delete;
-	using Treap<Node>::root;
+	using Base::create_node;
+	using Base::treap_insert;
+	using Base::treap_delete;
+	using Base::root;
 	// rotations, augmented by changing child and node's sizes
 	virtual void rotate_left(Node* node) override {
 		// child always becomes the parent of node
 		Node* child {node->right};
-		Treap<Node>::rotate_left(node);
+		Base::rotate_left(node);
 		// additional fixup for interval sets
 		update_max(node);
 		update_max(child);
 	}
 	virtual void rotate_right(Node* node) override {
 		Node* child {node->left};
-		Treap<Node>::rotate_right(node);
+		Base::rotate_right(node);
 		update_max(node);
 		update_max(child);
 	}
+	virtual void update_node(Node* node) override {update_max(node);}
 
 public:
 	using pointer = Node*;
@@ -35,8 +38,8 @@ public:
 	using iterator  = typename Treap<element_node>::iterator;
 	using const_iterator = typename Treap<element_node>::const_iterator;
 
-	using Treap<Node>::size;
-	using Treap<Node>::empty;
+	using Base::size;
+	using Base::empty;
 
 	Plane_treap() = default;
 
@@ -46,7 +49,7 @@ public:
 		auto x_interval = interval_exact_search(root, x_low, x_high);
 		// no interval exists, need to create interval
 		if (x_interval == Node::nil) {
-			x_interval = new Node{x_low, x_high};	// x is our first dimension
+			x_interval = create_node(x_low, x_high);	// x is our first dimension
 			treap_insert(x_interval, propagate_max_down<Node>);
 		}
 		x_interval->insert(y_low, y_high);
@@ -102,8 +105,9 @@ struct Planetreap_node {
 	Planetreap_node *parent, *left, *right;
 	T key, high, max;
 	int priority;
-	Planetreap_node() : priority{std::numeric_limits<int>::max()} {}	// sentinel construction
-	Planetreap_node(T l, T h) : parent{nil}, left{nil}, right{nil}, key{l}, high{h}, max{h}, priority{rand()} {}
+	Planetreap_node() : max{std::numeric_limits<T>::lowest()}, priority{std::numeric_limits<int>::max()} {}	// sentinel construction
+	// priority assigned by the treap
+	Planetreap_node(T l, T h) : parent{nil}, left{nil}, right{nil}, key{l}, high{h}, max{h}, priority{0} {}
 
 	// forward to the y_range interval set
 	iterator find(T low, T high) {return y_range.find(low, high);}
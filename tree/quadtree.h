@@ -1,6 +1,262 @@
 #pragma once
-#include "tree.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <utility>
+#include <vector>
 // each node is a bounding box covering some space, with root node covering entire area
-// leaf nodes contain points while internal nodes contains 4 children (1 per quadrant) 
+// leaf nodes contain points while internal nodes contains 4 children (1 per quadrant)
 // this particular implementation requires a grid unit size and only stores the PRESENCE of a point in that unit
-// multiple points within the same grid will be treated as 1 point, so only use this tree in emptiness queries
\ No newline at end of file
+// multiple points within the same grid will be treated as 1 point, so only use this tree in emptiness queries
+// linear quadtree: no node objects, only the sorted Morton (Z-order) codes of occupied grid cells
+// interleaving the bits of x and y puts every quadtree node's cells in one contiguous run of codes,
+// so a node is just an index range [lo, hi) into the array and splitting it into quadrants is 3 binary searches
+// empty nodes are pruned as soon as their range is empty, full nodes in a query are counted as hi - lo,
+// and nodes down to a handful of cells are scanned directly
+namespace sal {
+
+// spread the low 32 bits out to the even bit positions
+inline uint64_t morton_spread(uint64_t v) {
+	v &= 0xFFFFFFFFull;
+	v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+	v = (v | (v << 8))  & 0x00FF00FF00FF00FFull;
+	v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0Full;
+	v = (v | (v << 2))  & 0x3333333333333333ull;
+	v = (v | (v << 1))  & 0x5555555555555555ull;
+	return v;
+}
+inline uint32_t morton_compact(uint64_t v) {
+	v &= 0x5555555555555555ull;
+	v = (v | (v >> 1))  & 0x3333333333333333ull;
+	v = (v | (v >> 2))  & 0x0F0F0F0F0F0F0F0Full;
+	v = (v | (v >> 4))  & 0x00FF00FF00FF00FFull;
+	v = (v | (v >> 8))  & 0x0000FFFF0000FFFFull;
+	v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+	return static_cast<uint32_t>(v);
+}
+// x on the even bits, y on the odd bits
+inline uint64_t morton_encode(uint32_t x, uint32_t y) {return morton_spread(x) | (morton_spread(y) << 1);}
+inline std::pair<uint32_t, uint32_t> morton_decode(uint64_t code) {return {morton_compact(code), morton_compact(code >> 1)};}
+
+// LSD radix sort on bytes, skipping the bytes every code shares (high bytes of small grids)
+inline void radix_sort_codes(std::vector<uint64_t>& codes) {
+	if (codes.size() < 256) {std::sort(codes.begin(), codes.end()); return;}
+	std::vector<uint64_t> buffer (codes.size());
+	for (unsigned shift = 0; shift < 64; shift += 8) {
+		size_t counts[256] {};
+		for (uint64_t code : codes) ++counts[(code >> shift) & 0xFF];
+		if (counts[(codes[0] >> shift) & 0xFF] == codes.size()) continue;
+		size_t offset {0};
+		for (size_t& count : counts) {size_t c {count}; count = offset; offset += c;}
+		for (uint64_t code : codes) buffer[counts[(code >> shift) & 0xFF]++] = code;
+		codes.swap(buffer);
+	}
+}
+
+template <typename T = int>
+class Quadtree {
+	// occupied cells, sorted and unique
+	std::vector<uint64_t> codes;
+	T unit;
+	T min_x, min_y;
+	static constexpr unsigned levels {32};
+	static constexpr uint32_t max_cell {0xFFFFFFFFu};
+
+	// inclusive rectangle of cells
+	struct Box {uint64_t x0, x1, y0, y1;};
+
+	// quadtree node, a square of side 2^level cells starting at (x, y) and at code start
+	struct Node {
+		uint64_t start, x, y;
+		unsigned level;
+		size_t lo, hi;
+	};
+	// end of quadrant q's (0..3) ranges within the node, q = 2 * y bit + x bit
+	size_t quadrant_end(const Node& node, unsigned q) const {
+		if (q == 3) return node.hi;
+		uint64_t end {node.start + (q + 1) * (uint64_t{1} << (2 * (node.level - 1)))};
+		return std::lower_bound(codes.begin() + node.lo, codes.begin() + node.hi, end) - codes.begin();
+	}
+	Node quadrant(const Node& node, unsigned q, size_t lo, size_t hi) const {
+		unsigned level {node.level - 1};
+		uint64_t half {uint64_t{1} << level};
+		return {node.start + q * (uint64_t{1} << (2 * level)), node.x + (q & 1) * half, node.y + (q >> 1) * half, level, lo, hi};
+	}
+	// smallest node holding every cell, the levels above it would all be single child
+	Node root_node() const {
+		if (codes.empty()) return {0, 0, 0, 0, 0, 0};
+		uint64_t differ {codes.front() ^ codes.back()};
+		unsigned level {0};
+		while (level < levels && (differ >> (2 * level)) != 0) ++level;
+		uint64_t start {level == levels? 0 : codes.front() & ~((uint64_t{1} << (2 * level)) - 1)};
+		auto corner = morton_decode(start);
+		return {start, corner.first, corner.second, level, 0, codes.size()};
+	}
+	// root narrowed to the codes between the rectangle's corners, every cell in it has a code in there
+	Node root_node(const Box& box) const {
+		Node root {root_node()};
+		root.lo = std::lower_bound(codes.begin(), codes.end(), morton_encode(box.x0, box.y0)) - codes.begin();
+		root.hi = std::upper_bound(codes.begin() + root.lo, codes.end(), morton_encode(box.x1, box.y1)) - codes.begin();
+		return root;
+	}
+	// few enough cells to test one by one instead of splitting further
+	static constexpr size_t scan_limit {16};
+	bool in_box(uint64_t c, const Box& box) const {
+		auto xy = morton_decode(c);
+		return xy.first >= box.x0 && xy.first <= box.x1 && xy.second >= box.y0 && xy.second <= box.y1;
+	}
+
+	static bool disjoint(const Node& node, const Box& box) {
+		uint64_t last {(uint64_t{1} << node.level) - 1};
+		return node.x > box.x1 || node.x + last < box.x0 || node.y > box.y1 || node.y + last < box.y0;
+	}
+	static bool inside(const Node& node, const Box& box) {
+		uint64_t last {(uint64_t{1} << node.level) - 1};
+		return node.x >= box.x0 && node.x + last <= box.x1 && node.y >= box.y0 && node.y + last <= box.y1;
+	}
+	size_t count_in(const Node& node, const Box& box) const {
+		if (node.lo == node.hi || disjoint(node, box)) return 0;
+		if (inside(node, box)) return node.hi - node.lo;
+		if (node.hi - node.lo <= scan_limit)
+			return std::count_if(codes.begin() + node.lo, codes.begin() + node.hi, [&](uint64_t c){return in_box(c, box);});
+		size_t total {0}, lo {node.lo};
+		for (unsigned q = 0; q < 4; ++q) {
+			size_t hi {quadrant_end(node, q)};
+			total += count_in(quadrant(node, q, lo, hi), box);
+			lo = hi;
+		}
+		return total;
+	}
+	bool any_in(const Node& node, const Box& box) const {
+		if (node.lo == node.hi || disjoint(node, box)) return false;
+		if (inside(node, box)) return true;
+		if (node.hi - node.lo <= scan_limit)
+			return std::any_of(codes.begin() + node.lo, codes.begin() + node.hi, [&](uint64_t c){return in_box(c, box);});
+		size_t lo {node.lo};
+		for (unsigned q = 0; q < 4; ++q) {
+			size_t hi {quadrant_end(node, q)};
+			if (any_in(quadrant(node, q, lo, hi), box)) return true;
+			lo = hi;
+		}
+		return false;
+	}
+
+	// grid cell of a coordinate, clamped to the grid
+	uint32_t cell(T v, T origin) const {
+		double c {std::floor((static_cast<double>(v) - static_cast<double>(origin)) / static_cast<double>(unit))};
+		if (c < 0) return 0;
+		if (c > static_cast<double>(max_cell)) return max_cell;
+		return static_cast<uint32_t>(c);
+	}
+	uint64_t code(T x, T y) const {return morton_encode(cell(x, min_x), cell(y, min_y));}
+	Box box(T x_low, T x_high, T y_low, T y_high) const {
+		return {cell(x_low, min_x), cell(x_high, min_x), cell(y_low, min_y), cell(y_high, min_y)};
+	}
+	// squared distance in cells from a point to a node's square
+	static double distance(const Node& node, double px, double py) {
+		double side {static_cast<double>(uint64_t{1} << node.level)};
+		double dx {std::max({static_cast<double>(node.x) - px, 0.0, px - (static_cast<double>(node.x) + side)})};
+		double dy {std::max({static_cast<double>(node.y) - py, 0.0, py - (static_cast<double>(node.y) + side)})};
+		return dx*dx + dy*dy;
+	}
+
+public:
+	using value_type = std::pair<T,T>;
+
+	// grid covers 2^32 x 2^32 cells of side unit from (min_x, min_y), points outside are clamped onto it
+	explicit Quadtree(T grid_unit = T{1}, T origin_x = T{}, T origin_y = T{}) : unit{grid_unit}, min_x{origin_x}, min_y{origin_y} {}
+
+	// modifiers
+	// O(n) for a single point, use the batch insert for many
+	void insert(T x, T y) {
+		uint64_t c {code(x, y)};
+		auto pos = std::lower_bound(codes.begin(), codes.end(), c);
+		if (pos == codes.end() || *pos != c) codes.insert(pos, c);
+	}
+	// batch of (x, y) points in O(n + m) plus radix sorting the m new codes
+	template <typename Iter>
+	void insert(Iter first, Iter last) {
+		std::vector<uint64_t> added;
+		added.reserve(std::distance(first, last));
+		for (; first != last; ++first) added.push_back(code(first->first, first->second));
+		radix_sort_codes(added);
+		size_t old_size {codes.size()};
+		codes.insert(codes.end(), added.begin(), added.end());
+		std::inplace_merge(codes.begin(), codes.begin() + old_size, codes.end());
+		codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+	}
+	// bulk load from sorted Morton codes of cells (morton_encode), replacing the contents
+	template <typename Iter>
+	void build_from_sorted(Iter first, Iter last) {
+		codes.assign(first, last);
+		codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+	}
+	void erase(T x, T y) {
+		uint64_t c {code(x, y)};
+		auto pos = std::lower_bound(codes.begin(), codes.end(), c);
+		if (pos != codes.end() && *pos == c) codes.erase(pos);
+	}
+	void clear() {codes.clear();}
+
+	// query
+	bool contains(T x, T y) const {return std::binary_search(codes.begin(), codes.end(), code(x, y));}
+	// whether any occupied cell touches the rectangle (bounds inclusive)
+	bool empty(T x_low, T x_high, T y_low, T y_high) const {
+		Box b {box(x_low, x_high, y_low, y_high)};
+		return !any_in(root_node(b), b);
+	}
+	// number of occupied cells touching the rectangle
+	size_t count(T x_low, T x_high, T y_low, T y_high) const {
+		Box b {box(x_low, x_high, y_low, y_high)};
+		return count_in(root_node(b), b);
+	}
+
+	// lower corners of the k occupied cells closest to (x, y), nearest first
+	// best first search on the nodes ordered by distance to their square
+	std::vector<value_type> k_nearest(T x, T y, size_t k) const {
+		std::vector<value_type> nearest;
+		double px {(static_cast<double>(x) - static_cast<double>(min_x)) / static_cast<double>(unit)};
+		double py {(static_cast<double>(y) - static_cast<double>(min_y)) / static_cast<double>(unit)};
+		using Entry = std::pair<double, Node>;
+		auto farther = [](const Entry& a, const Entry& b) {return a.first > b.first;};
+		std::priority_queue<Entry, std::vector<Entry>, decltype(farther)> frontier {farther};
+		if (!codes.empty()) frontier.push({0.0, root_node()});
+		while (!frontier.empty() && nearest.size() < k) {
+			Node node {frontier.top().second};
+			frontier.pop();
+			if (node.level == 0) {
+				nearest.push_back({static_cast<T>(min_x + static_cast<T>(node.x * unit)), static_cast<T>(min_y + static_cast<T>(node.y * unit))});
+				continue;
+			}
+			// small nodes go straight to their cells
+			if (node.hi - node.lo <= scan_limit) {
+				for (size_t i = node.lo; i < node.hi; ++i) {
+					auto xy = morton_decode(codes[i]);
+					Node cell {codes[i], xy.first, xy.second, 0, i, i + 1};
+					frontier.push({distance(cell, px, py), cell});
+				}
+				continue;
+			}
+			size_t lo {node.lo};
+			for (unsigned q = 0; q < 4; ++q) {
+				size_t hi {quadrant_end(node, q)};
+				if (lo != hi) {
+					Node child {quadrant(node, q, lo, hi)};
+					frontier.push({distance(child, px, py), child});
+				}
+				lo = hi;
+			}
+		}
+		return nearest;
+	}
+
+	// number of occupied cells
+	size_t size() const {return codes.size();}
+	bool empty() const {return codes.empty();}
+	// the sorted Morton codes, the tree's whole representation
+	const std::vector<uint64_t>& cells() const {return codes;}
+};
+
+}	// end namespace sal
@@ -1,20 +1,51 @@
 #pragma once
-#include <cstdlib>	// rand
+#include <cstdint>
 #include <limits>	// max
+#include <utility>
+#include <vector>
 #include "tree.h"	// iterators
+#include "../parallel.h"	// parallel union
 // Treaps are a combination of BST and min-heap with
 // treed on key and heaped on priority, which is randomly generated
 // this simulates a tree built with random data, prevents imbalance
 // parent pointer not really necessary
+// priorities come from each treap's own generator (not the locked, global rand()),
+// so independent treaps on different threads share nothing, and the halves of a split
+// share only their pooled arena, which locks once shared so each half can go to its own thread
+// split and join make bulk operations cheap: building from sorted keys is O(n),
+// union, intersection and difference of sets of size m <= n take O(m log(n/m + 1)) expected
+// (plus destroying the dropped nodes), and erasing a range of k keys O(log n + k)
+// bulk operations consume the other treap and assume set semantics (unique keys)
 namespace sal {
 
-template <typename Node>
+// Alloc creates and destroys nodes, pooled by default (see pool.h)
+// Stats counts rotations from heap fixes on insert and delete (see stats.h)
+template <typename Node, typename Alloc = Node_pool<Node>, typename Stats = No_stats>
 class Treap {
 protected:
 	using NP = Node*;
 	using T = typename Node::key_type;
 
 	NP root {Node::nil};
+	Alloc alloc;
+	Stats counters;
+	// xorshift state, fixed default seed keeps shapes reproducible
+	uint32_t priority_state {0x9E3779B9u};
+
+	// 30 bit priorities, always below nil's
+	int next_priority() {
+		priority_state ^= priority_state << 13;
+		priority_state ^= priority_state >> 17;
+		priority_state ^= priority_state << 5;
+		return static_cast<int>(priority_state >> 2);
+	}
+	// all nodes are created through here to be given a priority
+	template <typename... Args>
+	NP create_node(Args&&... args) {
+		NP node {alloc.create(std::forward<Args>(args)...)};
+		node->priority = next_priority();
+		return node;
+	}
 
 	// treap specific methods
 	void heap_fix_up(NP node) {
@@ -55,7 +86,7 @@ protected:
 			}
 		}
 		fixup(node);
-		delete node;
+		alloc.destroy(node);
 	}
 
 	// core treap utilities
@@ -85,6 +116,7 @@ protected:
 		D     E
 	*/
 	virtual void rotate_left(NP node) {
+		counters.count(Stat::rotate);
 		NP child {node->right};
 
 		node->right = child->left;
@@ -100,6 +132,7 @@ protected:
 	}
 	// rotate right shifts everything right, inverse of rotate left
 	virtual void rotate_right(NP node) {
+		counters.count(Stat::rotate);
 		NP child {node->left};
 
 		node->left = child->right;
@@ -129,6 +162,146 @@ protected:
 		else parent->right = node;
 	}
 
+	// split and join utilities, on detached subtrees whose root parents are fixed by the caller
+	// augmented treaps recompute a node from its children here
+	virtual void update_node(NP) {}
+	void link_left(NP node, NP child) {
+		node->left = child;
+		if (child != Node::nil) child->parent = node;
+	}
+	void link_right(NP node, NP child) {
+		node->right = child;
+		if (child != Node::nil) child->parent = node;
+	}
+	void set_root(NP node) {
+		root = node;
+		if (root != Node::nil) root->parent = Node::nil;
+	}
+	// subtree nodes with keys satisfying before go left, the rest right (before must be monotone)
+	template <typename Pred>
+	std::pair<NP,NP> partition_nodes(NP node, Pred&& before) {
+		if (node == Node::nil) return {Node::nil, Node::nil};
+		if (before(node->key)) {
+			auto parts = partition_nodes(node->right, before);
+			link_right(node, parts.first);
+			update_node(node);
+			return {node, parts.second};
+		}
+		auto parts = partition_nodes(node->left, before);
+		link_left(node, parts.second);
+		update_node(node);
+		return {parts.first, node};
+	}
+	// three way split around key, the equal node (if any) comes out detached
+	struct Split {NP less, equal, greater;};
+	Split split_nodes(NP node, const T& key) {
+		if (node == Node::nil) return {Node::nil, Node::nil, Node::nil};
+		if (node->key < key) {
+			Split parts {split_nodes(node->right, key)};
+			link_right(node, parts.less);
+			update_node(node);
+			return {node, parts.equal, parts.greater};
+		}
+		if (key < node->key) {
+			Split parts {split_nodes(node->left, key)};
+			link_left(node, parts.greater);
+			update_node(node);
+			return {parts.less, parts.equal, node};
+		}
+		Split parts {node->left, node, node->right};
+		node->left = node->right = Node::nil;
+		return parts;
+	}
+	// every key of left before every key of right
+	NP join_nodes(NP left, NP right) {
+		if (left == Node::nil) return right;
+		if (right == Node::nil) return left;
+		if (left->priority < right->priority) {
+			link_right(left, join_nodes(left->right, right));
+			update_node(left);
+			return left;
+		}
+		link_left(right, join_nodes(left, right->left));
+		update_node(right);
+		return right;
+	}
+
+	// dropped nodes are collected and destroyed afterwards so forked unions never touch alloc
+	NP union_nodes(NP a, NP b, std::vector<NP>& dropped, size_t fork_depth, Thread_pool* pool) {
+		if (a == Node::nil) return b;
+		if (b == Node::nil) return a;
+		// the higher priority root stays on top
+		if (b->priority < a->priority) std::swap(a, b);
+		Split parts {split_nodes(b, a->key)};
+		if (parts.equal != Node::nil) dropped.push_back(parts.equal);
+		NP left {a->left}, right {a->right};
+		if (fork_depth > 0) {
+			std::vector<NP> left_dropped;
+			Task_group group {*pool};
+			group.run([&, this]() {left = union_nodes(left, parts.less, left_dropped, fork_depth - 1, pool);});
+			right = union_nodes(right, parts.greater, dropped, fork_depth - 1, pool);
+			group.wait();
+			dropped.insert(dropped.end(), left_dropped.begin(), left_dropped.end());
+		}
+		else {
+			left = union_nodes(left, parts.less, dropped, 0, pool);
+			right = union_nodes(right, parts.greater, dropped, 0, pool);
+		}
+		link_left(a, left);
+		link_right(a, right);
+		update_node(a);
+		return a;
+	}
+	NP intersect_nodes(NP a, NP b, std::vector<NP>& dropped) {
+		if (a == Node::nil || b == Node::nil) {
+			if (a != Node::nil) dropped.push_back(a);
+			if (b != Node::nil) dropped.push_back(b);
+			return Node::nil;
+		}
+		if (b->priority < a->priority) std::swap(a, b);
+		Split parts {split_nodes(b, a->key)};
+		NP left {intersect_nodes(a->left, parts.less, dropped)};
+		NP right {intersect_nodes(a->right, parts.greater, dropped)};
+		if (parts.equal != Node::nil) {
+			dropped.push_back(parts.equal);
+			link_left(a, left);
+			link_right(a, right);
+			update_node(a);
+			return a;
+		}
+		a->left = a->right = Node::nil;
+		dropped.push_back(a);
+		return join_nodes(left, right);
+	}
+	// a without the keys of b
+	NP subtract_nodes(NP a, NP b, std::vector<NP>& dropped) {
+		if (a == Node::nil || b == Node::nil) {
+			if (b != Node::nil) dropped.push_back(b);
+			return a;
+		}
+		Split parts {split_nodes(a, b->key)};
+		NP b_left {b->left}, b_right {b->right};
+		b->left = b->right = Node::nil;
+		dropped.push_back(b);
+		if (parts.equal != Node::nil) dropped.push_back(parts.equal);
+		NP left {subtract_nodes(parts.less, b_left, dropped)};
+		NP right {subtract_nodes(parts.greater, b_right, dropped)};
+		return join_nodes(left, right);
+	}
+	void destroy_subtree(NP node) {
+		postorder_walk(node, [this](NP n){alloc.destroy(n);});
+	}
+	void destroy_all(const std::vector<NP>& subtrees) {
+		for (NP node : subtrees) destroy_subtree(node);
+	}
+	// nodes of other now belong to this treap
+	NP take_nodes(Treap& other) {
+		alloc.absorb(other.alloc);
+		NP taken {other.root};
+		other.root = Node::nil;
+		return taken;
+	}
+
 	// moves one subtree to replace another one
 	void transplant(NP old, NP moved) {
 		// move moved into old's position in the tree without deleting any trees
@@ -137,8 +310,8 @@ protected:
 		// old is a left child
 		else if (is_left_child(old)) old->parent->left = moved;
 		else old->parent->right = moved;
-		// can assign to parent unconditionally due to sentinel (we know it's not nullptr)
-		moved->parent = old->parent;
+		// nil is shared, never assign to it
+		if (moved != Node::nil) moved->parent = old->parent;
 		// updating moved's children and erasing old is up to the caller
 	}
 
@@ -149,14 +322,31 @@ public:
 	using iterator = Tree_iterator<Node>;
 	using const_iterator = Tree_const_iterator<Node>;
 	Treap() = default;
+	// counting into stats kept elsewhere, e.g. a Stats_ref
+	explicit Treap(Stats s) : counters{std::move(s)} {}
 	Treap(std::initializer_list<T> l) {
 		for (const auto& v : l) insert(v);
 	}
+	Treap(Treap&& other) noexcept : 
+		root{other.root}, alloc{std::move(other.alloc)}, counters{std::move(other.counters)}, priority_state{other.priority_state} {
+		other.root = Node::nil;
+	}
+	Treap& operator=(Treap&& other) noexcept {
+		if (this != &other) {
+			clear();
+			root = other.root;
+			alloc = std::move(other.alloc);
+			counters = std::move(other.counters);
+			priority_state = other.priority_state;
+			other.root = Node::nil;
+		}
+		return *this;
+	}
 	virtual ~Treap() {clear();}
 
 	// modifiers
 	void insert(const T& data) {
-		NP node {new Node(data)};
+		NP node {create_node(data)};
 		treap_insert(node, skip_insert_fixup<Node>);
 	};
 
@@ -164,11 +354,100 @@ public:
 		NP node {tree_find(root, data)};
 		if (node != Node::nil) treap_delete(node, skip_delete_fixup<Node>);
 	}
+	// erase every key in [low, high]
+	void erase(const T& low, const T& high) {
+		auto lower = partition_nodes(root, [&low](const T& key){return key < low;});
+		auto upper = partition_nodes(lower.second, [&high](const T& key){return !(high < key);});
+		destroy_subtree(upper.first);
+		set_root(join_nodes(lower.first, upper.second));
+	}
 	void clear() {
-		postorder_walk(root, [](NP node){delete node;});
+		release_tree(root, alloc);
 		root = Node::nil;
 	}
 
+	// bulk operations
+	// replaces the contents with sorted unique keys in O(n)
+	// keeps the right spine on a stack, each new key pops the nodes with lower priority
+	// into its left subtree (a cartesian tree on priority)
+	template <typename Iter>
+	void build_from_sorted(Iter first, Iter last) {
+		clear();
+		std::vector<NP> spine;
+		for (; first != last; ++first) {
+			NP node {create_node(*first)};
+			NP popped {Node::nil};
+			while (!spine.empty() && spine.back()->priority > node->priority) {
+				popped = spine.back();
+				spine.pop_back();
+				// subtree is complete once it leaves the spine
+				update_node(popped);
+			}
+			link_left(node, popped);
+			if (!spine.empty()) link_right(spine.back(), node);
+			spine.push_back(node);
+		}
+		for (size_t i = spine.size(); i-- > 0;) update_node(spine[i]);
+		set_root(spine.empty()? Node::nil : spine.front());
+	}
+	// keys >= key move into the returned treap, which shares this treap's nodes' arena
+	// Node_pool locks an arena once shared, so the halves can be modified concurrently on different threads
+	// (a custom allocator whose share() does not lock would keep them on one thread)
+	Treap split(const T& key) {
+		Treap right;
+		right.alloc.share(alloc);
+		right.seed(next_priority());
+		auto parts = partition_nodes(root, [&key](const T& k){return k < key;});
+		set_root(parts.first);
+		right.set_root(parts.second);
+		return right;
+	}
+	// appends right, whose keys must all come after this treap's
+	void join(Treap&& right) {
+		if (&right == this) return;
+		set_root(join_nodes(root, take_nodes(right)));
+	}
+	// set operations leave the result here and other empty
+	// other must not be in use on another thread, its nodes and arena move here
+	void unite(Treap&& other) {
+		if (&other == this) return;
+		std::vector<NP> dropped;
+		NP b {take_nodes(other)};
+		set_root(union_nodes(root, b, dropped, 0, nullptr));
+		destroy_all(dropped);
+	}
+	// forks the recursion on the two subtrees for the first levels
+	void unite(Treap&& other, Parallel_policy, Thread_pool& pool = Thread_pool::global()) {
+		if (&other == this) return;
+		size_t fork_depth {0};
+		if (pool.size() > 1) {
+			for (size_t n = pool.size(); n > 1; n >>= 1) ++fork_depth;
+			// extra levels so uneven splits still keep every worker busy
+			fork_depth += 2;
+		}
+		std::vector<NP> dropped;
+		NP b {take_nodes(other)};
+		set_root(union_nodes(root, b, dropped, fork_depth, &pool));
+		destroy_all(dropped);
+	}
+	void unite(Treap&& other, Sequential_policy) {unite(std::move(other));}
+	void intersect(Treap&& other) {
+		if (&other == this) return;
+		std::vector<NP> dropped;
+		NP b {take_nodes(other)};
+		set_root(intersect_nodes(root, b, dropped));
+		destroy_all(dropped);
+	}
+	void subtract(Treap&& other) {
+		if (&other == this) {clear(); return;}
+		std::vector<NP> dropped;
+		NP b {take_nodes(other)};
+		set_root(subtract_nodes(root, b, dropped));
+		destroy_all(dropped);
+	}
+	// reseed the priority generator, 0 is not a valid xorshift state
+	void seed(uint32_t s) {priority_state = s? s : 0x9E3779B9u;}
+
 	// query
 	iterator find_and_elevate(const T& key) {
 		NP found {tree_find(root, key)};
@@ -203,6 +482,8 @@ public:
 		return num_elems;
 	}
 	bool empty() const {return root == Node::nil;}
+	Stats& stats() 				{return counters;}
+	const Stats& stats() const 	{return counters;}
 
 	// iterators
 	iterator begin() 			 {return iterator{tree_min(root)};}
@@ -235,7 +516,8 @@ struct Treap_node {
 	T key;
 	int priority;
 	Treap_node() : priority{std::numeric_limits<int>::max()} {}	// sentinel construction
-	Treap_node(T val) : parent{nil}, left{nil}, right{nil}, key{val}, priority{rand()} {}
+	// priority assigned by the treap
+	Treap_node(T val) : parent{nil}, left{nil}, right{nil}, key{val}, priority{0} {}
 };
 
 
@@ -4,9 +4,14 @@
 #include <sstream>
 #include <string>
 #include <initializer_list>
+#include <type_traits>
+#include "../pool.h"	// node allocators
+#include "../stats.h"	// rotation counts
 
 namespace sal {
 // no virtual methods since not meant to be polymorphic (e.g. don't point to an Order_tree with a Tree*)
+// Node::nil is shared by every tree of the same node type and is never written to after construction,
+// so independent trees share no mutable state and can be used from different threads
 // RB tree, 4 properties:
 // 1. Every node either red or black
 // 2. Root and leaves (nil) are black
@@ -165,6 +170,14 @@ void walk_and_print_indented(const Node* start, Print&& printer, int indent_step
 }
 
 
+// destroys every node of a tree, in O(chunks) for pooled trivially destructible nodes
+template <typename Node, typename Alloc>
+void release_tree(Node* root, Alloc& alloc) {
+	if (!Alloc::bulk_release || !std::is_trivially_destructible<Node>::value || !alloc.exclusive())
+		postorder_walk(root, [&alloc](Node* node){alloc.destroy(node);});
+	alloc.release();
+}
+
 // no-op fixup operators
 template<typename Node>
 void skip_insert_fixup(const Node*, const Node*) {}
@@ -268,7 +281,9 @@ struct Tree_const_iterator {
 	adjacent_const_iterator end()   const {return {Node::nil};}
 };
 
-template <typename Node>
+// Alloc creates and destroys nodes, pooled by default (see pool.h)
+// Stats counts rotations, which all fixups go through (see stats.h)
+template <typename Node, typename Alloc = Node_pool<Node>, typename Stats = No_stats>
 class Tree {
 protected:
 	friend struct Tree_iterator<Node>;
@@ -276,12 +291,15 @@ protected:
 	using T = typename Node::key_type;
 
 	NP root {Node::nil};
+	Alloc alloc;
+	Stats counters;
 	// rotations to preserve RB properties
 	/* rotate left shifts everything left s.t. 
 	   it becomes the left child of its original right child
 	   its right child is replaced by its right child's left child
 	*/
 	virtual void rotate_left(NP node) {
+		counters.count(Stat::rotate);
 		NP child {node->right};
 
 		node->right = child->left;
@@ -297,6 +315,7 @@ protected:
 	}
 	// rotate right shifts everything right, inverse of rotate left
 	virtual void rotate_right(NP node) {
+		counters.count(Stat::rotate);
 		NP child {node->left};
 
 		node->left = child->right;
@@ -398,6 +417,8 @@ protected:
 		NP moved {node};
 		// successor is either the single child of moved or Node::nil
 		NP successor;
+		// parent of successor tracked separately since nil's parent is never assigned
+		NP successor_parent {node->parent};
 		Color moved_original_color {moved->color};
 		// < 2 children, successor is just the other child
 		if (node->left == Node::nil) {
@@ -414,8 +435,9 @@ protected:
 			moved_original_color = moved->color;
 			successor = moved->right;
 			// immediate right child of node
-			if (moved->parent == node) successor->parent = moved;
+			if (moved->parent == node) successor_parent = moved;
 			else {
+				successor_parent = moved->parent;
 				// transplant assigns successor's parents
 				transplant(moved, moved->right);
 				moved->right = node->right;
@@ -430,16 +452,16 @@ protected:
 		// additional fixup to restore augmented data
 		fixup(moved);
 		// possible violation if a black node was moved
-		if (moved_original_color == Color::BLACK) rb_delete_fixup(successor);
-		delete node;
+		if (moved_original_color == Color::BLACK) rb_delete_fixup(successor, successor_parent);
+		alloc.destroy(node);
 	}
-	void rb_delete_fixup(NP successor) {
+	void rb_delete_fixup(NP successor, NP parent) {
 		// successor starts black-black, always has 1 extra black
 		// move extra black up tree until 
 		// 1. successor is red-black
 		// 2. successor is root, where extra black is removed
+		// successor may be nil, so its parent is passed along rather than read
 		while (successor != root && successor->color == Color::BLACK) {
-			NP parent {successor->parent};
 			if (successor == parent->left) {
 				// sibling cannot be Node::nil since successor is black (so bh is at least 1)
 				NP sibling {parent->right};
@@ -456,6 +478,7 @@ protected:
 				if (sibling->left->color == Color::BLACK && sibling->right->color == Color::BLACK) {
 					sibling->color = Color::RED;
 					successor = parent;	// parent now double black
+					parent = successor->parent;
 				}
 				else {
 					// case 3, sibling's left is red, switch sibling and its left child's color
@@ -487,6 +510,7 @@ protected:
 				if (sibling->right->color == Color::BLACK && sibling->left->color == Color::BLACK) {
 					sibling->color = Color::RED;
 					successor = parent;	// parent now double black
+					parent = successor->parent;
 				}
 				else {
 					if (sibling->left->color == Color::BLACK) {
@@ -503,7 +527,7 @@ protected:
 				}
 			}
 		}
-		successor->color = Color::BLACK;
+		if (successor != Node::nil) successor->color = Color::BLACK;
 	}
 
 	// moves one subtree to replace another one
@@ -511,8 +535,8 @@ protected:
 		if (old->parent == Node::nil) root = moved;
 		else if (is_left_child(old)) old->parent->left = moved;
 		else old->parent->right = moved;
-		// can assign to parent unconditionally due to sentinel
-		moved->parent = old->parent;
+		// nil is shared, never assign to it
+		if (moved != Node::nil) moved->parent = old->parent;
 		// updating moved's children is up to the caller
 	}
 
@@ -563,20 +587,20 @@ public:
 
 	// modifiers (non-virtual)
 	void insert(T data) {
-		NP node {new Node(data)};
+		NP node {alloc.create(data)};
 		rb_insert(node, skip_insert_fixup<Node>);	// no additional work (useful only for augments)
 	}
 	template <typename...Args>
 	void emplace(Args&&... args) {
-		NP node {new Node(std::forward<Args>(args)...)};
-		rb_insert(node);
+		NP node {alloc.create(std::forward<Args>(args)...)};
+		rb_insert(node, skip_insert_fixup<Node>);
 	}
 	void erase(T data) {
 		NP node {tree_find(root, data)};
 		if (node != Node::nil) rb_delete(node, skip_delete_fixup<Node>);	// no additional work (useful only for augments)
 	}
 	void clear() {
-		postorder_walk(root, [](NP node){delete node;});
+		release_tree(root, alloc);
 		root = Node::nil;
 	}			
 
@@ -591,6 +615,8 @@ public:
 		return num_elems;
 	}
 	bool empty() const {return root == Node::nil;}
+	Stats& stats() 				{return counters;}
+	const Stats& stats() const 	{return counters;}
 	// get root for traversal purposes
 	iterator get_root()				{return iterator{root};}
 	const_iterator get_root() const {return const_iterator{root};}
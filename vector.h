@@ -1,5 +1,13 @@
 #pragma once
 #include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>		// allocator traits
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <sys/mman.h>	// madvise for huge pages
 
 namespace sal {
 
@@ -10,6 +18,7 @@ namespace sal {
 // MUCH less secure than std vector though, use in multithreaded environments at your own risk
 template <typename T>
 class Persistent_vector {
+	static_assert(std::is_trivially_copyable<T>::value, "elements are moved with realloc, use Fast_vector");
 	T* elems;
 	size_t size_;	// usable size
 	size_t capacity_;	// actual size
@@ -32,18 +41,19 @@ public:
 	// core functions
 	Persistent_vector() : elems{nullptr}, size_{0}, capacity_{0} {}
 	Persistent_vector(size_t s) : elems{static_cast<T*>(malloc(s * sizeof(T)))}, size_{0}, capacity_{s} {}
-	Persistent_vector(const Persistent_vector& pv) : elems{static_cast<T*>(malloc(pv.size_ * sizeof(T)))}, size_{pv.size_}, capacity_{pv.capacity_} {
+	Persistent_vector(const Persistent_vector& pv) : elems{static_cast<T*>(malloc(pv.capacity_ * sizeof(T)))}, size_{pv.size_}, capacity_{pv.capacity_} {
 		memcpy(elems, pv.elems, size_ * sizeof(T));
 	}
-	Persistent_vector(Persistent_vector&& pv) : elems{pv.elems}, size_{pv.size_}, capacity_{pv.capacity_} {pv.elems = nullptr; pv.size_ = 0;}
+	Persistent_vector(Persistent_vector&& pv) : elems{pv.elems}, size_{pv.size_}, capacity_{pv.capacity_} {pv.elems = nullptr; pv.size_ = 0; pv.capacity_ = 0;}
 	Persistent_vector& operator=(const Persistent_vector& pv) {	// not even basic gurantee...
 		if (pv.elems != elems) {
 			destroy();
 			size_ = pv.size_;
 			capacity_ = pv.capacity_;
-			elems = static_cast<T*>(malloc(size_ * sizeof(T)));
+			elems = static_cast<T*>(malloc(capacity_ * sizeof(T)));
 			memcpy(elems, pv.elems, size_ * sizeof(T));
 		}
+		return *this;
 	}
 	Persistent_vector& operator=(Persistent_vector&& pv) {
 		if (pv.elems != elems) {
@@ -53,7 +63,9 @@ public:
 			capacity_ = pv.capacity_;
 			pv.elems = nullptr;
 			pv.size_ = 0;
+			pv.capacity_ = 0;
 		}
+		return *this;
 	}
 	~Persistent_vector() {destroy();}
 	// modifiers, no checking for out of bounds
@@ -85,7 +97,7 @@ public:
 	// resizing and clearing, don't actually remove elements, just make them inaccessible in iteration
 	// calling realloc with a smaller size will free the tail, so only do it if it grows tail
 	void reserve(size_t s) {
-		if (s > capacity_) {elems = realloc(elems, s * sizeof(T)); capacity_ = s;}
+		if (s > capacity_) {elems = static_cast<T*>(realloc(elems, s * sizeof(T))); capacity_ = s;}
 	}
 	void resize(size_t s) {	// no testing for safety; living on the egde...
 		reserve(s);
@@ -108,6 +120,7 @@ public:
 // again, not very secure! (barely better than a raw array), but use when the situation is very regular
 template <typename T>
 class Fixed_vector {
+	static_assert(std::is_trivially_copyable<T>::value, "elements are moved with realloc, use Fast_vector");
 	T* elems;
 	size_t size_;	// actual size_
 
@@ -132,6 +145,7 @@ public:
 			elems = static_cast<T*>(malloc(size_ * sizeof(T)));
 			memcpy(elems, pv.elems, size_ * sizeof(T));
 		}
+		return *this;
 	}
 	Fixed_vector& operator=(Fixed_vector&& pv) {
 		if (pv.elems != elems) {
@@ -141,6 +155,7 @@ public:
 			pv.elems = nullptr;
 			pv.size_ = 0;
 		}
+		return *this;
 	}
 	~Fixed_vector() {destroy();}
 	// modifiers, no checking for out of bounds
@@ -184,4 +199,268 @@ public:
 	void clear() {size_ = 0;}	// does not actually remove elements
 
 };
-}	// end namespace sal
\ No newline at end of file
+
+
+// fast vector for any element type ----------
+// elements that can be moved by copying their bytes and forgetting the source
+// specialize for types like unique_ptr that own resources but don't point into themselves
+template <typename T>
+struct Is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// malloc backed allocator that can also grow blocks through realloc, avoiding the copy when
+// there is room after the block
+template <typename T>
+struct Malloc_allocator {
+	static_assert(alignof(T) <= alignof(std::max_align_t), "malloc only aligns to max_align_t");
+	using value_type = T;
+
+	Malloc_allocator() = default;
+	template <typename U>
+	Malloc_allocator(const Malloc_allocator<U>&) {}
+
+	T* allocate(size_t n) {
+		void* block {std::malloc(n * sizeof(T))};
+		if (!block) throw std::bad_alloc{};
+		return static_cast<T*>(block);
+	}
+	void deallocate(T* block, size_t) {std::free(block);}
+	// only given trivially relocatable elements
+	T* reallocate(T* block, size_t, size_t n) {
+		void* grown {std::realloc(static_cast<void*>(block), n * sizeof(T))};
+		if (!grown) throw std::bad_alloc{};
+		return static_cast<T*>(grown);
+	}
+	friend bool operator==(const Malloc_allocator&, const Malloc_allocator&) {return true;}
+	friend bool operator!=(const Malloc_allocator&, const Malloc_allocator&) {return false;}
+};
+
+// blocks of at least a huge page are aligned to one and marked for transparent huge pages,
+// so long sweeps over big vectors take far fewer TLB misses; smaller blocks come from malloc
+constexpr size_t huge_page_size = size_t{2} << 20;
+
+template <typename T>
+struct Huge_page_allocator {
+	static_assert(alignof(T) <= alignof(std::max_align_t), "malloc only aligns to max_align_t");
+	using value_type = T;
+
+	Huge_page_allocator() = default;
+	template <typename U>
+	Huge_page_allocator(const Huge_page_allocator<U>&) {}
+
+	T* allocate(size_t n) {
+		size_t bytes {n * sizeof(T)};
+		void* block;
+		if (bytes >= huge_page_size) {
+			bytes = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+			block = std::aligned_alloc(huge_page_size, bytes);
+			if (block) madvise(block, bytes, MADV_HUGEPAGE);
+		}
+		else block = std::malloc(bytes);
+		if (!block) throw std::bad_alloc{};
+		return static_cast<T*>(block);
+	}
+	void deallocate(T* block, size_t) {std::free(block);}
+	friend bool operator==(const Huge_page_allocator&, const Huge_page_allocator&) {return true;}
+	friend bool operator!=(const Huge_page_allocator&, const Huge_page_allocator&) {return false;}
+};
+
+// allocators that can resize a block themselves, used for trivially relocatable elements
+template <typename Alloc, typename = void>
+struct Has_reallocate : std::false_type {};
+template <typename Alloc>
+struct Has_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+	std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// a Persistent_vector that is safe for any element type
+// growth is picked at compile time: trivially relocatable elements are moved by the allocator's
+// reallocate (realloc by default) or memcpy, others are move constructed (copied if moves can throw)
+// the allocator is any standard one, e.g. Huge_page_allocator or std::pmr::polymorphic_allocator for arenas
+// clear keeps the capacity like Persistent_vector, only shrink_to_fit gives memory back
+template <typename T, typename Alloc = Malloc_allocator<T>>
+class Fast_vector {
+	using Traits = std::allocator_traits<Alloc>;
+	static constexpr bool relocatable = Is_trivially_relocatable<T>::value;
+
+	T* elems {nullptr};
+	size_t size_ {0};
+	size_t capacity_ {0};
+	Alloc alloc;
+
+	template <typename... Args>
+	void construct(T* place, Args&&... args) {
+		// aggregates (edges, points) can be emplaced like with Persistent_vector's braces
+		if constexpr (std::is_constructible<T, Args&&...>::value) 
+			Traits::construct(alloc, place, std::forward<Args>(args)...);
+		else ::new (static_cast<void*>(place)) T{std::forward<Args>(args)...};
+	}
+	template <typename... Args>
+	static T make(Args&&... args) {
+		if constexpr (std::is_constructible<T, Args&&...>::value) return T(std::forward<Args>(args)...);
+		else return T{std::forward<Args>(args)...};
+	}
+	void destroy(T* first, T* last) {
+		if constexpr (!std::is_trivially_destructible<T>::value)
+			for (; first != last; ++first) Traits::destroy(alloc, first);
+	}
+	void release() {
+		destroy(elems, elems + size_);
+		if (elems) Traits::deallocate(alloc, elems, capacity_);
+		elems = nullptr;
+		size_ = capacity_ = 0;
+	}
+	// move the elements into a block of new_capacity >= size_
+	void relocate(size_t new_capacity) {
+		if (new_capacity == 0) return release();
+		if constexpr (relocatable && Has_reallocate<Alloc>::value) {
+			if (elems) {
+				elems = alloc.reallocate(elems, capacity_, new_capacity);
+				capacity_ = new_capacity;
+				return;
+			}
+		}
+		T* fresh {Traits::allocate(alloc, new_capacity)};
+		if constexpr (relocatable) {
+			if (size_) std::memcpy(static_cast<void*>(fresh), static_cast<const void*>(elems), size_ * sizeof(T));
+		}
+		else if constexpr (std::is_nothrow_move_constructible<T>::value) {
+			// one pass, each element is moved and its husk destroyed while in cache
+			for (size_t i = 0; i < size_; ++i) {
+				construct(fresh + i, std::move(elems[i]));
+				destroy(elems + i, elems + i + 1);
+			}
+		}
+		else {
+			size_t built {0};
+			try {
+				for (; built < size_; ++built) construct(fresh + built, std::move_if_noexcept(elems[built]));
+			}
+			catch (...) {	// old block untouched if copying
+				destroy(fresh, fresh + built);
+				Traits::deallocate(alloc, fresh, new_capacity);
+				throw;
+			}
+			destroy(elems, elems + size_);
+		}
+		if (elems) Traits::deallocate(alloc, elems, capacity_);
+		elems = fresh;
+		capacity_ = new_capacity;
+	}
+	void copy_from(const Fast_vector& v) {
+		reserve(v.size_);
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			if (v.size_) std::memcpy(static_cast<void*>(elems), static_cast<const void*>(v.elems), v.size_ * sizeof(T));
+			size_ = v.size_;
+		}
+		else for (const T& elem : v) emplace_back(elem);
+	}
+public:
+	using value_type = T;
+	using allocator_type = Alloc;
+	using iterator = T*;
+	using const_iterator = const T*;
+	// core functions
+	Fast_vector() = default;
+	explicit Fast_vector(const Alloc& a) : alloc{a} {}
+	Fast_vector(const Fast_vector& v) : alloc{Traits::select_on_container_copy_construction(v.alloc)} {copy_from(v);}
+	Fast_vector(Fast_vector&& v) noexcept : elems{v.elems}, size_{v.size_}, capacity_{v.capacity_}, alloc{std::move(v.alloc)} {
+		v.elems = nullptr;
+		v.size_ = v.capacity_ = 0;
+	}
+	Fast_vector(std::initializer_list<T> l, const Alloc& a = Alloc{}) : alloc{a} {
+		reserve(l.size());
+		for (const T& elem : l) emplace_back(elem);
+	}
+	Fast_vector& operator=(const Fast_vector& v) {
+		if (&v == this) return *this;
+		clear();
+		if constexpr (Traits::propagate_on_container_copy_assignment::value) {
+			if (alloc != v.alloc) release();
+			alloc = v.alloc;
+		}
+		copy_from(v);
+		return *this;
+	}
+	Fast_vector& operator=(Fast_vector&& v) noexcept(Traits::propagate_on_container_move_assignment::value || 
+		Traits::is_always_equal::value) {
+		if (&v == this) return *this;
+		if (Traits::propagate_on_container_move_assignment::value || alloc == v.alloc) {
+			release();
+			if constexpr (Traits::propagate_on_container_move_assignment::value) alloc = std::move(v.alloc);
+			elems = v.elems;
+			size_ = v.size_;
+			capacity_ = v.capacity_;
+			v.elems = nullptr;
+			v.size_ = v.capacity_ = 0;
+		}
+		else {	// memory of another arena can't be taken over
+			clear();
+			reserve(v.size_);
+			for (T& elem : v) emplace_back(std::move(elem));
+			v.clear();
+		}
+		return *this;
+	}
+	~Fast_vector() {release();}
+
+	// modifiers, no checking for out of bounds
+	// constructed in place without a temporary
+	template <typename... Args>
+	T& emplace_back(Args&&... args) {
+		if (size_ == capacity_) {
+			// arguments may refer to elements about to move, so build the element first
+			T elem {make(std::forward<Args>(args)...)};
+			relocate(capacity_? 2 * capacity_ : 4);
+			construct(elems + size_, std::move(elem));
+		}
+		else construct(elems + size_, std::forward<Args>(args)...);
+		return elems[size_++];
+	}
+	void push_back(const T& e) {emplace_back(e);}
+	void push_back(T&& e) {emplace_back(std::move(e));}
+	void pop_back() {--size_; destroy(elems + size_, elems + size_ + 1);}
+
+	// query and retrieval
+	bool empty() const {return size_ == 0;}
+	size_t size() const {return size_;}
+	size_t capacity() const {return capacity_;}
+	const T& operator[](size_t i) const {return elems[i];}
+	T& operator[](size_t i) {return elems[i];}
+	T& back() {return elems[size_ - 1];}
+	const T& back() const {return elems[size_ - 1];}
+	T* data() {return elems;}
+	const T* data() const {return elems;}
+	Alloc get_allocator() const {return alloc;}
+
+	// iteration
+	iterator begin() {return elems;}
+	iterator end() {return elems + size_;}
+	const_iterator begin() const {return elems;}
+	const_iterator end() const {return elems + size_;}
+
+	// resizing and clearing
+	void reserve(size_t s) {if (s > capacity_) relocate(s);}
+	// new elements are default initialized, so trivial ones are left as they were like Persistent_vector
+	void resize(size_t s) {
+		reserve(s);
+		if (s < size_) destroy(elems + s, elems + size_);
+		else for (; size_ < s; ++size_) ::new (static_cast<void*>(elems + size_)) T;
+		size_ = s;
+	}
+	void resize(size_t s, const T& def) {
+		reserve(s);
+		if (s < size_) {destroy(elems + s, elems + size_); size_ = s;}
+		while (size_ < s) emplace_back(def);
+	}
+	// destroys the elements but keeps the memory for reuse
+	void clear() {destroy(elems, elems + size_); size_ = 0;}
+	void shrink_to_fit() {if (capacity_ > size_) relocate(size_);}
+
+	void swap(Fast_vector& v) noexcept {
+		std::swap(elems, v.elems);
+		std::swap(size_, v.size_);
+		std::swap(capacity_, v.capacity_);
+		if constexpr (Traits::propagate_on_container_swap::value) std::swap(alloc, v.alloc);
+	}
+};
+
+}	// end namespace sal